@@ -0,0 +1,1012 @@
+/**
+ * @file BenchmarkMain.cpp
+ * @brief Micro-benchmarks for the PetSpace hot paths - build with "make clean bench"
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-07
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ChatRoom.h"
+#include "CtrlCat.h"
+#include "Command.h"
+#include "CommandJournal.h"
+#include "CommandQueue.h"
+#include "CommandScheduler.h"
+#include "CommandVariant.h"
+#include "Logger.h"
+#include "ProfanityAutomaton.h"
+#include "RoomSet.h"
+#include "SaveMessageCommand.h"
+#include "SendPipeline.h"
+#include "SendMessageCommand.h"
+#include "StringInterner.h"
+#include "StructuredLog.h"
+#include "SubstringSearcher.h"
+#include "ThreadPool.h"
+#include "UserTable.h"
+#include "Users.h"
+#include "ValidationStrategy.h"
+
+// Count every heap allocation so benchmarks can report allocations per operation
+std::atomic<unsigned long> allocationCount(0);
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void printSeparator(const std::string& title) {
+    std::cout << "\n" << std::string(50, '=') << std::endl;
+    std::cout << title << std::endl;
+    std::cout << std::string(50, '=') << std::endl;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Mix of clean, profane, shouty and long messages
+std::vector<std::string> makeMessages(size_t count, size_t maxLength) {
+    const char* samples[] = {
+        "Hello everyone, how are the cats today?",
+        "My dog ate my homework again",
+        "This is stupid and it sucks",
+        "PLEASE READ THIS IMPORTANT NOTICE",
+        "Anyone up for a walk in the park later?",
+        "what the shit happened here",
+        "Feeding time is at five o'clock sharp",
+        "Look at this picture of my hamster"
+    };
+
+    std::vector<std::string> messages;
+    messages.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::string message = samples[i % 8];
+        message += " #" + std::to_string(i);
+        while (message.length() + 40 < maxLength && (i % 5) == 0) {
+            message += " and some more words about pets";
+        }
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+// ================== BATCH VALIDATION BENCHMARK ==================
+void benchBatchValidation() {
+    printSeparator("BATCH VALIDATION BENCHMARK");
+
+    const size_t count = 200000;
+    std::vector<std::string> messages = makeMessages(count, 100);
+    FreeUserValidationStrategy strategy;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    size_t approved = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (strategy.evaluate(messages[i]) == ValidationVerdict::APPROVED) approved++;
+    }
+    double serial = secondsSince(start);
+    std::cout << "Serial evaluate:   " << count / serial << " msgs/s (" << approved << " approved)" << std::endl;
+
+    size_t hardware = std::thread::hardware_concurrency();
+    for (size_t threads = 1; threads <= std::max<size_t>(hardware, 1); threads *= 2) {
+        ThreadPool pool(threads);
+        start = std::chrono::steady_clock::now();
+        BatchValidationResult result = strategy.validateBatch(&messages[0], count, nullptr, &pool);
+        double elapsed = secondsSince(start);
+        std::cout << "Batch, " << threads << " worker(s): " << count / elapsed << " msgs/s, speedup "
+                  << serial / elapsed << "x (" << result.approvedCount << " approved)" << std::endl;
+    }
+}
+
+// The find-based scanner the strategies used before the automaton
+bool legacyContainsProfanity(const std::string& message, const std::vector<std::string>& blockedWords) {
+    std::string lowerMessage = message;
+    std::transform(lowerMessage.begin(), lowerMessage.end(), lowerMessage.begin(), ::tolower);
+
+    for (const std::string& word : blockedWords) {
+        size_t pos = 0;
+        while ((pos = lowerMessage.find(word, pos)) != std::string::npos) {
+            bool isWordStart = (pos == 0 || !isalnum(static_cast<unsigned char>(lowerMessage[pos - 1])));
+            bool isWordEnd = (pos + word.length() == lowerMessage.length() ||
+                             !isalnum(static_cast<unsigned char>(lowerMessage[pos + word.length()])));
+            if (isWordStart && isWordEnd) {
+                return true;
+            }
+            pos++;
+        }
+    }
+    return false;
+}
+
+// ================== PROFANITY SCANNER BENCHMARK ==================
+void benchProfanityScanners() {
+    printSeparator("PROFANITY SCANNER BENCHMARK");
+
+    std::vector<std::string> blockedWords = {
+        "stupid", "dumb", "hate", "sucks", "crap", "damn", "hell",
+        "shut", "idiot", "loser", "weird", "ugly", "fat", "shit", "fuck", "bitch", "poes"
+    };
+    ProfanityAutomaton automaton(blockedWords);
+    std::vector<std::string> messages = makeMessages(100000, 400);
+
+    size_t bytes = 0;
+    for (const std::string& message : messages) bytes += message.length();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    size_t legacyHits = 0;
+    for (const std::string& message : messages) {
+        if (legacyContainsProfanity(message, blockedWords)) legacyHits++;
+    }
+    double legacy = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t automatonHits = 0;
+    for (const std::string& message : messages) {
+        if (automaton.matches(message, nullptr)) automatonHits++;
+    }
+    double dfa = secondsSince(start);
+
+    std::cout << "Legacy find loop: " << bytes / legacy / 1e6 << " MB/s (" << legacyHits << " hits)" << std::endl;
+    std::cout << "DFA (" << automaton.getStateCount() << " states, " << automaton.getClassCount() << " classes): "
+              << bytes / dfa / 1e6 << " MB/s (" << automatonHits << " hits, obfuscation-aware)" << std::endl;
+    std::cout << "Speedup: " << legacy / dfa << "x" << std::endl;
+
+    // Compile cost of a large list, paid off the hot path on reload
+    std::vector<std::string> largeList;
+    uint32_t seed = 2463534242u;
+    for (size_t i = 0; i < 50000; i++) {
+        std::string word;
+        seed = seed * 1103515245u + 12345u;
+        size_t length = 4 + (seed >> 16) % 6;
+        for (size_t c = 0; c < length; c++) {
+            seed = seed * 1103515245u + 12345u;
+            word.push_back(static_cast<char>('a' + (seed >> 16) % 26));
+        }
+        largeList.push_back(word);
+    }
+    start = std::chrono::steady_clock::now();
+    ProfanityAutomaton large(largeList);
+    std::cout << "Compiling 50000 terms: " << secondsSince(start) * 1000 << " ms, "
+              << large.getNodeCount() << " trie nodes, " << large.getStateCount() << " table states" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    size_t largeHits = 0;
+    for (const std::string& message : messages) {
+        if (large.matches(message, nullptr)) largeHits++;
+    }
+    std::cout << "Scanning with 50000 terms: " << bytes / secondsSince(start) / 1e6 << " MB/s (" << largeHits << " hits)" << std::endl;
+}
+
+// The threat check the admin strategy used before SubstringSearcher
+bool legacyContainsThreats(const std::string& message, const std::vector<std::string>& threatWords) {
+    std::string upperMessage = message;
+    std::transform(upperMessage.begin(), upperMessage.end(), upperMessage.begin(), ::toupper);
+
+    for (const std::string& threat : threatWords) {
+        std::string upperThreat = threat;
+        std::transform(upperThreat.begin(), upperThreat.end(), upperThreat.begin(), ::toupper);
+        if (upperMessage.find(upperThreat) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ================== ADMIN THREAT SEARCH BENCHMARK ==================
+void benchThreatSearch() {
+    printSeparator("ADMIN THREAT SEARCH BENCHMARK");
+
+    std::vector<std::string> threatWords = {
+        "DELETE FROM", "DROP TABLE", "rm -rf", "format c:",
+        "shutdown", "reboot", "kill -9", "sudo rm", "del /s"
+    };
+    SubstringSearcher searcher(threatWords);
+
+    // 2 KB admin announcements, clean so every pattern is scanned in full
+    std::string message;
+    while (message.length() < 2000) {
+        message += "Reminder: the Dogorithm room will be moderated more strictly from Monday. ";
+    }
+    message.resize(2000);
+
+    const size_t iterations = 20000;
+    std::ostringstream report;
+    size_t hits = 0;
+
+    unsigned long allocationsBefore = allocationCount.load();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        if (legacyContainsThreats(message, threatWords)) hits++;
+    }
+    double legacy = secondsSince(start);
+    unsigned long legacyAllocations = allocationCount.load() - allocationsBefore;
+
+    allocationsBefore = allocationCount.load();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        if (searcher.search(message) >= 0) hits++;
+    }
+    double horspool = secondsSince(start);
+    unsigned long horspoolAllocations = allocationCount.load() - allocationsBefore;
+
+    std::cout << "Legacy uppercase+find: " << legacy / iterations * 1e9 << " ns/msg, "
+              << static_cast<double>(legacyAllocations) / iterations << " allocs/msg" << std::endl;
+    std::cout << "SubstringSearcher:     " << horspool / iterations * 1e9 << " ns/msg, "
+              << static_cast<double>(horspoolAllocations) / iterations << " allocs/msg" << std::endl;
+    std::cout << "Speedup: " << legacy / horspool << "x (" << hits << " hits)" << std::endl;
+}
+
+// ================== LOGGER BACKEND BENCHMARK ==================
+// Mean and 99th percentile of ChatRoom::sendMessage with every log line enabled
+void measureSendLatency(std::ostream& report, const char* label, ChatRoom* room, User* sender, size_t iterations) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (size_t i = 0; i < iterations; i++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        room->sendMessage("Walkies at five, bring treats", sender);
+        samples.push_back(secondsSince(start) * 1e9);
+    }
+    Logger::flush();
+
+    double total = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        total += samples[i];
+    }
+    std::sort(samples.begin(), samples.end());
+    report << label << "mean " << total / iterations << " ns, p99 "
+              << samples[iterations * 99 / 100] << " ns" << std::endl;
+}
+
+void benchLoggerBackends() {
+    printSeparator("LOGGER BACKEND BENCHMARK");
+
+    ChatRoom* room = new CtrlCat();
+    std::vector<User*> members;
+    for (int i = 0; i < 8; i++) {
+        members.push_back(new PremiumUser("Member" + std::to_string(i)));
+        room->registerUser(members.back());
+    }
+
+    // Log to a real file so the synchronous path pays for its flushes
+    const char* scratchPath = "bench_log.tmp";
+    std::ofstream scratch(scratchPath);
+    std::streambuf* original = std::cout.rdbuf(scratch.rdbuf());
+    Logger::setLevel(DEBUG);
+
+    const size_t iterations = 20000;
+    std::ostringstream report;
+    measureSendLatency(report, "Synchronous (endl):   ", room, members[0], iterations);
+
+    Logger::resetStats();
+    Logger::startAsync(8192, LogOverflowPolicy::BLOCK);
+    measureSendLatency(report, "Async ring, BLOCK:    ", room, members[0], iterations);
+    Logger::stopAsync();
+    LoggerStats blocking = Logger::getStats();
+
+    Logger::resetStats();
+    Logger::startAsync(256, LogOverflowPolicy::DROP);
+    measureSendLatency(report, "Async ring, DROP 256: ", room, members[0], iterations);
+    Logger::stopAsync();
+    LoggerStats dropping = Logger::getStats();
+
+    Logger::setLevel(NONE);
+    std::cout.rdbuf(original);
+    scratch.close();
+    std::remove(scratchPath);
+
+    std::cout << report.str();
+    std::cout << "BLOCK: " << blocking.written << " records in " << blocking.batches << " writes, "
+              << blocking.blocked << " waited for space" << std::endl;
+    std::cout << "DROP:  " << dropping.written << " written, " << dropping.dropped << " dropped" << std::endl;
+
+    for (size_t i = 0; i < members.size(); i++) {
+        delete members[i];
+    }
+    delete room;
+}
+
+// ================== STRUCTURED LOG BENCHMARK ==================
+// One message's worth of send-path debug records
+void logSendPath(const LogName& sender, const LogName& receiver, const std::string& message) {
+    LOG_EVENT(USER, DEBUG, SENDING_MESSAGE, sender, message);
+    LOG_EVENT(USER, DEBUG, COMMAND_ADDED, sender);
+    LOG_EVENT(USER, DEBUG, EXECUTING_COMMANDS, sender, 2);
+    LOG_EVENT(COMMAND, DEBUG, SEND_EXECUTING);
+    LOG_EVENT(CHATROOM, DEBUG, BROADCASTING, sender);
+    LOG_EVENT(USER, DEBUG, MESSAGE_RECEIVED, receiver, sender, "Premium");
+    LOG_EVENT(COMMAND, DEBUG, SEND_COMPLETED);
+    LOG_EVENT(USER, DEBUG, COMMANDS_EXECUTED, sender);
+}
+
+long fileSize(const char* path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return static_cast<long>(file.tellg());
+}
+
+void benchStructuredLog() {
+    printSeparator("STRUCTURED LOG BENCHMARK");
+
+    std::string senderName = "WhiskersTheCat";
+    std::string receiverName = "RexTheDog";
+    LogNameRef senderRef, receiverRef;
+    LogName sender(senderName, senderRef);
+    LogName receiver(receiverName, receiverRef);
+    std::string message = "Walkies at five, bring treats";
+
+    const size_t iterations = 100000;
+    const double records = iterations * 8.0;
+    const char* textPath = "bench_text.tmp";
+    const char* binaryPath = "bench_binary.tmp";
+    Logger::setLevel(DEBUG);
+
+    std::ofstream textFile(textPath);
+    std::streambuf* original = std::cout.rdbuf(textFile.rdbuf());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        logSendPath(sender, receiver, message);
+    }
+    double text = secondsSince(start);
+    std::cout.rdbuf(original);
+    textFile.close();
+
+    StructuredLog::open(binaryPath);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        logSendPath(sender, receiver, message);
+    }
+    double binary = secondsSince(start);
+    StructuredLog::close();
+    Logger::setLevel(NONE);
+
+    long textBytes = fileSize(textPath);
+    long binaryBytes = fileSize(binaryPath);
+    std::remove(textPath);
+    std::remove(binaryPath);
+
+    std::cout << "Text (std::cout lines): " << text / records * 1e9 << " ns/record, "
+              << textBytes / records << " bytes/record" << std::endl;
+    std::cout << "Binary (StructuredLog): " << binary / records * 1e9 << " ns/record, "
+              << binaryBytes / records << " bytes/record" << std::endl;
+    std::cout << "Speedup: " << text / binary << "x, size ratio: "
+              << static_cast<double>(textBytes) / binaryBytes << "x" << std::endl;
+}
+
+// ================== COMMAND ALLOCATION BENCHMARK ==================
+void benchCommandAllocation() {
+    printSeparator("COMMAND ALLOCATION BENCHMARK");
+
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* sender = new PremiumUser("Allocator");
+    AdminUser* listener = new AdminUser("AllocListener");
+    room->registerUser(sender);
+    room->registerUser(listener);
+    std::string message = "Walkies at five";
+    const size_t iterations = 200000;
+
+    // The old path: every command straight from the general-purpose heap
+    unsigned long before = allocationCount.load();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        SendMessageCommand* send = ::new SendMessageCommand(room, sender, message);
+        SaveMessageCommand* save = ::new SaveMessageCommand(room, sender, message);
+        ::delete send;
+        ::delete save;
+    }
+    double heap = secondsSince(start);
+    double heapAllocations = static_cast<double>(allocationCount.load() - before) / iterations;
+
+    before = allocationCount.load();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        Command* send = new SendMessageCommand(room, sender, message);
+        Command* save = new SaveMessageCommand(room, sender, message);
+        delete send;
+        delete save;
+    }
+    double pooled = secondsSince(start);
+    double pooledAllocations = static_cast<double>(allocationCount.load() - before) / iterations;
+
+    // Whole send path, which still copies the message into the history
+    const size_t messages = 20000;
+    before = allocationCount.load();
+    for (size_t i = 0; i < messages; i++) {
+        sender->send(message, room);
+    }
+    double sendAllocations = static_cast<double>(allocationCount.load() - before) / messages;
+
+    std::cout << "Heap commands:   " << heap / iterations * 1e9 << " ns/message, "
+              << heapAllocations << " allocations/message" << std::endl;
+    std::cout << "Pooled commands: " << pooled / iterations * 1e9 << " ns/message, "
+              << pooledAllocations << " allocations/message" << std::endl;
+    std::cout << "Full send path:  " << sendAllocations << " allocations/message" << std::endl;
+
+    // Queue and run a send + save pair: virtual commands vs inline variants
+    Logger::setLevel(NONE);
+    CommandQueue queue;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        queue.push(new SendMessageCommand(room, sender, message));
+        queue.push(new SaveMessageCommand(room, sender, message));
+        queue.executeAll();
+    }
+    double virtualQueue = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        queue.push(CommandVariant::sendMessage(room, sender, message));
+        queue.push(CommandVariant::saveMessage(room, sender, message));
+        queue.executeAll();
+    }
+    double variantQueue = secondsSince(start);
+
+    std::cout << "Virtual queue:   " << virtualQueue / iterations * 1e9 << " ns/message" << std::endl;
+    std::cout << "Variant queue:   " << variantQueue / iterations * 1e9 << " ns/message" << std::endl;
+
+    delete sender;
+    delete listener;
+    delete room;
+}
+
+// ================== ASYNC FAN-OUT BENCHMARK ==================
+void benchAsyncFanOut() {
+    printSeparator("ASYNC FAN-OUT BENCHMARK");
+
+    const size_t members = 50000;
+    const size_t messages = 20;
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* sender = new PremiumUser("Broadcaster");
+    room->registerUser(sender);
+    std::vector<User*> listeners;
+    for (size_t i = 0; i < members; i++) {
+        listeners.push_back(new PremiumUser("Listener" + std::to_string(i)));
+        room->registerUser(listeners.back());
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < messages; i++) {
+        sender->send("Walkies at five", room);
+    }
+    double sync = secondsSince(start);
+
+    sender->setAsyncExecution(true);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < messages; i++) {
+        sender->send("Walkies at five", room);
+    }
+    double returned = secondsSince(start);
+    sender->waitForCommands();
+    double completed = secondsSince(start);
+
+    std::cout << "Room of " << members << ", " << messages << " messages" << std::endl;
+    std::cout << "Synchronous send: " << sync / messages * 1e6 << " us/message until send() returns" << std::endl;
+    std::cout << "Async send:       " << returned / messages * 1e6 << " us/message until send() returns, "
+              << completed / messages * 1e6 << " us/message until fan-out completes" << std::endl;
+
+    delete sender;
+    for (size_t i = 0; i < listeners.size(); i++) {
+        delete listeners[i];
+    }
+    delete room;
+}
+
+// ================== GROUP COMMIT BENCHMARK ==================
+void benchGroupCommit() {
+    printSeparator("GROUP COMMIT BENCHMARK");
+
+    const size_t saves = 100000;
+    const char* path = "bench_history.tmp";
+    size_t batchSizes[] = {1, 8, 64, 256};
+
+    for (size_t b = 0; b < 4; b++) {
+        ChatRoom* room = new CtrlCat();
+        PremiumUser* sender = new PremiumUser("Saver");
+        room->registerUser(sender);
+
+        // One write() per batch, as a durable history backend would do
+        FILE* file = std::fopen(path, "w");
+        room->setHistoryBatchSink([file](const std::vector<std::string>& batch) {
+            std::string data;
+            for (size_t i = 0; i < batch.size(); i++) {
+                data += batch[i];
+                data += '\n';
+            }
+            return std::fwrite(data.data(), 1, data.size(), file) == data.size() && std::fflush(file) == 0;
+        });
+        room->setGroupCommit(GroupCommitOptions(batchSizes[b], 2000));
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < saves; i++) {
+            room->saveMessage("Walkies at five", sender);
+        }
+        room->flushHistory();
+        double elapsed = secondsSince(start);
+
+        GroupCommitStats stats = room->getGroupCommitStats();
+        std::cout << "Batch " << batchSizes[b] << ": " << elapsed / saves * 1e9 << " ns/save, "
+                  << stats.batches << " batches" << std::endl;
+
+        delete sender;
+        delete room;
+        std::fclose(file);
+    }
+    std::remove(path);
+}
+
+// ================== SEND PIPELINE BENCHMARK ==================
+void benchSendPipeline() {
+    printSeparator("SEND PIPELINE BENCHMARK");
+
+    const size_t members = 200;
+    const size_t messages = 20000;
+    std::vector<std::string> texts = makeMessages(messages, 200);
+
+    for (int mode = 0; mode < 2; mode++) {
+        ChatRoom* room = new CtrlCat();
+        PremiumUser* sender = new PremiumUser("Burst");
+        room->registerUser(sender);
+        std::vector<User*> listeners;
+        for (size_t i = 0; i < members; i++) {
+            listeners.push_back(new PremiumUser("Member" + std::to_string(i)));
+            room->registerUser(listeners.back());
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        SendPipelineStats stats;
+        if (mode == 0) {
+            for (size_t i = 0; i < messages; i++) {
+                sender->send(texts[i], room);
+            }
+        } else {
+            SendPipeline pipeline(1024);
+            for (size_t i = 0; i < messages; i++) {
+                pipeline.submit(sender, room, texts[i]);
+            }
+            pipeline.drain();
+            stats = pipeline.getStats();
+        }
+        double elapsed = secondsSince(start);
+
+        std::cout << (mode == 0 ? "Serial:   " : "Pipeline: ") << messages / elapsed << " messages/s" << std::endl;
+        if (mode == 1) {
+            const char* names[] = {"validate", "broadcast", "persist"};
+            for (int s = 0; s < static_cast<int>(PipelineStage::COUNT); s++) {
+                std::cout << "  " << names[s] << ": " << stats.stages[s].meanServiceMicros << " us/message, max depth "
+                          << stats.stages[s].maxQueueDepth << std::endl;
+            }
+        }
+
+        delete sender;
+        for (size_t i = 0; i < listeners.size(); i++) {
+            delete listeners[i];
+        }
+        delete room;
+    }
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+}
+
+// ================== DEFERRED FLUSH BENCHMARK ==================
+void benchDeferredFlush() {
+    printSeparator("DEFERRED FLUSH BENCHMARK");
+
+    const size_t members = 8;
+    const size_t messages = 50000;
+    std::vector<std::string> texts = makeMessages(messages, 200);
+    CommandFlushPolicy policies[] = {CommandFlushPolicy(), CommandFlushPolicy(16), CommandFlushPolicy(128),
+                                     CommandFlushPolicy(0, 5)};
+    const char* labels[] = {"Immediate:   ", "Every 16:    ", "Every 128:   ", "Every 5 ms:  "};
+
+    for (int p = 0; p < 4; p++) {
+        ChatRoom* room = new CtrlCat();
+        PremiumUser* sender = new PremiumUser("Chatty");
+        room->registerUser(sender);
+        std::vector<User*> listeners;
+        for (size_t i = 0; i < members; i++) {
+            listeners.push_back(new PremiumUser("Member" + std::to_string(i)));
+            room->registerUser(listeners.back());
+        }
+        sender->setFlushPolicy(policies[p]);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messages; i++) {
+            sender->send(texts[i], room);
+        }
+        sender->flushCommands();
+        double elapsed = secondsSince(start);
+
+        CommandFlushStats stats = sender->getFlushStats();
+        unsigned long roomCalls = policies[p].isImmediate() ? 2 * messages : stats.roomCalls;
+        std::cout << labels[p] << messages / elapsed << " messages/s, " << roomCalls << " room calls, "
+                  << stats.flushes << " flushes (" << stats.timedFlushes << " timed)" << std::endl;
+
+        delete sender;
+        for (size_t i = 0; i < listeners.size(); i++) {
+            delete listeners[i];
+        }
+        delete room;
+    }
+}
+
+// ================== USER TABLE BENCHMARK ==================
+void benchUserTable() {
+    printSeparator("USER TABLE BENCHMARK");
+
+    const size_t userCount = 100000;
+    const int rounds = 20;
+    std::vector<User*> users;
+    users.reserve(userCount);
+    for (size_t i = 0; i < userCount; i++) {
+        if (i % 10 == 0) {
+            users.push_back(new AdminUser("Admin" + std::to_string(i)));
+        } else {
+            users.push_back(new PremiumUser("Member" + std::to_string(i)));
+        }
+    }
+    std::cout << "sizeof(User*): " << sizeof(User*) << " bytes, sizeof(UserHandle): " << sizeof(UserHandle)
+              << " bytes" << std::endl;
+
+    // Type of every user, by pointer (one cache miss per object) and by table column
+    size_t admins = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < users.size(); i++) {
+            admins += users[i]->getUserType() == UserType::ADMIN;
+        }
+    }
+    double byPointer = secondsSince(start);
+
+    size_t tableAdmins = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        tableAdmins += UserTable::countByType(UserType::ADMIN);
+    }
+    double byColumn = secondsSince(start);
+
+    std::vector<UserHandle> handles;
+    for (size_t i = 0; i < users.size(); i++) {
+        handles.push_back(users[i]->getHandle());
+    }
+    size_t resolved = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < handles.size(); i++) {
+            resolved += UserTable::resolve(handles[i]) != nullptr;
+        }
+    }
+    double byHandle = secondsSince(start);
+
+    double scanned = static_cast<double>(userCount) * rounds;
+    std::cout << "Type scan via User*:   " << byPointer / scanned * 1e9 << " ns/user (" << admins / rounds << " admins)" << std::endl;
+    std::cout << "Type scan via column:  " << byColumn / scanned * 1e9 << " ns/user (" << tableAdmins / rounds << " admins)" << std::endl;
+    std::cout << "Handle resolve:        " << byHandle / scanned * 1e9 << " ns/handle (" << resolved / rounds << " live)" << std::endl;
+
+    for (size_t i = 0; i < users.size(); i++) {
+        delete users[i];
+    }
+}
+
+// ================== STRING INTERNING BENCHMARK ==================
+void benchStringInterning() {
+    printSeparator("STRING INTERNING BENCHMARK");
+
+    const size_t lookups = 1000000;
+    ChatRoom* room = new CtrlCat();
+    std::vector<User*> members;
+    for (int i = 0; i < 32; i++) {
+        members.push_back(new PremiumUser("LongishPetOwnerName" + std::to_string(i)));
+        room->registerUser(members.back());
+    }
+    std::string wantedText = members.back()->getName();
+
+    // Find the last member by name: string compares against hash-first compares
+    size_t hits = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups / 32; i++) {
+        for (size_t m = 0; m < members.size(); m++) {
+            hits += members[m]->getName() == wantedText;
+        }
+    }
+    double byText = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups / 32; i++) {
+        hits += room->findMember(wantedText) != nullptr;
+    }
+    double byHash = secondsSince(start);
+    std::cout << "Member lookup by text: " << byText / lookups * 1e9 << " ns/compare" << std::endl;
+    std::cout << "Member lookup by hash: " << byHash / lookups * 1e9 << " ns/compare (" << hits << " hits)" << std::endl;
+
+    // Each save now builds "name: message" in one allocation from the stored prefix
+    const size_t saves = 100000;
+    room->setGroupCommit(GroupCommitOptions(1024));
+    unsigned long before = allocationCount.load();
+    for (size_t i = 0; i < saves; i++) {
+        room->saveMessage("Walkies at five", members[i % members.size()]);
+    }
+    room->flushHistory();
+    std::cout << "Allocations per save: " << static_cast<double>(allocationCount.load() - before) / saves << std::endl;
+    std::cout << "Interned strings: " << StringInterner::getCount() << " (" << StringInterner::getBytes() << " bytes)" << std::endl;
+
+    for (size_t i = 0; i < members.size(); i++) {
+        delete members[i];
+    }
+    delete room;
+}
+
+// ================== ROOM SET BENCHMARK ==================
+void benchRoomSet() {
+    printSeparator("ROOM SET BENCHMARK");
+
+    const size_t checks = 2000000;
+    size_t roomCounts[] = {1, 3, 64, 1000, 10000};
+    std::vector<char> arena(64 * 10000);   // Room addresses to compare; never dereferenced
+
+    for (size_t c = 0; c < 5; c++) {
+        std::vector<ChatRoom*> legacy;
+        RoomSet rooms;
+        for (size_t i = 0; i < roomCounts[c]; i++) {
+            ChatRoom* room = reinterpret_cast<ChatRoom*>(&arena[i * 64]);
+            legacy.push_back(room);
+            rooms.insert(room);
+        }
+
+        // Look up the most recently joined room, the worst case for a scan
+        ChatRoom* wanted = legacy.back();
+        size_t found = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < checks / roomCounts[c] + 1000; i++) {
+            found += std::find(legacy.begin(), legacy.end(), wanted) != legacy.end();
+        }
+        double scanned = secondsSince(start) / (checks / roomCounts[c] + 1000);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < checks; i++) {
+            found += rooms.contains(wanted);
+        }
+        double hashed = secondsSince(start) / checks;
+
+        std::cout << roomCounts[c] << " rooms: vector scan " << scanned * 1e9 << " ns, RoomSet "
+                  << hashed * 1e9 << " ns (" << (rooms.isInline() ? "inline" : "hashed") << ", "
+                  << sizeof(RoomSet) + rooms.heapBytes() << " bytes vs "
+                  << sizeof(legacy) + legacy.capacity() * sizeof(ChatRoom*) << ")" << (found ? "" : " ?") << std::endl;
+    }
+}
+
+// ================== PRESENCE BROADCAST BENCHMARK ==================
+void benchPresenceBroadcast() {
+    printSeparator("PRESENCE BROADCAST BENCHMARK");
+
+    const size_t members = 20000;
+    const size_t sends = 200;
+    double onlinePercents[] = {100, 20, 5, 1};
+
+    for (size_t p = 0; p < 4; p++) {
+        ChatRoom* room = new CtrlCat();
+        std::vector<User*> crowd;
+        for (size_t i = 0; i < members; i++) {
+            crowd.push_back(new PremiumUser("Member" + std::to_string(i)));
+            room->registerUser(crowd.back());
+            if (i % 100 >= onlinePercents[p]) {
+                crowd.back()->goOffline();
+            }
+        }
+        User* sender = crowd[0];
+
+        unsigned long allocationsBefore = allocationCount.load();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sends; i++) {
+            room->sendMessage("Walkies at five, everyone welcome", sender);
+        }
+        double perSend = secondsSince(start) / sends;
+        unsigned long allocations = allocationCount.load() - allocationsBefore;
+        size_t recipients = room->getOnlineCount() - 1;
+
+        // Catching up is paid once per reconnect instead of once per message
+        start = std::chrono::steady_clock::now();
+        room->saveMessage("Walkies at five, everyone welcome", sender);
+        size_t replayed = crowd[members - 1]->isOnline() ? 0 : crowd[members - 1]->goOnline();
+        double catchUp = secondsSince(start);
+
+        std::cout << onlinePercents[p] << "% of " << members << " online: " << perSend * 1e6 << " us per broadcast ("
+                  << recipients << " pushed, " << static_cast<double>(allocations) / sends
+                  << " allocations), reconnect replayed " << replayed << " in " << catchUp * 1e6 << " us" << std::endl;
+
+        for (size_t i = crowd.size(); i-- > 0;) {
+            room->removeUser(crowd[i]);
+            delete crowd[i];
+        }
+        delete room;
+    }
+}
+
+// ================== COMMAND JOURNAL BENCHMARK ==================
+void benchCommandJournal() {
+    printSeparator("COMMAND JOURNAL BENCHMARK");
+
+    const char* path = "bench_journal.tmp";
+    const size_t saves = 20000;
+    struct Level {
+        const char* name;
+        JournalDurability durability;
+        size_t batch;
+    } levels[] = {
+        {"BUFFERED, batch 1   ", JournalDurability::BUFFERED, 1},
+        {"WRITE, batch 1      ", JournalDurability::WRITE, 1},
+        {"GROUP_FSYNC, batch 1", JournalDurability::GROUP_FSYNC, 1},
+        {"FSYNC, batch 1      ", JournalDurability::FSYNC, 1},
+        {"FSYNC, batch 64     ", JournalDurability::FSYNC, 64}
+    };
+
+    for (size_t l = 0; l < 5; l++) {
+        std::remove(path);
+        ChatRoom* room = new CtrlCat();
+        PremiumUser* sender = new PremiumUser("Durable");
+        room->registerUser(sender);
+        room->setGroupCommit(GroupCommitOptions(levels[l].batch));
+        room->openJournal(JournalOptions(path, levels[l].durability));
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < saves; i++) {
+            room->saveMessage("Walkies at five, bring treats", sender);
+        }
+        room->closeJournal();
+        double elapsed = secondsSince(start);
+        std::cout << levels[l].name << ": " << saves / elapsed << " saves/s" << std::endl;
+
+        delete sender;
+        delete room;
+    }
+
+    // Replay a large journal
+    std::remove(path);
+    const size_t records = 1000000;
+    {
+        JournalOptions options(path, JournalDurability::BUFFERED);
+        options.bufferBytes = 1 << 20;
+        CommandJournal journal(options);
+        journal.open();
+        std::vector<std::string> batch(1000, "Durable: Walkies at five, bring treats");
+        for (size_t i = 0; i < records / batch.size(); i++) {
+            journal.appendBatch(batch);
+        }
+    }
+    std::vector<std::string> entries;
+    entries.reserve(records);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    JournalReplayResult result = CommandJournal::replay(path, entries);
+    double elapsed = secondsSince(start);
+    std::cout << "Replay: " << result.records << " records, " << result.validBytes / (1024.0 * 1024.0) << " MB in "
+              << elapsed * 1000 << " ms = " << result.records / elapsed << " messages/s" << std::endl;
+    std::remove(path);
+}
+
+// ================== QOS SCHEDULER BENCHMARK ==================
+// Burns a fixed slice of CPU, standing in for a send's fan-out
+class BusyCommand : public Command {
+private:
+    std::chrono::steady_clock::time_point submitted;
+    std::vector<double>* latencies;   // Filled for admin commands only
+
+public:
+    BusyCommand(std::vector<double>* latencies)
+        : Command(nullptr, nullptr, ""), submitted(std::chrono::steady_clock::now()), latencies(latencies) {}
+
+    void execute() override {
+        std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::microseconds(20);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+        if (latencies) {
+            latencies->push_back(secondsSince(submitted) * 1e6);
+        }
+    }
+};
+
+double percentile(std::vector<double> values, double fraction) {
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[static_cast<size_t>(fraction * (values.size() - 1))];
+}
+
+void benchQosScheduler() {
+    printSeparator("QOS SCHEDULER BENCHMARK");
+
+    const int freeUsers = 20;
+    const int floodBatches = 200;
+    const int adminBatches = 50;
+
+    for (int mode = 0; mode < 2; mode++) {
+        std::vector<double> adminLatencies;
+        ThreadPool pool(1);
+        CommandScheduler scheduler(1);
+        std::vector<CommandExecutor*> executors;
+        for (int u = 0; u <= freeUsers; u++) {
+            executors.push_back(new CommandExecutor(&pool));
+        }
+        int flowKeys[freeUsers + 1];
+
+        // Everyone floods at once, then the admin trickles in moderation actions
+        for (int b = 0; b < floodBatches; b++) {
+            for (int u = 0; u < freeUsers; u++) {
+                std::vector<CommandVariant> batch;
+                batch.push_back(CommandVariant(new BusyCommand(nullptr)));
+                if (mode == 0) {
+                    executors[u]->submit(std::move(batch));
+                } else {
+                    scheduler.submit(&flowKeys[u], UserType::FREE, std::move(batch));
+                }
+            }
+        }
+        for (int a = 0; a < adminBatches; a++) {
+            std::vector<CommandVariant> batch;
+            batch.push_back(CommandVariant(new BusyCommand(&adminLatencies)));
+            if (mode == 0) {
+                executors[freeUsers]->submit(std::move(batch));
+            } else {
+                scheduler.submit(&flowKeys[freeUsers], UserType::ADMIN, std::move(batch));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        for (int u = 0; u <= freeUsers; u++) {
+            if (mode == 1) {
+                scheduler.waitIdle(&flowKeys[u]);
+            }
+            delete executors[u];
+        }
+
+        std::cout << (mode == 0 ? "FIFO pool:         " : "QoS scheduler:     ") << "admin p50 "
+                  << percentile(adminLatencies, 0.5) << " us, p99 " << percentile(adminLatencies, 0.99) << " us" << std::endl;
+        if (mode == 1) {
+            QosClassStats freeStats = scheduler.getStats(UserType::FREE);
+            std::cout << "  free p50 <= " << freeStats.p50LatencyMicros << " us, p99 <= " << freeStats.p99LatencyMicros
+                      << " us, promoted " << freeStats.promoted << std::endl;
+        }
+    }
+}
+
+// ================== MAIN FUNCTION ==================
+int main() {
+    Logger::setLevel(NONE);
+
+    std::cout << "Starting Benchmarks..." << std::endl;
+
+    benchBatchValidation();
+    benchProfanityScanners();
+    benchThreatSearch();
+    benchLoggerBackends();
+    benchStructuredLog();
+    benchCommandAllocation();
+    benchAsyncFanOut();
+    benchGroupCommit();
+    benchSendPipeline();
+    benchCommandJournal();
+    benchQosScheduler();
+    benchDeferredFlush();
+    benchUserTable();
+    benchStringInterning();
+    benchRoomSet();
+    benchPresenceBroadcast();
+
+    std::cout << "\n=== All Benchmarks Complete ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * @file BlockList.cpp
+ * @brief Implementation of reloadable block lists
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-06
+ */
+
+#include "BlockList.h"
+#include "Logger.h"
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ================== BlockLists ==================
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+BlockLists::BlockLists(const std::vector<std::string>& freeTerms,
+                       const std::vector<std::string>& severeTerms,
+                       const std::vector<std::string>& threatTerms)
+    : freeWords(freeTerms), severeWords(severeTerms), version(0) {
+
+    // Keep threatWords aligned with the searcher's pattern indexes
+    for (const std::string& threat : threatTerms) {
+        if (!threat.empty()) threatWords.push_back(threat);
+    }
+    threats = SubstringSearcher(threatWords);
+}
+
+BlockLists* BlockLists::createDefault() {
+    std::vector<std::string> freeTerms = {
+        "stupid", "dumb", "hate", "sucks", "crap", "damn", "hell",
+        "shut", "idiot", "loser", "weird", "ugly", "fat", "shit", "fuck", "bitch", "poes"
+    };
+    std::vector<std::string> severeTerms = {
+        "fuck", "shit", "bitch", "asshole", "bastard", "whore", "slut"
+    };
+    std::vector<std::string> threatTerms = {
+        "DELETE FROM", "DROP TABLE", "rm -rf", "format c:",
+        "shutdown", "reboot", "kill -9", "sudo rm", "del /s"
+    };
+
+    return new BlockLists(freeTerms, severeTerms, threatTerms);
+}
+
+BlockLists* BlockLists::createConfigured() {
+    const char* configured = std::getenv("PETSPACE_CONFIG_DIR");
+    std::string directory = (configured && *configured) ? configured : "config";
+
+    std::vector<std::string> freeTerms;
+    std::vector<std::string> severeTerms;
+    std::vector<std::string> threatTerms;
+    if (!BlockListRegistry::readTermFile(directory + "/free_blocklist.txt", freeTerms) ||
+        !BlockListRegistry::readTermFile(directory + "/premium_blocklist.txt", severeTerms) ||
+        !BlockListRegistry::readTermFile(directory + "/admin_threats.txt", threatTerms)) {
+        LOG_INFO_IN(VALIDATION, "[BlockList] No block lists in " + directory + "/ - using the built-in lists");
+        return createDefault();
+    }
+
+    LOG_DEBUG_IN(VALIDATION, "[BlockList] Loaded block lists from " + directory + "/");
+    return new BlockLists(freeTerms, severeTerms, threatTerms);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ================== BlockListRegistry ==================
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::atomic<const BlockLists*> BlockListRegistry::current(nullptr);
+std::atomic<unsigned long> BlockListRegistry::epoch(0);
+std::atomic<long> BlockListRegistry::readers[2] = {{0}, {0}};
+std::atomic<unsigned long> BlockListRegistry::versionCounter(0);
+std::mutex BlockListRegistry::writerMutex;
+
+namespace {
+
+// Frees the last published snapshot at exit
+struct RegistryCleanup {
+    ~RegistryCleanup() { BlockListRegistry::publish(nullptr); }
+} registryCleanup;
+
+} // namespace
+
+BlockListRegistry::ReadGuard::ReadGuard() : pinnedEpoch(0), lists(nullptr) {
+    for (;;) {
+        // Pin an epoch; retry if a writer flipped it between load and increment
+        pinnedEpoch = epoch.load();
+        readers[pinnedEpoch & 1].fetch_add(1);
+        if (epoch.load() != pinnedEpoch) {
+            readers[pinnedEpoch & 1].fetch_sub(1);
+            continue;
+        }
+
+        lists = current.load();
+        if (lists) {
+            return;
+        }
+
+        // First use: publish the configured lists outside the pin, then retry
+        readers[pinnedEpoch & 1].fetch_sub(1);
+        std::lock_guard<std::mutex> lock(writerMutex);
+        if (!current.load()) {
+            BlockLists* configured = BlockLists::createConfigured();
+            configured->version = ++versionCounter;
+            current.store(configured);
+        }
+    }
+}
+
+BlockListRegistry::ReadGuard::~ReadGuard() {
+    readers[pinnedEpoch & 1].fetch_sub(1);
+}
+
+void BlockListRegistry::publish(BlockLists* lists) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    if (lists) {
+        lists->version = ++versionCounter;
+    }
+    const BlockLists* old = current.exchange(lists);
+
+    // Readers that could still see the old snapshot are all pinned to the
+    // previous epoch; flip it and wait for them to finish.
+    unsigned long previous = epoch.load();
+    epoch.store(previous + 1);
+    while (readers[previous & 1].load() != 0) {
+        std::this_thread::yield();
+    }
+
+    delete old;
+}
+
+bool BlockListRegistry::loadFromFiles(const std::string& freePath,
+                                      const std::string& premiumPath,
+                                      const std::string& adminPath) {
+    std::vector<std::string> freeTerms;
+    std::vector<std::string> severeTerms;
+    std::vector<std::string> threatTerms;
+
+    if (!readTermFile(freePath, freeTerms) ||
+        !readTermFile(premiumPath, severeTerms) ||
+        !readTermFile(adminPath, threatTerms)) {
+        LOG_INFO_IN(VALIDATION, "[BlockList] Reload failed - keeping current block lists");
+        return false;
+    }
+
+    // Compile before publishing so senders never wait on the build
+    BlockLists* lists = new BlockLists(freeTerms, severeTerms, threatTerms);
+    LOG_INFO_IN(VALIDATION, "[BlockList] Loaded " + std::to_string(lists->freeWords.size()) + " free, " +
+             std::to_string(lists->severeWords.size()) + " premium and " +
+             std::to_string(lists->threatWords.size()) + " admin terms");
+
+    publish(lists);
+    return true;
+}
+
+void BlockListRegistry::reloadFromConfig() {
+    publish(BlockLists::createConfigured());
+}
+
+void BlockListRegistry::resetToDefaults() {
+    publish(BlockLists::createDefault());
+}
+
+unsigned long BlockListRegistry::getVersion() {
+    ReadGuard guard;
+    return guard->version;
+}
+
+bool BlockListRegistry::readTermFile(const std::string& path, std::vector<std::string>& terms) {
+    std::ifstream file(path.c_str());
+    if (!file) {
+        LOG_DEBUG_IN(VALIDATION, "[BlockList] Cannot open " + path);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+
+        size_t end = line.find_last_not_of(" \t\r");
+        terms.push_back(line.substr(start, end - start + 1));
+    }
+    return true;
+}
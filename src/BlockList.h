@@ -0,0 +1,133 @@
+/**
+ * @file BlockList.h
+ * @brief Reloadable block lists used by the validation strategies
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-06
+ */
+
+#ifndef BLOCKLIST_H
+#define BLOCKLIST_H
+
+#include "ProfanityAutomaton.h"
+#include "SubstringSearcher.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class BlockLists
+ * @brief Immutable snapshot of every block list used by the strategies
+ */
+class BlockLists {
+public:
+    ProfanityAutomaton freeWords;          ///< Words blocked for Free users
+    ProfanityAutomaton severeWords;        ///< Words blocked for Premium users
+    std::vector<std::string> threatWords;  ///< Admin system threat patterns (original case, no blanks)
+    SubstringSearcher threats;             ///< Case-insensitive searcher over threatWords
+    unsigned long version;                 ///< Set by BlockListRegistry when published
+
+    BlockLists(const std::vector<std::string>& freeTerms,
+               const std::vector<std::string>& severeTerms,
+               const std::vector<std::string>& threatTerms);
+
+    /**
+     * @brief Build the snapshot from the lists that used to be hard-coded
+     */
+    static BlockLists* createDefault();
+
+    /**
+     * @brief Build the snapshot from the config files, or the defaults if one is missing
+     *
+     * Reads free_blocklist.txt, premium_blocklist.txt and admin_threats.txt
+     * from $PETSPACE_CONFIG_DIR, or config/ when it is not set.
+     */
+    static BlockLists* createConfigured();
+};
+
+/**
+ * @class BlockListRegistry
+ * @brief Publishes BlockLists snapshots that can be swapped at runtime
+ *
+ * Readers pin the current snapshot with a ReadGuard, which only touches
+ * atomics. A reload compiles the new lists first, swaps the pointer, then
+ * waits for readers of the old snapshot to drain before deleting it, so
+ * in-flight validations keep the version they started with.
+ *
+ * The first reader publishes BlockLists::createConfigured(), so the lists
+ * in config/ apply from startup without any explicit load.
+ */
+class BlockListRegistry {
+private:
+    static std::atomic<const BlockLists*> current;
+    static std::atomic<unsigned long> epoch;
+    static std::atomic<long> readers[2];
+    static std::atomic<unsigned long> versionCounter;
+    static std::mutex writerMutex;   // Serialises writers only
+
+public:
+    /**
+     * @brief RAII pin on the current snapshot (lock-free)
+     */
+    class ReadGuard {
+    private:
+        unsigned long pinnedEpoch;
+        const BlockLists* lists;
+
+    public:
+        ReadGuard();
+        ~ReadGuard();
+        const BlockLists* operator->() const { return lists; }
+        const BlockLists& operator*() const { return *lists; }
+
+    private:
+        ReadGuard(const ReadGuard&);
+        ReadGuard& operator=(const ReadGuard&);
+    };
+
+    /**
+     * @brief Publish a new snapshot, taking ownership of it
+     * @param lists Compiled lists to make current
+     */
+    static void publish(BlockLists* lists);
+
+    /**
+     * @brief Load and publish lists from files (one term per line, # comments)
+     * @param freePath File with words blocked for Free users
+     * @param premiumPath File with words blocked for Premium users
+     * @param adminPath File with Admin threat patterns
+     * @return true if all three files were read and published, false otherwise
+     *
+     * Nothing is published if any file cannot be read.
+     */
+    static bool loadFromFiles(const std::string& freePath,
+                              const std::string& premiumPath,
+                              const std::string& adminPath);
+
+    /**
+     * @brief Reload the lists from $PETSPACE_CONFIG_DIR (default "config")
+     *
+     * Falls back to the built-ins if a config file is missing.
+     */
+    static void reloadFromConfig();
+
+    /**
+     * @brief Publish the compiled-in lists, ignoring any config files
+     */
+    static void resetToDefaults();
+
+    /**
+     * @brief Version of the current snapshot, bumped on every publish
+     */
+    static unsigned long getVersion();
+
+    /**
+     * @brief Read a term list file
+     * @param path File to read
+     * @param terms Receives the trimmed, non-comment lines
+     * @return false if the file could not be opened
+     */
+    static bool readTermFile(const std::string& path, std::vector<std::string>& terms);
+};
+
+#endif // BLOCKLIST_H
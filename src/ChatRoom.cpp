@@ -13,27 +13,28 @@
 
 #include <iostream>
 #include <algorithm>
+#include <mutex>
 #include <vector>
 
+ChatRoom::~ChatRoom() {
+    closeJournal();
+}
+
 void ChatRoom::sendMessage(std::string message, User* fromUser) {
+    // Lanes broadcast concurrently; joins, leaves and presence changes wait
+    SharedLock membership(membershipMutex);
+
     // Validate that the fromUser is actually in this room
-    bool userFound = false;
-    for (std::vector<User*>::iterator it = users.begin(); it != users.end(); ++it) {
-        if (*it == fromUser) {
-            userFound = true;
-            break;
-        }
-    }
-    
-    if (!userFound) {
-        Logger::debug("[ChatRoom] ERROR: User " + fromUser->getName() + " is not registered in this room!");
+    if (!isMember(fromUser)) {
+        LOG_DEBUG_IN(CHATROOM, "[ChatRoom] ERROR: User " + fromUser->getName() + " is not registered in this room!");
         return;
     }
 
-    Logger::user(fromUser->getName() + ": " + message);
-    Logger::debug("[ChatRoom] Broadcasting message from " + fromUser->getName());
+    LOG_USER_IN(CHATROOM, fromUser->getHistoryPrefix() + message);
+    LOG_EVENT(CHATROOM, DEBUG, BROADCASTING, fromUser->getLogName());
 
-    for (std::vector<User*>::iterator it = users.begin(); it != users.end(); ++it) {
+    // Offline members catch up from history when they reconnect
+    for (std::vector<User*>::iterator it = onlineUsers.begin(); it != onlineUsers.end(); ++it) {
         if (*it != fromUser) {
             (*it)->receive(message, fromUser, this);
         }
@@ -41,35 +42,183 @@ void ChatRoom::sendMessage(std::string message, User* fromUser) {
 }
 
 void ChatRoom::saveMessage(std::string message, User* fromUser) {
-    bool userFound = false;
-    for (std::vector<User*>::iterator it = users.begin(); it != users.end(); ++it) {
-        if (*it == fromUser) {
-            userFound = true;
-            break;
+    if (!hasMember(fromUser)) {
+        LOG_DEBUG_IN(CHATROOM, "[ChatRoom] ERROR: Cannot save message - User " + fromUser->getName() + " is not registered in this room!");
+        return;
+    }
+
+    //Format: "UserName: message", built in one allocation
+    const std::string& prefix = fromUser->getHistoryPrefix();
+    std::string formattedMessage;
+    formattedMessage.reserve(prefix.size() + message.size());
+    formattedMessage.append(prefix).append(message);
+    LOG_EVENT(CHATROOM, DEBUG, MESSAGE_SAVED, formattedMessage);
+    historyCommitter.append(std::move(formattedMessage), fromUser->getHandle().value);
+}
+
+void ChatRoom::sendMessages(const std::vector<std::string>& messages, User* fromUser) {
+    SharedLock membership(membershipMutex);
+    if (!isMember(fromUser)) {
+        LOG_DEBUG_IN(CHATROOM, "[ChatRoom] ERROR: User " + fromUser->getName() + " is not registered in this room!");
+        return;
+    }
+
+    for (size_t i = 0; i < messages.size(); i++) {
+        LOG_USER_IN(CHATROOM, fromUser->getHistoryPrefix() + messages[i]);
+        LOG_EVENT(CHATROOM, DEBUG, BROADCASTING, fromUser->getLogName());
+
+        for (std::vector<User*>::iterator it = onlineUsers.begin(); it != onlineUsers.end(); ++it) {
+            if (*it != fromUser) {
+                (*it)->receive(messages[i], fromUser, this);
+            }
         }
     }
-    
-    if (!userFound) {
-        Logger::debug("[ChatRoom] ERROR: Cannot save message - User " + fromUser->getName() + " is not registered in this room!");
+}
+
+void ChatRoom::saveMessages(std::vector<std::string>& messages, User* fromUser) {
+    if (!hasMember(fromUser)) {
+        LOG_DEBUG_IN(CHATROOM, "[ChatRoom] ERROR: Cannot save message - User " + fromUser->getName() + " is not registered in this room!");
+        return;
+    }
+
+    const std::string& prefix = fromUser->getHistoryPrefix();
+    for (size_t i = 0; i < messages.size(); i++) {
+        std::string formattedMessage;
+        formattedMessage.reserve(prefix.size() + messages[i].size());
+        formattedMessage.append(prefix).append(messages[i]);
+        LOG_EVENT(CHATROOM, DEBUG, MESSAGE_SAVED, formattedMessage);
+        historyCommitter.append(std::move(formattedMessage), fromUser->getHandle().value);
+    }
+}
+
+bool ChatRoom::hasMember(UserHandle user) const {
+    User* member = UserTable::resolve(user);
+    return member && hasMember(member);
+}
+
+bool ChatRoom::hasMember(const User* user) const {
+    SharedLock membership(membershipMutex);
+    return isMember(user);
+}
+
+User* ChatRoom::findMember(StringRef name) const {
+    uint32_t hash = name.hash();
+    SharedLock membership(membershipMutex);
+    for (std::vector<User*>::const_iterator it = users.begin(); it != users.end(); ++it) {
+        if ((*it)->getNameHash() == hash && StringRef((*it)->getName()) == name) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+size_t ChatRoom::copyHistory(size_t first, size_t maxBytes, std::vector<std::string>& lines) const {
+    lines.clear();
+    size_t total = 0;
+    historyCommitter.withHistory([&](const std::vector<std::string>& history, const std::vector<uint32_t>&) {
+        size_t bytes = 0;
+        for (size_t i = first; i < history.size(); i++) {
+            if (!lines.empty() && bytes + history[i].size() > maxBytes) {
+                break;
+            }
+            bytes += history[i].size();
+            lines.push_back(history[i]);
+        }
+        total = history.size();
+    });
+    return total;
+}
+
+void ChatRoom::appendHistory(std::vector<std::string>& lines) {
+    historyCommitter.restore(lines);   // Senders don't travel with the text, so they come in as unknown
+}
+
+size_t ChatRoom::getHistorySize() const {
+    return historyCommitter.size();
+}
+
+void ChatRoom::addMember(User* user) {
+    MemberState state;
+    state.onlineSlot = OFFLINE;
+    state.readWatermark = 0;
+    if (user->isOnline()) {
+        state.onlineSlot = static_cast<uint32_t>(onlineUsers.size());
+        onlineUsers.push_back(user);
+    } else {
+        state.readWatermark = historyCommitter.size();   // Nothing before joining is missed
+    }
+    memberStates[user] = state;
+}
+
+void ChatRoom::dropMember(User* user) {
+    std::unordered_map<const User*, MemberState>::iterator it = memberStates.find(user);
+    if (it == memberStates.end()) {
         return;
     }
+    if (it->second.onlineSlot != OFFLINE) {
+        // Leaving is already linear in users; keep the others in join order
+        onlineUsers.erase(onlineUsers.begin() + it->second.onlineSlot);
+        for (size_t i = it->second.onlineSlot; i < onlineUsers.size(); i++) {
+            memberStates[onlineUsers[i]].onlineSlot = static_cast<uint32_t>(i);
+        }
+    }
+    memberStates.erase(it);
+}
+
+size_t ChatRoom::setPresence(User* user, bool online) {
+    std::vector<std::string> missed;
+    {
+        std::lock_guard<SharedMutex> membership(membershipMutex);
+        std::unordered_map<const User*, MemberState>::iterator it = memberStates.find(user);
+        if (it == memberStates.end() || (it->second.onlineSlot != OFFLINE) == online) {
+            return 0;
+        }
+        MemberState& state = it->second;
 
-    //Format: "UserName: message"
-    std::string formattedMessage = fromUser->getName() + ": " + message;
-    chatHistory.push_back(formattedMessage);
+        if (!online) {
+            // Swap the last online member into the gap
+            User* moved = onlineUsers.back();
+            onlineUsers[state.onlineSlot] = moved;
+            memberStates[moved].onlineSlot = state.onlineSlot;
+            onlineUsers.pop_back();
+            state.onlineSlot = OFFLINE;
+            state.readWatermark = historyCommitter.size();
+            return 0;
+        }
+
+        state.onlineSlot = static_cast<uint32_t>(onlineUsers.size());
+        onlineUsers.push_back(user);
+
+        // The member's own messages are skipped, as they are on live delivery
+        uint32_t own = user->getHandle().value;
+        historyCommitter.withHistory([&](const std::vector<std::string>& history, const std::vector<uint32_t>& senders) {
+            for (size_t i = std::min(state.readWatermark, history.size()); i < history.size(); i++) {
+                if (senders[i] != own) {
+                    missed.push_back(history[i]);
+                }
+            }
+            state.readWatermark = history.size();
+        });
+    }
 
-    Logger::debug("[ChatRoom] Message saved to history: " + formattedMessage);
+    // Delivered unlocked, so a member may reply from receiveMissed()
+    for (size_t i = 0; i < missed.size(); i++) {
+        user->receiveMissed(missed[i], this);
+    }
+    LOG_DEBUG_IN(CHATROOM, "[ChatRoom] " + user->getName() + " caught up on " + std::to_string(missed.size()) + " messages");
+    return missed.size();
 }
 
 const std::vector<std::string>* ChatRoom::getChatHistory(User* requestingUser) const {
 
     if (requestingUser && requestingUser->getUserType() == UserType::ADMIN) {
-        Logger::debug("[ChatRoom] Admin " + requestingUser->getName() + " granted access to chat history (" + std::to_string(chatHistory.size()) + " messages)");
+        historyCommitter.flush();
+        LOG_DEBUG_IN(CHATROOM, "[ChatRoom] Admin " + requestingUser->getName() + " granted access to chat history (" + std::to_string(historyCommitter.size()) + " messages)");
         return &chatHistory;
     } else {
-        Logger::info("Access denied - only admins can access chat history");
+        LOG_INFO_IN(CHATROOM, "Access denied - only admins can access chat history");
         if (requestingUser) {
-            Logger::debug("[ChatRoom] User " + requestingUser->getName() + " (" + requestingUser->getUserTypeString() + ") lacks admin privileges");
+            LOG_DEBUG_IN(CHATROOM, "[ChatRoom] User " + requestingUser->getName() + " (" + requestingUser->getUserTypeString() + ") lacks admin privileges");
         }
         return nullptr;
     }
@@ -78,31 +227,70 @@ const std::vector<std::string>* ChatRoom::getChatHistory(User* requestingUser) c
 Iterator* ChatRoom::createIterator(User* requestingUser) {
 
     if (requestingUser && requestingUser->getUserType() == UserType::ADMIN) {
-        Logger::debug("[ChatRoom] Creating iterator for admin " + requestingUser->getName());
+        LOG_DEBUG_IN(CHATROOM, "[ChatRoom] Creating iterator for admin " + requestingUser->getName());
+        historyCommitter.flush();
         return new ConcreteIterator(&chatHistory);
     } else {
-        Logger::info("Iterator access denied - only admins can iterate chat history");
+        LOG_INFO_IN(CHATROOM, "Iterator access denied - only admins can iterate chat history");
         if (requestingUser) {
-            Logger::debug("[ChatRoom] User " + requestingUser->getName() + " (" + requestingUser->getUserTypeString() + ") lacks admin privileges");
+            LOG_DEBUG_IN(CHATROOM, "[ChatRoom] User " + requestingUser->getName() + " (" + requestingUser->getUserTypeString() + ") lacks admin privileges");
         }
         return nullptr;
     }
 }
 
 Iterator* ChatRoom::createIterator() {
-    Logger::debug("[ChatRoom] WARNING: Creating unrestricted iterator (base Aggregate method)");
+    LOG_DEBUG_IN(CHATROOM, "[ChatRoom] WARNING: Creating unrestricted iterator (base Aggregate method)");
+    historyCommitter.flush();
     return new ConcreteIterator(&chatHistory);
 }
 
 void ChatRoom::removeUser(User* user) {
+    std::lock_guard<SharedMutex> membership(membershipMutex);
     for (std::vector<User*>::iterator it = users.begin(); it != users.end(); it++) {
         if (*it == user) {
             users.erase(it);
+            dropMember(user);
             user->removeChatRoom(this);
-            Logger::info(user->getName() + " left the room");
+            LOG_INFO_IN(CHATROOM, user->getName() + " left the room");
             return;
         }
     }
     
-    Logger::debug("[ChatRoom] User " + user->getName() + " was not in this room");
-}
\ No newline at end of file
+    LOG_DEBUG_IN(CHATROOM, "[ChatRoom] User " + user->getName() + " was not in this room");
+}
+bool ChatRoom::openJournal(const JournalOptions& options, JournalReplayResult* replayed) {
+    closeJournal();
+
+    std::vector<std::string> entries;
+    JournalReplayResult result = CommandJournal::replay(options.path, entries);
+    CommandJournal* opened = new CommandJournal(options);
+    if (!opened->open(result.validBytes)) {
+        delete opened;
+        LOG_INFO_IN(CHATROOM, "Could not open journal " + options.path);
+        return false;
+    }
+
+    historyCommitter.restore(entries);
+    journal = opened;
+    historyCommitter.setBatchSink([opened](const std::vector<std::string>& batch) {
+        return opened->appendBatch(batch);
+    });
+
+    LOG_INFO_IN(CHATROOM, "Replayed " + std::to_string(result.records) + " messages from " + options.path +
+                (result.truncated ? " (dropped a torn record)" : ""));
+    if (replayed) {
+        *replayed = result;
+    }
+    return true;
+}
+
+void ChatRoom::closeJournal() {
+    if (!journal) {
+        return;
+    }
+    historyCommitter.flush();
+    historyCommitter.setBatchSink(HistoryCommitter::BatchSink());
+    delete journal;   // Writes and syncs what's left
+    journal = nullptr;
+}
@@ -9,8 +9,13 @@
 #define CHATROOM_H
 
 #include "Aggregate.h"
+#include "CommandJournal.h"
+#include "HistoryCommitter.h"
 #include "Iterator.h"
+#include "SharedMutex.h"
+#include "UserTable.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class User; // Forward declaration
@@ -21,11 +26,44 @@ class User; // Forward declaration
  */
 class ChatRoom : public Aggregate {
 protected:
+    /**
+     * @brief Presence and read position of one member
+     */
+    struct MemberState {
+        uint32_t onlineSlot;     ///< Index in onlineUsers, or OFFLINE
+        size_t readWatermark;    ///< History entries seen; set when the member goes offline
+    };
+    static const uint32_t OFFLINE = 0xFFFFFFFFu;
+
+    mutable SharedMutex membershipMutex;         // Shared for fan-out, exclusive to change the fields below
     std::vector<User*> users;                    // Users in this chat room
-    std::vector<std::string> chatHistory;        // Chat history storage
+    std::vector<User*> onlineUsers;              // Connected members, the only ones messages are pushed to
+    std::unordered_map<const User*, MemberState> memberStates;   // Every member, for O(1) lookups
+    std::vector<std::string> chatHistory;        // Chat history storage; read through historyCommitter
+    std::vector<uint32_t> historySenders;        // UserHandle value of each entry's sender (0 = unknown)
+    mutable HistoryCommitter historyCommitter;   // Batches saves into chatHistory
+    CommandJournal* journal;                     // Write-ahead journal of saves, if open
+    InternedString roomName;
+
+    /**
+     * @brief Start tracking a member's presence (subclasses call this from registerUser)
+     *
+     * addMember(), dropMember() and isMember() expect the caller to hold
+     * membershipMutex: exclusively for the first two, shared for isMember().
+     */
+    void addMember(User* user);
+
+    /**
+     * @brief Stop tracking a member (subclasses call this from removeUser)
+     */
+    void dropMember(User* user);
+
+    bool isMember(const User* user) const { return memberStates.count(user) != 0; }
 
 public:
-    virtual ~ChatRoom() = default;
+    explicit ChatRoom(StringRef roomName = "ChatRoom")
+        : historyCommitter(&chatHistory, &historySenders), journal(nullptr), roomName(InternedString::of(roomName)) {}
+    virtual ~ChatRoom();
 
     // MEDIATOR PATTERN METHODS
     virtual void registerUser(User* user) = 0;
@@ -33,11 +71,126 @@ public:
     virtual void sendMessage(std::string message, User* fromUser);
     virtual void saveMessage(std::string message, User* fromUser);
 
+    /**
+     * @brief Broadcast several messages from one user, checking membership once
+     * @param messages Messages in send order
+     * @param fromUser Sender
+     *
+     * Used when a deferred flush coalesces adjacent sends to the same room.
+     */
+    virtual void sendMessages(const std::vector<std::string>& messages, User* fromUser);
+
+    /**
+     * @brief Save several messages from one user, checking membership once
+     * @param messages Messages in send order (moved from)
+     * @param fromUser Sender
+     */
+    virtual void saveMessages(std::vector<std::string>& messages, User* fromUser);
+
+    /**
+     * @brief Check membership by handle
+     * @return false if the user is not in the room or no longer exists
+     */
+    bool hasMember(UserHandle user) const;
+    bool hasMember(const User* user) const;
+
+    /**
+     * @brief Find a member by name
+     * @return The member, or nullptr if no member has that name
+     *
+     * Members are compared by name hash first, so the text is only
+     * compared for the likely match.
+     */
+    User* findMember(StringRef name) const;
+
+    InternedString getRoomName() const { return roomName; }
+
+    // PRESENCE
+    /**
+     * @brief Move a member on or off the online list (User::goOnline/goOffline call this)
+     * @param user Member whose presence changed
+     * @param online true when the member connects
+     * @return History entries from others replayed to the member to catch up
+     *
+     * Going offline records how much history the member has seen; coming
+     * back replays the rest through User::receiveMissed(), after the room's
+     * membership lock is released. The member's own entries are recognised
+     * by the sender handle saved with each one, so they are skipped whatever
+     * their text. Safe to call while sends are in flight.
+     */
+    size_t setPresence(User* user, bool online);
+
+    size_t getMemberCount() const { SharedLock lock(membershipMutex); return memberStates.size(); }
+    size_t getOnlineCount() const { SharedLock lock(membershipMutex); return onlineUsers.size(); }
+
+    // GROUP COMMIT
+    /**
+     * @brief Batch history saves (the default commits each save on its own)
+     * @param options Batch size and delay limits
+     */
+    void setGroupCommit(const GroupCommitOptions& options) { historyCommitter.setOptions(options); }
+
+    /**
+     * @brief Commit any saves still waiting in the current batch
+     * @return false if the batch sink (e.g. the journal) refused them; they stay pending
+     */
+    bool flushHistory() { return historyCommitter.flush(); }
+
+    /**
+     * @brief Receive each committed batch in one call, e.g. to write it out
+     */
+    void setHistoryBatchSink(const HistoryCommitter::BatchSink& sink) { historyCommitter.setBatchSink(sink); }
+
+    // WRITE-AHEAD JOURNAL
+    /**
+     * @brief Replay a journal into the history, then journal every committed batch
+     * @param options Journal file and durability level
+     * @param replayed Receives the replay outcome (optional)
+     * @return false if the journal can't be opened for appending
+     *
+     * Meant for startup: replayed entries are appended to the current history.
+     * The journal takes over the history batch sink.
+     */
+    bool openJournal(const JournalOptions& options, JournalReplayResult* replayed = nullptr);
+
+    /**
+     * @brief Commit pending saves, sync and close the journal
+     */
+    void closeJournal();
+
+    CommandJournal* getJournal() const { return journal; }
+
+    /**
+     * @brief Group commit counters and batch-size histogram
+     */
+    GroupCommitStats getGroupCommitStats() { return historyCommitter.getStats(); }
+
+    // ROOM MIGRATION
+    /**
+     * @brief Copy a page of committed history, e.g. to move the room to another shard
+     * @param first Index of the first entry to copy
+     * @param maxBytes Stop before an entry that would take the page past this (one entry always fits)
+     * @param lines Receives the page; pending saves are committed first
+     * @return Entries in the whole history
+     */
+    size_t copyHistory(size_t first, size_t maxBytes, std::vector<std::string>& lines) const;
+
+    /**
+     * @brief Append history brought over from elsewhere (moved from; not journaled)
+     * @param lines History in order, oldest first
+     */
+    void appendHistory(std::vector<std::string>& lines);
+
+    size_t getHistorySize() const;
+
     // ITERATOR PATTERN METHODS
     /**
      * @brief Get chat history for admin access only
      * @param requestingUser The user requesting access
      * @return Pointer to chat history vector if user is admin, nullptr otherwise
+     *
+     * Pending saves are committed first. Read it while no asynchronous sends
+     * into the room are in flight.
      */
     virtual const std::vector<std::string>* getChatHistory(User* requestingUser) const;
     
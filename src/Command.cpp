@@ -7,10 +7,11 @@
 
 #include "Command.h"
 #include "Logger.h"
+#include "StructuredLog.h"
 #include <iostream>
 
 Command::Command(ChatRoom* room, User* user, std::string msg) 
     : chatRoom(room), fromUser(user), message(msg) {
     
-    Logger::debug("[Command] Command created with message: \"" + msg + "\"");
+    LOG_EVENT(COMMAND, DEBUG, COMMAND_CREATED, msg);
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 #ifndef COMMAND_H
 #define COMMAND_H
 
+#include "CommandPool.h"
+#include <cstddef>
 #include <string>
 
 class ChatRoom;
@@ -45,6 +47,14 @@ public:
      */
     virtual ~Command() {}
     
+    /**
+     * @brief Commands (including subclasses) come from per-thread free lists
+     *
+     * The virtual destructor makes delete pass the concrete object's size.
+     */
+    static void* operator new(std::size_t size) { return CommandPool::allocate(size); }
+    static void operator delete(void* block, std::size_t size) { CommandPool::release(block, size); }
+    
     /**
      * @brief Execute the command
      */
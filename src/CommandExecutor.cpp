@@ -0,0 +1,92 @@
+/**
+ * @file CommandExecutor.cpp
+ * @brief Implementation of CommandExecutor
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-14
+ */
+
+#include "CommandExecutor.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+#include <exception>
+#include <utility>
+
+CommandExecutor::CommandExecutor(ThreadPool* pool) : pool(pool), running(false) {}
+
+CommandExecutor::~CommandExecutor() {
+    waitIdle();
+}
+
+CommandBatchResult CommandExecutor::runBatch(std::vector<CommandVariant>& commands) {
+    CommandBatchResult result;
+    for (size_t i = 0; i < commands.size(); i++) {
+        try {
+            commands[i].execute();
+            result.executed++;
+        } catch (const std::exception& e) {
+            result.errors.push_back(e.what());
+        } catch (...) {
+            result.errors.push_back("unknown error");
+        }
+    }
+    if (!result.errors.empty()) {
+        LOG_DEBUG_IN(COMMAND, "[CommandExecutor] " + std::to_string(result.errors.size()) +
+                     " command(s) failed: " + result.errors.front());
+    }
+    return result;
+}
+
+CommandFuture CommandExecutor::submit(std::vector<CommandVariant>&& commands) {
+    Batch batch;
+    batch.commands.swap(commands);
+    CommandFuture future = batch.done.get_future().share();
+
+    bool startDrain;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(batch));
+        startDrain = !running;
+        running = true;
+        if (!pool) {
+            pool = &ThreadPool::shared();
+        }
+    }
+
+    if (startDrain) {
+        pool->submit([this]() { drain(); });
+    }
+    return future;
+}
+
+void CommandExecutor::drain() {
+    for (;;) {
+        Batch batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending.empty()) {
+                running = false;
+                idle.notify_all();
+                return;
+            }
+            batch = std::move(pending.front());
+        }
+
+        CommandBatchResult result = runBatch(batch.commands);
+        batch.commands.clear();   // Release extension commands before anyone is told we're done
+        batch.done.set_value(std::move(result));
+
+        // Popped only now so pendingBatches() counts the running batch
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.pop_front();
+    }
+}
+
+void CommandExecutor::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return !running; });
+}
+
+size_t CommandExecutor::pendingBatches() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
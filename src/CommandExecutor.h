@@ -0,0 +1,104 @@
+/**
+ * @file CommandExecutor.h
+ * @brief Runs a user's queued commands on the shared worker pool
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-14
+ */
+
+#ifndef COMMANDEXECUTOR_H
+#define COMMANDEXECUTOR_H
+
+#include "CommandVariant.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @brief Outcome of one batch of commands
+ */
+struct CommandBatchResult {
+    size_t executed;                  ///< Commands that ran to completion
+    std::vector<std::string> errors;  ///< One entry per command that threw
+
+    CommandBatchResult() : executed(0) {}
+    bool succeeded() const { return errors.empty(); }
+};
+
+/**
+ * @brief Completion handle for a submitted batch
+ *
+ * Poll with wait_for(std::chrono::seconds(0)), block with wait() or get().
+ */
+typedef std::shared_future<CommandBatchResult> CommandFuture;
+
+/**
+ * @class CommandExecutor
+ * @brief Serial lane of command batches on a shared ThreadPool
+ *
+ * Each User owns one executor. Batches from the same executor run one at a
+ * time in submission order; different executors run in parallel on the
+ * pool's workers. At most one pool task per executor is queued or running,
+ * so a busy user cannot occupy more than one worker.
+ */
+class CommandExecutor {
+private:
+    struct Batch {
+        std::vector<CommandVariant> commands;
+        std::promise<CommandBatchResult> done;
+    };
+
+    ThreadPool* pool;                  // nullptr = ThreadPool::shared(), resolved on first submit
+    mutable std::mutex mutex;
+    std::condition_variable idle;
+    std::deque<Batch> pending;
+    bool running;                      // A drain task is queued or running
+
+    void drain();
+
+    CommandExecutor(const CommandExecutor&);
+    CommandExecutor& operator=(const CommandExecutor&);
+
+public:
+    /**
+     * @brief Create an executor
+     * @param pool Workers to run on, nullptr for the process-wide pool
+     */
+    explicit CommandExecutor(ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Wait for every submitted batch to finish
+     */
+    ~CommandExecutor();
+
+    /**
+     * @brief Queue a batch to run after earlier batches from this executor
+     * @param commands Commands to run in order (taken over by the executor)
+     * @return Handle that completes once the whole batch has run
+     */
+    CommandFuture submit(std::vector<CommandVariant>&& commands);
+
+    /**
+     * @brief Block until nothing is queued or running
+     */
+    void waitIdle();
+
+    /**
+     * @brief Batches queued or running
+     */
+    size_t pendingBatches() const;
+
+    /**
+     * @brief Run commands in order on the calling thread
+     *
+     * An exception from one command is recorded and the rest still run.
+     */
+    static CommandBatchResult runBatch(std::vector<CommandVariant>& commands);
+};
+
+#endif // COMMANDEXECUTOR_H
@@ -0,0 +1,270 @@
+/**
+ * @file CommandJournal.cpp
+ * @brief Implementation of CommandJournal
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-16
+ */
+
+#include "CommandJournal.h"
+#include "Logger.h"
+#include "TimerService.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t HEADER_BYTES = 8;   // Payload length + checksum
+
+uint64_t steadyMillis() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t checksum(const char* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::write(fd, data, length);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+CommandJournal::CommandJournal(const JournalOptions& options)
+    : options(options), fd(-1), fileBytes(0), lastFsyncMillis(steadyMillis()), dirty(false),
+      syncArmed(false), syncTimerId(0) {
+    stats.records = 0;
+    stats.batches = 0;
+    stats.bytesWritten = 0;
+    stats.writes = 0;
+    stats.fsyncs = 0;
+    stats.writeErrors = 0;
+    stats.syncErrors = 0;
+}
+
+CommandJournal::~CommandJournal() {
+    // Not under the mutex: cancel() waits for a running callback, which takes it
+    uint64_t armed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        armed = syncTimerId;
+    }
+    if (armed) {
+        TimerService::cancel(armed);
+    }
+    if (fd >= 0) {
+        flush();
+        ::close(fd);
+    }
+}
+
+bool CommandJournal::open(uint64_t validBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        return true;
+    }
+
+    fd = ::open(options.path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) == 0) {
+        fileBytes = static_cast<uint64_t>(info.st_size);
+    }
+    if (validBytes != UINT64_MAX && fileBytes > validBytes) {
+        // Drop the torn tail so new records follow the last good one
+        if (::ftruncate(fd, static_cast<off_t>(validBytes)) != 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        fileBytes = validBytes;
+    }
+    return true;
+}
+
+void CommandJournal::encodeRecord(RecordKind kind, const std::string& text, std::string& out) {
+    uint32_t length = static_cast<uint32_t>(text.size() + 1);
+    size_t start = out.size();
+    out.resize(start + HEADER_BYTES + length);
+
+    char* record = &out[start];
+    record[HEADER_BYTES] = static_cast<char>(kind);
+    std::memcpy(record + HEADER_BYTES + 1, text.data(), text.size());
+    uint32_t sum = checksum(record + HEADER_BYTES, length);
+    std::memcpy(record, &length, 4);
+    std::memcpy(record + 4, &sum, 4);
+}
+
+bool CommandJournal::writeBuffer() {
+    if (buffer.empty() || fd < 0) {
+        return fd >= 0;
+    }
+    bool written = writeAll(fd, buffer.data(), buffer.size());
+    if (written) {
+        fileBytes += buffer.size();
+        stats.bytesWritten += buffer.size();
+        stats.writes++;
+        dirty = true;
+    } else {
+        // The caller keeps the batch out of the history; cut off any partial record
+        stats.writeErrors++;
+        LOG_INFO_IN(GENERAL, "Journal write to " + options.path + " failed: " + std::strerror(errno));
+        rollback(fileBytes);
+    }
+    buffer.clear();
+    return written;
+}
+
+bool CommandJournal::sync() {
+    bool synced = true;
+    if (dirty && fd >= 0) {
+        if (::fdatasync(fd) == 0) {
+            stats.fsyncs++;
+        } else {
+            synced = false;
+            stats.syncErrors++;
+            LOG_INFO_IN(GENERAL, "Journal fsync of " + options.path + " failed: " + std::strerror(errno));
+        }
+        dirty = false;   // Pages a failed fsync dropped can't be synced by retrying
+    }
+    lastFsyncMillis = steadyMillis();
+    return synced;
+}
+
+void CommandJournal::rollback(uint64_t length) {
+    if (::ftruncate(fd, static_cast<off_t>(length)) == 0) {
+        fileBytes = length;
+    }
+}
+
+void CommandJournal::armSync() {
+    if (syncArmed || !dirty) {
+        return;
+    }
+    uint64_t elapsed = steadyMillis() - lastFsyncMillis;
+    uint64_t delay = elapsed < options.fsyncIntervalMillis ? options.fsyncIntervalMillis - elapsed : 0;
+    syncArmed = true;
+    syncTimerId = TimerService::schedule(delay, [this]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        syncArmed = false;
+        sync();
+    });
+}
+
+bool CommandJournal::appendBatch(const std::vector<std::string>& entries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t batchStart = fileBytes;
+    for (size_t i = 0; i < entries.size(); i++) {
+        encodeRecord(SAVE_RECORD, entries[i], buffer);
+    }
+    stats.records += entries.size();
+    stats.batches++;
+
+    switch (options.durability) {
+        case JournalDurability::BUFFERED:
+            if (buffer.size() >= options.bufferBytes) {
+                return writeBuffer();
+            }
+            return fd >= 0;
+        case JournalDurability::WRITE:
+            return writeBuffer();
+        case JournalDurability::GROUP_FSYNC:
+            if (!writeBuffer()) {
+                return false;
+            }
+            if (steadyMillis() - lastFsyncMillis >= options.fsyncIntervalMillis) {
+                sync();
+            } else {
+                armSync();   // Sync on time even if no further batch arrives
+            }
+            return true;
+        case JournalDurability::FSYNC:
+            if (!writeBuffer()) {
+                return false;
+            }
+            if (!sync()) {
+                rollback(batchStart);
+                return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+bool CommandJournal::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool written = writeBuffer();
+    return sync() && written;
+}
+
+JournalStats CommandJournal::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+JournalReplayResult CommandJournal::replay(const std::string& path, std::vector<std::string>& entries) {
+    JournalReplayResult result = {0, 0, false};
+    int input = ::open(path.c_str(), O_RDONLY);
+    if (input < 0) {
+        return result;
+    }
+
+    // One sequential pass: read the whole file, then decode in memory
+    std::string data;
+    struct stat info;
+    if (::fstat(input, &info) == 0 && info.st_size > 0) {
+        data.resize(static_cast<size_t>(info.st_size));
+        size_t filled = 0;
+        while (filled < data.size()) {
+            ssize_t got = ::read(input, &data[filled], data.size() - filled);
+            if (got <= 0) {
+                break;
+            }
+            filled += static_cast<size_t>(got);
+        }
+        data.resize(filled);
+    }
+    ::close(input);
+
+    size_t offset = 0;
+    while (offset + HEADER_BYTES <= data.size()) {
+        uint32_t length;
+        uint32_t sum;
+        std::memcpy(&length, data.data() + offset, 4);
+        std::memcpy(&sum, data.data() + offset + 4, 4);
+        const char* payload = data.data() + offset + HEADER_BYTES;
+
+        if (length == 0 || length > data.size() - offset - HEADER_BYTES || checksum(payload, length) != sum) {
+            break;
+        }
+        if (static_cast<uint8_t>(payload[0]) == SAVE_RECORD) {
+            entries.push_back(std::string(payload + 1, length - 1));
+        }
+        result.records++;
+        offset += HEADER_BYTES + length;
+    }
+
+    result.validBytes = offset;
+    result.truncated = offset < data.size();
+    return result;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file CommandJournal.h
+ * @brief Write-ahead journal of saved chat messages
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-16
+ */
+
+#ifndef COMMANDJOURNAL_H
+#define COMMANDJOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief How much a committed batch survives
+ */
+enum class JournalDurability {
+    BUFFERED,      ///< Kept in memory until bufferBytes fill up or flush(); lost if the process dies
+    WRITE,         ///< write() per batch; survives a process crash, not a power cut
+    GROUP_FSYNC,   ///< write() per batch, fsync within fsyncIntervalMillis (a timer covers idle periods)
+    FSYNC          ///< write() and fsync per batch before it reaches the history
+};
+
+/**
+ * @brief Settings for a CommandJournal
+ */
+struct JournalOptions {
+    std::string path;
+    JournalDurability durability;
+    size_t bufferBytes;               ///< BUFFERED: write once this much is pending
+    uint64_t fsyncIntervalMillis;     ///< GROUP_FSYNC: longest time between fsyncs
+
+    explicit JournalOptions(const std::string& path = "petspace.journal",
+                            JournalDurability durability = JournalDurability::GROUP_FSYNC)
+        : path(path), durability(durability), bufferBytes(64 * 1024), fsyncIntervalMillis(10) {}
+};
+
+/**
+ * @brief Journal counters
+ */
+struct JournalStats {
+    unsigned long records;
+    unsigned long batches;
+    unsigned long bytesWritten;
+    unsigned long writes;     ///< write() calls
+    unsigned long fsyncs;
+    unsigned long writeErrors;   ///< Batches a failed write() kept out of the journal
+    unsigned long syncErrors;    ///< fdatasync() calls that failed
+};
+
+/**
+ * @brief Outcome of reading a journal back
+ */
+struct JournalReplayResult {
+    unsigned long records;
+    uint64_t validBytes;     ///< Length of the intact prefix
+    bool truncated;          ///< A torn or corrupt record was found after validBytes
+};
+
+/**
+ * @class CommandJournal
+ * @brief Appends saved messages to a file before they reach the history
+ *
+ * Each record is [u32 payload length][u32 FNV-1a checksum][u8 kind][text],
+ * host byte order. A ChatRoom feeds it whole group-commit batches, so a
+ * batch becomes one write() and, depending on the durability level, at
+ * most one fsync. Replay reads the file sequentially and stops at the
+ * first record whose length or checksum doesn't hold, which is where a
+ * crash interrupted the last write.
+ *
+ * A failed write() or fsync is counted, logged and reported to the caller;
+ * the file is cut back to its last complete batch so later records still
+ * replay.
+ */
+class CommandJournal {
+public:
+    enum RecordKind : uint8_t {
+        SAVE_RECORD = 1   ///< A history entry ("User: message")
+    };
+
+private:
+    JournalOptions options;
+    int fd;
+    std::string buffer;           // Encoded records not yet written
+    uint64_t fileBytes;           // Length of the file up to the last complete write
+    uint64_t lastFsyncMillis;
+    bool dirty;                   // Written since the last fsync
+    bool syncArmed;               // GROUP_FSYNC: a timer will sync; cleared by the timer
+    uint64_t syncTimerId;         // Last timer armed; never cleared, so the destructor always cancels it
+    mutable std::mutex mutex;
+    JournalStats stats;
+
+    bool writeBuffer();
+    bool sync();
+    void rollback(uint64_t length);
+    void armSync();
+
+    CommandJournal(const CommandJournal&);
+    CommandJournal& operator=(const CommandJournal&);
+
+public:
+    explicit CommandJournal(const JournalOptions& options);
+
+    /**
+     * @brief Write and sync anything pending, then close
+     */
+    ~CommandJournal();
+
+    /**
+     * @brief Open for appending, first cutting off a torn tail at @p validBytes
+     * @param validBytes Intact length from replay(), or UINT64_MAX to keep the file as is
+     * @return false if the file can't be opened
+     */
+    bool open(uint64_t validBytes = UINT64_MAX);
+
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * @brief Journal one committed batch of history entries
+     * @return false if the batch could not be written (or, for FSYNC, synced)
+     *
+     * A BUFFERED batch only reports failure if it triggered the write.
+     */
+    bool appendBatch(const std::vector<std::string>& entries);
+
+    /**
+     * @brief Write and fsync everything appended so far
+     * @return false if the write or the fsync failed
+     */
+    bool flush();
+
+    JournalStats getStats() const;
+    JournalOptions getOptions() const { return options; }
+
+    /**
+     * @brief Read a journal's entries in order
+     * @param path Journal file (a missing file replays nothing)
+     * @param entries Receives each SAVE record's text, appended
+     */
+    static JournalReplayResult replay(const std::string& path, std::vector<std::string>& entries);
+
+    /**
+     * @brief Append one encoded record to @p out
+     */
+    static void encodeRecord(RecordKind kind, const std::string& text, std::string& out);
+};
+
+#endif // COMMANDJOURNAL_H
@@ -0,0 +1,220 @@
+/**
+ * @file CommandPool.cpp
+ * @brief Implementation of CommandPool
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-13
+ */
+
+#include "CommandPool.h"
+#include <atomic>
+#include <new>
+
+namespace {
+
+const std::size_t SIZE_CLASSES[] = {64, 128, 256};
+const int CLASS_COUNT = 3;
+const std::size_t MAX_CACHED_PER_CLASS = 1024;   // Bounds what a thread can hoard
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+int sizeClass(std::size_t size) {
+    for (int i = 0; i < CLASS_COUNT; i++) {
+        if (size <= SIZE_CLASSES[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+struct PoolOwner;
+
+/**
+ * Sits in front of every pooled block and names the thread it goes back to
+ * (nullptr for blocks handed out after their thread's pool closed).
+ */
+struct alignas(std::max_align_t) BlockHeader {
+    PoolOwner* owner;
+};
+
+// Marks a remote stack whose owner has exited; releases then go to the heap
+FreeBlock* const CLOSED = reinterpret_cast<FreeBlock*>(1);
+
+/**
+ * One thread's free lists. The owner pops and pushes its local lists
+ * without synchronisation; other threads push onto the lock-free remote
+ * stacks, which the owner takes over in one exchange when a local list runs
+ * dry. Each block in existence holds a reference, so an owner outlives its
+ * thread until the last block allocated there is gone.
+ */
+struct PoolOwner {
+    FreeBlock* heads[CLASS_COUNT];
+    std::size_t counts[CLASS_COUNT];
+    std::atomic<FreeBlock*> remote[CLASS_COUNT];
+    std::atomic<long> references;   // Thread + every block allocated here
+
+    PoolOwner() : references(1) {
+        for (int i = 0; i < CLASS_COUNT; i++) {
+            heads[i] = nullptr;
+            counts[i] = 0;
+            remote[i].store(nullptr);
+        }
+    }
+
+    void unreference(long count) {
+        if (references.fetch_sub(count, std::memory_order_acq_rel) == count) {
+            delete this;
+        }
+    }
+};
+
+void freeToHeap(FreeBlock* block) {
+    ::operator delete(reinterpret_cast<BlockHeader*>(block) - 1);
+}
+
+// Plain pointer and state so they stay usable after thread_local destructors
+// have run (e.g. a command deleted from a static destructor at exit)
+enum PoolState { UNSET, ACTIVE, CLOSED_STATE };
+thread_local PoolOwner* currentOwner = nullptr;
+thread_local PoolState poolState = UNSET;
+
+struct OwnerCloser {
+    ~OwnerCloser() {
+        PoolOwner* owner = currentOwner;
+        currentOwner = nullptr;
+        poolState = CLOSED_STATE;
+
+        long freed = 0;
+        for (int i = 0; i < CLASS_COUNT; i++) {
+            FreeBlock* lists[2] = {owner->heads[i], owner->remote[i].exchange(CLOSED, std::memory_order_acq_rel)};
+            for (int l = 0; l < 2; l++) {
+                while (lists[l]) {
+                    FreeBlock* block = lists[l];
+                    lists[l] = block->next;
+                    freeToHeap(block);
+                    freed++;
+                }
+            }
+            owner->heads[i] = nullptr;
+        }
+        owner->unreference(freed + 1);
+    }
+};
+
+PoolOwner* threadOwner() {
+    if (poolState == UNSET) {
+        static thread_local OwnerCloser closer;
+        (void)closer;
+        currentOwner = new PoolOwner();
+        poolState = ACTIVE;
+    }
+    return currentOwner;
+}
+
+std::atomic<unsigned long> pooledCount(0);
+std::atomic<unsigned long> heapCount(0);
+std::atomic<unsigned long> oversizeCount(0);
+
+} // namespace
+
+void* CommandPool::allocate(std::size_t size) {
+    int cls = sizeClass(size);
+    if (cls < 0) {
+        oversizeCount.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+
+    PoolOwner* owner = threadOwner();
+    if (owner) {
+        if (!owner->heads[cls] && owner->remote[cls].load(std::memory_order_relaxed)) {
+            // Take back everything other threads returned in one exchange
+            FreeBlock* list = owner->remote[cls].exchange(nullptr, std::memory_order_acquire);
+            long dropped = 0;
+            while (list) {
+                FreeBlock* block = list;
+                list = block->next;
+                if (owner->counts[cls] < MAX_CACHED_PER_CLASS) {
+                    block->next = owner->heads[cls];
+                    owner->heads[cls] = block;
+                    owner->counts[cls]++;
+                } else {
+                    freeToHeap(block);
+                    dropped++;
+                }
+            }
+            if (dropped) owner->unreference(dropped);
+        }
+
+        FreeBlock* block = owner->heads[cls];
+        if (block) {
+            owner->heads[cls] = block->next;
+            owner->counts[cls]--;
+            pooledCount.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+        owner->references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    heapCount.fetch_add(1, std::memory_order_relaxed);
+    BlockHeader* header = static_cast<BlockHeader*>(::operator new(sizeof(BlockHeader) + SIZE_CLASSES[cls]));
+    header->owner = owner;
+    return header + 1;
+}
+
+void CommandPool::release(void* block, std::size_t size) {
+    if (!block) {
+        return;
+    }
+
+    int cls = sizeClass(size);
+    if (cls < 0) {
+        ::operator delete(block);
+        return;
+    }
+
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    PoolOwner* owner = (static_cast<BlockHeader*>(block) - 1)->owner;
+    if (!owner) {
+        freeToHeap(freed);
+        return;
+    }
+
+    if (owner == currentOwner) {
+        if (owner->counts[cls] < MAX_CACHED_PER_CLASS) {
+            freed->next = owner->heads[cls];
+            owner->heads[cls] = freed;
+            owner->counts[cls]++;
+            return;
+        }
+        freeToHeap(freed);
+        owner->unreference(1);
+        return;
+    }
+
+    // Another thread's block: hand it back unless that thread has exited
+    FreeBlock* head = owner->remote[cls].load(std::memory_order_relaxed);
+    while (head != CLOSED) {
+        freed->next = head;
+        if (owner->remote[cls].compare_exchange_weak(head, freed, std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    freeToHeap(freed);
+    owner->unreference(1);
+}
+
+CommandPoolStats CommandPool::getStats() {
+    CommandPoolStats stats;
+    stats.pooledAllocations = pooledCount.load();
+    stats.heapAllocations = heapCount.load();
+    stats.oversizeAllocations = oversizeCount.load();
+    return stats;
+}
+
+void CommandPool::resetStats() {
+    pooledCount.store(0);
+    heapCount.store(0);
+    oversizeCount.store(0);
+}
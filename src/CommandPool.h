@@ -0,0 +1,50 @@
+/**
+ * @file CommandPool.h
+ * @brief Per-thread free lists for command objects
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-13
+ */
+
+#ifndef COMMANDPOOL_H
+#define COMMANDPOOL_H
+
+#include <cstddef>
+
+/**
+ * @brief Process-wide pool counters
+ */
+struct CommandPoolStats {
+    unsigned long pooledAllocations;   ///< Served from a free list
+    unsigned long heapAllocations;     ///< Had to ask the heap for a new block
+    unsigned long oversizeAllocations; ///< Too big for any size class
+};
+
+/**
+ * @class CommandPool
+ * @brief Recycles command-sized blocks without touching the heap
+ *
+ * Blocks fall into a few size classes. Each thread keeps a LIFO free list
+ * per class, so the Send/Save pair created for every message reuses the
+ * pair freed by the previous message and no lock is ever taken. A block
+ * freed on another thread (say, a command run by an executor worker) goes
+ * back to the thread that allocated it through a lock-free return stack.
+ * Cached blocks go back to the heap when their thread exits; blocks freed
+ * after that, including from static destructors, go straight to the heap.
+ */
+class CommandPool {
+public:
+    /**
+     * @brief Get a block of at least @p size bytes
+     */
+    static void* allocate(std::size_t size);
+
+    /**
+     * @brief Return a block from allocate() with the same @p size
+     */
+    static void release(void* block, std::size_t size);
+
+    static CommandPoolStats getStats();
+    static void resetStats();
+};
+
+#endif // COMMANDPOOL_H
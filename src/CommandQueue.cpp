@@ -0,0 +1,120 @@
+/**
+ * @file CommandQueue.cpp
+ * @brief Implementation of CommandQueue
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-13
+ */
+
+#include "CommandQueue.h"
+#include "ChatRoom.h"
+#include "Logger.h"
+#include <string>
+
+namespace {
+
+// Which room and sender a built-in command targets; both null for extensions
+struct RunTarget {
+    ChatRoom* room;
+    UserHandle user;
+
+    void operator()(const SendMessageAction& action) { room = action.chatRoom; user = action.fromUser; }
+    void operator()(const SaveMessageAction& action) { room = action.chatRoom; user = action.fromUser; }
+    void operator()(const Command&) { room = nullptr; user = UserHandle(); }
+};
+
+// Moves each command's text into the matching list
+struct RunCollector {
+    std::vector<std::string>& sends;
+    std::vector<std::string>& saves;
+
+    void operator()(SendMessageAction& action) { sends.push_back(std::move(action.message)); }
+    void operator()(SaveMessageAction& action) { saves.push_back(std::move(action.message)); }
+    void operator()(Command&) {}
+};
+
+// Reused across flushes so a steady stream of runs stops allocating
+thread_local std::vector<std::string> runSends;
+thread_local std::vector<std::string> runSaves;
+
+} // namespace
+
+CommandQueue::CommandQueue(std::size_t initialCapacity) {
+    commands.reserve(initialCapacity);
+}
+
+CommandQueue::~CommandQueue() {
+    discardAll();
+}
+
+void CommandQueue::executeAll() {
+    // Indexing (not iterators) so commands may queue more commands
+    for (std::size_t i = 0; i < commands.size(); i++) {
+        CommandVariant command(std::move(commands[i]));   // A push may move the array
+        command.execute();
+    }
+    commands.clear();   // Keeps capacity
+}
+
+void CommandQueue::takeAll(std::vector<CommandVariant>& out) {
+    out.clear();
+    out.swap(commands);
+    commands.reserve(out.capacity());   // Taken batches leave with the storage
+}
+
+std::size_t CommandQueue::executeCoalesced(std::vector<CommandVariant>& batch) {
+    std::size_t calls = 0;
+    std::size_t i = 0;
+    while (i < batch.size()) {
+        RunTarget first = {nullptr, UserHandle()};
+        batch[i].visit(first);
+
+        std::size_t end = i + 1;
+        if (first.room) {
+            for (; end < batch.size(); end++) {
+                RunTarget next = {nullptr, UserHandle()};
+                batch[end].visit(next);
+                if (next.room != first.room || next.user != first.user) {
+                    break;
+                }
+            }
+        }
+
+        if (end - i == 1) {
+            batch[i].execute();
+            calls++;
+            i = end;
+            continue;
+        }
+
+        User* fromUser = UserTable::resolve(first.user);
+        if (!fromUser) {
+            LOG_DEBUG_IN(COMMAND, "[CommandQueue] Sender left before its commands ran");
+            i = end;   // Cleared with the rest of the batch
+            continue;
+        }
+
+        runSends.clear();
+        runSaves.clear();
+        RunCollector collector = {runSends, runSaves};
+        for (std::size_t j = i; j < end; j++) {
+            batch[j].visit(collector);
+        }
+        LOG_DEBUG_IN(COMMAND, "[CommandQueue] Coalesced " + std::to_string(end - i) + " commands into one room call");
+
+        if (!runSends.empty()) {
+            first.room->sendMessages(runSends, fromUser);
+            calls++;
+        }
+        if (!runSaves.empty()) {
+            first.room->saveMessages(runSaves, fromUser);
+            calls++;
+        }
+        i = end;
+    }
+    batch.clear();
+    return calls;
+}
+
+void CommandQueue::discardAll() {
+    commands.clear();
+}
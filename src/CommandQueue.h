@@ -0,0 +1,120 @@
+/**
+ * @file CommandQueue.h
+ * @brief Reusable FIFO of pending commands
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-13
+ */
+
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include "CommandVariant.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Command;
+
+/**
+ * @brief When a user's queued commands are flushed
+ *
+ * A flush happens once everyCommands are queued or everyMillis after the
+ * first unflushed command, whichever comes first. everyCommands = 1 runs
+ * each send straight away (the default); 0 turns a trigger off, so
+ * CommandFlushPolicy(0, 0) waits for an explicit User::flushCommands().
+ * A send queues two commands.
+ */
+struct CommandFlushPolicy {
+    std::size_t everyCommands;
+    uint64_t everyMillis;
+
+    explicit CommandFlushPolicy(std::size_t everyCommands = 1, uint64_t everyMillis = 0)
+        : everyCommands(everyCommands), everyMillis(everyMillis) {}
+
+    bool isImmediate() const { return everyCommands == 1; }
+};
+
+/**
+ * @brief Counters for a user's deferred flushes
+ */
+struct CommandFlushStats {
+    unsigned long flushes;        ///< Flushes that ran at least one command
+    unsigned long timedFlushes;   ///< Of those, started by the timer
+    unsigned long commands;       ///< Commands run by flushes
+    unsigned long roomCalls;      ///< Mediator calls those commands became after coalescing
+};
+
+/**
+ * @class CommandQueue
+ * @brief Owns queued commands and runs them in order
+ *
+ * Commands are stored by value as CommandVariant, so built-in sends and
+ * saves sit inline in one array. Storage is reserved up front and kept
+ * across executeAll() calls, so a user's queue stops allocating after the
+ * first message.
+ */
+class CommandQueue {
+private:
+    std::vector<CommandVariant> commands;
+
+    CommandQueue(const CommandQueue&);
+    CommandQueue& operator=(const CommandQueue&);
+
+public:
+    /**
+     * @brief Create an empty queue
+     * @param initialCapacity Commands to reserve room for (a send queues two)
+     */
+    explicit CommandQueue(std::size_t initialCapacity = 4);
+
+    /**
+     * @brief Drop any commands that never ran
+     */
+    ~CommandQueue();
+
+    /**
+     * @brief Queue a built-in command
+     */
+    void push(CommandVariant&& command) { commands.push_back(std::move(command)); }
+
+    /**
+     * @brief Queue an extension command; the queue takes ownership
+     */
+    void push(Command* command) { commands.push_back(CommandVariant(command)); }
+
+    /**
+     * @brief Execute and delete every queued command, oldest first
+     *
+     * Commands queued while executing run in the same call.
+     */
+    void executeAll();
+
+    /**
+     * @brief Move every queued command into @p out, leaving the queue empty
+     */
+    void takeAll(std::vector<CommandVariant>& out);
+
+    /**
+     * @brief Execute a taken batch, merging adjacent built-ins into one mediator call
+     * @param batch Commands in queue order; left empty
+     * @return Mediator calls made (sendMessages/saveMessages or single commands)
+     *
+     * A run of sends and saves from the same user to the same room becomes
+     * one ChatRoom::sendMessages() followed by one saveMessages(), so the
+     * room checks membership once per run instead of once per command. An
+     * extension command ends the run and executes on its own. Within a run
+     * every message is broadcast before any is saved; messages keep their order.
+     */
+    static std::size_t executeCoalesced(std::vector<CommandVariant>& batch);
+
+    /**
+     * @brief Drop every queued command without running it
+     */
+    void discardAll();
+
+    std::size_t size() const { return commands.size(); }
+    bool empty() const { return commands.empty(); }
+    std::size_t capacity() const { return commands.capacity(); }
+};
+
+#endif // COMMANDQUEUE_H
@@ -0,0 +1,258 @@
+/**
+ * @file CommandScheduler.cpp
+ * @brief Implementation of CommandScheduler
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-16
+ */
+
+#include "CommandScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+const uint64_t TAG_UNIT = 1000000;   // Virtual time for one command at weight 1
+
+uint64_t steadyMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+int latencyBucket(uint64_t micros) {
+    int bucket = 0;
+    while (bucket < QosClassStats::HISTOGRAM_BUCKETS - 1 && (static_cast<uint64_t>(1) << bucket) <= micros) {
+        bucket++;
+    }
+    return bucket;
+}
+
+} // namespace
+
+const int QosClassStats::HISTOGRAM_BUCKETS;
+const int CommandScheduler::CLASS_COUNT;
+
+CommandScheduler::CommandScheduler(size_t threadCount)
+    : virtualTime(0), nextSequence(0), queuedBatches(0), runningBatches(0), promotedLast(false), stopping(false) {
+    QosClassPolicy free = {1, 500000};
+    QosClassPolicy premium = {8, 100000};
+    QosClassPolicy admin = {64, 20000};
+    policies[static_cast<int>(UserType::FREE)] = free;
+    policies[static_cast<int>(UserType::PREMIUM)] = premium;
+    policies[static_cast<int>(UserType::ADMIN)] = admin;
+    resetStats();
+
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 2;
+    }
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread(&CommandScheduler::workerLoop, this));
+    }
+}
+
+CommandScheduler::~CommandScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+void CommandScheduler::setPolicy(UserType type, const QosClassPolicy& policy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    policies[static_cast<int>(type)] = policy;
+    if (policies[static_cast<int>(type)].weight == 0) {
+        policies[static_cast<int>(type)].weight = 1;
+    }
+}
+
+QosClassPolicy CommandScheduler::getPolicy(UserType type) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return policies[static_cast<int>(type)];
+}
+
+void CommandScheduler::makeReady(Flow* flow) {
+    const Batch& head = flow->pending.front();
+    HeadKey byTag = {head.finishTag, head.sequence, flow};
+    HeadKey byTime = {head.submittedMicros, head.sequence, flow};
+    byFinishTag.insert(byTag);
+    byArrival[static_cast<int>(flow->type)].insert(byTime);
+}
+
+void CommandScheduler::makeUnready(Flow* flow) {
+    const Batch& head = flow->pending.front();
+    HeadKey byTag = {head.finishTag, head.sequence, flow};
+    HeadKey byTime = {head.submittedMicros, head.sequence, flow};
+    byFinishTag.erase(byTag);
+    byArrival[static_cast<int>(flow->type)].erase(byTime);
+}
+
+CommandFuture CommandScheduler::submit(const User* user, std::vector<CommandVariant>&& commands) {
+    return submit(user, user->getUserType(), std::move(commands));
+}
+
+CommandFuture CommandScheduler::submit(const void* flowKey, UserType type, std::vector<CommandVariant>&& commands) {
+    CommandFuture future;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Flow& flow = flows[flowKey];
+        if (!flow.running && flow.pending.empty()) {
+            flow.type = type;   // Never while the flow's head is indexed under its class
+        }
+
+        Batch batch;
+        batch.commands.swap(commands);
+        batch.sequence = nextSequence++;
+        batch.submittedMicros = steadyMicros();
+        uint64_t cost = std::max<size_t>(1, batch.commands.size()) * TAG_UNIT / policies[static_cast<int>(type)].weight;
+        batch.startTag = std::max(virtualTime, flow.lastFinishTag);
+        batch.finishTag = batch.startTag + cost;
+        flow.lastFinishTag = batch.finishTag;
+        future = batch.done.get_future().share();
+
+        bool becomesReady = !flow.running && flow.pending.empty();
+        flow.pending.push_back(std::move(batch));
+        if (becomesReady) {
+            makeReady(&flow);
+        }
+        queuedBatches++;
+    }
+    workReady.notify_one();
+    return future;
+}
+
+CommandScheduler::Flow* CommandScheduler::pickFlow(uint64_t now, bool& promoted) {
+    Flow* fair = byFinishTag.begin()->flow;
+    promoted = false;
+
+    // Starvation protection: the oldest head past its class's deadline goes
+    // first, highest class first. Promotions alternate with fair picks, so an
+    // overdue free backlog can't hold back an admin batch that fair order
+    // would run next.
+    if (promotedLast) {
+        promotedLast = false;
+        return fair;
+    }
+    for (int c = CLASS_COUNT - 1; c >= 0; c--) {
+        if (byArrival[c].empty() || policies[c].maxWaitMicros == 0) {
+            continue;
+        }
+        const HeadKey& oldest = *byArrival[c].begin();
+        if (now - oldest.key >= policies[c].maxWaitMicros) {
+            promoted = promotedLast = oldest.flow != fair;
+            return oldest.flow;
+        }
+    }
+    return fair;
+}
+
+void CommandScheduler::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        while (!stopping && byFinishTag.empty()) {
+            workReady.wait(lock);
+        }
+        if (byFinishTag.empty()) {
+            return;   // Stopping; whoever runs a flow's batch re-readies its next one
+        }
+
+        uint64_t now = steadyMicros();
+        bool promoted;
+        Flow* flow = pickFlow(now, promoted);
+        makeUnready(flow);
+        flow->running = true;
+        Batch batch = std::move(flow->pending.front());
+        flow->pending.pop_front();
+        virtualTime = std::max(virtualTime, batch.startTag);
+        queuedBatches--;
+        runningBatches++;
+
+        ClassCounters& counter = counters[static_cast<int>(flow->type)];
+        uint64_t wait = now - batch.submittedMicros;
+        counter.batches++;
+        counter.totalWaitMicros += wait;
+        counter.maxWaitMicros = std::max(counter.maxWaitMicros, wait);
+        if (promoted) {
+            counter.promoted++;
+        }
+
+        lock.unlock();
+        CommandBatchResult result = CommandExecutor::runBatch(batch.commands);
+        batch.commands.clear();
+        uint64_t latency = steadyMicros() - batch.submittedMicros;
+        batch.done.set_value(std::move(result));
+        lock.lock();
+
+        counter.latencyHistogram[latencyBucket(latency)]++;
+        runningBatches--;
+        flow->running = false;
+        if (!flow->pending.empty()) {
+            makeReady(flow);
+            workReady.notify_one();
+        } else {
+            flowIdle.notify_all();
+        }
+    }
+}
+
+void CommandScheduler::waitIdle(const void* flowKey) {
+    std::unique_lock<std::mutex> lock(mutex);
+    flowIdle.wait(lock, [this, flowKey]() {
+        std::map<const void*, Flow>::const_iterator it = flows.find(flowKey);
+        return it == flows.end() || (!it->second.running && it->second.pending.empty());
+    });
+}
+
+void CommandScheduler::retireFlow(const void* flowKey) {
+    waitIdle(flowKey);
+    std::lock_guard<std::mutex> lock(mutex);
+    flows.erase(flowKey);
+}
+
+QosClassStats CommandScheduler::getStats(UserType type) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const ClassCounters& counter = counters[static_cast<int>(type)];
+
+    QosClassStats stats;
+    stats.batches = counter.batches;
+    stats.promoted = counter.promoted;
+    stats.meanWaitMicros = counter.batches ? static_cast<double>(counter.totalWaitMicros) / counter.batches : 0.0;
+    stats.maxWaitMicros = counter.maxWaitMicros;
+
+    unsigned long finished = 0;
+    for (int i = 0; i < QosClassStats::HISTOGRAM_BUCKETS; i++) {
+        stats.latencyHistogram[i] = counter.latencyHistogram[i];
+        finished += counter.latencyHistogram[i];
+    }
+
+    stats.p50LatencyMicros = 0;
+    stats.p99LatencyMicros = 0;
+    unsigned long seen = 0;
+    for (int i = 0; i < QosClassStats::HISTOGRAM_BUCKETS && finished; i++) {
+        seen += counter.latencyHistogram[i];
+        if (!stats.p50LatencyMicros && seen * 100 >= finished * 50) {
+            stats.p50LatencyMicros = static_cast<uint64_t>(1) << i;
+        }
+        if (seen * 100 >= finished * 99) {
+            stats.p99LatencyMicros = static_cast<uint64_t>(1) << i;
+            break;
+        }
+    }
+    return stats;
+}
+
+void CommandScheduler::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        counters[c].batches = 0;
+        counters[c].promoted = 0;
+        counters[c].totalWaitMicros = 0;
+        counters[c].maxWaitMicros = 0;
+        for (int i = 0; i < QosClassStats::HISTOGRAM_BUCKETS; i++) {
+            counters[c].latencyHistogram[i] = 0;
+        }
+    }
+}
@@ -0,0 +1,175 @@
+/**
+ * @file CommandScheduler.h
+ * @brief QoS-aware scheduling of users' command batches by UserType
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-16
+ */
+
+#ifndef COMMANDSCHEDULER_H
+#define COMMANDSCHEDULER_H
+
+#include "CommandExecutor.h"
+#include "Users.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Scheduling rules for one UserType
+ */
+struct QosClassPolicy {
+    unsigned weight;          ///< Share of the workers relative to other users (0 is treated as 1)
+    uint64_t maxWaitMicros;   ///< A batch waiting this long may jump the queue (0 = never)
+};
+
+/**
+ * @brief Latency metrics for one UserType
+ *
+ * Wait is submit to start; latency is submit to finish. Percentiles are
+ * upper bounds of power-of-two microsecond buckets.
+ */
+struct QosClassStats {
+    static const int HISTOGRAM_BUCKETS = 32;
+
+    unsigned long batches;
+    unsigned long promoted;           ///< Batches run early by starvation protection
+    double meanWaitMicros;
+    uint64_t maxWaitMicros;
+    uint64_t p50LatencyMicros;
+    uint64_t p99LatencyMicros;
+    unsigned long latencyHistogram[HISTOGRAM_BUCKETS];   ///< Bucket i: latency < 2^i us
+};
+
+/**
+ * @class CommandScheduler
+ * @brief Runs users' batches on its own workers with weighted fair queuing
+ *
+ * Every user is a flow. A batch gets a virtual finish tag of
+ * max(virtual time, flow's last tag) + commands / class weight, and the
+ * workers always start the waiting batch with the smallest tag, so users
+ * share the workers in proportion to their class weight however much any
+ * one of them queues. A free-user flood therefore only delays an admin by
+ * about one batch per worker.
+ *
+ * Starvation protection: a batch that has waited longer than its class's
+ * maxWaitMicros is started ahead of the fair order, admins' first, then the
+ * oldest. At most every other start is such a promotion, so a backlog of
+ * overdue free batches still lets the fair order run an admin next.
+ *
+ * A flow runs one batch at a time, so each user's batches keep their order.
+ */
+class CommandScheduler {
+private:
+    struct Batch {
+        std::vector<CommandVariant> commands;
+        std::promise<CommandBatchResult> done;
+        uint64_t sequence;                 // Submission order, breaks ties
+        uint64_t startTag;
+        uint64_t finishTag;
+        uint64_t submittedMicros;
+    };
+
+    struct Flow;
+
+    // A ready flow's head batch, ordered by key then submission
+    struct HeadKey {
+        uint64_t key;
+        uint64_t sequence;
+        Flow* flow;
+
+        bool operator<(const HeadKey& other) const {
+            return key != other.key ? key < other.key : sequence < other.sequence;
+        }
+    };
+
+    struct Flow {
+        UserType type;
+        std::deque<Batch> pending;
+        uint64_t lastFinishTag;
+        bool running;
+
+        Flow() : type(UserType::FREE), lastFinishTag(0), running(false) {}
+    };
+
+    static const int CLASS_COUNT = 3;
+
+    QosClassPolicy policies[CLASS_COUNT];
+    std::map<const void*, Flow> flows;
+    std::set<HeadKey> byFinishTag;                 // Heads of flows ready to run
+    std::set<HeadKey> byArrival[CLASS_COUNT];      // Same heads, per class, by submit time
+    uint64_t virtualTime;
+    uint64_t nextSequence;
+    size_t queuedBatches;
+    size_t runningBatches;
+    bool promotedLast;                             // The last pick jumped the fair order
+    bool stopping;
+
+    mutable std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable flowIdle;
+    std::vector<std::thread> workers;
+
+    struct ClassCounters {
+        unsigned long batches;
+        unsigned long promoted;
+        uint64_t totalWaitMicros;
+        uint64_t maxWaitMicros;
+        unsigned long latencyHistogram[QosClassStats::HISTOGRAM_BUCKETS];
+    };
+    ClassCounters counters[CLASS_COUNT];
+
+    void workerLoop();
+    void makeReady(Flow* flow);
+    void makeUnready(Flow* flow);
+    Flow* pickFlow(uint64_t now, bool& promoted);
+
+    CommandScheduler(const CommandScheduler&);
+    CommandScheduler& operator=(const CommandScheduler&);
+
+public:
+    /**
+     * @brief Start the workers
+     * @param threadCount Number of workers, 0 for one per hardware thread
+     */
+    explicit CommandScheduler(size_t threadCount = 0);
+
+    /**
+     * @brief Run everything queued, then join the workers
+     */
+    ~CommandScheduler();
+
+    void setPolicy(UserType type, const QosClassPolicy& policy);
+    QosClassPolicy getPolicy(UserType type) const;
+
+    /**
+     * @brief Queue a batch for @p user, after the user's earlier batches
+     */
+    CommandFuture submit(const User* user, std::vector<CommandVariant>&& commands);
+
+    /**
+     * @brief Queue a batch for an arbitrary flow key with the given class
+     */
+    CommandFuture submit(const void* flowKey, UserType type, std::vector<CommandVariant>&& commands);
+
+    /**
+     * @brief Block until a flow has nothing queued or running, then forget it
+     */
+    void retireFlow(const void* flowKey);
+
+    /**
+     * @brief Block until a flow has nothing queued or running
+     */
+    void waitIdle(const void* flowKey);
+
+    QosClassStats getStats(UserType type) const;
+    void resetStats();
+
+    size_t getThreadCount() const { return workers.size(); }
+};
+
+#endif // COMMANDSCHEDULER_H
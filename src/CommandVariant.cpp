@@ -0,0 +1,132 @@
+/**
+ * @file CommandVariant.cpp
+ * @brief Implementation of CommandVariant
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-14
+ */
+
+#include "CommandVariant.h"
+#include "ChatRoom.h"
+#include "Command.h"
+#include "Logger.h"
+#include "StructuredLog.h"
+#include "Users.h"
+#include <new>
+
+namespace {
+
+// Logs the same events as SendMessageCommand/SaveMessageCommand
+struct ExecuteVisitor {
+    void operator()(SendMessageAction& action) {
+        User* fromUser = UserTable::resolve(action.fromUser);
+        if (!fromUser) {
+            LOG_DEBUG_IN(COMMAND, "[CommandVariant] Sender left before the send ran");
+            return;
+        }
+        LOG_EVENT(COMMAND, DEBUG, SEND_EXECUTING);
+        action.chatRoom->sendMessage(action.message, fromUser);
+        LOG_EVENT(COMMAND, DEBUG, SEND_COMPLETED);
+    }
+
+    void operator()(SaveMessageAction& action) {
+        User* fromUser = UserTable::resolve(action.fromUser);
+        if (!fromUser) {
+            LOG_DEBUG_IN(COMMAND, "[CommandVariant] Sender left before the save ran");
+            return;
+        }
+        LOG_EVENT(COMMAND, DEBUG, SAVE_EXECUTING);
+        action.chatRoom->saveMessage(action.message, fromUser);
+        LOG_EVENT(COMMAND, DEBUG, SAVE_COMPLETED);
+    }
+
+    void operator()(Command& command) {
+        command.execute();
+    }
+};
+
+} // namespace
+
+CommandVariant::CommandVariant(Kind kind) : kind(kind) {
+    switch (kind) {
+        case Kind::SEND:
+            new (&send) SendMessageAction();
+            break;
+        case Kind::SAVE:
+            new (&save) SaveMessageAction();
+            break;
+        case Kind::CUSTOM:
+            custom = nullptr;
+            break;
+    }
+}
+
+CommandVariant::CommandVariant(Command* command) : kind(Kind::CUSTOM), custom(command) {}
+
+CommandVariant CommandVariant::sendMessage(ChatRoom* room, User* user, std::string msg) {
+    CommandVariant command(Kind::SEND);
+    command.send.chatRoom = room;
+    command.send.fromUser = user->getHandle();
+    command.send.message.swap(msg);
+    LOG_EVENT(COMMAND, DEBUG, SEND_COMMAND_CREATED, user->getLogName());
+    return command;
+}
+
+CommandVariant CommandVariant::saveMessage(ChatRoom* room, User* user, std::string msg) {
+    CommandVariant command(Kind::SAVE);
+    command.save.chatRoom = room;
+    command.save.fromUser = user->getHandle();
+    command.save.message.swap(msg);
+    LOG_EVENT(COMMAND, DEBUG, SAVE_COMMAND_CREATED, command.save.message);
+    return command;
+}
+
+void CommandVariant::moveFrom(CommandVariant& other) {
+    kind = other.kind;
+    switch (kind) {
+        case Kind::SEND:
+            new (&send) SendMessageAction(std::move(other.send));
+            break;
+        case Kind::SAVE:
+            new (&save) SaveMessageAction(std::move(other.save));
+            break;
+        case Kind::CUSTOM:
+            custom = other.custom;
+            other.custom = nullptr;
+            break;
+    }
+}
+
+void CommandVariant::destroy() {
+    switch (kind) {
+        case Kind::SEND:
+            send.~SendMessageAction();
+            break;
+        case Kind::SAVE:
+            save.~SaveMessageAction();
+            break;
+        case Kind::CUSTOM:
+            delete custom;
+            break;
+    }
+}
+
+CommandVariant::CommandVariant(CommandVariant&& other) {
+    moveFrom(other);
+}
+
+CommandVariant& CommandVariant::operator=(CommandVariant&& other) {
+    if (this != &other) {
+        destroy();
+        moveFrom(other);
+    }
+    return *this;
+}
+
+CommandVariant::~CommandVariant() {
+    destroy();
+}
+
+void CommandVariant::execute() {
+    ExecuteVisitor executor;
+    visit(executor);
+}
@@ -0,0 +1,133 @@
+/**
+ * @file CommandVariant.h
+ * @brief Closed, value-semantic set of built-in commands
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-14
+ */
+
+#ifndef COMMANDVARIANT_H
+#define COMMANDVARIANT_H
+
+#include "UserTable.h"
+#include <string>
+#include <utility>
+
+class ChatRoom;
+class Command;
+class User;
+
+/**
+ * @brief Payload of a built-in send (same action as SendMessageCommand)
+ */
+struct SendMessageAction {
+    ChatRoom* chatRoom;
+    UserHandle fromUser;   ///< Resolved when the command runs; dropped if the user is gone
+    std::string message;
+};
+
+/**
+ * @brief Payload of a built-in save (same action as SaveMessageCommand)
+ */
+struct SaveMessageAction {
+    ChatRoom* chatRoom;
+    UserHandle fromUser;
+    std::string message;
+};
+
+/**
+ * @class CommandVariant
+ * @brief A queued command stored by value
+ *
+ * COMMAND PATTERN: the built-in commands are a closed set held inline in a
+ * tagged union, so a queue of them is one contiguous array and executing
+ * one is a switch rather than a heap object plus a virtual call. Anything
+ * else still goes through the open Command hierarchy as a CUSTOM entry,
+ * which owns its Command*.
+ *
+ * Move-only: a CUSTOM entry owns its command.
+ */
+class CommandVariant {
+public:
+    enum class Kind {
+        SEND,
+        SAVE,
+        CUSTOM
+    };
+
+private:
+    Kind kind;
+    union {
+        SendMessageAction send;
+        SaveMessageAction save;
+        Command* custom;
+    };
+
+    explicit CommandVariant(Kind kind);
+    void moveFrom(CommandVariant& other);
+    void destroy();
+
+    CommandVariant(const CommandVariant&);
+    CommandVariant& operator=(const CommandVariant&);
+
+public:
+    /**
+     * @brief Build a send; the message is moved in
+     */
+    static CommandVariant sendMessage(ChatRoom* room, User* user, std::string msg);
+
+    /**
+     * @brief Build a save; the message is moved in
+     */
+    static CommandVariant saveMessage(ChatRoom* room, User* user, std::string msg);
+
+    /**
+     * @brief Wrap an extension command, taking ownership
+     */
+    explicit CommandVariant(Command* command);
+
+    CommandVariant(CommandVariant&& other);
+    CommandVariant& operator=(CommandVariant&& other);
+    ~CommandVariant();
+
+    Kind getKind() const { return kind; }
+
+    /**
+     * @brief Call visitor(SendMessageAction&), visitor(SaveMessageAction&) or visitor(Command&)
+     */
+    template <typename Visitor>
+    void visit(Visitor& visitor) {
+        switch (kind) {
+            case Kind::SEND:
+                visitor(send);
+                break;
+            case Kind::SAVE:
+                visitor(save);
+                break;
+            case Kind::CUSTOM:
+                visitor(*custom);
+                break;
+        }
+    }
+
+    template <typename Visitor>
+    void visit(Visitor& visitor) const {
+        switch (kind) {
+            case Kind::SEND:
+                visitor(static_cast<const SendMessageAction&>(send));
+                break;
+            case Kind::SAVE:
+                visitor(static_cast<const SaveMessageAction&>(save));
+                break;
+            case Kind::CUSTOM:
+                visitor(static_cast<const Command&>(*custom));
+                break;
+        }
+    }
+
+    /**
+     * @brief Perform the command
+     */
+    void execute();
+};
+
+#endif // COMMANDVARIANT_H
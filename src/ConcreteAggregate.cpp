@@ -7,17 +7,17 @@
 
 #include "ConcreteAggregate.h"
 #include "ConcreteIterator.h"
-#include <iostream>
+#include "Logger.h"
 
 ConcreteAggregate::ConcreteAggregate(const std::vector<std::string>* history) 
     : chatHistory(history) {
     
-    std::cout << "[ConcreteAggregate] Created with chat history containing " 
-              << (history ? history->size() : 0) << " messages" << std::endl;
+    LOG_DEBUG_IN(ITERATOR, "[ConcreteAggregate] Created with chat history containing " + 
+                 std::to_string(history ? history->size() : 0) + " messages");
 }
 
 Iterator* ConcreteAggregate::createIterator() {
-    std::cout << "[ConcreteAggregate] Creating iterator for chat history" << std::endl;
+    LOG_DEBUG_IN(ITERATOR, "[ConcreteAggregate] Creating iterator for chat history");
     
     return new ConcreteIterator(chatHistory);
 }
\ No newline at end of file
@@ -6,26 +6,27 @@
  */
 
 #include "ConcreteIterator.h"
-#include <iostream>
+#include "Logger.h"
 
 ConcreteIterator::ConcreteIterator(const std::vector<std::string>* history) 
     : chatHistory(history), currentIndex(0) {
     
-    std::cout << "[ConcreteIterator] Created for chat history with " 
-              << (history ? history->size() : 0) << " messages" << std::endl;
+    LOG_DEBUG_IN(ITERATOR, "[ConcreteIterator] Created for chat history with " + 
+                 std::to_string(history ? history->size() : 0) + " messages");
 }
 
+// The per-step traces below run once per history entry, so they are sampled
 void ConcreteIterator::first() {
     currentIndex = 0;
-    std::cout << "[ConcreteIterator] Reset to first element" << std::endl;
+    LOG_DEBUG_SAMPLED(ITERATOR, "[ConcreteIterator] Reset to first element");
 }
 
 void ConcreteIterator::next() {
     if (!isDone()) {
         currentIndex++;
-        std::cout << "[ConcreteIterator] Moved to index " << currentIndex << std::endl;
+        LOG_DEBUG_SAMPLED(ITERATOR, "[ConcreteIterator] Moved to index " + std::to_string(currentIndex));
     } else {
-        std::cout << "[ConcreteIterator] Already at end - cannot move next" << std::endl;
+        LOG_DEBUG_SAMPLED(ITERATOR, "[ConcreteIterator] Already at end - cannot move next");
     }
 }
 
@@ -37,7 +38,7 @@ bool ConcreteIterator::isDone() const {
     bool done = currentIndex >= static_cast<int>(chatHistory->size());
     
     if (done) {
-        std::cout << "[ConcreteIterator] Iteration complete" << std::endl;
+        LOG_DEBUG_SAMPLED(ITERATOR, "[ConcreteIterator] Iteration complete");
     }
     
     return done;
@@ -45,12 +46,12 @@ bool ConcreteIterator::isDone() const {
 
 std::string ConcreteIterator::currentItem() const {
     if (isDone() || !chatHistory) {
-        std::cout << "[ConcreteIterator] No current item available" << std::endl;
+        LOG_DEBUG_SAMPLED(ITERATOR, "[ConcreteIterator] No current item available");
         return "";
     }
     
     std::string item = (*chatHistory)[currentIndex];
-    std::cout << "[ConcreteIterator] Current item: \"" << item << "\"" << std::endl;
+    LOG_DEBUG_SAMPLED(ITERATOR, "[ConcreteIterator] Current item: \"" + item + "\"");
     
     return item;
-}
\ No newline at end of file
+}
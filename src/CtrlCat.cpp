@@ -10,36 +10,41 @@
 #include "Logger.h"
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 void CtrlCat::registerUser(User* user) {
+    std::lock_guard<SharedMutex> membership(membershipMutex);
     // Check if user already exists using iterator
     std::vector<User*>::iterator it;
     for (it = users.begin(); it != users.end(); it++) {
         if (*it == user) {
-            Logger::info(user->getName() + " is already in CtrlCat room");
+            LOG_INFO_IN(CHATROOM, user->getName() + " is already in CtrlCat room");
             return;
         }
     }
     
     users.push_back(user);
+    addMember(user);
     user->addChatRoom(this);
 
-    Logger::info(user->getName() + " joined CtrlCat");
+    LOG_INFO_IN(CHATROOM, user->getName() + " joined CtrlCat");
 
-    Logger::debug("[CtrlCat] User " + user->getName() + " registered with mediator");
+    LOG_DEBUG_IN(CHATROOM, "[CtrlCat] User " + user->getName() + " registered with mediator");
 }
 
 void CtrlCat::removeUser(User* user) {
+    std::lock_guard<SharedMutex> membership(membershipMutex);
     std::vector<User*>::iterator it;
     for (it = users.begin(); it != users.end(); it++) {
         if (*it == user) {
             users.erase(it);
-            Logger::info(user->getName() + " left CtrlCat");
-            Logger::debug("[CtrlCat] User removed from mediator");
+            dropMember(user);
+            LOG_INFO_IN(CHATROOM, user->getName() + " left CtrlCat");
+            LOG_DEBUG_IN(CHATROOM, "[CtrlCat] User removed from mediator");
             return;
         }
     }
     
-    Logger::debug("[CtrlCat] User " + user->getName() + " was not in this room");
+    LOG_DEBUG_IN(CHATROOM, "[CtrlCat] User " + user->getName() + " was not in this room");
 }
\ No newline at end of file
@@ -18,6 +18,8 @@
  */
 class CtrlCat : public ChatRoom {
 public:
+    CtrlCat() : ChatRoom("CtrlCat") {}
+    
     /**
      * @brief Register a user with CtrlCat room, adds users to user vector
      * @param user Pointer to user to register
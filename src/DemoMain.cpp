@@ -10,6 +10,7 @@
 #include "CtrlCat.h"
 #include "Dogorithm.h"
 #include "Logger.h"
+#include "RateLimiter.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -53,6 +54,7 @@ int main() {
     int choice = 0;
     
     while (choice != 10) {
+        RateLimiter::processEvents();  // Quota notices that came due while waiting for input
         displayMainMenu();
         std::cout << "\nEnter your choice: ";
         std::cin >> choice;
@@ -10,37 +10,42 @@
 #include "Logger.h"
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 void Dogorithm::registerUser(User* user) {
+    std::lock_guard<SharedMutex> membership(membershipMutex);
     std::vector<User*>::iterator it;
     for (it = users.begin(); it != users.end(); it++) {
         if (*it == user) {
-            Logger::info(user->getName() + " already in Dogorithm room");
+            LOG_INFO_IN(CHATROOM, user->getName() + " already in Dogorithm room");
             return;
         }
     }
     
     // Add user to this mediator's user list
     users.push_back(user);
+    addMember(user);
 
     user->addChatRoom(this);
 
-    Logger::info(user->getName() + " joined Dogorithm");
+    LOG_INFO_IN(CHATROOM, user->getName() + " joined Dogorithm");
 
-    Logger::debug("[Dogorithm] User " + user->getName() + " registered with mediator");
+    LOG_DEBUG_IN(CHATROOM, "[Dogorithm] User " + user->getName() + " registered with mediator");
 }
 
 void Dogorithm::removeUser(User* user) {
+    std::lock_guard<SharedMutex> membership(membershipMutex);
     std::vector<User*>::iterator it;
     for (it = users.begin(); it != users.end(); it++) {
         if (*it == user) {
             users.erase(it);
-            Logger::info(user->getName() + " left Dogorithm");
-            Logger::debug("[Dogorithm] User removed from mediator");
+            dropMember(user);
+            LOG_INFO_IN(CHATROOM, user->getName() + " left Dogorithm");
+            LOG_DEBUG_IN(CHATROOM, "[Dogorithm] User removed from mediator");
             return;
         }
     }
     
-    Logger::debug("[Dogorithm] User " + user->getName() + " was not in this room");
+    LOG_DEBUG_IN(CHATROOM, "[Dogorithm] User " + user->getName() + " was not in this room");
 }
\ No newline at end of file
@@ -16,6 +16,8 @@
  */
 class Dogorithm : public ChatRoom {
 public:
+    Dogorithm() : ChatRoom("Dogorithm") {}
+    
     /**
      * @brief Register a user with Dogorithm room
      * @param user Pointer to user to register
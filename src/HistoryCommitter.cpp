@@ -0,0 +1,188 @@
+/**
+ * @file HistoryCommitter.cpp
+ * @brief Implementation of HistoryCommitter
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-15
+ */
+
+#include "HistoryCommitter.h"
+#include "TimerService.h"
+#include <chrono>
+#include <iterator>
+
+namespace {
+
+uint64_t steadyMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+const int GroupCommitStats::HISTOGRAM_BUCKETS;
+
+HistoryCommitter::HistoryCommitter(std::vector<std::string>* history, std::vector<uint32_t>* senders)
+    : history(history), senders(senders), oldestPendingMicros(0), delayArmed(false), delayTimer(0) {
+    resetStats();
+}
+
+HistoryCommitter::~HistoryCommitter() {
+    // Not under pendingMutex: cancel() waits for a running callback, which takes it
+    uint64_t armed;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        armed = delayTimer;
+    }
+    if (armed) {
+        TimerService::cancel(armed);
+    }
+    flush();
+}
+
+void HistoryCommitter::setOptions(const GroupCommitOptions& newOptions) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        options = newOptions;
+        if (options.maxBatchMessages == 0) {
+            options.maxBatchMessages = 1;
+        }
+    }
+    flush();   // Don't leave entries waiting under rules that no longer apply
+}
+
+GroupCommitOptions HistoryCommitter::getOptions() const {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return options;
+}
+
+void HistoryCommitter::setBatchSink(const BatchSink& sink) {
+    std::lock_guard<std::mutex> lock(commitMutex);
+    batchSink = sink;
+}
+
+void HistoryCommitter::append(std::string entry, uint32_t sender) {
+    bool commitNow;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (pending.empty() && options.maxDelayMicros) {
+            oldestPendingMicros = steadyMicros();
+        }
+        pending.push_back(std::string());
+        pending.back().swap(entry);
+        pendingSenders.push_back(sender);
+
+        uint64_t waited = steadyMicros() - oldestPendingMicros;
+        commitNow = pending.size() >= options.maxBatchMessages ||
+                    (options.maxDelayMicros && waited >= options.maxDelayMicros);
+
+        // Without a timer a quiet room would wait for its next save forever.
+        // schedule() never waits for a callback, so arming under the lock is safe.
+        if (!commitNow && options.maxDelayMicros && !delayArmed) {
+            delayArmed = true;
+            delayTimer = TimerService::schedule((options.maxDelayMicros - waited + 999) / 1000, [this]() {
+                {
+                    std::lock_guard<std::mutex> lock(pendingMutex);
+                    delayArmed = false;
+                }
+                flush();
+            });
+        }
+    }
+
+    if (commitNow) {
+        flush();
+    }
+}
+
+bool HistoryCommitter::flush() {
+    std::lock_guard<std::mutex> commit(commitMutex);
+    return commitPending();
+}
+
+bool HistoryCommitter::commitPending() {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (pending.empty()) {
+            return true;
+        }
+        batch.swap(pending);
+        batchSenders.swap(pendingSenders);
+    }
+
+    if (batchSink && !batchSink(batch)) {
+        // Not durable, so not committed: put it back ahead of newer saves
+        stats.failedBatches++;
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        batch.insert(batch.end(), std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.end()));
+        pending.swap(batch);
+        batch.clear();
+        batchSenders.insert(batchSenders.end(), pendingSenders.begin(), pendingSenders.end());
+        pendingSenders.swap(batchSenders);
+        batchSenders.clear();
+        return false;
+    }
+    history->insert(history->end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    if (senders) {
+        senders->insert(senders->end(), batchSenders.begin(), batchSenders.end());
+    }
+
+    stats.batches++;
+    stats.messages += batch.size();
+    stats.batchSizeHistogram[bucketFor(batch.size())]++;
+    batch.clear();   // Keeps capacity for the next swap
+    batchSenders.clear();
+    return true;
+}
+
+void HistoryCommitter::restore(std::vector<std::string>& entries) {
+    flush();
+    std::lock_guard<std::mutex> commit(commitMutex);
+    history->insert(history->end(), std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+    if (senders) {
+        senders->resize(history->size(), 0);
+    }
+    entries.clear();
+}
+
+void HistoryCommitter::withHistory(const HistoryReader& reader) {
+    static const std::vector<uint32_t> noSenders;
+    std::lock_guard<std::mutex> commit(commitMutex);
+    commitPending();
+    reader(*history, senders ? *senders : noSenders);
+}
+
+size_t HistoryCommitter::size() {
+    std::lock_guard<std::mutex> commit(commitMutex);
+    commitPending();
+    return history->size();
+}
+
+size_t HistoryCommitter::pendingCount() const {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return pending.size();
+}
+
+GroupCommitStats HistoryCommitter::getStats() {
+    std::lock_guard<std::mutex> lock(commitMutex);
+    return stats;
+}
+
+void HistoryCommitter::resetStats() {
+    std::lock_guard<std::mutex> lock(commitMutex);
+    stats.batches = 0;
+    stats.messages = 0;
+    stats.failedBatches = 0;
+    for (int i = 0; i < GroupCommitStats::HISTOGRAM_BUCKETS; i++) {
+        stats.batchSizeHistogram[i] = 0;
+    }
+}
+
+int HistoryCommitter::bucketFor(size_t batchSize) {
+    int bucket = 0;
+    size_t limit = 1;
+    while (limit < batchSize && bucket < GroupCommitStats::HISTOGRAM_BUCKETS - 1) {
+        limit <<= 1;
+        bucket++;
+    }
+    return bucket;
+}
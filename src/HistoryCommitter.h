@@ -0,0 +1,156 @@
+/**
+ * @file HistoryCommitter.h
+ * @brief Group commit of chat history entries
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-15
+ */
+
+#ifndef HISTORYCOMMITTER_H
+#define HISTORYCOMMITTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Latency/throughput knobs for group commit
+ *
+ * A batch commits as soon as it holds maxBatchMessages entries, or once
+ * its oldest entry has waited maxDelayMicros; a TimerService timer covers
+ * rooms where no further save arrives. The defaults commit every save
+ * immediately.
+ */
+struct GroupCommitOptions {
+    size_t maxBatchMessages;   ///< Commit once this many saves are pending (1 = no batching)
+    uint64_t maxDelayMicros;   ///< Commit once the oldest pending save is this old (0 = size only)
+
+    explicit GroupCommitOptions(size_t maxBatchMessages = 1, uint64_t maxDelayMicros = 0)
+        : maxBatchMessages(maxBatchMessages), maxDelayMicros(maxDelayMicros) {}
+};
+
+/**
+ * @brief Batch counters; histogram bucket i holds batches of 2^(i-1)+1 .. 2^i entries
+ */
+struct GroupCommitStats {
+    static const int HISTOGRAM_BUCKETS = 12;   ///< The last bucket also takes anything larger
+
+    unsigned long batches;
+    unsigned long messages;
+    unsigned long failedBatches;   ///< Commits the batch sink refused; the entries were kept pending
+    unsigned long batchSizeHistogram[HISTOGRAM_BUCKETS];
+};
+
+/**
+ * @class HistoryCommitter
+ * @brief Collects saved messages and appends them to a history in batches
+ *
+ * Savers only take a short lock to add to the pending batch. Committing
+ * takes the history lock once per batch and hands the whole batch to the
+ * batch sink in one call, which is where a durable backend does its single
+ * write. Commits are serialised, so batches reach the history and the sink
+ * in save order. A batch the sink refuses (returns false) is not
+ * committed; it stays pending, ahead of newer saves, for the next commit.
+ *
+ * Each entry may carry a 32-bit sender id (0 = unknown), kept in a column
+ * parallel to the history so the entry text never has to be parsed to
+ * find who wrote it.
+ */
+class HistoryCommitter {
+public:
+    typedef std::function<bool(const std::vector<std::string>&)> BatchSink;
+    typedef std::function<void(const std::vector<std::string>& history,
+                               const std::vector<uint32_t>& senders)> HistoryReader;
+
+private:
+    std::vector<std::string>* history;
+    std::vector<uint32_t>* senders;
+    GroupCommitOptions options;
+    BatchSink batchSink;
+
+    mutable std::mutex pendingMutex;     // Guards pending, oldestPendingMicros, options and the delay timer
+    std::vector<std::string> pending;
+    std::vector<uint32_t> pendingSenders;
+    uint64_t oldestPendingMicros;
+    bool delayArmed;                     // A timer will commit what is pending
+    uint64_t delayTimer;                 // Last timer armed; kept after it fires so the destructor can cancel it
+
+    std::mutex commitMutex;              // Guards history, batch, batchSink and stats
+    std::vector<std::string> batch;      // Reused between commits
+    std::vector<uint32_t> batchSenders;
+    GroupCommitStats stats;
+
+    HistoryCommitter(const HistoryCommitter&);
+    HistoryCommitter& operator=(const HistoryCommitter&);
+
+    bool commitPending();                // Caller holds commitMutex
+
+public:
+    /**
+     * @brief Commit into @p history and, if given, each entry's sender into @p senders (not owned)
+     */
+    explicit HistoryCommitter(std::vector<std::string>* history, std::vector<uint32_t>* senders = nullptr);
+
+    /**
+     * @brief Cancel the delay timer and commit anything still pending
+     */
+    ~HistoryCommitter();
+
+    void setOptions(const GroupCommitOptions& newOptions);
+    GroupCommitOptions getOptions() const;
+
+    /**
+     * @brief Receive every batch before it commits, once per batch (empty to remove)
+     *
+     * The sink returns false to keep the batch out of the history, e.g.
+     * when it could not be made durable.
+     */
+    void setBatchSink(const BatchSink& sink);
+
+    /**
+     * @brief Add an entry, committing the batch if it is full or old enough
+     * @param sender Who wrote it, recorded in the sender column (0 = unknown)
+     */
+    void append(std::string entry, uint32_t sender = 0);
+
+    /**
+     * @brief Commit whatever is pending now
+     * @return false if the batch sink refused the batch
+     */
+    bool flush();
+
+    /**
+     * @brief Append already-durable entries (e.g. a journal replay) without the batch sink
+     *
+     * Their senders are recorded as unknown.
+     */
+    void restore(std::vector<std::string>& entries);
+
+    /**
+     * @brief Commit what is pending, then run @p reader on the history under the commit lock
+     *
+     * Commits append without any lock of the owner's, so every read of the
+     * history outside the committer goes through here. @p senders is empty
+     * if the committer has no sender column. Don't save from @p reader.
+     */
+    void withHistory(const HistoryReader& reader);
+
+    /**
+     * @brief Committed entries, after committing what is pending
+     */
+    size_t size();
+
+    size_t pendingCount() const;
+
+    GroupCommitStats getStats();
+    void resetStats();
+
+    /**
+     * @brief Histogram bucket for a batch of @p batchSize entries
+     */
+    static int bucketFor(size_t batchSize);
+};
+
+#endif // HISTORYCOMMITTER_H
@@ -0,0 +1,451 @@
+/**
+ * @file LoadGeneratorMain.cpp
+ * @brief Synthetic load generator for the send path - build with "make clean loadgen"
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ *
+ * Creates a population of Free/Premium/Admin users and rooms, joins users
+ * to rooms with Zipfian popularity, then drives sends from N threads with
+ * log-normal message sizes and optional Poisson pacing, then reconnects
+ * the offline users so they catch up. Reports throughput, latency
+ * percentiles, peak memory, allocations per send and catch-up cost.
+ *
+ * Example: ./loadgen --users=1000000 --rooms=20000 --threads=8 --messages=2000000
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+#include "ChatRoom.h"
+#include "CtrlCat.h"
+#include "Dogorithm.h"
+#include "Logger.h"
+#include "Users.h"
+
+// Count heap allocations per thread, so a sender can count just its own send() calls
+thread_local unsigned long threadAllocations = 0;
+
+void* operator new(std::size_t size) {
+    threadAllocations++;
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+struct LoadOptions {
+    size_t users;
+    size_t rooms;
+    unsigned threads;
+    size_t messages;
+    double freePercent;
+    double adminPercent;        ///< The rest are Premium
+    double zipfExponent;        ///< Room popularity skew (0 = uniform)
+    double ratePerSecond;       ///< Total offered load, 0 = as fast as possible
+    double medianLength;        ///< Message length distribution (log-normal)
+    double lengthSigma;
+    double flaggedPercent;      ///< Messages containing a word Free users may not send
+    double onlinePercent;       ///< Users connected during the run; the rest reconnect and catch up after it
+    unsigned long seed;
+
+    LoadOptions()
+        : users(10000), rooms(500), threads(std::max(1u, std::thread::hardware_concurrency())),
+          messages(200000), freePercent(80), adminPercent(2), zipfExponent(1.0), ratePerSecond(0),
+          medianLength(40), lengthSigma(0.8), flaggedPercent(1), onlinePercent(100), seed(42) {}
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--option=value ...]\n"
+              << "  --users=N          users to create (default 10000)\n"
+              << "  --rooms=N          rooms to create (default 500)\n"
+              << "  --threads=N        sending threads (default: hardware threads)\n"
+              << "  --messages=N       sends to attempt in total (default 200000)\n"
+              << "  --free-pct=P       percent Free users (default 80)\n"
+              << "  --admin-pct=P      percent Admin users (default 2); the rest are Premium\n"
+              << "  --zipf=S           room popularity exponent (default 1.0, 0 = uniform)\n"
+              << "  --rate=R           offered sends/s across all threads (default 0 = unpaced)\n"
+              << "  --median-length=L  median message length in characters (default 40)\n"
+              << "  --length-sigma=S   log-normal spread of message length (default 0.8)\n"
+              << "  --flagged-pct=P    percent of messages Free validation blocks (default 1)\n"
+              << "  --online-pct=P     percent of users online while sending; the rest reconnect and\n"
+              << "                     catch up from history afterwards (default 100)\n"
+              << "  --seed=N           random seed (default 42)\n";
+}
+
+bool parseOptions(int argc, char* argv[], LoadOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        size_t equals = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || equals == std::string::npos) {
+            return false;
+        }
+        std::string key = arg.substr(2, equals - 2);
+        const char* value = argv[i] + equals + 1;
+        char* end = nullptr;
+        double number = std::strtod(value, &end);
+        if (end == value || *end != '\0' || number < 0) {
+            return false;
+        }
+
+        if (key == "users") options.users = static_cast<size_t>(number);
+        else if (key == "rooms") options.rooms = static_cast<size_t>(number);
+        else if (key == "threads") options.threads = static_cast<unsigned>(number);
+        else if (key == "messages") options.messages = static_cast<size_t>(number);
+        else if (key == "free-pct") options.freePercent = number;
+        else if (key == "admin-pct") options.adminPercent = number;
+        else if (key == "zipf") options.zipfExponent = number;
+        else if (key == "rate") options.ratePerSecond = number;
+        else if (key == "median-length") options.medianLength = number;
+        else if (key == "length-sigma") options.lengthSigma = number;
+        else if (key == "flagged-pct") options.flaggedPercent = number;
+        else if (key == "online-pct") options.onlinePercent = number;
+        else if (key == "seed") options.seed = static_cast<unsigned long>(number);
+        else return false;
+    }
+    return options.users > 0 && options.rooms > 0 && options.threads > 0 &&
+           options.freePercent + options.adminPercent <= 100 && options.onlinePercent <= 100;
+}
+
+/**
+ * Samples room indexes with P(k) proportional to 1 / (k + 1)^s
+ */
+class ZipfSampler {
+private:
+    std::vector<double> cumulative;
+
+public:
+    ZipfSampler(size_t count, double exponent) : cumulative(count) {
+        double total = 0;
+        for (size_t k = 0; k < count; k++) {
+            total += 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+            cumulative[k] = total;
+        }
+        for (size_t k = 0; k < count; k++) {
+            cumulative[k] /= total;
+        }
+    }
+
+    template <typename Engine>
+    size_t operator()(Engine& engine) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+        size_t k = static_cast<size_t>(std::lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin());
+        return std::min(k, cumulative.size() - 1);
+    }
+};
+
+/**
+ * Log-linear latency histogram: 16 sub-buckets per power of two, about 6% resolution
+ */
+class LatencyHistogram {
+private:
+    static const unsigned SUB_BITS = 4;
+    static const unsigned BUCKETS = 64 << SUB_BITS;
+    unsigned long counts[BUCKETS];
+    unsigned long total;
+    uint64_t maxNanos;
+
+    static unsigned bucketFor(uint64_t nanos) {
+        if (nanos < (1u << SUB_BITS)) {
+            return static_cast<unsigned>(nanos);
+        }
+        unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(nanos));
+        unsigned sub = static_cast<unsigned>((nanos >> (msb - SUB_BITS)) & ((1u << SUB_BITS) - 1));
+        return ((msb - SUB_BITS + 1) << SUB_BITS) + sub;
+    }
+
+    static uint64_t upperBound(unsigned bucket) {
+        if (bucket < (1u << SUB_BITS)) {
+            return bucket;
+        }
+        unsigned msb = (bucket >> SUB_BITS) + SUB_BITS - 1;
+        uint64_t sub = bucket & ((1u << SUB_BITS) - 1);
+        return ((uint64_t(1) << SUB_BITS | sub) + 1) << (msb - SUB_BITS);
+    }
+
+public:
+    LatencyHistogram() : total(0), maxNanos(0) {
+        std::fill(counts, counts + BUCKETS, 0UL);
+    }
+
+    void record(uint64_t nanos) {
+        counts[bucketFor(nanos)]++;
+        total++;
+        maxNanos = std::max(maxNanos, nanos);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (unsigned i = 0; i < BUCKETS; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        maxNanos = std::max(maxNanos, other.maxNanos);
+    }
+
+    uint64_t percentile(double fraction) const {
+        unsigned long rank = static_cast<unsigned long>(std::ceil(fraction * total));
+        unsigned long seen = 0;
+        for (unsigned i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank && counts[i]) {
+                return std::min(upperBound(i), maxNanos);
+            }
+        }
+        return maxNanos;
+    }
+
+    uint64_t getMax() const { return maxNanos; }
+    unsigned long getCount() const { return total; }
+};
+
+struct ThreadResult {
+    LatencyHistogram latency;
+    unsigned long attempted;
+    unsigned long allocations;   ///< Made on this thread inside send()
+    unsigned long accepted[3];
+    unsigned long rejected[3];
+
+    ThreadResult() : attempted(0), allocations(0) {
+        for (int t = 0; t < 3; t++) {
+            accepted[t] = rejected[t] = 0;
+        }
+    }
+};
+
+const char* WORDS[] = {
+    "walkies", "treat", "nap", "fetch", "purr", "bark", "whiskers", "tail", "zoomies", "vet",
+    "kibble", "leash", "park", "squirrel", "sunbeam", "cuddle", "ball", "yarn", "bath", "groom",
+    "good", "boy", "girl", "today", "again", "later", "cute", "sleepy", "hungry", "happy"
+};
+const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+template <typename Engine>
+std::string makeMessage(Engine& engine, std::lognormal_distribution<double>& length, double flaggedPercent) {
+    size_t target = static_cast<size_t>(std::min(2000.0, std::max(1.0, length(engine))));
+    std::string message;
+    message.reserve(target + 16);
+    if (std::uniform_real_distribution<double>(0.0, 100.0)(engine) < flaggedPercent) {
+        message += "stupid ";   // On the Free block list only
+    }
+    std::uniform_int_distribution<size_t> word(0, WORD_COUNT - 1);
+    while (message.size() < target) {
+        message += WORDS[word(engine)];
+        message += ' ';
+    }
+    message.resize(target);
+    return message;
+}
+
+long peakResidentKilobytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;   // Kilobytes on Linux
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int typeIndex(UserType type) {
+    return type == UserType::FREE ? 0 : type == UserType::PREMIUM ? 1 : 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    Logger::setLevel(NONE);
+
+    std::cout << "PetSpace load generator: " << options.users << " users, " << options.rooms << " rooms, "
+              << options.threads << " threads, " << options.messages << " messages" << std::endl;
+
+    // Population
+    std::chrono::steady_clock::time_point setupStart = std::chrono::steady_clock::now();
+    std::mt19937_64 setupEngine(options.seed);
+    std::vector<ChatRoom*> rooms;
+    rooms.reserve(options.rooms);
+    for (size_t r = 0; r < options.rooms; r++) {
+        rooms.push_back(r % 2 ? static_cast<ChatRoom*>(new Dogorithm()) : static_cast<ChatRoom*>(new CtrlCat()));
+    }
+
+    ZipfSampler popularRoom(options.rooms, options.zipfExponent);
+    std::uniform_real_distribution<double> percent(0.0, 100.0);
+    std::vector<User*> users;
+    std::vector<std::vector<ChatRoom*> > joined(options.users);
+    std::vector<size_t> roomSizes(options.rooms, 0);
+    users.reserve(options.users);
+    size_t memberships = 0;
+    for (size_t u = 0; u < options.users; u++) {
+        double roll = percent(setupEngine);
+        std::string name = "user" + std::to_string(u);
+        if (roll < options.freePercent) {
+            users.push_back(new FreeUser(name));
+        } else if (roll < options.freePercent + options.adminPercent) {
+            users.push_back(new AdminUser(name));
+        } else {
+            users.push_back(new PremiumUser(name));
+        }
+        if (options.onlinePercent < 100 && percent(setupEngine) >= options.onlinePercent) {
+            users.back()->goOffline();   // Rooms skip it on broadcast
+        }
+
+        // Most people are in one to three rooms; a few power users are in many
+        double size = percent(setupEngine);
+        size_t wanted = size < 60 ? 1 : size < 85 ? 2 : size < 95 ? 3 : 4 + static_cast<size_t>(percent(setupEngine) / 6);
+        wanted = std::min(wanted, options.rooms);
+        for (size_t attempt = 0; joined[u].size() < wanted && attempt < wanted * 8; attempt++) {
+            size_t r = popularRoom(setupEngine);
+            if (!users[u]->isInChatRoom(rooms[r])) {
+                rooms[r]->registerUser(users[u]);
+                joined[u].push_back(rooms[r]);
+                roomSizes[r]++;
+            }
+        }
+        memberships += joined[u].size();
+    }
+    double setupSeconds = secondsSince(setupStart);
+    long setupPeakKb = peakResidentKilobytes();
+    std::cout << "Setup: " << setupSeconds << " s, " << memberships << " memberships (largest room "
+              << *std::max_element(roomSizes.begin(), roomSizes.end()) << "), peak RSS "
+              << setupPeakKb / 1024 << " MB" << std::endl;
+
+    // Load: each thread owns a slice of the users, so no user is driven by two threads
+    std::vector<ThreadResult> results(options.threads);
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < options.threads; t++) {
+        workers.push_back(std::thread([&options, &users, &joined, &results, t]() {
+            ThreadResult& result = results[t];
+            std::mt19937_64 engine(options.seed * 7919 + t + 1);
+            std::lognormal_distribution<double> length(std::log(std::max(1.0, options.medianLength)), options.lengthSigma);
+            size_t first = users.size() * t / options.threads;
+            size_t last = users.size() * (t + 1) / options.threads;
+            size_t quota = options.messages / options.threads + (t < options.messages % options.threads ? 1 : 0);
+
+            // Only connected users in at least one room send
+            std::vector<size_t> senders;
+            for (size_t u = first; u < last; u++) {
+                if (!joined[u].empty() && users[u]->isOnline()) {
+                    senders.push_back(u);
+                }
+            }
+            if (senders.empty()) {
+                return;
+            }
+            std::uniform_int_distribution<size_t> pickUser(0, senders.size() - 1);
+
+            // Poisson arrivals; latency counts from the intended start so a backlog shows up
+            double perThreadRate = options.ratePerSecond / options.threads;
+            std::exponential_distribution<double> gap(perThreadRate > 0 ? perThreadRate : 1.0);
+            std::chrono::steady_clock::time_point intended = std::chrono::steady_clock::now();
+
+            for (size_t i = 0; i < quota; i++) {
+                size_t u = senders[pickUser(engine)];
+                ChatRoom* room = joined[u][std::uniform_int_distribution<size_t>(0, joined[u].size() - 1)(engine)];
+                std::string message = makeMessage(engine, length, options.flaggedPercent);
+
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                if (perThreadRate > 0) {
+                    intended += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(gap(engine)));
+                    if (intended > start) {
+                        std::this_thread::sleep_until(intended);
+                    }
+                    start = intended;
+                }
+
+                unsigned long allocationsBefore = threadAllocations;
+                bool sent = users[u]->send(std::move(message), room);
+                result.allocations += threadAllocations - allocationsBefore;
+                uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+                result.latency.record(nanos);
+                result.attempted++;
+                int type = typeIndex(users[u]->getUserType());
+                if (sent) {
+                    result.accepted[type]++;
+                } else {
+                    result.rejected[type]++;
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    double loadSeconds = secondsSince(loadStart);
+
+    // Catch-up: everyone who was offline reconnects and replays what they missed
+    std::chrono::steady_clock::time_point catchUpStart = std::chrono::steady_clock::now();
+    size_t reconnected = 0;
+    size_t replayed = 0;
+    for (size_t u = 0; u < users.size(); u++) {
+        if (!users[u]->isOnline()) {
+            replayed += users[u]->goOnline();
+            reconnected++;
+        }
+    }
+    double catchUpSeconds = secondsSince(catchUpStart);
+
+    // Report
+    ThreadResult total;
+    for (size_t t = 0; t < results.size(); t++) {
+        total.latency.merge(results[t].latency);
+        total.attempted += results[t].attempted;
+        total.allocations += results[t].allocations;
+        for (int type = 0; type < 3; type++) {
+            total.accepted[type] += results[t].accepted[type];
+            total.rejected[type] += results[t].rejected[type];
+        }
+    }
+    unsigned long accepted = total.accepted[0] + total.accepted[1] + total.accepted[2];
+    const char* typeNames[] = {"Free", "Premium", "Admin"};
+
+    std::cout << "\n=== Load Report ===" << std::endl;
+    std::cout << "Elapsed:        " << loadSeconds << " s" << std::endl;
+    std::cout << "Attempted:      " << total.attempted << " (" << total.attempted / loadSeconds << " sends/s)" << std::endl;
+    std::cout << "Accepted:       " << accepted << " (" << accepted / loadSeconds << " sends/s)" << std::endl;
+    for (int type = 0; type < 3; type++) {
+        std::cout << "  " << typeNames[type] << ": " << total.accepted[type] << " sent, " << total.rejected[type]
+                  << " rejected (quota or validation)" << std::endl;
+    }
+    std::cout << "Latency p50:    " << total.latency.percentile(0.50) / 1000.0 << " us" << std::endl;
+    std::cout << "Latency p99:    " << total.latency.percentile(0.99) / 1000.0 << " us" << std::endl;
+    std::cout << "Latency p999:   " << total.latency.percentile(0.999) / 1000.0 << " us" << std::endl;
+    std::cout << "Latency max:    " << total.latency.getMax() / 1000.0 << " us" << std::endl;
+    std::cout << "Peak RSS:       " << peakResidentKilobytes() / 1024 << " MB (" << setupPeakKb / 1024
+              << " MB after setup)" << std::endl;
+    std::cout << "Allocations:    " << (total.attempted ? static_cast<double>(total.allocations) / total.attempted : 0)
+              << " per send attempt (sending thread only)" << std::endl;
+    std::cout << "Catch-up:       " << reconnected << " users replayed " << replayed << " messages in "
+              << catchUpSeconds << " s" << std::endl;
+
+    for (size_t u = 0; u < users.size(); u++) {
+        delete users[u];
+    }
+    for (size_t r = 0; r < rooms.size(); r++) {
+        delete rooms[r];
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file LogDecoderMain.cpp
+ * @brief Offline decoder that renders StructuredLog files as text - build with "make logdecode"
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-11
+ */
+
+#include <fstream>
+#include <iostream>
+#include "StructuredLog.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <log file>" << std::endl;
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    long records = StructuredLog::decode(in, std::cout);
+    if (records < 0) {
+        std::cerr << argv[1] << " is not a valid PetSpace structured log" << std::endl;
+        return 1;
+    }
+    std::cerr << records << " records" << std::endl;
+    return 0;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file LogFileSink.cpp
+ * @brief Implementation of LogFileSink
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-12
+ */
+
+#include "LogFileSink.h"
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<uint64_t> nextSinkId(1);
+
+uint64_t steadyMillis() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// The calling thread's buffer in the most recently used sink
+struct LocalBufferCache {
+    uint64_t sinkId;
+    void* buffer;
+};
+
+thread_local LocalBufferCache localCache = {0, nullptr};
+
+} // namespace
+
+LogFileSink::LogFileSink(const LogFileSinkOptions& options)
+    : options(options), sinkId(nextSinkId.fetch_add(1)), fd(-1), fileBytes(0),
+      stopping(false), flushRequests(0), flushesCompleted(0),
+      bytesWritten(0), rotations(0), fsyncs(0), handoffs(0) {
+    if (this->options.bufferBytes < 256) {
+        this->options.bufferBytes = 256;
+    }
+    if (this->options.flushIntervalMillis == 0) {
+        this->options.flushIntervalMillis = 200;
+    }
+    fileOpenedMillis = lastFsyncMillis = steadyMillis();
+    openFile();
+    writer = std::thread(&LogFileSink::writerLoop, this);
+}
+
+LogFileSink::~LogFileSink() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        queueReady.notify_one();
+    }
+    writer.join();
+
+    if (fd >= 0) {
+        if (options.fsyncIntervalMillis) {
+            ::fsync(fd);
+        }
+        ::close(fd);
+    }
+    for (size_t i = 0; i < threadBuffers.size(); i++) {
+        delete threadBuffers[i];
+    }
+}
+
+bool LogFileSink::openFile() {
+    fd = ::open(options.path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    fileBytes = size > 0 ? static_cast<uint64_t>(size) : 0;
+    fileOpenedMillis = steadyMillis();
+    return true;
+}
+
+LogFileSink::ThreadBuffer* LogFileSink::localBuffer() {
+    if (localCache.sinkId == sinkId) {
+        return static_cast<ThreadBuffer*>(localCache.buffer);
+    }
+
+    ThreadBuffer* buffer = new ThreadBuffer;
+    buffer->data.reserve(options.bufferBytes);
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        threadBuffers.push_back(buffer);
+    }
+    localCache.sinkId = sinkId;
+    localCache.buffer = buffer;
+    return buffer;
+}
+
+void LogFileSink::handOff(std::string& data) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    fullBuffers.push_back(std::string());
+    fullBuffers.back().swap(data);
+    if (!spareBuffers.empty()) {
+        data.swap(spareBuffers.back());   // Reuse a written buffer's capacity
+        spareBuffers.pop_back();
+    } else {
+        data.reserve(options.bufferBytes);
+    }
+    handoffs.fetch_add(1, std::memory_order_relaxed);
+    queueReady.notify_one();
+}
+
+void LogFileSink::write(const std::string& record) {
+    ThreadBuffer* buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);   // Only the writer's sweep competes
+    buffer->data += record;
+    buffer->data += '\n';
+    if (buffer->data.size() >= options.bufferBytes) {
+        handOff(buffer->data);
+    }
+}
+
+void LogFileSink::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    unsigned long ticket = ++flushRequests;
+    queueReady.notify_one();
+    flushDone.wait(lock, [this, ticket]() { return flushesCompleted >= ticket || stopping; });
+}
+
+void LogFileSink::writeOut(const std::string& data) {
+    if (fd < 0 && !openFile()) {
+        return;
+    }
+
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t written = ::write(fd, data.data() + offset, data.size() - offset);
+        if (written <= 0) {
+            return;   // Disk full or similar: drop the rest rather than stall logging
+        }
+        offset += static_cast<size_t>(written);
+    }
+    fileBytes += data.size();
+    bytesWritten.fetch_add(data.size(), std::memory_order_relaxed);
+}
+
+void LogFileSink::rotate() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+
+    // path.(n-1) -> path.n, ..., path -> path.1; the oldest is overwritten
+    for (unsigned i = options.maxFiles; i > 1; i--) {
+        std::string from = options.path + "." + std::to_string(i - 1);
+        std::string to = options.path + "." + std::to_string(i);
+        std::rename(from.c_str(), to.c_str());
+    }
+    if (options.maxFiles > 0) {
+        std::rename(options.path.c_str(), (options.path + ".1").c_str());
+    } else {
+        std::remove(options.path.c_str());
+    }
+
+    openFile();
+    rotations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LogFileSink::writerLoop() {
+    std::vector<std::string> batch;
+    uint64_t lastSweep = steadyMillis();
+
+    for (;;) {
+        bool sweep;
+        bool stop;
+        unsigned long flushTicket;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait_for(lock, std::chrono::milliseconds(options.flushIntervalMillis), [this]() {
+                return stopping || !fullBuffers.empty() || flushRequests > flushesCompleted;
+            });
+            batch.swap(fullBuffers);
+            stop = stopping;
+            flushTicket = flushRequests;
+            sweep = stop || flushTicket > flushesCompleted ||
+                    steadyMillis() - lastSweep >= options.flushIntervalMillis;
+        }
+
+        if (sweep) {
+            // Collect partly filled buffers so quiet threads still reach the file
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            for (size_t i = 0; i < threadBuffers.size(); i++) {
+                std::lock_guard<std::mutex> bufferLock(threadBuffers[i]->mutex);
+                {
+                    // Anything this thread handed off must be written before its newer partial buffer
+                    std::lock_guard<std::mutex> queueLock(queueMutex);
+                    for (size_t j = 0; j < fullBuffers.size(); j++) {
+                        batch.push_back(std::string());
+                        batch.back().swap(fullBuffers[j]);
+                    }
+                    fullBuffers.clear();
+                }
+                if (!threadBuffers[i]->data.empty()) {
+                    batch.push_back(std::string());
+                    batch.back().swap(threadBuffers[i]->data);
+                }
+            }
+            lastSweep = steadyMillis();
+        }
+
+        for (size_t i = 0; i < batch.size(); i++) {
+            uint64_t now = steadyMillis();
+            if ((options.maxFileBytes && fileBytes > 0 && fileBytes + batch[i].size() > options.maxFileBytes) ||
+                (options.rotateIntervalMillis && now - fileOpenedMillis >= options.rotateIntervalMillis)) {
+                rotate();
+            }
+            writeOut(batch[i]);
+        }
+
+        uint64_t now = steadyMillis();
+        if (fd >= 0 && options.fsyncIntervalMillis && now - lastFsyncMillis >= options.fsyncIntervalMillis) {
+            ::fsync(fd);
+            fsyncs.fetch_add(1, std::memory_order_relaxed);
+            lastFsyncMillis = now;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            for (size_t i = 0; i < batch.size() && spareBuffers.size() < 16; i++) {
+                batch[i].clear();
+                spareBuffers.push_back(std::string());
+                spareBuffers.back().swap(batch[i]);
+            }
+            if (sweep && flushTicket > flushesCompleted) {
+                flushesCompleted = flushTicket;
+                flushDone.notify_all();
+            }
+        }
+        batch.clear();
+
+        if (stop) {
+            return;
+        }
+    }
+}
+
+LogFileSinkStats LogFileSink::getStats() const {
+    LogFileSinkStats stats;
+    stats.bytesWritten = bytesWritten.load();
+    stats.rotations = rotations.load();
+    stats.fsyncs = fsyncs.load();
+    stats.handoffs = handoffs.load();
+    return stats;
+}
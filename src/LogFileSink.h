@@ -0,0 +1,124 @@
+/**
+ * @file LogFileSink.h
+ * @brief Buffered, rotating log file output for Logger
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-12
+ */
+
+#ifndef LOGFILESINK_H
+#define LOGFILESINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Settings for a LogFileSink
+ */
+struct LogFileSinkOptions {
+    std::string path;                 ///< Active log file; rotated files get ".1", ".2", ...
+    size_t bufferBytes;               ///< Per-thread buffer size before handing off to the writer
+    uint64_t maxFileBytes;            ///< Rotate once the file reaches this size (0 = never)
+    uint64_t rotateIntervalMillis;    ///< Rotate after this long (0 = never)
+    unsigned maxFiles;                ///< Rotated files to keep
+    uint64_t flushIntervalMillis;     ///< Collect partly filled thread buffers this often
+    uint64_t fsyncIntervalMillis;     ///< fsync the file this often (0 = leave it to the OS)
+
+    explicit LogFileSinkOptions(const std::string& path = "petspace.log")
+        : path(path), bufferBytes(64 * 1024), maxFileBytes(0), rotateIntervalMillis(0),
+          maxFiles(5), flushIntervalMillis(200), fsyncIntervalMillis(0) {}
+};
+
+/**
+ * @brief Snapshot of sink counters
+ */
+struct LogFileSinkStats {
+    unsigned long bytesWritten;
+    unsigned long rotations;
+    unsigned long fsyncs;
+    unsigned long handoffs;   ///< Buffers passed from logging threads to the writer
+};
+
+/**
+ * @class LogFileSink
+ * @brief Writes log records to a file through per-thread buffers
+ *
+ * Each logging thread appends to its own buffer (guarded by a lock only the
+ * writer ever competes for) and hands full buffers to a background writer
+ * thread. The writer owns the file: it issues large write() calls, rotates
+ * by size or age and fsyncs on its own schedule, so a logging thread never
+ * waits for a rename, open or sync.
+ */
+class LogFileSink {
+private:
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::string data;
+    };
+
+    LogFileSinkOptions options;
+    uint64_t sinkId;                           // Tells thread-local caches which sink they belong to
+    int fd;
+    uint64_t fileBytes;
+    uint64_t fileOpenedMillis;
+    uint64_t lastFsyncMillis;
+
+    std::mutex buffersMutex;                   // Guards threadBuffers
+    std::vector<ThreadBuffer*> threadBuffers;
+
+    std::mutex queueMutex;                     // Guards everything below
+    std::condition_variable queueReady;
+    std::condition_variable flushDone;
+    std::vector<std::string> fullBuffers;      // Handed off, waiting to be written
+    std::vector<std::string> spareBuffers;     // Written, ready for reuse
+    bool stopping;
+    unsigned long flushRequests;
+    unsigned long flushesCompleted;
+    std::thread writer;
+
+    std::atomic<unsigned long> bytesWritten;
+    std::atomic<unsigned long> rotations;
+    std::atomic<unsigned long> fsyncs;
+    std::atomic<unsigned long> handoffs;
+
+    ThreadBuffer* localBuffer();
+    void handOff(std::string& data);
+    void writerLoop();
+    void writeOut(const std::string& data);
+    void rotate();
+    bool openFile();
+
+    LogFileSink(const LogFileSink&);
+    LogFileSink& operator=(const LogFileSink&);
+
+public:
+    /**
+     * @brief Open the log file (appending) and start the writer thread
+     */
+    explicit LogFileSink(const LogFileSinkOptions& options);
+
+    /**
+     * @brief Write every buffered record, then close the file
+     */
+    ~LogFileSink();
+
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * @brief Append one record (a newline is added) from any thread
+     */
+    void write(const std::string& record);
+
+    /**
+     * @brief Block until every record written so far is in the file
+     */
+    void flush();
+
+    LogFileSinkStats getStats() const;
+};
+
+#endif // LOGFILESINK_H
@@ -0,0 +1,63 @@
+/**
+ * @file LogRingBuffer.cpp
+ * @brief Implementation of LogRingBuffer
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-10
+ */
+
+#include "LogRingBuffer.h"
+
+LogRingBuffer::LogRingBuffer(size_t capacity) : enqueuePos(0), dequeuePos(0) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mask = size - 1;
+
+    cells = new Cell[size];
+    for (size_t i = 0; i < size; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+LogRingBuffer::~LogRingBuffer() {
+    delete[] cells;
+}
+
+bool LogRingBuffer::tryPush(std::string& record) {
+    size_t position = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[position & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        long difference = static_cast<long>(sequence) - static_cast<long>(position);
+
+        if (difference == 0) {
+            // Cell is free for this lap; claim it
+            if (enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.record.swap(record);
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;   // Consumer has not freed this cell yet
+        } else {
+            position = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool LogRingBuffer::tryPop(std::string& record) {
+    Cell& cell = cells[dequeuePos & mask];
+    if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+        return false;
+    }
+
+    record.swap(cell.record);
+    cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+    dequeuePos++;
+    return true;
+}
+
+bool LogRingBuffer::isEmpty() const {
+    return cells[dequeuePos & mask].sequence.load(std::memory_order_acquire) != dequeuePos + 1;
+}
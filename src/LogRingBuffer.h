@@ -0,0 +1,70 @@
+/**
+ * @file LogRingBuffer.h
+ * @brief Bounded lock-free queue of log records for the asynchronous Logger
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-10
+ */
+
+#ifndef LOGRINGBUFFER_H
+#define LOGRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+/**
+ * @class LogRingBuffer
+ * @brief Multi-producer, single-consumer ring of strings
+ *
+ * Each cell carries a sequence number (Vyukov's bounded queue), so producers
+ * claim cells with one compare-and-swap and never take a lock. Records are
+ * swapped in and out, so a cell's string buffer is reused once it has grown.
+ */
+class LogRingBuffer {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        std::string record;
+    };
+
+    Cell* cells;
+    size_t mask;
+    char producerPad[64];                     // Keep the two positions on separate cache lines
+    std::atomic<size_t> enqueuePos;
+    char consumerPad[64];
+    size_t dequeuePos;                        // Consumer only
+
+    LogRingBuffer(const LogRingBuffer&);
+    LogRingBuffer& operator=(const LogRingBuffer&);
+
+public:
+    /**
+     * @brief Create the ring
+     * @param capacity Number of records, rounded up to a power of two
+     */
+    explicit LogRingBuffer(size_t capacity);
+    ~LogRingBuffer();
+
+    /**
+     * @brief Add a record if there is room (any thread)
+     * @param record Record to add; on success it is swapped with a spent buffer
+     * @return false if the ring is full
+     */
+    bool tryPush(std::string& record);
+
+    /**
+     * @brief Take the oldest record (consumer thread only)
+     * @param record Receives the record
+     * @return false if the ring is empty
+     */
+    bool tryPop(std::string& record);
+
+    /**
+     * @brief Whether the next pop would fail (consumer thread only)
+     */
+    bool isEmpty() const;
+
+    size_t getCapacity() const { return mask + 1; }
+};
+
+#endif // LOGRINGBUFFER_H
@@ -6,5 +6,259 @@
  */
 
 #include "Logger.h"
+#include "LogFileSink.h"
+#include "LogRingBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
-LogLevel Logger::currentLevel = DEBUG;
\ No newline at end of file
+std::atomic<int> Logger::currentLevel(DEBUG);
+std::atomic<int> Logger::componentLevels[static_cast<int>(LogComponent::COUNT)] = {{-1}, {-1}, {-1}, {-1}, {-1}, {-1}};
+std::atomic<unsigned> Logger::sampleRates[static_cast<int>(LogComponent::COUNT)] = {{1}, {1}, {1}, {1}, {1}, {1}};
+
+namespace {
+
+const size_t BATCH_BYTES = 64 * 1024;
+
+std::atomic<bool> asyncEnabled(false);
+std::atomic<int> activeProducers(0);    // Producers that may be touching the ring
+std::atomic<bool> writerStopping(false);
+std::atomic<bool> writerSleeping(false);
+std::atomic<LogFileSink*> fileSink(nullptr);
+std::atomic<bool> fileSinkMirrors(false);  // Also write to std::cout while a file sink is open
+LogOverflowPolicy overflowPolicy = LogOverflowPolicy::BLOCK;
+LogRingBuffer* ring = nullptr;
+
+std::atomic<unsigned long> pushedCount(0);
+std::atomic<unsigned long> writtenCount(0);
+std::atomic<unsigned long> droppedCount(0);
+std::atomic<unsigned long> blockedCount(0);
+std::atomic<unsigned long> batchCount(0);
+
+std::mutex controlMutex;                // Serialises start/stop
+std::mutex wakeMutex;
+std::condition_variable wakeWriter;
+std::thread writerThread;
+
+void notifyWriter() {
+    if (writerSleeping.load()) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeWriter.notify_one();
+    }
+}
+
+void writerLoop() {
+    std::string batch;
+    std::string record;
+    batch.reserve(BATCH_BYTES);
+    unsigned long batched = 0;
+
+    for (;;) {
+        while (batch.size() < BATCH_BYTES && ring->tryPop(record)) {
+            batch += record;
+            batch += '\n';
+            batched++;
+        }
+
+        if (!batch.empty()) {
+            std::cout.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            std::cout.flush();
+            batch.clear();
+            writtenCount.fetch_add(batched);
+            batchCount.fetch_add(1);
+            batched = 0;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (writerStopping.load() && ring->isEmpty()) {
+            return;
+        }
+        writerSleeping.store(true);
+        if (ring->isEmpty() && !writerStopping.load()) {
+            // The timeout bounds latency if a producer's wakeup is missed
+            wakeWriter.wait_for(lock, std::chrono::milliseconds(2));
+        }
+        writerSleeping.store(false);
+    }
+}
+
+// Drains the buffer and closes the file sink when the program exits
+struct AsyncShutdown {
+    ~AsyncShutdown() {
+        Logger::closeFileSink();
+        Logger::stopAsync();
+        delete ring;
+        ring = nullptr;
+    }
+};
+
+AsyncShutdown asyncShutdown;
+
+} // namespace
+
+void Logger::resetComponentLevels() {
+    for (int i = 0; i < static_cast<int>(LogComponent::COUNT); i++) {
+        componentLevels[i].store(-1, std::memory_order_relaxed);
+        sampleRates[i].store(1, std::memory_order_relaxed);
+    }
+}
+
+void Logger::write(const std::string& message) {
+    activeProducers.fetch_add(1);
+    LogFileSink* sink = fileSink.load();
+    if (sink) {
+        sink->write(message);
+        if (!fileSinkMirrors.load()) {
+            activeProducers.fetch_sub(1);
+            return;
+        }
+    }
+
+    if (!asyncEnabled.load()) {
+        activeProducers.fetch_sub(1);
+        std::cout << message << std::endl;
+        return;
+    }
+
+    std::string record(message);
+    if (!ring->tryPush(record)) {
+        if (overflowPolicy == LogOverflowPolicy::DROP) {
+            droppedCount.fetch_add(1);
+            activeProducers.fetch_sub(1);
+            return;
+        }
+
+        blockedCount.fetch_add(1);
+        do {
+            notifyWriter();
+            std::this_thread::yield();
+        } while (!ring->tryPush(record));
+    }
+
+    pushedCount.fetch_add(1);
+    activeProducers.fetch_sub(1);
+    notifyWriter();
+}
+
+void Logger::startAsync(size_t capacity, LogOverflowPolicy policy) {
+    std::lock_guard<std::mutex> control(controlMutex);
+    if (asyncEnabled.load()) {
+        return;
+    }
+
+    if (!ring || ring->getCapacity() < capacity) {
+        delete ring;
+        ring = new LogRingBuffer(capacity);
+    }
+    overflowPolicy = policy;
+    writerStopping.store(false);
+    writerThread = std::thread(writerLoop);
+    asyncEnabled.store(true);
+}
+
+void Logger::stopAsync() {
+    std::lock_guard<std::mutex> control(controlMutex);
+    if (!asyncEnabled.load()) {
+        return;
+    }
+
+    // New records go straight to std::cout; wait out pushes already under way
+    asyncEnabled.store(false);
+    while (activeProducers.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        writerStopping.store(true);
+        wakeWriter.notify_one();
+    }
+    writerThread.join();
+}
+
+bool Logger::openFileSink(const LogFileSinkOptions& options, bool mirrorToConsole) {
+    LogFileSink* sink = new LogFileSink(options);
+    if (!sink->isOpen()) {
+        delete sink;
+        return false;
+    }
+
+    closeFileSink();
+    fileSinkMirrors.store(mirrorToConsole);
+    fileSink.store(sink);
+    return true;
+}
+
+void Logger::closeFileSink() {
+    std::lock_guard<std::mutex> control(controlMutex);
+    LogFileSink* sink = fileSink.exchange(nullptr);
+    if (!sink) {
+        return;
+    }
+
+    // Let writers that already picked up the sink finish before it goes away
+    while (activeProducers.load() != 0) {
+        std::this_thread::yield();
+    }
+    delete sink;   // Writes everything still buffered
+}
+
+bool Logger::hasFileSink() {
+    return fileSink.load() != nullptr;
+}
+
+LogFileSinkStats Logger::getFileSinkStats() {
+    std::lock_guard<std::mutex> control(controlMutex);
+    LogFileSink* sink = fileSink.load();
+    if (sink) {
+        return sink->getStats();
+    }
+    LogFileSinkStats none = {0, 0, 0, 0};
+    return none;
+}
+
+bool Logger::isAsync() {
+    return asyncEnabled.load();
+}
+
+void Logger::flush() {
+    {
+        std::lock_guard<std::mutex> control(controlMutex);
+        LogFileSink* sink = fileSink.load();
+        if (sink) {
+            sink->flush();
+        }
+    }
+    if (asyncEnabled.load()) {
+        unsigned long target = pushedCount.load();
+        while (writtenCount.load() < target) {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                wakeWriter.notify_one();
+            }
+            std::this_thread::yield();
+        }
+    }
+    std::cout.flush();
+}
+
+LoggerStats Logger::getStats() {
+    LoggerStats stats;
+    stats.written = writtenCount.load();
+    stats.dropped = droppedCount.load();
+    stats.blocked = blockedCount.load();
+    stats.batches = batchCount.load();
+    return stats;
+}
+
+void Logger::resetStats() {
+    // Keep pushed and written in step so flush() stays correct
+    flush();
+    pushedCount.fetch_sub(writtenCount.exchange(0));
+    droppedCount.store(0);
+    blockedCount.store(0);
+    batchCount.store(0);
+}
@@ -8,6 +8,8 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
+#include <cstddef>
 #include <iostream>
 #include <string>
 
@@ -18,48 +20,187 @@ enum LogLevel {
     DEBUG = 3      // Full debugging info
 };
 
+struct LogFileSinkOptions;
+struct LogFileSinkStats;
+
+// Subsystems whose log levels can be set independently of the global level
+enum class LogComponent {
+    GENERAL,
+    CHATROOM,
+    COMMAND,
+    VALIDATION,
+    ITERATOR,
+    USER,
+    COUNT
+};
+
+// What a producer does when the asynchronous buffer is full
+enum class LogOverflowPolicy {
+    BLOCK,   // Wait for the writer thread (nothing is lost)
+    DROP     // Discard the record and count it
+};
+
+struct LoggerStats {
+    unsigned long written;   // Records written by the background thread
+    unsigned long dropped;   // Records discarded under LogOverflowPolicy::DROP
+    unsigned long blocked;   // Records that had to wait for space
+    unsigned long batches;   // Writes issued to std::cout
+};
+
 class Logger {
 private:
-    static LogLevel currentLevel;
+    // Read on every log call from any thread; relaxed is enough for a level switch
+    static std::atomic<int> currentLevel;
+    static std::atomic<int> componentLevels[static_cast<int>(LogComponent::COUNT)];      // -1 follows currentLevel
+    static std::atomic<unsigned> sampleRates[static_cast<int>(LogComponent::COUNT)];
 
 public:
+    // Writes a record to std::cout, directly or through the async backend.
+    // No level check: callers have already decided the record is wanted.
+    static void write(const std::string& message);
+    
     static void setLevel(LogLevel level) {
-        currentLevel = level;
+        currentLevel.store(level, std::memory_order_relaxed);
     }
     
     static LogLevel getLevel() {
-        return currentLevel;
+        return static_cast<LogLevel>(currentLevel.load(std::memory_order_relaxed));
+    }
+    
+    static bool isEnabled(LogLevel level) {
+        return getLevel() >= level;
+    }
+    
+    // Per-component levels override the global level in either direction,
+    // e.g. trace ITERATOR at DEBUG while everything else stays at USER_ONLY
+    static void setComponentLevel(LogComponent component, LogLevel level) {
+        componentLevels[static_cast<int>(component)].store(level, std::memory_order_relaxed);
+    }
+    
+    static void clearComponentLevel(LogComponent component) {
+        componentLevels[static_cast<int>(component)].store(-1, std::memory_order_relaxed);
+    }
+    
+    static void resetComponentLevels();
+    
+    static LogLevel getComponentLevel(LogComponent component) {
+        int level = componentLevels[static_cast<int>(component)].load(std::memory_order_relaxed);
+        return level < 0 ? getLevel() : static_cast<LogLevel>(level);
+    }
+    
+    static bool isEnabled(LogComponent component, LogLevel level) {
+        return getComponentLevel(component) >= level;
+    }
+    
+    // LOG_DEBUG_SAMPLED sites in a component log one call in every "rate"
+    static void setSampleRate(LogComponent component, unsigned rate) {
+        sampleRates[static_cast<int>(component)].store(rate ? rate : 1, std::memory_order_relaxed);
+    }
+    
+    static unsigned getSampleRate(LogComponent component) {
+        return sampleRates[static_cast<int>(component)].load(std::memory_order_relaxed);
+    }
+    
+    // Log at a level chosen at run time
+    static void log(LogLevel level, const std::string& message) {
+        if (getLevel() >= level) {
+            write(message);
+        }
     }
     
     // Log only essential user messages (clean chat experience)
     static void user(const std::string& message) {
-        if (currentLevel >= USER_ONLY) {
-            std::cout << message << std::endl;
+        if (getLevel() >= USER_ONLY) {
+            write(message);
         }
     }
     
     // Log basic system operations (joins, leaves, etc.)
     static void info(const std::string& message) {
-        if (currentLevel >= BASIC) {
-            std::cout << message << std::endl;
+        if (getLevel() >= BASIC) {
+            write(message);
         }
     }
     
     // Log detailed debugging info (pattern operations, memory management)
     static void debug(const std::string& message) {
-        if (currentLevel >= DEBUG) {
-            std::cout << message << std::endl;
+        if (getLevel() >= DEBUG) {
+            write(message);
         }
     }
     
+    // Asynchronous backend: records go into a lock-free ring buffer and a
+    // background thread writes them to std::cout in batches. Anything still
+    // buffered is written by stopAsync(), which also runs at program exit.
+    // Call flush() before writing to std::cout directly to keep ordering.
+    static void startAsync(size_t capacity = 8192, LogOverflowPolicy policy = LogOverflowPolicy::BLOCK);
+    static void stopAsync();
+    static bool isAsync();
+    
+    // File output (see LogFileSink): records go to per-thread buffers and a
+    // writer thread that handles rotation and fsync. While a sink is open it
+    // replaces std::cout unless mirrorToConsole is set.
+    static bool openFileSink(const LogFileSinkOptions& options, bool mirrorToConsole = false);
+    static void closeFileSink();
+    static bool hasFileSink();
+    static LogFileSinkStats getFileSinkStats();
+    
+    // Wait until every record logged so far has been written
+    static void flush();
+    
+    static LoggerStats getStats();
+    static void resetStats();
+    
     // Utility methods for common patterns
     static void chatMessage(const std::string& username, const std::string& message) {
-        user(username + ": " + message);
+        if (getLevel() >= USER_ONLY) {
+            write(username + ": " + message);
+        }
     }
     
     static void systemMessage(const std::string& message) {
-        info("[SYSTEM] " + message);
+        if (getLevel() >= BASIC) {
+            write("[SYSTEM] " + message);
+        }
     }
 };
 
+// Highest level compiled into the program. Build with -DLOGGER_COMPILE_LEVEL=2
+// (make LOG_LEVEL=2) to strip every LOG_DEBUG call from release builds.
+#ifndef LOGGER_COMPILE_LEVEL
+#define LOGGER_COMPILE_LEVEL DEBUG
+#endif
+
+// True if messages at this level are compiled in and currently enabled
+#define LOG_ENABLED(level) (LOGGER_COMPILE_LEVEL >= (level) && Logger::isEnabled(level))
+
+// Logging front end: the message expression is only evaluated (and its
+// strings only built) when the level is enabled, so disabled calls cost a
+// single comparison and compiled-out calls cost nothing.
+#define LOG_USER(...) do { if (LOG_ENABLED(USER_ONLY)) Logger::user(__VA_ARGS__); } while (0)
+#define LOG_INFO(...) do { if (LOG_ENABLED(BASIC)) Logger::info(__VA_ARGS__); } while (0)
+#define LOG_DEBUG(...) do { if (LOG_ENABLED(DEBUG)) Logger::debug(__VA_ARGS__); } while (0)
+
+// Component-aware front end, e.g. LOG_DEBUG_IN(CHATROOM, "...")
+#define LOG_COMPONENT_ENABLED(component, level) \
+    (LOGGER_COMPILE_LEVEL >= (level) && Logger::isEnabled(LogComponent::component, level))
+#define LOG_AT(component, level, ...) do { \
+        if (LOG_COMPONENT_ENABLED(component, level)) Logger::write(__VA_ARGS__); \
+    } while (0)
+#define LOG_USER_IN(component, ...) LOG_AT(component, USER_ONLY, __VA_ARGS__)
+#define LOG_INFO_IN(component, ...) LOG_AT(component, BASIC, __VA_ARGS__)
+#define LOG_DEBUG_IN(component, ...) LOG_AT(component, DEBUG, __VA_ARGS__)
+
+// For very frequent debug sites: each site logs one call in every
+// Logger::getSampleRate(component), counting only calls at enabled levels
+#define LOG_DEBUG_SAMPLED(component, ...) do { \
+        if (LOG_COMPONENT_ENABLED(component, DEBUG)) { \
+            static std::atomic<unsigned long> logSiteCalls(0); \
+            if (logSiteCalls.fetch_add(1, std::memory_order_relaxed) % \
+                    Logger::getSampleRate(LogComponent::component) == 0) { \
+                Logger::write(__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
 #endif
\ No newline at end of file
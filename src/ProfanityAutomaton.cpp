@@ -0,0 +1,319 @@
+/**
+ * @file ProfanityAutomaton.cpp
+ * @brief Compilation (trie and bounded subset construction) and matching for ProfanityAutomaton
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-08
+ */
+
+#include "ProfanityAutomaton.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <deque>
+#include <map>
+
+namespace {
+
+const uint32_t ROOT_AT_BOUNDARY = 0;   // Previous byte was not a letter/digit
+const uint32_t ROOT_IN_WORD = 1;       // Previous byte was a letter/digit
+const uint32_t SPILL = 0xFFFFFFFFu;    // Transition past the state cap: continue on the trie
+
+struct TrieNode {
+    std::vector<std::pair<char, uint32_t> > children;
+    int term;   // Pattern ending here, -1 if none
+
+    TrieNode() : term(-1) {}
+};
+
+bool isSeparator(unsigned char c) {
+    return c == '.' || c == '-' || c == '_' || c == '*' || c == '~';
+}
+
+// Bytes that stand for a (lowercase) pattern character
+void fillEquivalents(unsigned char c, std::vector<char>& row) {
+    row[c] = 1;
+    if (!isalpha(c)) {
+        return;
+    }
+
+    row[toupper(c)] = 1;
+
+    const char* lookAlikes = "";
+    switch (c) {
+        case 'a': lookAlikes = "4@*"; break;
+        case 'b': lookAlikes = "8"; break;
+        case 'e': lookAlikes = "3*"; break;
+        case 'g': lookAlikes = "9"; break;
+        case 'i': lookAlikes = "1!|*"; break;
+        case 'l': lookAlikes = "1|"; break;
+        case 'o': lookAlikes = "0*"; break;
+        case 's': lookAlikes = "5$"; break;
+        case 't': lookAlikes = "7+"; break;
+        case 'u': lookAlikes = "*"; break;
+        case 'z': lookAlikes = "2"; break;
+        default: break;
+    }
+    for (const char* p = lookAlikes; *p; p++) {
+        row[static_cast<unsigned char>(*p)] = 1;
+    }
+}
+
+} // namespace
+
+const size_t ProfanityAutomaton::DEFAULT_MAX_DFA_STATES;
+
+ProfanityAutomaton::ProfanityAutomaton() : classCount(1) {
+    std::memset(byteClass, 0, sizeof(byteClass));
+    for (int b = 0; b < 256; b++) {
+        wordByte[b] = isalnum(b) != 0;
+    }
+    classWord.assign(1, 0);
+    classSeparator.assign(1, 0);
+    classCharStart.assign(2, 0);
+    edgeStart.assign(2, 0);
+    nodeTerm.assign(1, -1);
+    transitions.assign(1, 0);
+    acceptingTerm.assign(1, -1);
+    stateSets.assign(1, NodeSet(1, ROOT_AT_BOUNDARY));
+}
+
+ProfanityAutomaton::ProfanityAutomaton(const std::vector<std::string>& blockedTerms, size_t maxDfaStates)
+    : classCount(0) {
+    for (int b = 0; b < 256; b++) {
+        wordByte[b] = isalnum(b) != 0;
+    }
+
+    // Patterns are the lowercased terms without separators (they are skippable anyway)
+    std::vector<std::string> patterns;
+    for (const std::string& term : blockedTerms) {
+        std::string pattern;
+        for (char ch : term) {
+            unsigned char c = static_cast<unsigned char>(ch);
+            if (!isSeparator(c)) pattern.push_back(static_cast<char>(tolower(c)));
+        }
+        if (!pattern.empty()) {
+            terms.push_back(term);
+            patterns.push_back(pattern);
+        }
+    }
+
+    // equivalent[c * 256 + b] != 0 when byte b can stand for pattern char c
+    std::vector<char> equivalent(256 * 256, 0);
+    bool usedChar[256] = {false};
+    for (const std::string& pattern : patterns) {
+        for (char ch : pattern) usedChar[static_cast<unsigned char>(ch)] = true;
+    }
+    for (int c = 0; c < 256; c++) {
+        if (!usedChar[c]) continue;
+        std::vector<char> row(256, 0);
+        fillEquivalents(static_cast<unsigned char>(c), row);
+        std::copy(row.begin(), row.end(), equivalent.begin() + c * 256);
+    }
+
+    // Fold bytes with identical behaviour into classes
+    std::map<std::string, unsigned char> classOf;
+    std::vector<unsigned char> classRepresentative;
+    for (int b = 0; b < 256; b++) {
+        std::string signature;
+        signature.push_back(wordByte[b] ? 'w' : '-');
+        signature.push_back(isSeparator(static_cast<unsigned char>(b)) ? 's' : '-');
+        for (int c = 0; c < 256; c++) {
+            if (usedChar[c]) signature.push_back(equivalent[c * 256 + b] ? '1' : '0');
+        }
+
+        std::map<std::string, unsigned char>::iterator it = classOf.find(signature);
+        if (it == classOf.end()) {
+            unsigned char id = static_cast<unsigned char>(classRepresentative.size());
+            classOf[signature] = id;
+            classRepresentative.push_back(static_cast<unsigned char>(b));
+            byteClass[b] = id;
+        } else {
+            byteClass[b] = it->second;
+        }
+    }
+    classCount = classRepresentative.size();
+    for (size_t k = 0; k < classCount; k++) {
+        unsigned char b = classRepresentative[k];
+        classWord.push_back(wordByte[b] ? 1 : 0);
+        classSeparator.push_back(isSeparator(b) ? 1 : 0);
+        classCharStart.push_back(static_cast<uint32_t>(classChars.size()));
+        for (int c = 0; c < 256; c++) {
+            if (usedChar[c] && equivalent[c * 256 + b]) classChars.push_back(static_cast<unsigned char>(c));
+        }
+    }
+    classCharStart.push_back(static_cast<uint32_t>(classChars.size()));
+
+    // Trie over the patterns, so shared prefixes share nodes; node 0 is the root
+    std::vector<TrieNode> trie(1);
+    for (size_t p = 0; p < patterns.size(); p++) {
+        uint32_t node = 0;
+        for (char ch : patterns[p]) {
+            uint32_t child = 0;
+            for (const std::pair<char, uint32_t>& edge : trie[node].children) {
+                if (edge.first == ch) child = edge.second;
+            }
+            if (!child) {
+                child = static_cast<uint32_t>(trie.size());
+                trie[node].children.push_back(std::make_pair(ch, child));
+                trie.push_back(TrieNode());
+            }
+            node = child;
+        }
+        if (trie[node].term < 0) trie[node].term = static_cast<int>(p);
+    }
+
+    // Flatten it: one edge array, each node's edges sorted for binary search
+    edgeStart.reserve(trie.size() + 1);
+    edgeChar.reserve(trie.size());
+    edgeTarget.reserve(trie.size());
+    nodeTerm.reserve(trie.size());
+    for (size_t n = 0; n < trie.size(); n++) {
+        std::vector<std::pair<char, uint32_t> >& children = trie[n].children;
+        std::sort(children.begin(), children.end(),
+                  [](const std::pair<char, uint32_t>& a, const std::pair<char, uint32_t>& b) {
+                      return static_cast<unsigned char>(a.first) < static_cast<unsigned char>(b.first);
+                  });
+        edgeStart.push_back(static_cast<uint32_t>(edgeChar.size()));
+        for (const std::pair<char, uint32_t>& edge : children) {
+            edgeChar.push_back(static_cast<unsigned char>(edge.first));
+            edgeTarget.push_back(edge.second);
+        }
+        nodeTerm.push_back(trie[n].term);
+        std::vector<std::pair<char, uint32_t> >().swap(children);
+    }
+    edgeStart.push_back(static_cast<uint32_t>(edgeChar.size()));
+
+    // Subset construction, breadth first, stopping at the state cap
+    if (maxDfaStates == 0) maxDfaStates = 1;
+    std::map<NodeSet, uint32_t> stateIds;
+    std::deque<uint32_t> pending;
+
+    NodeSet start(1, ROOT_AT_BOUNDARY);
+    stateIds[start] = 0;
+    stateSets.push_back(start);
+    pending.push_back(0);
+
+    NodeSet next;
+    while (!pending.empty()) {
+        uint32_t id = pending.front();
+        pending.pop_front();
+
+        if (transitions.size() < (id + 1) * classCount) {
+            transitions.resize((id + 1) * classCount, SPILL);
+        }
+
+        for (size_t k = 0; k < classCount; k++) {
+            step(stateSets[id], k, next);
+
+            std::map<NodeSet, uint32_t>::iterator found = stateIds.find(next);
+            uint32_t nextId;
+            if (found != stateIds.end()) {
+                nextId = found->second;
+            } else if (stateSets.size() < maxDfaStates) {
+                nextId = static_cast<uint32_t>(stateSets.size());
+                stateIds[next] = nextId;
+                stateSets.push_back(next);
+                pending.push_back(nextId);
+            } else {
+                nextId = SPILL;
+            }
+            transitions[id * classCount + k] = nextId;
+        }
+    }
+
+    acceptingTerm.assign(stateSets.size(), -1);
+    for (size_t id = 0; id < stateSets.size(); id++) {
+        acceptingTerm[id] = acceptedTerm(stateSets[id]);
+    }
+}
+
+void ProfanityAutomaton::step(const NodeSet& current, size_t k, NodeSet& next) const {
+    next.clear();
+    next.push_back(classWord[k] ? ROOT_IN_WORD : ROOT_AT_BOUNDARY);
+    const unsigned char* charsBegin = classChars.data() + classCharStart[k];
+    const unsigned char* charsEnd = classChars.data() + classCharStart[k + 1];
+
+    for (size_t s = 0; s < current.size(); s++) {
+        uint32_t node;
+        if (s == 0) {
+            if (current[0] != ROOT_AT_BOUNDARY) continue;
+            node = 0;   // Words may only start after a boundary
+        } else {
+            node = current[s];
+            if (classSeparator[k]) next.push_back(node);
+        }
+
+        const unsigned char* edgesBegin = edgeChar.data() + edgeStart[node];
+        const unsigned char* edgesEnd = edgeChar.data() + edgeStart[node + 1];
+        if (edgesBegin == edgesEnd) continue;
+        for (const unsigned char* c = charsBegin; c != charsEnd; c++) {
+            const unsigned char* edge = std::lower_bound(edgesBegin, edgesEnd, *c);
+            if (edge != edgesEnd && *edge == *c) {
+                next.push_back(edgeTarget[edge - edgeChar.data()]);
+            }
+        }
+    }
+    std::sort(next.begin() + 1, next.end());
+    next.erase(std::unique(next.begin() + 1, next.end()), next.end());
+}
+
+int ProfanityAutomaton::acceptedTerm(const NodeSet& nodes) const {
+    for (size_t s = 1; s < nodes.size(); s++) {
+        if (nodeTerm[nodes[s]] >= 0) return nodeTerm[nodes[s]];
+    }
+    return -1;
+}
+
+bool ProfanityAutomaton::matches(const std::string& message, std::string* found) const {
+    return matches(message.data(), message.length(), found);
+}
+
+bool ProfanityAutomaton::matches(const char* data, size_t length, std::string* found) const {
+    uint32_t state = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char b = static_cast<unsigned char>(data[i]);
+
+        // A completed term only counts if the word ends here
+        if (acceptingTerm[state] >= 0 && !wordByte[b]) {
+            if (found) *found = terms[acceptingTerm[state]];
+            return true;
+        }
+        uint32_t next = transitions[state * classCount + byteClass[b]];
+        if (next == SPILL) {
+            return matchOnTrie(stateSets[state], data + i, length - i, found);
+        }
+        state = next;
+    }
+
+    if (acceptingTerm[state] >= 0) {
+        if (found) *found = terms[acceptingTerm[state]];
+        return true;
+    }
+    return false;
+}
+
+bool ProfanityAutomaton::matchOnTrie(const NodeSet& start, const char* data, size_t length, std::string* found) const {
+    NodeSet current(start);
+    NodeSet next;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char b = static_cast<unsigned char>(data[i]);
+        if (!wordByte[b]) {
+            int term = acceptedTerm(current);
+            if (term >= 0) {
+                if (found) *found = terms[term];
+                return true;
+            }
+        }
+        step(current, byteClass[b], next);
+        current.swap(next);
+    }
+
+    int term = acceptedTerm(current);
+    if (term >= 0) {
+        if (found) *found = terms[term];
+        return true;
+    }
+    return false;
+}
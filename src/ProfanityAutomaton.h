@@ -0,0 +1,102 @@
+/**
+ * @file ProfanityAutomaton.h
+ * @brief Table-driven DFA that finds blocked words, including obfuscated spellings
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-08
+ */
+
+#ifndef PROFANITYAUTOMATON_H
+#define PROFANITYAUTOMATON_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class ProfanityAutomaton
+ * @brief Whole-word, case-insensitive matcher for a list of blocked terms
+ *
+ * The terms go into a trie over lowercase pattern characters; matching
+ * walks the set of trie nodes the input could be at, directly on the raw
+ * message with no lowercased or normalised copies. Inside the matcher:
+ * - letters match either case and common look-alikes (0->o, 1->i/l, 3->e,
+ *   4/@->a, 5/$->s, 7/+->t, 8->b, 9->g, 2->z, !/|->i, and * for any vowel)
+ * - the separators . - _ * ~ may appear between letters ("s.h-i_t")
+ * - a match must start and end on a word boundary (no letter or digit next
+ *   to it), exactly like the old find-based scanner
+ *
+ * Bytes that behave identically are folded into classes. The node sets
+ * reached first (breadth first) are determinised into a table so common
+ * input costs one lookup per byte, but only up to maxDfaStates states:
+ * wildcards and look-alikes make the full DFA grow exponentially with
+ * the list. Input that leaves the table continues on the trie, so memory
+ * and compile time grow linearly with the terms.
+ */
+class ProfanityAutomaton {
+public:
+    static const size_t DEFAULT_MAX_DFA_STATES = 4096;
+
+private:
+    typedef std::vector<uint32_t> NodeSet;   // Root marker, then sorted trie nodes
+
+    std::vector<std::string> terms;      // Original terms, indexed by nodeTerm
+    unsigned char byteClass[256];        // Byte -> equivalence class
+    bool wordByte[256];                  // Letters and digits (word boundary test)
+    size_t classCount;
+    std::vector<unsigned char> classWord;        // Class is a letter/digit
+    std::vector<unsigned char> classSeparator;   // Class is a skippable separator
+    std::vector<uint32_t> classCharStart;        // classCount + 1 offsets into classChars
+    std::vector<unsigned char> classChars;       // Pattern characters each class stands for
+
+    // Trie, flattened: node n's edges are [edgeStart[n], edgeStart[n + 1]), sorted by char
+    std::vector<uint32_t> edgeStart;
+    std::vector<unsigned char> edgeChar;
+    std::vector<uint32_t> edgeTarget;
+    std::vector<int> nodeTerm;           // Term ending at each node, -1 if none
+
+    std::vector<uint32_t> transitions;   // stateCount x classCount; SPILL past the cap
+    std::vector<int> acceptingTerm;      // Term completed in each state, -1 if none
+    std::vector<NodeSet> stateSets;      // Node set of each state, to continue on the trie
+
+    void step(const NodeSet& current, size_t k, NodeSet& next) const;
+    int acceptedTerm(const NodeSet& nodes) const;
+    bool matchOnTrie(const NodeSet& start, const char* data, size_t length, std::string* found) const;
+
+public:
+    /**
+     * @brief Build an automaton that matches nothing
+     */
+    ProfanityAutomaton();
+
+    /**
+     * @brief Compile a list of terms
+     * @param blockedTerms Raw terms as read from a list file
+     * @param maxDfaStates Most table states to build; the rest is matched on the trie
+     */
+    explicit ProfanityAutomaton(const std::vector<std::string>& blockedTerms,
+                                size_t maxDfaStates = DEFAULT_MAX_DFA_STATES);
+
+    /**
+     * @brief Find the first blocked term in a message
+     * @param message Message to scan
+     * @param found Set to the matched term when one is found (may be nullptr)
+     * @return true if a blocked term appears as a whole word
+     */
+    bool matches(const std::string& message, std::string* found) const;
+
+    /**
+     * @brief Find the first blocked term in a byte range
+     * @param data First byte
+     * @param length Number of bytes
+     * @param found Set to the matched term when one is found (may be nullptr)
+     * @return true if a blocked term appears as a whole word
+     */
+    bool matches(const char* data, size_t length, std::string* found) const;
+
+    size_t size() const { return terms.size(); }
+    size_t getStateCount() const { return acceptingTerm.size(); }
+    size_t getClassCount() const { return classCount; }
+    size_t getNodeCount() const { return nodeTerm.size(); }
+};
+
+#endif // PROFANITYAUTOMATON_H
@@ -0,0 +1,161 @@
+/**
+ * @file RateLimiter.cpp
+ * @brief Implementation of RateLimiter
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-09
+ */
+
+#include "RateLimiter.h"
+#include "Users.h"
+#include <chrono>
+
+namespace {
+
+uint64_t steadyClockMillis() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Milliseconds between tokens
+uint64_t emissionInterval(const RateLimitPolicy& policy) {
+    uint64_t interval = policy.refillPeriodMillis / policy.capacity;
+    return interval ? interval : 1;
+}
+
+const uint64_t DAY_MILLIS = 24ULL * 60 * 60 * 1000;
+
+// Quota events only need coarse timing
+const uint64_t EVENT_TICK_MILLIS = 100;
+
+// Frees the event wheel at exit
+struct EventWheelCleanup {
+    ~EventWheelCleanup() { RateLimiter::setClock(nullptr); }
+};
+
+} // namespace
+
+// Free users get 10 messages a day; other types are unlimited by default
+RateLimitPolicy RateLimiter::policies[3] = {
+    {10, DAY_MILLIS},   // FREE
+    {0, 0},             // PREMIUM
+    {0, 0}              // ADMIN
+};
+uint64_t (*RateLimiter::clock)() = steadyClockMillis;
+std::recursive_mutex RateLimiter::eventMutex;
+TimingWheel* RateLimiter::events = nullptr;
+
+namespace {
+EventWheelCleanup eventWheelCleanup;
+}
+
+void RateLimiter::setPolicy(UserType type, RateLimitPolicy policy) {
+    policies[static_cast<int>(type)] = policy;
+}
+
+RateLimitPolicy RateLimiter::getPolicy(UserType type) {
+    return policies[static_cast<int>(type)];
+}
+
+bool RateLimiter::canConsume(const TokenBucket& bucket, UserType type) {
+    return millisUntilAvailable(bucket, type) == 0;
+}
+
+bool RateLimiter::tryConsume(TokenBucket& bucket, UserType type) {
+    const RateLimitPolicy& policy = policies[static_cast<int>(type)];
+    if (policy.capacity == 0) {
+        return true;
+    }
+
+    uint64_t current = now();
+    uint64_t interval = emissionInterval(policy);
+    uint64_t start = bucket.fullAt > current ? bucket.fullAt : current;
+
+    // Allowed while at most capacity - 1 tokens are missing
+    if (start - current > (policy.capacity - 1) * interval) {
+        return false;
+    }
+
+    bucket.fullAt = start + interval;
+    return true;
+}
+
+void RateLimiter::refund(TokenBucket& bucket, UserType type) {
+    const RateLimitPolicy& policy = policies[static_cast<int>(type)];
+    if (policy.capacity == 0) {
+        return;
+    }
+    uint64_t interval = emissionInterval(policy);
+    bucket.fullAt = bucket.fullAt > interval ? bucket.fullAt - interval : 0;
+}
+
+uint32_t RateLimiter::getRemaining(const TokenBucket& bucket, UserType type) {
+    const RateLimitPolicy& policy = policies[static_cast<int>(type)];
+    if (policy.capacity == 0) {
+        return 0xFFFFFFFFu;
+    }
+
+    uint64_t current = now();
+    if (bucket.fullAt <= current) {
+        return policy.capacity;
+    }
+
+    uint64_t interval = emissionInterval(policy);
+    uint64_t missing = (bucket.fullAt - current + interval - 1) / interval;
+    return missing >= policy.capacity ? 0 : static_cast<uint32_t>(policy.capacity - missing);
+}
+
+uint64_t RateLimiter::millisUntilAvailable(const TokenBucket& bucket, UserType type) {
+    const RateLimitPolicy& policy = policies[static_cast<int>(type)];
+    if (policy.capacity == 0) {
+        return 0;
+    }
+
+    uint64_t current = now();
+    if (bucket.fullAt <= current) {
+        return 0;
+    }
+
+    uint64_t debt = bucket.fullAt - current;
+    uint64_t allowance = (policy.capacity - 1) * emissionInterval(policy);
+    return debt > allowance ? debt - allowance : 0;
+}
+
+void RateLimiter::setClock(uint64_t (*source)()) {
+    std::lock_guard<std::recursive_mutex> lock(eventMutex);
+    clock = source ? source : steadyClockMillis;
+
+    // Pending events were timed against the old clock
+    delete events;
+    events = nullptr;
+}
+
+TimingWheel& RateLimiter::wheel() {
+    if (!events) {
+        events = new TimingWheel(EVENT_TICK_MILLIS, now());
+    }
+    return *events;
+}
+
+uint64_t RateLimiter::scheduleEvent(uint64_t delayMillis, std::function<void()> callback) {
+    std::lock_guard<std::recursive_mutex> lock(eventMutex);
+    // Measure the delay from now, not from wherever the wheel last stopped
+    TimingWheel& timingWheel = wheel();
+    uint64_t current = now();
+    uint64_t lag = current > timingWheel.getCurrentMillis() ? current - timingWheel.getCurrentMillis() : 0;
+    return timingWheel.schedule(delayMillis + lag, callback);
+}
+
+bool RateLimiter::cancelEvent(uint64_t timerId) {
+    std::lock_guard<std::recursive_mutex> lock(eventMutex);
+    return events && events->cancel(timerId);
+}
+
+size_t RateLimiter::processEvents() {
+    std::lock_guard<std::recursive_mutex> lock(eventMutex);
+    return wheel().advanceTo(now());
+}
+
+size_t RateLimiter::getPendingEventCount() {
+    std::lock_guard<std::recursive_mutex> lock(eventMutex);
+    return events ? events->getPendingCount() : 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file RateLimiter.h
+ * @brief Lazy per-user token buckets with per-UserType limits
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-09
+ */
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include "TimingWheel.h"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+enum class UserType;
+
+/**
+ * @brief Limit applied to every user of one UserType
+ */
+struct RateLimitPolicy {
+    uint32_t capacity;            ///< Burst size in messages, 0 for unlimited
+    uint64_t refillPeriodMillis;  ///< Time to refill an empty bucket completely
+};
+
+/**
+ * @brief Per-user quota state (8 bytes)
+ *
+ * Stored GCRA-style as the time the bucket will next be full, which is
+ * equivalent to a token count plus last-refill time but needs one field.
+ * Refills happen implicitly when the bucket is read, so there is no
+ * periodic reset sweep over all users.
+ */
+struct TokenBucket {
+    uint64_t fullAt;   ///< Clock reading (ms) at which all tokens are back
+
+    TokenBucket() : fullAt(0) {}
+};
+
+/**
+ * @class RateLimiter
+ * @brief Applies RateLimitPolicy to TokenBuckets and runs quota events
+ *
+ * Buckets are refilled from a monotonic millisecond clock on access. Events
+ * that must fire on their own (for example telling a user their quota is
+ * back) go on a hierarchical TimingWheel that the host turns with
+ * processEvents().
+ */
+class RateLimiter {
+private:
+    static RateLimitPolicy policies[3];
+    static uint64_t (*clock)();
+    static std::recursive_mutex eventMutex;   // Callbacks may schedule events
+    static TimingWheel* events;
+
+    static TimingWheel& wheel();
+
+public:
+    /**
+     * @brief Set the limit for one user type
+     * @param type User type to configure
+     * @param policy New limit (capacity 0 disables limiting)
+     */
+    static void setPolicy(UserType type, RateLimitPolicy policy);
+    static RateLimitPolicy getPolicy(UserType type);
+    static bool isLimited(UserType type) { return getPolicy(type).capacity != 0; }
+
+    /**
+     * @brief Check for a token without taking it
+     * @return true if a message may be sent now
+     */
+    static bool canConsume(const TokenBucket& bucket, UserType type);
+
+    /**
+     * @brief Take one token if available
+     * @return true if the token was taken
+     */
+    static bool tryConsume(TokenBucket& bucket, UserType type);
+
+    /**
+     * @brief Give back a token taken by tryConsume, e.g. when the send it paid for was refused later
+     */
+    static void refund(TokenBucket& bucket, UserType type);
+
+    /**
+     * @brief Tokens currently available (capacity when unlimited)
+     */
+    static uint32_t getRemaining(const TokenBucket& bucket, UserType type);
+
+    /**
+     * @brief Milliseconds until the next token is available, 0 if one is now
+     */
+    static uint64_t millisUntilAvailable(const TokenBucket& bucket, UserType type);
+
+    /**
+     * @brief Refill a bucket completely (manual reset)
+     */
+    static void refill(TokenBucket& bucket) { bucket.fullAt = 0; }
+
+    /**
+     * @brief Current monotonic clock reading in milliseconds
+     */
+    static uint64_t now() { return clock(); }
+
+    /**
+     * @brief Replace the clock (tests and simulations)
+     * @param source Function returning monotonic milliseconds, nullptr for the steady clock
+     */
+    static void setClock(uint64_t (*source)());
+
+    /**
+     * @brief Schedule a quota event on the timing wheel
+     * @param delayMillis Delay from now
+     * @param callback Work to run from processEvents()
+     * @return Timer id for cancelEvent()
+     */
+    static uint64_t scheduleEvent(uint64_t delayMillis, std::function<void()> callback);
+    static bool cancelEvent(uint64_t timerId);
+
+    /**
+     * @brief Run every event that is due by now()
+     * @return Number of events run
+     */
+    static size_t processEvents();
+
+    static size_t getPendingEventCount();
+};
+
+#endif // RATELIMITER_H
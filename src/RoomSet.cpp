@@ -0,0 +1,152 @@
+/**
+ * @file RoomSet.cpp
+ * @brief Implementation of RoomSet
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#include "RoomSet.h"
+
+namespace {
+
+const uint32_t FIRST_TABLE_SLOTS = 16;
+
+} // namespace
+
+RoomSet::RoomSet() : count(0), capacity(0) {
+    for (uint32_t i = 0; i < INLINE_ROOMS; i++) {
+        inlineRooms[i] = nullptr;
+    }
+}
+
+RoomSet::~RoomSet() {
+    if (capacity) {
+        delete[] slots;
+    }
+}
+
+bool RoomSet::hashedContains(const ChatRoom* room) const {
+    uint32_t mask = capacity - 1;
+    for (uint32_t i = hash(room, mask);; i = (i + 1) & mask) {
+        if (slots[i] == room) {
+            return true;
+        }
+        if (!slots[i]) {
+            return false;
+        }
+    }
+}
+
+void RoomSet::insertHashed(ChatRoom* room) {
+    uint32_t mask = capacity - 1;
+    uint32_t i = hash(room, mask);
+    while (slots[i]) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = room;
+}
+
+void RoomSet::rehash(uint32_t newCapacity) {
+    ChatRoom* moving[INLINE_ROOMS];
+    ChatRoom** oldSlots = nullptr;
+    uint32_t oldCapacity = capacity;
+    uint32_t oldCount = count;
+    if (capacity == 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            moving[i] = inlineRooms[i];
+        }
+    } else {
+        oldSlots = slots;
+    }
+
+    if (newCapacity == 0) {
+        // Back to inline; the caller has checked that the rooms fit
+        count = 0;
+        capacity = 0;
+        for (uint32_t i = 0; i < oldCapacity; i++) {
+            if (oldSlots[i]) {
+                inlineRooms[count++] = oldSlots[i];
+            }
+        }
+        delete[] oldSlots;
+        return;
+    }
+
+    slots = new ChatRoom*[newCapacity]();
+    capacity = newCapacity;
+    if (oldSlots) {
+        for (uint32_t i = 0; i < oldCapacity; i++) {
+            if (oldSlots[i]) {
+                insertHashed(oldSlots[i]);
+            }
+        }
+        delete[] oldSlots;
+    } else {
+        for (uint32_t i = 0; i < oldCount; i++) {
+            insertHashed(moving[i]);
+        }
+    }
+}
+
+bool RoomSet::insert(ChatRoom* room) {
+    if (contains(room)) {
+        return false;
+    }
+
+    if (capacity == 0) {
+        if (count < INLINE_ROOMS) {
+            inlineRooms[count++] = room;
+            return true;
+        }
+        rehash(FIRST_TABLE_SLOTS);
+    } else if ((count + 1) * 2 > capacity) {
+        rehash(capacity * 2);
+    }
+    insertHashed(room);
+    count++;
+    return true;
+}
+
+bool RoomSet::erase(ChatRoom* room) {
+    if (capacity == 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (inlineRooms[i] == room) {
+                for (uint32_t j = i + 1; j < count; j++) {   // Keep insertion order
+                    inlineRooms[j - 1] = inlineRooms[j];
+                }
+                inlineRooms[--count] = nullptr;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t mask = capacity - 1;
+    uint32_t hole = hash(room, mask);
+    for (;; hole = (hole + 1) & mask) {
+        if (!slots[hole]) {
+            return false;
+        }
+        if (slots[hole] == room) {
+            break;
+        }
+    }
+
+    // Pull later entries of the probe run back into the hole, unless their
+    // home slot lies after the hole (they would then become unreachable)
+    for (uint32_t next = (hole + 1) & mask; slots[next]; next = (next + 1) & mask) {
+        uint32_t home = hash(slots[next], mask);
+        bool staysPut = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!staysPut) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+    }
+    slots[hole] = nullptr;
+    count--;
+
+    if (count < INLINE_ROOMS) {
+        rehash(0);   // Below the inline size (not at it) so a user hovering there does not flip back and forth
+    }
+    return true;
+}
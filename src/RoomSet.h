@@ -0,0 +1,108 @@
+/**
+ * @file RoomSet.h
+ * @brief Set of the chat rooms a user belongs to, sized to how many there are
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef ROOMSET_H
+#define ROOMSET_H
+
+#include <cstddef>
+#include <cstdint>
+
+class ChatRoom;
+
+/**
+ * @class RoomSet
+ * @brief Membership set with O(1) contains() at any size
+ *
+ * Most users are in one to three rooms, so up to INLINE_ROOMS rooms are
+ * kept in the object itself (32 bytes, no heap allocation) and checked
+ * with a short scan. Past that the set switches to an open-addressing
+ * linear-probing hash table of room pointers, kept at most half full
+ * and without tombstones (erase shifts later entries back), so bots in
+ * thousands of rooms still check membership in constant time. It
+ * switches back once the user is down to a couple of rooms.
+ *
+ * Iteration order is insertion order while inline and unspecified after.
+ */
+class RoomSet {
+public:
+    static const uint32_t INLINE_ROOMS = 3;
+
+private:
+    uint32_t count;
+    uint32_t capacity;   // Hash slots (a power of two), 0 while inline
+    union {
+        ChatRoom* inlineRooms[INLINE_ROOMS];
+        ChatRoom** slots;
+    };
+
+    static uint32_t hash(const ChatRoom* room, uint32_t mask) {
+        uint64_t bits = reinterpret_cast<uintptr_t>(room) >> 4;   // Rooms are at least 16-byte aligned
+        return static_cast<uint32_t>((bits * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    }
+
+    bool hashedContains(const ChatRoom* room) const;
+    void rehash(uint32_t newCapacity);
+    void insertHashed(ChatRoom* room);
+
+    RoomSet(const RoomSet&);
+    RoomSet& operator=(const RoomSet&);
+
+public:
+    RoomSet();
+    ~RoomSet();
+
+    /**
+     * @return true if added, false if the room was already there
+     */
+    bool insert(ChatRoom* room);
+
+    /**
+     * @return true if removed, false if the room was not there
+     */
+    bool erase(ChatRoom* room);
+
+    bool contains(const ChatRoom* room) const {
+        if (capacity == 0) {
+            for (uint32_t i = 0; i < count; i++) {
+                if (inlineRooms[i] == room) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        return hashedContains(room);
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool isInline() const { return capacity == 0; }
+
+    /**
+     * @brief Bytes used on the heap (0 while inline)
+     */
+    std::size_t heapBytes() const { return capacity * sizeof(ChatRoom*); }
+
+    /**
+     * @brief Call visitor(ChatRoom*) for every room
+     */
+    template <typename Visitor>
+    void forEach(Visitor& visitor) const {
+        if (capacity == 0) {
+            for (uint32_t i = 0; i < count; i++) {
+                visitor(inlineRooms[i]);
+            }
+            return;
+        }
+        for (uint32_t i = 0; i < capacity; i++) {
+            if (slots[i]) {
+                visitor(slots[i]);
+            }
+        }
+    }
+};
+
+#endif // ROOMSET_H
@@ -14,13 +14,13 @@
 SaveMessageCommand::SaveMessageCommand(ChatRoom* room, User* user, std::string msg)
     : Command(room, user, msg) {
     
-    Logger::debug("[SaveMessageCommand] Created for message: \"" + msg + "\"");
+    LOG_EVENT(COMMAND, DEBUG, SAVE_COMMAND_CREATED, msg);
 }
 
 void SaveMessageCommand::execute() {
-    Logger::debug("[SaveMessageCommand] Executing - saving message to history");
+    LOG_EVENT(COMMAND, DEBUG, SAVE_EXECUTING);
     
     chatRoom->saveMessage(message, fromUser);
     
-    Logger::debug("[SaveMessageCommand] Message saved to history");
+    LOG_EVENT(COMMAND, DEBUG, SAVE_COMPLETED);
 }
\ No newline at end of file
@@ -14,13 +14,13 @@
 SendMessageCommand::SendMessageCommand(ChatRoom* room, User* user, std::string msg)
     : Command(room, user, msg) {
     
-    Logger::debug("[SendMessageCommand] Created for user: " + user->getName());
+    LOG_EVENT(COMMAND, DEBUG, SEND_COMMAND_CREATED, user->getLogName());
 }
 
 void SendMessageCommand::execute() {
-    Logger::debug("[SendMessageCommand] Executing - sending message to all users");
+    LOG_EVENT(COMMAND, DEBUG, SEND_EXECUTING);
    
     chatRoom->sendMessage(message, fromUser);
     
-    Logger::debug("[SendMessageCommand] Message delivery completed");
+    LOG_EVENT(COMMAND, DEBUG, SEND_COMPLETED);
 }
\ No newline at end of file
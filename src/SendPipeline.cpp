@@ -0,0 +1,191 @@
+/**
+ * @file SendPipeline.cpp
+ * @brief Implementation of SendPipeline
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-15
+ */
+
+#include "SendPipeline.h"
+#include "ChatRoom.h"
+#include "Logger.h"
+#include "Users.h"
+#include <chrono>
+
+namespace {
+
+thread_local SendPipeline* currentValidator = nullptr;
+
+uint64_t steadyNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+SendPipeline::SendPipeline(size_t queueCapacity)
+    : validateQueue(queueCapacity), broadcastQueue(queueCapacity), persistQueue(queueCapacity),
+      stopping(false), submitted(0), completed(0), rejected(0), forwardedCurrent(false) {
+    for (int i = 0; i < static_cast<int>(PipelineStage::COUNT); i++) {
+        stages[i].sleeping.store(false);
+        stages[i].processed.store(0);
+        stages[i].serviceNanos.store(0);
+        stages[i].maxDepth.store(0);
+    }
+
+    stages[static_cast<int>(PipelineStage::VALIDATE)].thread = std::thread(&SendPipeline::validateLoop, this);
+    stages[static_cast<int>(PipelineStage::BROADCAST)].thread = std::thread(&SendPipeline::broadcastLoop, this);
+    stages[static_cast<int>(PipelineStage::PERSIST)].thread = std::thread(&SendPipeline::persistLoop, this);
+}
+
+SendPipeline::~SendPipeline() {
+    drain();
+    stopping.store(true);
+    for (int i = 0; i < static_cast<int>(PipelineStage::COUNT); i++) {
+        wakeStage(stages[i]);
+        stages[i].thread.join();
+    }
+}
+
+SendPipeline* SendPipeline::validatingPipeline() {
+    return currentValidator;
+}
+
+void SendPipeline::wakeStage(StageState& stage) {
+    if (stage.sleeping.load()) {
+        std::lock_guard<std::mutex> lock(stage.mutex);
+        stage.wake.notify_one();
+    }
+}
+
+template <typename Queue>
+bool SendPipeline::popOrWait(StageState& stage, Queue& queue, Message& message) {
+    for (;;) {
+        if (queue.tryPop(message)) {
+            return true;
+        }
+        if (stopping.load()) {
+            return queue.tryPop(message);   // Upstream is drained before stopping is set
+        }
+
+        std::unique_lock<std::mutex> lock(stage.mutex);
+        stage.sleeping.store(true);
+        if (queue.size() == 0 && !stopping.load()) {
+            // The timeout bounds latency if a producer's wakeup is missed
+            stage.wake.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        stage.sleeping.store(false);
+    }
+}
+
+template <typename Queue>
+void SendPipeline::pushTo(StageState& stage, Queue& queue, Message& message) {
+    while (!queue.tryPush(message)) {
+        wakeStage(stage);
+        std::this_thread::yield();
+    }
+
+    size_t depth = queue.size();
+    size_t deepest = stage.maxDepth.load(std::memory_order_relaxed);
+    while (depth > deepest && !stage.maxDepth.compare_exchange_weak(deepest, depth, std::memory_order_relaxed)) {
+    }
+    wakeStage(stage);
+}
+
+void SendPipeline::submit(User* user, ChatRoom* room, std::string message) {
+    Message item;
+    item.user = user;
+    item.room = room;
+    item.text.swap(message);
+    submitted.fetch_add(1);
+    pushTo(stages[static_cast<int>(PipelineStage::VALIDATE)], validateQueue, item);
+}
+
+void SendPipeline::forward(User* user, ChatRoom* room, std::string message) {
+    Message item;
+    item.user = user;
+    item.room = room;
+    item.text.swap(message);
+    forwardedCurrent = true;
+    pushTo(stages[static_cast<int>(PipelineStage::BROADCAST)], broadcastQueue, item);
+}
+
+void SendPipeline::finishMessage() {
+    if (completed.fetch_add(1) + 1 == submitted.load()) {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        drained.notify_all();
+    }
+}
+
+void SendPipeline::drain() {
+    // The validate stage may still be finishing its bookkeeping for a message another stage completed
+    const StageState& validator = stages[static_cast<int>(PipelineStage::VALIDATE)];
+    std::unique_lock<std::mutex> lock(drainMutex);
+    while (completed.load() < submitted.load() || validator.processed.load() < submitted.load()) {
+        drained.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+void SendPipeline::validateLoop() {
+    currentValidator = this;
+    StageState& stage = stages[static_cast<int>(PipelineStage::VALIDATE)];
+    Message message;
+
+    while (popOrWait(stage, validateQueue, message)) {
+        uint64_t start = steadyNanos();
+        forwardedCurrent = false;
+        bool accepted = message.user->send(message.text, message.room);
+        stage.serviceNanos.fetch_add(steadyNanos() - start, std::memory_order_relaxed);
+        stage.processed.fetch_add(1);
+        if (!forwardedCurrent) {
+            if (!accepted) {
+                rejected.fetch_add(1);
+            }
+            finishMessage();   // Nothing for the later stages to do
+        }
+    }
+    currentValidator = nullptr;
+}
+
+void SendPipeline::broadcastLoop() {
+    StageState& stage = stages[static_cast<int>(PipelineStage::BROADCAST)];
+    Message message;
+
+    while (popOrWait(stage, broadcastQueue, message)) {
+        uint64_t start = steadyNanos();
+        message.room->sendMessage(message.text, message.user);
+        stage.serviceNanos.fetch_add(steadyNanos() - start, std::memory_order_relaxed);
+        stage.processed.fetch_add(1, std::memory_order_relaxed);
+
+        pushTo(stages[static_cast<int>(PipelineStage::PERSIST)], persistQueue, message);
+    }
+}
+
+void SendPipeline::persistLoop() {
+    StageState& stage = stages[static_cast<int>(PipelineStage::PERSIST)];
+    Message message;
+
+    while (popOrWait(stage, persistQueue, message)) {
+        uint64_t start = steadyNanos();
+        message.room->saveMessage(message.text, message.user);
+        stage.serviceNanos.fetch_add(steadyNanos() - start, std::memory_order_relaxed);
+        stage.processed.fetch_add(1);
+        finishMessage();
+    }
+}
+
+SendPipelineStats SendPipeline::getStats() const {
+    SendPipelineStats stats;
+    for (int i = 0; i < static_cast<int>(PipelineStage::COUNT); i++) {
+        const StageState& stage = stages[i];
+        PipelineStageStats& out = stats.stages[i];
+        out.processed = stage.processed.load();
+        out.maxQueueDepth = stage.maxDepth.load();
+        out.meanServiceMicros = out.processed ? stage.serviceNanos.load() / 1000.0 / out.processed : 0.0;
+    }
+    stats.stages[static_cast<int>(PipelineStage::VALIDATE)].queueDepth = validateQueue.size();
+    stats.stages[static_cast<int>(PipelineStage::BROADCAST)].queueDepth = broadcastQueue.size();
+    stats.stages[static_cast<int>(PipelineStage::PERSIST)].queueDepth = persistQueue.size();
+    stats.submitted = submitted.load();
+    stats.rejected = rejected.load();
+    return stats;
+}
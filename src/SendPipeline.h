@@ -0,0 +1,158 @@
+/**
+ * @file SendPipeline.h
+ * @brief Staged send path: validate, persist and broadcast on separate threads
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-15
+ */
+
+#ifndef SENDPIPELINE_H
+#define SENDPIPELINE_H
+
+#include "StageQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class ChatRoom;
+class User;
+
+enum class PipelineStage {
+    VALIDATE,    ///< User::send checks: quota, membership, validation strategy
+    BROADCAST,   ///< ChatRoom::sendMessage fan-out
+    PERSIST,     ///< ChatRoom::saveMessage
+    COUNT
+};
+
+/**
+ * @brief Snapshot of one stage
+ */
+struct PipelineStageStats {
+    size_t queueDepth;            ///< Messages waiting for the stage now
+    size_t maxQueueDepth;         ///< Deepest the queue has been
+    unsigned long processed;      ///< Messages the stage has handled
+    double meanServiceMicros;     ///< Average time the stage spent per message
+};
+
+/**
+ * @brief Snapshot of the whole pipeline
+ */
+struct SendPipelineStats {
+    PipelineStageStats stages[static_cast<int>(PipelineStage::COUNT)];
+    unsigned long submitted;
+    unsigned long rejected;       ///< Turned away by the validate stage
+};
+
+/**
+ * @class SendPipeline
+ * @brief Runs a burst of sends as an assembly line across three threads
+ *
+ * submit() puts a message on a bounded multi-producer queue. The validate
+ * stage calls the sender's own send(), so every user type keeps its rules
+ * and log lines; when send() reaches performSend() on this stage the
+ * message is forwarded to the broadcast stage and then the persist stage
+ * over single-producer queues instead of being executed in place. Each
+ * stage is FIFO, so messages reach every room's members and history in
+ * submission order, as on the serial path.
+ *
+ * Broadcast comes before persist, as on the serial path, so a member who
+ * goes offline between the two stages is never skipped: the message is
+ * saved past their read watermark and replayed on reconnect, even if it was
+ * also pushed live (at least once). One who comes back online between the
+ * stages is replayed only what has been saved so far; both paths share
+ * that window.
+ *
+ * Full queues apply backpressure to the stage (or submitter) feeding them.
+ * Room membership must not change while messages are in flight.
+ */
+class SendPipeline {
+private:
+    struct Message {
+        User* user;
+        ChatRoom* room;
+        std::string text;
+
+        Message() : user(nullptr), room(nullptr) {}
+    };
+
+    struct StageState {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::atomic<bool> sleeping;
+        std::atomic<unsigned long> processed;
+        std::atomic<unsigned long> serviceNanos;
+        std::atomic<size_t> maxDepth;
+    };
+
+    MpscQueue<Message> validateQueue;
+    SpscQueue<Message> broadcastQueue;
+    SpscQueue<Message> persistQueue;
+    StageState stages[static_cast<int>(PipelineStage::COUNT)];
+
+    std::atomic<bool> stopping;
+    std::atomic<unsigned long> submitted;
+    std::atomic<unsigned long> completed;   // Persisted or turned away
+    std::atomic<unsigned long> rejected;
+    bool forwardedCurrent;                  // Validate stage only: send() reached forward()
+
+    std::mutex drainMutex;
+    std::condition_variable drained;
+
+    void validateLoop();
+    void broadcastLoop();
+    void persistLoop();
+    void finishMessage();
+    void wakeStage(StageState& stage);
+
+    template <typename Queue>
+    bool popOrWait(StageState& stage, Queue& queue, Message& message);
+
+    template <typename Queue>
+    void pushTo(StageState& stage, Queue& queue, Message& message);
+
+    SendPipeline(const SendPipeline&);
+    SendPipeline& operator=(const SendPipeline&);
+
+public:
+    /**
+     * @brief Start the three stage threads
+     * @param queueCapacity Messages each queue holds, rounded up to a power of two
+     */
+    explicit SendPipeline(size_t queueCapacity = 1024);
+
+    /**
+     * @brief Finish every submitted message, then stop the stages
+     */
+    ~SendPipeline();
+
+    /**
+     * @brief Queue a message from @p user to @p room (any thread)
+     *
+     * Blocks while the validate queue is full.
+     */
+    void submit(User* user, ChatRoom* room, std::string message);
+
+    /**
+     * @brief Block until every message submitted so far has been broadcast and saved, or rejected
+     */
+    void drain();
+
+    SendPipelineStats getStats() const;
+
+    /**
+     * @brief Hand an accepted message to the broadcast stage (validate stage only)
+     *
+     * Called by User::performSend when it runs on this pipeline's validate stage.
+     */
+    void forward(User* user, ChatRoom* room, std::string message);
+
+    /**
+     * @brief The pipeline whose validate stage is the calling thread, or nullptr
+     */
+    static SendPipeline* validatingPipeline();
+};
+
+#endif // SENDPIPELINE_H
@@ -0,0 +1,175 @@
+/**
+ * @file ShardProtocol.cpp
+ * @brief Implementation of ShardFrame, ShardFrameReader and ShardProtocol
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#include "ShardProtocol.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t LENGTH_BYTES = 4;
+
+bool fillAddress(const std::string& socketPath, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return true;
+}
+
+bool readAll(int fd, char* out, size_t length) {
+    while (length > 0) {
+        ssize_t got = ::read(fd, out, length);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        out += got;
+        length -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+} // namespace
+
+ShardFrame::ShardFrame(ShardMessage type) : bytes(LENGTH_BYTES, '\0') {
+    bytes += static_cast<char>(type);
+}
+
+void ShardFrame::reset(ShardMessage type) {
+    bytes.assign(LENGTH_BYTES, '\0');
+    bytes += static_cast<char>(type);
+}
+
+ShardFrame& ShardFrame::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        bytes += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    bytes += static_cast<char>(value);
+    return *this;
+}
+
+ShardFrame& ShardFrame::putString(StringRef text) {
+    putVarint(text.size);
+    bytes.append(text.data, text.size);
+    return *this;
+}
+
+const std::string& ShardFrame::data() {
+    uint32_t length = static_cast<uint32_t>(bytes.size() - LENGTH_BYTES);
+    for (size_t i = 0; i < LENGTH_BYTES; i++) {
+        bytes[i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+    }
+    return bytes;
+}
+
+ShardFrameReader::ShardFrameReader(const std::string& body) : body(body), offset(1), valid(!body.empty()) {}
+
+ShardMessage ShardFrameReader::getType() const {
+    return body.empty() ? ShardMessage::STATUS : static_cast<ShardMessage>(static_cast<uint8_t>(body[0]));
+}
+
+bool ShardFrameReader::getVarint(uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; valid && shift < 64; shift += 7) {
+        if (offset >= body.size()) {
+            break;
+        }
+        uint8_t byte = static_cast<uint8_t>(body[offset++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    valid = false;
+    return false;
+}
+
+bool ShardFrameReader::getString(std::string& text) {
+    uint64_t length;
+    if (!getVarint(length) || length > body.size() - offset) {
+        valid = false;
+        return false;
+    }
+    text.assign(body, offset, static_cast<size_t>(length));
+    offset += static_cast<size_t>(length);
+    return true;
+}
+
+bool ShardProtocol::writeFrame(int fd, ShardFrame& frame) {
+    const std::string& bytes = frame.data();
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        // MSG_NOSIGNAL: a vanished peer is an error return, not SIGPIPE
+        ssize_t sent = ::send(fd, bytes.data() + offset, bytes.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool ShardProtocol::readFrame(int fd, std::string& body) {
+    unsigned char header[LENGTH_BYTES];
+    if (!readAll(fd, reinterpret_cast<char*>(header), LENGTH_BYTES)) {
+        return false;
+    }
+    uint32_t length = 0;
+    for (size_t i = 0; i < LENGTH_BYTES; i++) {
+        length |= static_cast<uint32_t>(header[i]) << (8 * i);
+    }
+    if (length == 0 || length > MAX_FRAME_BYTES) {
+        return false;
+    }
+    body.resize(length);
+    return readAll(fd, &body[0], length);
+}
+
+int ShardProtocol::listenAt(const std::string& socketPath) {
+    sockaddr_un address;
+    if (!fillAddress(socketPath, address)) {
+        return -1;
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    ::unlink(socketPath.c_str());   // Left behind by a worker that did not shut down cleanly
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 16) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int ShardProtocol::connectTo(const std::string& socketPath) {
+    sockaddr_un address;
+    if (!fillAddress(socketPath, address)) {
+        return -1;
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file ShardProtocol.h
+ * @brief Binary framing and Unix socket helpers shared by ShardRouter and ShardWorker
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef SHARDPROTOCOL_H
+#define SHARDPROTOCOL_H
+
+#include "StringInterner.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Frame types; replies have the high bit set
+ *
+ * Request fields (varints and length-prefixed strings, in order):
+ *   JOIN            user, user type, room, room kind   -> STATUS (1 if newly joined)
+ *   LEAVE           user, room                          -> STATUS (1 if was a member)
+ *   SEND            user, room, message                 -> STATUS (1 if sent)
+ *   EXPORT_ROOM     room, first line, byte budget       -> HISTORY (total lines, line count, lines)
+ *   IMPORT_ROOM     room, room kind, member count, (user, user type)...
+ *                                                       -> STATUS (1 once created, empty)
+ *   APPEND_HISTORY  room, line count, lines             -> STATUS (1 if the room exists)
+ *   DROP_ROOM       room                                -> STATUS (1 if the room existed)
+ *   ROOM_INFO       room                                -> INFO (exists, members, history size)
+ *
+ * Moving a room is copy-then-delete: IMPORT_ROOM on the new shard, then
+ * EXPORT_ROOM pages from the old shard re-sent as APPEND_HISTORY, and only
+ * once every page is acknowledged DROP_ROOM on the old shard. EXPORT_ROOM
+ * only reads; it returns at least one line and stops adding lines once
+ * the budget (capped at HISTORY_PAGE_BYTES) is used. IMPORT_ROOM replaces
+ * any copy left behind by an earlier move.
+ */
+enum class ShardMessage : uint8_t {
+    JOIN = 1,
+    LEAVE = 2,
+    SEND = 3,
+    EXPORT_ROOM = 4,
+    IMPORT_ROOM = 5,
+    ROOM_INFO = 6,
+    APPEND_HISTORY = 7,
+    DROP_ROOM = 8,
+    STATUS = 0x81,
+    HISTORY = 0x82,
+    INFO = 0x83
+};
+
+/**
+ * @brief Concrete mediator a shard creates for a room it has not seen yet
+ */
+enum class ShardRoomKind : uint8_t {
+    CTRLCAT = 0,
+    DOGORITHM = 1
+};
+
+/**
+ * @class ShardFrame
+ * @brief Builds one frame: [u32 little-endian length][u8 type][fields]
+ *
+ * The length counts everything after itself. Integers are LEB128 varints
+ * and strings are a varint length followed by the bytes, so a typical
+ * send is its text plus about a dozen bytes.
+ */
+class ShardFrame {
+private:
+    std::string bytes;
+
+public:
+    explicit ShardFrame(ShardMessage type);
+
+    /**
+     * @brief Start a new frame, keeping the buffer's capacity
+     */
+    void reset(ShardMessage type);
+
+    ShardFrame& putVarint(uint64_t value);
+    ShardFrame& putString(StringRef text);
+
+    /**
+     * @brief The finished frame, length header included
+     */
+    const std::string& data();
+};
+
+/**
+ * @class ShardFrameReader
+ * @brief Reads the fields of one received frame body (type byte first)
+ *
+ * Every getter returns false once the body runs out or is malformed, and
+ * stays false, so a handler can read all fields and check once.
+ */
+class ShardFrameReader {
+private:
+    const std::string& body;
+    size_t offset;
+    bool valid;
+
+public:
+    explicit ShardFrameReader(const std::string& body);
+
+    ShardMessage getType() const;
+    bool getVarint(uint64_t& value);
+    bool getString(std::string& text);
+    bool isValid() const { return valid; }
+    bool atEnd() const { return offset == body.size(); }
+};
+
+/**
+ * @class ShardProtocol
+ * @brief Blocking frame I/O over Unix domain stream sockets
+ */
+class ShardProtocol {
+public:
+    static const uint32_t MAX_FRAME_BYTES = 64u << 20;   ///< Larger frames close the connection
+    static const uint32_t HISTORY_PAGE_BYTES = 1u << 20;   ///< Most history text in one EXPORT_ROOM reply
+
+    /**
+     * @brief Write a whole frame, retrying short writes
+     * @return false if the peer has gone away
+     */
+    static bool writeFrame(int fd, ShardFrame& frame);
+
+    /**
+     * @brief Read one frame body (type byte and fields, without the length)
+     * @return false on end of stream, error or an oversized frame
+     */
+    static bool readFrame(int fd, std::string& body);
+
+    /**
+     * @brief Bind and listen on a socket path, replacing a stale socket file
+     * @return Listening descriptor, or -1 (path too long, permission denied, ...)
+     */
+    static int listenAt(const std::string& socketPath);
+
+    /**
+     * @return Connected descriptor, or -1 if nothing is listening at the path
+     */
+    static int connectTo(const std::string& socketPath);
+};
+
+#endif // SHARDPROTOCOL_H
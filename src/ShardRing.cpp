@@ -0,0 +1,72 @@
+/**
+ * @file ShardRing.cpp
+ * @brief Implementation of ShardRing
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#include "ShardRing.h"
+#include <algorithm>
+
+namespace {
+
+uint64_t mix(uint64_t value) {
+    // splitmix64 finalizer
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+uint64_t pointFor(uint32_t shard, unsigned replica) {
+    return mix((static_cast<uint64_t>(shard) << 32 | replica) + 0x9E3779B97F4A7C15ull);
+}
+
+} // namespace
+
+uint64_t ShardRing::hash(StringRef key) {
+    uint64_t value = 14695981039346656037ull;   // FNV-1a
+    for (size_t i = 0; i < key.size; i++) {
+        value = (value ^ static_cast<unsigned char>(key.data[i])) * 1099511628211ull;
+    }
+    return mix(value);
+}
+
+bool ShardRing::addShard(uint32_t shard) {
+    if (hasShard(shard)) {
+        return false;
+    }
+    for (unsigned replica = 0; replica < VIRTUAL_NODES; replica++) {
+        points.push_back(std::make_pair(pointFor(shard, replica), shard));
+    }
+    std::sort(points.begin(), points.end());
+    return true;
+}
+
+bool ShardRing::removeShard(uint32_t shard) {
+    size_t before = points.size();
+    for (size_t i = 0; i < points.size();) {
+        if (points[i].second == shard) {
+            points.erase(points.begin() + static_cast<std::ptrdiff_t>(i));
+        } else {
+            i++;
+        }
+    }
+    return points.size() != before;
+}
+
+bool ShardRing::hasShard(uint32_t shard) const {
+    std::pair<uint64_t, uint32_t> first(pointFor(shard, 0), shard);
+    return std::binary_search(points.begin(), points.end(), first);
+}
+
+uint32_t ShardRing::shardFor(StringRef key) const {
+    if (points.empty()) {
+        return 0;
+    }
+    std::pair<uint64_t, uint32_t> probe(hash(key), 0);
+    std::vector<std::pair<uint64_t, uint32_t> >::const_iterator it =
+        std::lower_bound(points.begin(), points.end(), probe);
+    return it == points.end() ? points.front().second : it->second;   // Wrap around the ring
+}
@@ -0,0 +1,57 @@
+/**
+ * @file ShardRing.h
+ * @brief Consistent hash ring that assigns rooms to shards
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef SHARDRING_H
+#define SHARDRING_H
+
+#include "StringInterner.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ShardRing
+ * @brief Maps keys (room names) to shard ids by consistent hashing
+ *
+ * Every shard is placed on a 64-bit ring at VIRTUAL_NODES pseudo-random
+ * points, and a key belongs to the first point at or after its own hash.
+ * Adding an Nth shard therefore takes over about 1/N of the keys, all of
+ * them from existing shards, and removing one hands only its own keys to
+ * the others. The virtual nodes keep the shares within a few percent of
+ * even.
+ */
+class ShardRing {
+public:
+    static const unsigned VIRTUAL_NODES = 160;
+
+private:
+    std::vector<std::pair<uint64_t, uint32_t> > points;   // (position, shard), sorted
+
+public:
+    /**
+     * @return false if the shard is already on the ring
+     */
+    bool addShard(uint32_t shard);
+    bool removeShard(uint32_t shard);
+    bool hasShard(uint32_t shard) const;
+
+    /**
+     * @brief Shard that owns a key
+     * @return Shard id; only meaningful while at least one shard is on the ring
+     */
+    uint32_t shardFor(StringRef key) const;
+
+    size_t getShardCount() const { return points.size() / VIRTUAL_NODES; }
+    bool isEmpty() const { return points.empty(); }
+
+    /**
+     * @brief 64-bit FNV-1a followed by a finalizer, so similar names spread out
+     */
+    static uint64_t hash(StringRef key);
+};
+
+#endif // SHARDRING_H
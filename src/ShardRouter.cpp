@@ -0,0 +1,401 @@
+/**
+ * @file ShardRouter.cpp
+ * @brief Implementation of ShardRouter
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#include "ShardRouter.h"
+#include "Logger.h"
+#include <unistd.h>
+#include <vector>
+
+ShardRouter::Shard::~Shard() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+ShardRouter::ShardRouter(size_t historyPageBytes) : nextShardId(1), historyPageBytes(historyPageBytes) {
+    ShardRouterStats none = {0, 0, 0, 0, 0};
+    stats = none;
+}
+
+ShardRouter::~ShardRouter() {}
+
+bool ShardRouter::call(Shard& shard, ShardFrame& request, std::string& reply) {
+    std::lock_guard<std::mutex> lock(shard.callMutex);
+    if (shard.fd < 0) {
+        shard.fd = ShardProtocol::connectTo(shard.socketPath);
+        if (shard.fd < 0) {
+            return false;
+        }
+        LOG_INFO_IN(GENERAL, "[ShardRouter] Reconnected to shard at " + shard.socketPath);
+    }
+    if (ShardProtocol::writeFrame(shard.fd, request) && ShardProtocol::readFrame(shard.fd, reply)) {
+        return true;
+    }
+
+    LOG_INFO_IN(GENERAL, "[ShardRouter] Lost connection to shard at " + shard.socketPath);
+    ::close(shard.fd);
+    shard.fd = -1;
+    return false;
+}
+
+bool ShardRouter::callStatus(Shard& shard, ShardFrame& request) {
+    std::string reply;
+    if (!call(shard, request, reply)) {
+        return false;
+    }
+    ShardFrameReader reader(reply);
+    uint64_t status = 0;
+    return reader.getType() == ShardMessage::STATUS && reader.getVarint(status) && status == 1;
+}
+
+std::map<std::string, ShardRouter::RoomEntry>::iterator ShardRouter::waitForRoom(std::unique_lock<std::mutex>& lock,
+                                                                                   const std::string& roomKey) {
+    std::map<std::string, RoomEntry>::iterator room = rooms.find(roomKey);
+    while (room != rooms.end() && room->second.moving) {
+        roomIdle.wait(lock);
+        room = rooms.find(roomKey);   // A failed first join may have forgotten it meanwhile
+    }
+    return room;
+}
+
+std::shared_ptr<ShardRouter::Shard> ShardRouter::beginRoomCall(RoomEntry& room) {
+    room.calls++;
+    return shards[room.shard];
+}
+
+std::map<std::string, ShardRouter::RoomEntry>::iterator ShardRouter::endRoomCall(const std::string& roomKey) {
+    // Still there: rooms with calls in flight are never forgotten
+    std::map<std::string, RoomEntry>::iterator room = rooms.find(roomKey);
+    if (--room->second.calls == 0) {
+        roomIdle.notify_all();
+    }
+    return room;
+}
+
+bool ShardRouter::copyRoom(const std::string& roomKey, ShardFrame& import, Shard& from, Shard& to,
+                           uint64_t& lines, uint64_t& pages) {
+    if (!callStatus(to, import)) {
+        return false;
+    }
+
+    ShardFrame request(ShardMessage::EXPORT_ROOM);
+    ShardFrame append(ShardMessage::APPEND_HISTORY);
+    std::string page;
+    std::string line;
+    uint64_t total = 0;
+    do {
+        request.reset(ShardMessage::EXPORT_ROOM);
+        request.putString(roomKey).putVarint(lines).putVarint(historyPageBytes);
+        if (!call(from, request, page)) {
+            return false;
+        }
+        ShardFrameReader reader(page);
+        uint64_t count = 0;
+        if (reader.getType() != ShardMessage::HISTORY || !reader.getVarint(total) || !reader.getVarint(count)) {
+            return false;
+        }
+        if (count == 0) {
+            return lines >= total;   // Nothing more, or a shard that stopped making progress
+        }
+
+        // Re-frame the page straight from the export reply
+        append.reset(ShardMessage::APPEND_HISTORY);
+        append.putString(roomKey).putVarint(count);
+        for (uint64_t i = 0; i < count; i++) {
+            if (!reader.getString(line)) {
+                return false;
+            }
+            append.putString(line);
+        }
+        if (!callStatus(to, append)) {
+            return false;
+        }
+        lines += count;
+        pages++;
+    } while (lines < total);
+    return true;
+}
+
+bool ShardRouter::moveRoom(const std::string& roomKey, uint32_t target) {
+    std::shared_ptr<Shard> from;
+    std::shared_ptr<Shard> to;
+    uint32_t source;
+    ShardFrame import(ShardMessage::IMPORT_ROOM);
+    {
+        std::unique_lock<std::mutex> lock(directoryMutex);
+        std::map<std::string, RoomEntry>::iterator room = waitForRoom(lock, roomKey);
+        if (room == rooms.end() || room->second.shard == target || !shards.count(target)) {
+            return room != rooms.end() && room->second.shard == target;
+        }
+
+        // New calls wait from here on; let the ones in flight finish first
+        room->second.moving = true;
+        while (room->second.calls > 0) {
+            roomIdle.wait(lock);
+        }
+        source = room->second.shard;
+        from = shards[source];
+        to = shards[target];
+        import.putString(roomKey).putVarint(static_cast<uint64_t>(room->second.kind)).putVarint(room->second.members.size());
+        for (std::set<std::string>::const_iterator it = room->second.members.begin(); it != room->second.members.end(); ++it) {
+            import.putString(*it).putVarint(static_cast<uint64_t>(users[*it].type));
+        }
+    }
+
+    uint64_t lines = 0;
+    uint64_t pages = 0;
+    bool copied = copyRoom(roomKey, import, *from, *to, lines, pages);
+    if (!copied) {
+        ShardFrame drop(ShardMessage::DROP_ROOM);
+        drop.putString(roomKey);
+        callStatus(*to, drop);   // Best effort; a leftover copy is replaced by the next import
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        std::map<std::string, RoomEntry>::iterator room = rooms.find(roomKey);
+        room->second.moving = false;
+        if (copied) {
+            room->second.shard = target;
+            stats.roomsMoved++;
+            stats.historyMoved += static_cast<unsigned long>(lines);
+            stats.historyPages += static_cast<unsigned long>(pages);
+        } else {
+            stats.failedMoves++;
+        }
+    }
+    roomIdle.notify_all();
+
+    if (!copied) {
+        LOG_INFO_IN(GENERAL, "[ShardRouter] Room " + roomKey + " could not move; still served by shard " + std::to_string(source));
+        return false;
+    }
+    // Only now that the new shard holds everything does the old copy go
+    ShardFrame drop(ShardMessage::DROP_ROOM);
+    drop.putString(roomKey);
+    if (!callStatus(*from, drop)) {
+        LOG_INFO_IN(GENERAL, "[ShardRouter] Room " + roomKey + " moved, but shard " + std::to_string(source) + " kept a stale copy");
+    }
+    return true;
+}
+
+void ShardRouter::rebalance() {
+    std::vector<std::pair<std::string, uint32_t> > moves;
+    {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        for (std::map<std::string, RoomEntry>::iterator it = rooms.begin(); it != rooms.end(); ++it) {
+            uint32_t target = ring.shardFor(it->first);
+            if (target != it->second.shard) {
+                moves.push_back(std::make_pair(it->first, target));
+            }
+        }
+    }
+    for (size_t i = 0; i < moves.size(); i++) {
+        moveRoom(moves[i].first, moves[i].second);
+    }
+}
+
+int ShardRouter::addShard(const std::string& socketPath) {
+    int fd = ShardProtocol::connectTo(socketPath);
+    if (fd < 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> topology(topologyMutex);
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        id = nextShardId++;
+        shards[id] = std::make_shared<Shard>(socketPath, fd);
+        ring.addShard(id);
+    }
+    rebalance();
+    LOG_DEBUG_IN(GENERAL, "[ShardRouter] Shard " + std::to_string(id) + " added at " + socketPath);
+    return static_cast<int>(id);
+}
+
+bool ShardRouter::removeShard(uint32_t shard) {
+    std::lock_guard<std::mutex> topology(topologyMutex);
+    {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        if (!ring.hasShard(shard) || ring.getShardCount() == 1) {
+            return false;
+        }
+        ring.removeShard(shard);
+    }
+    rebalance();
+
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    for (std::map<std::string, RoomEntry>::iterator it = rooms.begin(); it != rooms.end(); ++it) {
+        if (it->second.shard == shard) {
+            ring.addShard(shard);   // Something could not move; keep serving it from here
+            return false;
+        }
+    }
+    shards.erase(shard);   // Closed once no call holds it
+    return true;
+}
+
+bool ShardRouter::join(const std::string& userName, UserType type, const std::string& roomKey, ShardRoomKind kind) {
+    std::unique_lock<std::mutex> lock(directoryMutex);
+    if (ring.isEmpty()) {
+        return false;
+    }
+    std::map<std::string, RoomEntry>::iterator room = waitForRoom(lock, roomKey);
+
+    std::map<std::string, UserEntry>::iterator user = users.find(userName);
+    bool newUser = user == users.end();
+    if (newUser) {
+        UserEntry entry;
+        entry.type = type;
+        entry.rooms = 0;
+        entry.joining = 0;
+        user = users.insert(std::make_pair(userName, entry)).first;
+    } else if (user->second.type != type) {
+        return false;
+    }
+
+    if (room == rooms.end()) {
+        RoomEntry entry;
+        entry.kind = kind;
+        entry.shard = ring.shardFor(roomKey);
+        entry.calls = 0;
+        entry.moving = false;
+        entry.confirmed = false;
+        room = rooms.insert(std::make_pair(roomKey, entry)).first;
+    } else if (room->second.members.count(userName)) {
+        return false;
+    }
+
+    ShardFrame request(ShardMessage::JOIN);
+    request.putString(userName).putVarint(static_cast<uint64_t>(type))
+           .putString(roomKey).putVarint(static_cast<uint64_t>(room->second.kind));
+    std::shared_ptr<Shard> shard = beginRoomCall(room->second);
+    user->second.joining++;
+    lock.unlock();
+    bool joined = callStatus(*shard, request);
+    lock.lock();
+
+    room = endRoomCall(roomKey);
+    user = users.find(userName);
+    user->second.joining--;
+    if (joined) {
+        room->second.confirmed = true;
+        room->second.members.insert(userName);
+        user->second.rooms++;
+        return true;
+    }
+    if (!room->second.confirmed && room->second.calls == 0 && !room->second.moving) {
+        rooms.erase(room);
+    }
+    if (newUser && user->second.rooms == 0 && user->second.joining == 0) {
+        users.erase(user);   // No other join of this new user got in meanwhile
+    }
+    return false;
+}
+
+bool ShardRouter::leave(const std::string& userName, const std::string& roomKey) {
+    std::unique_lock<std::mutex> lock(directoryMutex);
+    std::map<std::string, RoomEntry>::iterator room = waitForRoom(lock, roomKey);
+    if (room == rooms.end() || !room->second.members.count(userName)) {
+        return false;
+    }
+
+    ShardFrame request(ShardMessage::LEAVE);
+    request.putString(userName).putString(roomKey);
+    std::shared_ptr<Shard> shard = beginRoomCall(room->second);
+    lock.unlock();
+    bool left = callStatus(*shard, request);
+    lock.lock();
+
+    room = endRoomCall(roomKey);
+    if (!left || !room->second.members.erase(userName)) {
+        return false;
+    }
+    // The user entry stays, so leaving and rejoining does not reset the quota
+    users[userName].rooms--;
+    return true;
+}
+
+bool ShardRouter::send(const std::string& userName, const std::string& roomKey, const std::string& message) {
+    std::unique_lock<std::mutex> lock(directoryMutex);
+    std::map<std::string, RoomEntry>::iterator room = waitForRoom(lock, roomKey);
+    if (room == rooms.end() || !room->second.members.count(userName)) {
+        return false;
+    }
+
+    // Taken before the call so concurrent sends can't overspend; refunded if the shard refuses
+    UserEntry& user = users[userName];
+    if (!RateLimiter::tryConsume(user.quota, user.type)) {
+        stats.quotaRejections++;
+        return false;
+    }
+
+    ShardFrame request(ShardMessage::SEND);
+    request.putString(userName).putString(roomKey).putString(message);
+    std::shared_ptr<Shard> shard = beginRoomCall(room->second);
+    lock.unlock();
+    bool sent = callStatus(*shard, request);
+    lock.lock();
+
+    endRoomCall(roomKey);
+    if (!sent) {
+        UserEntry& sender = users[userName];   // Members' entries are never forgotten
+        RateLimiter::refund(sender.quota, sender.type);
+    }
+    return sent;
+}
+
+ShardRoomInfo ShardRouter::getRoomInfo(const std::string& roomKey) {
+    std::unique_lock<std::mutex> lock(directoryMutex);
+    ShardRoomInfo info = {false, ring.shardFor(roomKey), 0, 0};
+    std::map<std::string, RoomEntry>::iterator room = waitForRoom(lock, roomKey);
+    if (room == rooms.end()) {
+        return info;
+    }
+
+    info.shard = room->second.shard;
+    ShardFrame request(ShardMessage::ROOM_INFO);
+    request.putString(roomKey);
+    std::shared_ptr<Shard> shard = beginRoomCall(room->second);
+    lock.unlock();
+    std::string reply;
+    bool answered = call(*shard, request, reply);
+    lock.lock();
+    endRoomCall(roomKey);
+    if (!answered) {
+        return info;
+    }
+
+    ShardFrameReader reader(reply);
+    uint64_t exists = 0;
+    if (reader.getType() == ShardMessage::INFO && reader.getVarint(exists) &&
+        reader.getVarint(info.members) && reader.getVarint(info.historySize)) {
+        info.exists = exists == 1;
+    }
+    return info;
+}
+
+uint32_t ShardRouter::getShardFor(const std::string& roomKey) {
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    return ring.shardFor(roomKey);
+}
+
+size_t ShardRouter::getShardCount() {
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    return ring.getShardCount();
+}
+
+size_t ShardRouter::getRoomCount() {
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    return rooms.size();
+}
+
+ShardRouterStats ShardRouter::getStats() {
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    return stats;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file ShardRouter.h
+ * @brief Thin front end that forwards room traffic to ShardWorker processes
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef SHARDROUTER_H
+#define SHARDROUTER_H
+
+#include "RateLimiter.h"
+#include "ShardProtocol.h"
+#include "ShardRing.h"
+#include "Users.h"
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+/**
+ * @brief Where a room lives and what it holds, as reported by its shard
+ */
+struct ShardRoomInfo {
+    bool exists;
+    uint32_t shard;
+    uint64_t members;
+    uint64_t historySize;
+};
+
+/**
+ * @brief Rebalancing counters
+ */
+struct ShardRouterStats {
+    unsigned long roomsMoved;        ///< Rooms migrated by addShard()/removeShard()
+    unsigned long historyMoved;      ///< History entries carried along with them
+    unsigned long historyPages;      ///< EXPORT_ROOM pages the history was copied in
+    unsigned long failedMoves;       ///< Moves abandoned; the room stayed where it was
+    unsigned long quotaRejections;   ///< Sends refused here before reaching a shard
+};
+
+/**
+ * @class ShardRouter
+ * @brief Assigns rooms to shards with a ShardRing and forwards calls to them
+ *
+ * The router keeps the directory every shard needs to agree on: which
+ * rooms exist, their members, and each user's type and send quota. Quota
+ * is checked and charged here, once per user, so a Free user in rooms on
+ * three shards still gets one daily allowance rather than three. Each
+ * shard also runs the full User::send checks, which can only be stricter;
+ * a send a shard refuses gets its token back.
+ *
+ * When a shard is added, only the rooms the ring now maps to it move
+ * (about 1/N of them). A move copies before it deletes: the new shard
+ * creates the room with the same members, the history follows in pages
+ * of at most historyPageBytes, and the old shard drops its copy only
+ * after every page is acknowledged. If any step fails the half-built copy
+ * is dropped and the room keeps being served where it was. Removing a
+ * shard moves its rooms to the survivors the same way.
+ *
+ * Each shard has its own connection and lock, so calls to different
+ * shards run in parallel; the directory lock is only held between calls.
+ * Calls into a room that is moving wait until the move is over, and a
+ * move waits for calls already in flight, so no send lands on a copy
+ * that is about to be dropped. A connection that fails is closed and
+ * reopened by the next call to that shard; the failed call is not
+ * retried, since the shard may have applied it.
+ */
+class ShardRouter {
+private:
+    struct Shard {
+        std::string socketPath;
+        std::mutex callMutex;   ///< One request/reply at a time on fd
+        int fd;                 ///< -1 while disconnected; the next call reconnects
+
+        Shard(const std::string& socketPath, int fd) : socketPath(socketPath), fd(fd) {}
+        ~Shard();
+    };
+
+    struct RoomEntry {
+        ShardRoomKind kind;
+        uint32_t shard;
+        std::set<std::string> members;
+        unsigned calls;    ///< Calls in flight on the room's shard
+        bool moving;       ///< Being copied to another shard; new calls wait
+        bool confirmed;    ///< A shard has accepted a join; until then a failed join forgets the room
+    };
+
+    struct UserEntry {
+        UserType type;
+        TokenBucket quota;
+        size_t rooms;
+        size_t joining;    ///< Joins in flight; a new user is forgotten only when none succeed
+    };
+
+    std::mutex topologyMutex;          // Serializes addShard/removeShard and their moves
+    std::mutex directoryMutex;         // Guards everything below; never held across a call
+    std::condition_variable roomIdle;  // A room's calls finished or its move ended
+    ShardRing ring;
+    std::map<uint32_t, std::shared_ptr<Shard>> shards;
+    std::map<std::string, RoomEntry> rooms;
+    std::map<std::string, UserEntry> users;
+    uint32_t nextShardId;
+    size_t historyPageBytes;
+    ShardRouterStats stats;
+
+    bool call(Shard& shard, ShardFrame& request, std::string& reply);
+    bool callStatus(Shard& shard, ShardFrame& request);
+
+    std::map<std::string, RoomEntry>::iterator waitForRoom(std::unique_lock<std::mutex>& lock, const std::string& roomKey);
+    std::shared_ptr<Shard> beginRoomCall(RoomEntry& room);
+    std::map<std::string, RoomEntry>::iterator endRoomCall(const std::string& roomKey);
+
+    bool copyRoom(const std::string& roomKey, ShardFrame& import, Shard& from, Shard& to,
+                  uint64_t& lines, uint64_t& pages);
+    bool moveRoom(const std::string& roomKey, uint32_t target);
+    void rebalance();
+
+    ShardRouter(const ShardRouter&);
+    ShardRouter& operator=(const ShardRouter&);
+
+public:
+    /**
+     * @param historyPageBytes History text per page when moving a room (capped by the shard)
+     */
+    explicit ShardRouter(size_t historyPageBytes = ShardProtocol::HISTORY_PAGE_BYTES);
+    ~ShardRouter();
+
+    /**
+     * @brief Connect to a worker and move the rooms the ring now gives it
+     * @param socketPath Worker's Unix socket
+     * @return Shard id, or -1 if nothing is listening there
+     */
+    int addShard(const std::string& socketPath);
+
+    /**
+     * @brief Move a shard's rooms to the others, then disconnect from it
+     * @return false if the shard is unknown, is the last one, or a move failed
+     *         (the shard then stays in the ring and keeps serving what did not move)
+     */
+    bool removeShard(uint32_t shard);
+
+    /**
+     * @brief Add a user to a room, creating the room on its shard if needed
+     * @param kind Mediator to create the room with; ignored if it exists
+     * @return false if already a member, the user is known with another type, or the shard is unreachable
+     */
+    bool join(const std::string& userName, UserType type, const std::string& roomKey,
+              ShardRoomKind kind = ShardRoomKind::DOGORITHM);
+
+    bool leave(const std::string& userName, const std::string& roomKey);
+
+    /**
+     * @brief Send a message as a user to a room on whichever shard has it
+     * @return true if the shard accepted and broadcast it
+     */
+    bool send(const std::string& userName, const std::string& roomKey, const std::string& message);
+
+    ShardRoomInfo getRoomInfo(const std::string& roomKey);
+
+    /**
+     * @brief Shard the ring assigns a room to (whether or not the room exists yet)
+     */
+    uint32_t getShardFor(const std::string& roomKey);
+
+    size_t getShardCount();
+    size_t getRoomCount();
+    ShardRouterStats getStats();
+};
+
+#endif // SHARDROUTER_H
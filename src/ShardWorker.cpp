@@ -0,0 +1,334 @@
+/**
+ * @file ShardWorker.cpp
+ * @brief Implementation of ShardWorker
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#include "ShardWorker.h"
+#include "ChatRoom.h"
+#include "CtrlCat.h"
+#include "Dogorithm.h"
+#include "Logger.h"
+#include "Users.h"
+#include <algorithm>
+#include <sys/socket.h>
+#include <unistd.h>
+
+ShardWorker::ShardWorker(const std::string& socketPath)
+    : socketPath(socketPath), listenFd(-1), stopping(false) {}
+
+ShardWorker::~ShardWorker() {
+    stop();
+
+    // Users leave before their rooms go away
+    std::vector<std::string> names;
+    for (std::map<std::string, LocalUser>::iterator it = users.begin(); it != users.end(); ++it) {
+        names.push_back(it->first);
+    }
+    for (std::map<std::string, ChatRoom*>::iterator room = rooms.begin(); room != rooms.end(); ++room) {
+        for (size_t i = 0; i < names.size(); i++) {
+            leaveRoom(names[i], room->second);
+        }
+        delete room->second;
+    }
+}
+
+bool ShardWorker::start() {
+    if (listenFd >= 0) {
+        return true;
+    }
+    listenFd = ShardProtocol::listenAt(socketPath);
+    if (listenFd < 0) {
+        LOG_INFO_IN(GENERAL, "[ShardWorker] Can't listen on " + socketPath);
+        return false;
+    }
+    stopping.store(false);
+    acceptThread = std::thread(&ShardWorker::acceptLoop, this);
+    LOG_DEBUG_IN(GENERAL, "[ShardWorker] Serving rooms on " + socketPath);
+    return true;
+}
+
+void ShardWorker::stop() {
+    if (listenFd < 0) {
+        return;
+    }
+    stopping.store(true);
+    ::shutdown(listenFd, SHUT_RDWR);   // Wakes accept()
+    acceptThread.join();
+    ::close(listenFd);
+    listenFd = -1;
+    ::unlink(socketPath.c_str());
+
+    std::vector<std::thread> threads;
+    {
+        // Connections still open are shut down here; each thread closes its own
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        for (size_t i = 0; i < connectionFds.size(); i++) {
+            ::shutdown(connectionFds[i], SHUT_RDWR);
+        }
+        threads.swap(connectionThreads);
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+void ShardWorker::acceptLoop() {
+    while (!stopping.load()) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (stopping.load()) {
+                return;
+            }
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        connectionFds.push_back(fd);
+        connectionThreads.push_back(std::thread(&ShardWorker::serve, this, fd));
+    }
+}
+
+void ShardWorker::serve(int fd) {
+    std::string request;
+    ShardFrame reply(ShardMessage::STATUS);
+    while (ShardProtocol::readFrame(fd, request)) {
+        bool handled;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            handled = handle(request, reply);
+        }
+        if (!handled) {
+            LOG_DEBUG_IN(GENERAL, "[ShardWorker] Malformed request; closing connection");
+            break;
+        }
+        if (!ShardProtocol::writeFrame(fd, reply)) {
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(connectionMutex);
+    connectionFds.erase(std::find(connectionFds.begin(), connectionFds.end(), fd));
+    ::close(fd);
+}
+
+bool ShardWorker::handle(const std::string& request, ShardFrame& reply) {
+    ShardFrameReader reader(request);
+    std::string roomKey;
+    std::string userName;
+    uint64_t value = 0;
+    reply.reset(ShardMessage::STATUS);
+
+    switch (reader.getType()) {
+        case ShardMessage::JOIN: {
+            uint64_t type = 0;
+            uint64_t kind = 0;
+            if (!reader.getString(userName) || !reader.getVarint(type) || !reader.getString(roomKey) ||
+                !reader.getVarint(kind) || type > 2) {
+                return false;
+            }
+            reply.putVarint(joinRoom(userName, type, findOrCreateRoom(roomKey, kind)) ? 1 : 0);
+            return true;
+        }
+
+        case ShardMessage::LEAVE: {
+            if (!reader.getString(userName) || !reader.getString(roomKey)) {
+                return false;
+            }
+            std::map<std::string, ChatRoom*>::iterator room = rooms.find(roomKey);
+            reply.putVarint(room != rooms.end() && leaveRoom(userName, room->second) ? 1 : 0);
+            return true;
+        }
+
+        case ShardMessage::SEND: {
+            std::string message;
+            if (!reader.getString(userName) || !reader.getString(roomKey) || !reader.getString(message)) {
+                return false;
+            }
+            std::map<std::string, ChatRoom*>::iterator room = rooms.find(roomKey);
+            std::map<std::string, LocalUser>::iterator user = users.find(userName);
+            bool sent = room != rooms.end() && user != users.end() && user->second.user->send(message, room->second);
+            reply.putVarint(sent ? 1 : 0);
+            return true;
+        }
+
+        case ShardMessage::EXPORT_ROOM: {
+            uint64_t first = 0;
+            uint64_t budget = 0;
+            if (!reader.getString(roomKey) || !reader.getVarint(first) || !reader.getVarint(budget)) {
+                return false;
+            }
+            reply.reset(ShardMessage::HISTORY);
+            std::map<std::string, ChatRoom*>::iterator room = rooms.find(roomKey);
+            if (room == rooms.end()) {
+                reply.putVarint(0).putVarint(0);
+                return true;
+            }
+
+            // Read only: the room stays here until the router drops it
+            std::vector<std::string> page;
+            size_t total = room->second->copyHistory(static_cast<size_t>(first),
+                                                     static_cast<size_t>(std::min<uint64_t>(budget, ShardProtocol::HISTORY_PAGE_BYTES)), page);
+            reply.putVarint(total).putVarint(page.size());
+            for (size_t i = 0; i < page.size(); i++) {
+                reply.putString(page[i]);
+            }
+            return true;
+        }
+
+        case ShardMessage::IMPORT_ROOM: {
+            uint64_t kind = 0;
+            uint64_t memberCount = 0;
+            if (!reader.getString(roomKey) || !reader.getVarint(kind) || !reader.getVarint(memberCount)) {
+                return false;
+            }
+            if (dropRoom(roomKey)) {
+                LOG_DEBUG_IN(GENERAL, "[ShardWorker] Replaced a leftover copy of room " + roomKey);
+            }
+
+            ChatRoom* room = findOrCreateRoom(roomKey, kind);
+            for (uint64_t i = 0; i < memberCount; i++) {
+                uint64_t type = 0;
+                if (!reader.getString(userName) || !reader.getVarint(type) || type > 2) {
+                    dropRoom(roomKey);
+                    return false;
+                }
+                joinRoom(userName, type, room);
+            }
+            reply.putVarint(1);
+            return true;
+        }
+
+        case ShardMessage::APPEND_HISTORY: {
+            uint64_t lineCount = 0;
+            if (!reader.getString(roomKey) || !reader.getVarint(lineCount) || lineCount > request.size()) {
+                return false;
+            }
+            std::vector<std::string> history(static_cast<size_t>(lineCount));
+            for (size_t i = 0; i < history.size(); i++) {
+                if (!reader.getString(history[i])) {
+                    return false;
+                }
+            }
+            std::map<std::string, ChatRoom*>::iterator room = rooms.find(roomKey);
+            if (room != rooms.end()) {
+                room->second->appendHistory(history);
+            }
+            reply.putVarint(room != rooms.end() ? 1 : 0);
+            return true;
+        }
+
+        case ShardMessage::DROP_ROOM: {
+            if (!reader.getString(roomKey)) {
+                return false;
+            }
+            bool dropped = dropRoom(roomKey);
+            if (dropped) {
+                LOG_DEBUG_IN(GENERAL, "[ShardWorker] Room " + roomKey + " moved off " + socketPath);
+            }
+            reply.putVarint(dropped ? 1 : 0);
+            return true;
+        }
+
+        case ShardMessage::ROOM_INFO: {
+            if (!reader.getString(roomKey)) {
+                return false;
+            }
+            reply.reset(ShardMessage::INFO);
+            std::map<std::string, ChatRoom*>::iterator room = rooms.find(roomKey);
+            if (room == rooms.end()) {
+                reply.putVarint(0).putVarint(0).putVarint(0);
+                return true;
+            }
+            for (std::map<std::string, LocalUser>::iterator it = users.begin(); it != users.end(); ++it) {
+                value += it->second.user->isInChatRoom(room->second) ? 1 : 0;
+            }
+            reply.putVarint(1).putVarint(value).putVarint(room->second->getHistorySize());
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+ChatRoom* ShardWorker::findOrCreateRoom(const std::string& roomKey, uint64_t kind) {
+    std::map<std::string, ChatRoom*>::iterator it = rooms.find(roomKey);
+    if (it != rooms.end()) {
+        return it->second;
+    }
+    ChatRoom* room;
+    if (kind == static_cast<uint64_t>(ShardRoomKind::CTRLCAT)) {
+        room = new CtrlCat();
+    } else {
+        room = new Dogorithm();
+    }
+    rooms[roomKey] = room;
+    return room;
+}
+
+bool ShardWorker::joinRoom(const std::string& userName, uint64_t type, ChatRoom* room) {
+    std::map<std::string, LocalUser>::iterator it = users.find(userName);
+    if (it == users.end()) {
+        LocalUser local;
+        if (type == 0) {
+            local.user = new FreeUser(userName);
+        } else if (type == 1) {
+            local.user = new PremiumUser(userName);
+        } else {
+            local.user = new AdminUser(userName);
+        }
+        local.rooms = 0;
+        it = users.insert(std::make_pair(userName, local)).first;
+    }
+
+    if (it->second.user->isInChatRoom(room)) {
+        return false;
+    }
+    room->registerUser(it->second.user);
+    it->second.rooms++;
+    return true;
+}
+
+bool ShardWorker::leaveRoom(const std::string& userName, ChatRoom* room) {
+    std::map<std::string, LocalUser>::iterator it = users.find(userName);
+    if (it == users.end() || !it->second.user->isInChatRoom(room)) {
+        return false;
+    }
+    room->removeUser(it->second.user);
+    it->second.user->removeChatRoom(room);
+    if (--it->second.rooms == 0) {
+        delete it->second.user;
+        users.erase(it);
+    }
+    return true;
+}
+
+bool ShardWorker::dropRoom(const std::string& roomKey) {
+    std::map<std::string, ChatRoom*>::iterator room = rooms.find(roomKey);
+    if (room == rooms.end()) {
+        return false;
+    }
+    std::vector<std::string> members;
+    for (std::map<std::string, LocalUser>::iterator it = users.begin(); it != users.end(); ++it) {
+        if (it->second.user->isInChatRoom(room->second)) {
+            members.push_back(it->first);
+        }
+    }
+    for (size_t i = 0; i < members.size(); i++) {
+        leaveRoom(members[i], room->second);
+    }
+    delete room->second;
+    rooms.erase(room);
+    return true;
+}
+
+size_t ShardWorker::getRoomCount() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return rooms.size();
+}
+
+size_t ShardWorker::getUserCount() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return users.size();
+}
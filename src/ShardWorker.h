@@ -0,0 +1,92 @@
+/**
+ * @file ShardWorker.h
+ * @brief One shard of a sharded deployment: owns some rooms and serves router requests
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef SHARDWORKER_H
+#define SHARDWORKER_H
+
+#include "ShardProtocol.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ChatRoom;
+class User;
+
+/**
+ * @class ShardWorker
+ * @brief Hosts the rooms a ShardRouter assigns to it, behind a Unix socket
+ *
+ * Rooms are created on first use. Users are local stand-ins created by
+ * name and type the first time they join a room here and deleted when
+ * they have left every room on this shard, so a user whose rooms span
+ * shards has one User per shard. Sends go through the normal User::send
+ * path (membership, validation, quota) and rooms mediate as usual.
+ *
+ * Each connection gets a thread; requests are handled one at a time under
+ * a single lock. Run one per process with the shardworker executable, or
+ * several in one process for tests.
+ */
+class ShardWorker {
+private:
+    struct LocalUser {
+        User* user;
+        size_t rooms;   ///< Rooms joined on this shard
+    };
+
+    std::string socketPath;
+    int listenFd;
+    std::atomic<bool> stopping;
+    std::thread acceptThread;
+
+    std::mutex connectionMutex;        // Guards the two vectors below
+    std::vector<int> connectionFds;
+    std::vector<std::thread> connectionThreads;
+
+    std::mutex stateMutex;             // Guards rooms and users; held for each request
+    std::map<std::string, ChatRoom*> rooms;
+    std::map<std::string, LocalUser> users;
+
+    void acceptLoop();
+    void serve(int fd);
+    bool handle(const std::string& request, ShardFrame& reply);
+
+    ChatRoom* findOrCreateRoom(const std::string& roomKey, uint64_t kind);
+    bool joinRoom(const std::string& userName, uint64_t type, ChatRoom* room);
+    bool leaveRoom(const std::string& userName, ChatRoom* room);
+    bool dropRoom(const std::string& roomKey);
+
+    ShardWorker(const ShardWorker&);
+    ShardWorker& operator=(const ShardWorker&);
+
+public:
+    explicit ShardWorker(const std::string& socketPath);
+
+    /**
+     * @brief Stops serving and deletes every hosted room and user
+     */
+    ~ShardWorker();
+
+    /**
+     * @brief Listen on the socket path and serve connections in the background
+     * @return false if the socket can't be created
+     */
+    bool start();
+
+    /**
+     * @brief Close the socket and every connection, then wait for their threads
+     */
+    void stop();
+
+    const std::string& getSocketPath() const { return socketPath; }
+    size_t getRoomCount();
+    size_t getUserCount();
+};
+
+#endif // SHARDWORKER_H
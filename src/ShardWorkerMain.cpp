@@ -0,0 +1,46 @@
+/**
+ * @file ShardWorkerMain.cpp
+ * @brief One shard process for a sharded deployment - build with "make shardworker"
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ *
+ * Start one per shard, each on its own socket, then point a ShardRouter
+ * at the sockets:
+ *   ./shardworker /tmp/petspace-shard1.sock &
+ *   ./shardworker /tmp/petspace-shard2.sock &
+ * Stops cleanly on SIGINT or SIGTERM.
+ */
+
+#include <csignal>
+#include <iostream>
+#include "Logger.h"
+#include "ShardWorker.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket path>" << std::endl;
+        return 2;
+    }
+    Logger::setLevel(BASIC);
+
+    // Block the stop signals before any thread starts so only sigwait sees them
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    ShardWorker worker(argv[1]);
+    if (!worker.start()) {
+        std::cerr << "Cannot listen on " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Shard serving on " << argv[1] << std::endl;
+
+    int received = 0;
+    sigwait(&stopSignals, &received);
+    worker.stop();
+    std::cout << "Shard on " << argv[1] << " stopped (" << worker.getRoomCount() << " rooms, "
+              << worker.getUserCount() << " users)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file SharedMutex.h
+ * @brief Reader-writer lock for data that is read far more often than changed
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef SHAREDMUTEX_H
+#define SHAREDMUTEX_H
+
+#include <pthread.h>
+
+/**
+ * @class SharedMutex
+ * @brief Thin wrapper over pthread_rwlock_t (C++11 has no std::shared_mutex)
+ *
+ * lock()/unlock() take it exclusively and work with std::lock_guard;
+ * readers use SharedLock. Readers are preferred, so a thread that already
+ * holds a shared lock can take it again while a writer waits. Never take
+ * it shared while holding it exclusively, or the other way round.
+ */
+class SharedMutex {
+private:
+    pthread_rwlock_t rwlock;
+
+    SharedMutex(const SharedMutex&);
+    SharedMutex& operator=(const SharedMutex&);
+
+public:
+    SharedMutex() { pthread_rwlock_init(&rwlock, nullptr); }
+    ~SharedMutex() { pthread_rwlock_destroy(&rwlock); }
+
+    void lock() { pthread_rwlock_wrlock(&rwlock); }
+    void unlock() { pthread_rwlock_unlock(&rwlock); }
+    void lock_shared() { pthread_rwlock_rdlock(&rwlock); }
+    void unlock_shared() { pthread_rwlock_unlock(&rwlock); }
+};
+
+/**
+ * @class SharedLock
+ * @brief RAII shared (reader) hold on a SharedMutex
+ */
+class SharedLock {
+private:
+    SharedMutex& mutex;
+
+    SharedLock(const SharedLock&);
+    SharedLock& operator=(const SharedLock&);
+
+public:
+    explicit SharedLock(SharedMutex& mutex) : mutex(mutex) { mutex.lock_shared(); }
+    ~SharedLock() { mutex.unlock_shared(); }
+};
+
+#endif // SHAREDMUTEX_H
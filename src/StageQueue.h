@@ -0,0 +1,188 @@
+/**
+ * @file StageQueue.h
+ * @brief Bounded lock-free queues that connect pipeline stages
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-15
+ */
+
+#ifndef STAGEQUEUE_H
+#define STAGEQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @class SpscQueue
+ * @brief Single-producer, single-consumer ring
+ *
+ * Items are swapped in and out, so a slot's buffers are reused once they
+ * have grown. T must be default constructible and swappable.
+ */
+template <typename T>
+class SpscQueue {
+private:
+    T* slots;
+    size_t mask;
+    char producerPad[64];                 // Keep the two positions on separate cache lines
+    std::atomic<size_t> tail;             // Next slot to fill (producer)
+    char consumerPad[64];
+    std::atomic<size_t> head;             // Next slot to take (consumer)
+
+    SpscQueue(const SpscQueue&);
+    SpscQueue& operator=(const SpscQueue&);
+
+public:
+    /**
+     * @param capacity Number of items, rounded up to a power of two
+     */
+    explicit SpscQueue(size_t capacity) : tail(0), head(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        slots = new T[size];
+    }
+
+    ~SpscQueue() { delete[] slots; }
+
+    /**
+     * @brief Add an item if there is room (producer thread only)
+     * @return false if the queue is full
+     */
+    bool tryPush(T& item) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        using std::swap;
+        swap(slots[position & mask], item);
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest item (consumer thread only)
+     * @return false if the queue is empty
+     */
+    bool tryPop(T& item) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        using std::swap;
+        swap(item, slots[position & mask]);
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Items waiting (any thread; approximate while both ends are busy)
+     */
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t getCapacity() const { return mask + 1; }
+};
+
+/**
+ * @class MpscQueue
+ * @brief Multi-producer, single-consumer ring
+ *
+ * Vyukov's bounded queue, as in LogRingBuffer: each slot carries a sequence
+ * number, so producers claim slots with one compare-and-swap.
+ */
+template <typename T>
+class MpscQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    Cell* cells;
+    size_t mask;
+    char producerPad[64];
+    std::atomic<size_t> enqueuePos;
+    char consumerPad[64];
+    std::atomic<size_t> dequeuePos;       // Written by the consumer only
+
+    MpscQueue(const MpscQueue&);
+    MpscQueue& operator=(const MpscQueue&);
+
+public:
+    /**
+     * @param capacity Number of items, rounded up to a power of two
+     */
+    explicit MpscQueue(size_t capacity) : enqueuePos(0), dequeuePos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells = new Cell[size];
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpscQueue() { delete[] cells; }
+
+    /**
+     * @brief Add an item if there is room (any thread)
+     * @return false if the queue is full
+     */
+    bool tryPush(T& item) {
+        size_t position = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            long difference = static_cast<long>(sequence) - static_cast<long>(position);
+
+            if (difference == 0) {
+                if (enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    using std::swap;
+                    swap(cell.item, item);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Take the oldest item (consumer thread only)
+     * @return false if the queue is empty
+     */
+    bool tryPop(T& item) {
+        size_t position = dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = cells[position & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+        using std::swap;
+        swap(item, cell.item);
+        cell.sequence.store(position + mask + 1, std::memory_order_release);
+        dequeuePos.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Items claimed but not yet taken (any thread; approximate)
+     */
+    size_t size() const {
+        size_t dequeued = dequeuePos.load(std::memory_order_acquire);
+        size_t enqueued = enqueuePos.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    size_t getCapacity() const { return mask + 1; }
+};
+
+#endif // STAGEQUEUE_H
@@ -0,0 +1,112 @@
+/**
+ * @file StringInterner.cpp
+ * @brief Implementation of InternedString and StringInterner
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#include "StringInterner.h"
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+const uint32_t CHUNK_BITS = 12;
+const uint32_t CHUNK_STRINGS = 1u << CHUNK_BITS;
+const uint32_t MAX_CHUNKS = 1u << 12;   // 16M strings
+
+struct StringChunk {
+    std::string strings[CHUNK_STRINGS];
+};
+
+struct RefHash {
+    std::size_t operator()(const StringRef& text) const {
+        return text.hash();
+    }
+};
+
+std::atomic<StringChunk*> chunks[MAX_CHUNKS];
+
+typedef std::unordered_map<StringRef, uint32_t, RefHash> IdMap;
+
+std::mutex internMutex;     // Guards everything below
+uint32_t nextId = 1;        // Id 0 is the empty string and is never stored
+std::size_t byteCount = 0;
+
+// Built on first use and never destroyed: names are interned from other
+// files' static initialisers and looked up from their destructors
+IdMap& ids() {
+    static IdMap* map = new IdMap();
+    return *map;
+}
+
+const std::string& stored(uint32_t id) {
+    return chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)->strings[id & (CHUNK_STRINGS - 1)];
+}
+
+uint32_t append(StringRef text) {
+    uint32_t id = nextId++;
+    StringChunk* chunk = chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new StringChunk();
+        chunks[id >> CHUNK_BITS].store(chunk, std::memory_order_release);
+    }
+    std::string& slot = chunk->strings[id & (CHUNK_STRINGS - 1)];
+    slot.assign(text.data, text.size);
+    ids()[StringRef(slot)] = id;
+    byteCount += text.size;
+    return id;
+}
+
+} // namespace
+
+InternedString InternedString::of(StringRef text) {
+    if (text.size == 0) {
+        return InternedString();
+    }
+    std::lock_guard<std::mutex> lock(internMutex);
+    IdMap::const_iterator it = ids().find(text);
+    if (it != ids().end()) {
+        return InternedString(it->second);
+    }
+    if (nextId == MAX_CHUNKS * CHUNK_STRINGS) {
+        // The empty string would stand in for every new text, so refuse instead
+        throw std::length_error("StringInterner is full (" + std::to_string(nextId - 1) + " strings)");
+    }
+    return InternedString(append(text));
+}
+
+InternedString InternedString::find(StringRef text, bool* found) {
+    if (text.size == 0) {
+        if (found) {
+            *found = true;
+        }
+        return InternedString();
+    }
+    std::lock_guard<std::mutex> lock(internMutex);
+    IdMap::const_iterator it = ids().find(text);
+    if (found) {
+        *found = it != ids().end();
+    }
+    return it != ids().end() ? InternedString(it->second) : InternedString();
+}
+
+const std::string& InternedString::str() const {
+    if (id == 0) {
+        static const std::string emptyString;
+        return emptyString;
+    }
+    return stored(id);
+}
+
+std::size_t StringInterner::getCount() {
+    std::lock_guard<std::mutex> lock(internMutex);
+    return nextId - 1;
+}
+
+std::size_t StringInterner::getBytes() {
+    std::lock_guard<std::mutex> lock(internMutex);
+    return byteCount;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file StringInterner.h
+ * @brief Process-wide string interning with stable ids
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Non-owning view of characters (std::string_view is C++17)
+ */
+struct StringRef {
+    const char* data;
+    std::size_t size;
+
+    StringRef() : data(""), size(0) {}
+    StringRef(const char* data, std::size_t size) : data(data), size(size) {}
+    StringRef(const char* text) : data(text), size(std::strlen(text)) {}
+    StringRef(const std::string& text) : data(text.data()), size(text.size()) {}
+
+    std::string str() const { return std::string(data, size); }
+
+    uint32_t hash() const {
+        uint32_t value = 2166136261u;   // FNV-1a
+        for (std::size_t i = 0; i < size; i++) {
+            value = (value ^ static_cast<unsigned char>(data[i])) * 16777619u;
+        }
+        return value;
+    }
+
+    bool operator==(const StringRef& other) const {
+        return size == other.size && std::memcmp(data, other.data, size) == 0;
+    }
+    bool operator!=(const StringRef& other) const { return !(*this == other); }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const StringRef& text) {
+    return out.write(text.data, static_cast<std::streamsize>(text.size));
+}
+
+/**
+ * @brief Id of an interned string; equal ids mean equal text
+ *
+ * Four bytes, compared as an integer. The default value is the empty
+ * string. The text is stored once for the life of the program, so
+ * str() and view() may be kept without copying.
+ */
+class InternedString {
+private:
+    uint32_t id;
+
+public:
+    InternedString() : id(0) {}
+    explicit InternedString(uint32_t id) : id(id) {}
+
+    /**
+     * @brief Intern text, returning the existing id if it was seen before
+     * @throws std::length_error if the table is full and the text is new
+     */
+    static InternedString of(StringRef text);
+
+    /**
+     * @brief Find text without interning it
+     * @return The id, or the empty string's id if the text was never interned
+     */
+    static InternedString find(StringRef text, bool* found = nullptr);
+
+    uint32_t getId() const { return id; }
+    bool empty() const { return id == 0; }
+
+    const std::string& str() const;
+    StringRef view() const { return StringRef(str()); }
+
+    bool operator==(const InternedString& other) const { return id == other.id; }
+    bool operator!=(const InternedString& other) const { return id != other.id; }
+    bool operator<(const InternedString& other) const { return id < other.id; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const InternedString& text) {
+    return out << text.str();
+}
+
+/**
+ * @class StringInterner
+ * @brief Counters for the shared string table behind InternedString
+ *
+ * Strings live in fixed chunks that are never moved or freed, so lookups
+ * by id need no lock; interning takes a mutex. Nothing is ever freed, so
+ * it is meant for a bounded vocabulary such as room names and fixed
+ * labels. User names come and go with their users and live in UserTable.
+ */
+class StringInterner {
+private:
+    StringInterner() = delete;
+
+public:
+    static std::size_t getCount();
+    static std::size_t getBytes();   ///< Characters stored, not counting std::string overhead
+};
+
+#endif // STRINGINTERNER_H
@@ -0,0 +1,351 @@
+/**
+ * @file StructuredLog.cpp
+ * @brief Implementation of StructuredLog
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-11
+ */
+
+#include "StructuredLog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <vector>
+
+std::atomic<uint32_t> StructuredLog::session(0);
+
+namespace {
+
+const char MAGIC[] = "PSLOG1\n";
+const size_t MAGIC_LENGTH = sizeof(MAGIC) - 1;
+
+const char* const FORMATS[] = {
+#define STRUCTURED_LOG_TEXT(id, text) text,
+    STRUCTURED_LOG_FORMATS(STRUCTURED_LOG_TEXT)
+#undef STRUCTURED_LOG_TEXT
+};
+
+std::mutex fileMutex;                       // Guards the file, names and session changes
+std::FILE* logFile = nullptr;
+uint32_t sessionCounter = 0;
+std::chrono::steady_clock::time_point openedAt;
+std::map<std::string, uint32_t> nameIds;
+
+std::mutex registryMutex;                   // Guards the list of thread buffers
+std::vector<StructuredLogBuffer*> threadBuffers;
+uint32_t threadCounter = 0;
+
+char* putVarint(char* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<char>(value);
+    return out;
+}
+
+// Caller holds fileMutex
+void writeChunk(uint32_t threadIndex, uint64_t startMicros, const char* data, size_t length) {
+    if (!logFile || length == 0) {
+        return;
+    }
+    char header[32];
+    char* end = putVarint(putVarint(putVarint(header, threadIndex), startMicros), length);
+    std::fwrite(header, 1, static_cast<size_t>(end - header), logFile);
+    std::fwrite(data, 1, length, logFile);
+}
+
+// Caller holds the buffer's busy flag
+void flushBuffer(StructuredLogBuffer* buffer) {
+    if (buffer->used == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (buffer->session == sessionCounter) {
+            writeChunk(buffer->threadIndex, buffer->chunkStartMicros, buffer->data, buffer->used);
+        }
+    }
+    buffer->used = 0;
+    buffer->chunkStartMicros = buffer->lastMicros;
+}
+
+// Owns the calling thread's buffer; flushes and unregisters it at thread exit
+struct ThreadBufferHolder {
+    StructuredLogBuffer* buffer;
+
+    ThreadBufferHolder() : buffer(new StructuredLogBuffer) {
+        buffer->busy.clear();
+        buffer->session = 0;
+        buffer->chunkStartMicros = 0;
+        buffer->lastMicros = 0;
+        buffer->used = 0;
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->threadIndex = ++threadCounter;
+        threadBuffers.push_back(buffer);
+    }
+
+    ~ThreadBufferHolder() {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            threadBuffers.erase(std::find(threadBuffers.begin(), threadBuffers.end(), buffer));
+        }
+        while (buffer->busy.test_and_set(std::memory_order_acquire)) {
+        }
+        flushBuffer(buffer);
+        delete buffer;
+    }
+};
+
+thread_local ThreadBufferHolder threadBuffer;
+
+// Closes the log at exit so buffered records reach the file
+struct LogCloser {
+    ~LogCloser() { StructuredLog::close(); }
+};
+
+LogCloser logCloser;
+
+bool readVarint(const std::string& data, size_t& position, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && position < data.size(); shift += 7) {
+        unsigned char byte = static_cast<unsigned char>(data[position++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct DecodedRecord {
+    uint64_t micros;
+    uint32_t threadIndex;
+    std::string text;
+};
+
+} // namespace
+
+StructuredLogBuffer* StructuredLog::acquireBuffer() {
+    StructuredLogBuffer* buffer = threadBuffer.buffer;
+    while (buffer->busy.test_and_set(std::memory_order_acquire)) {
+        // Only close() or thread exit ever contend for it
+    }
+
+    uint32_t current = session.load(std::memory_order_acquire);
+    if (current == 0) {
+        releaseBuffer(buffer);
+        return nullptr;
+    }
+    if (buffer->session != current) {
+        // Records from an earlier session were flushed or are stale
+        buffer->session = current;
+        buffer->used = 0;
+        buffer->lastMicros = elapsedMicros();
+        buffer->chunkStartMicros = buffer->lastMicros;
+    }
+    return buffer;
+}
+
+char* StructuredLog::reserve(StructuredLogBuffer* buffer, size_t bytes) {
+    if (buffer->used + bytes > StructuredLogBuffer::CAPACITY) {
+        flushBuffer(buffer);
+    }
+    return buffer->data + buffer->used;
+}
+
+uint64_t StructuredLog::elapsedMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - openedAt).count());
+}
+
+uint32_t StructuredLog::defineName(const std::string& text) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    std::map<std::string, uint32_t>::iterator found = nameIds.find(text);
+    if (found != nameIds.end()) {
+        return found->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(nameIds.size() + 1);
+    nameIds[text] = id;
+
+    // Written straight to the file so it precedes every chunk that uses it
+    std::string record(16 + text.size(), '\0');
+    char* out = &record[0];
+    out = putVarint(out, static_cast<uint16_t>(LogFormat::NAME_DEFINITION));
+    out = putVarint(out, 0);
+    *out++ = TAG_UNSIGNED;
+    out = putVarint(out, id);
+    out = putString(out, text.data(), text.size());
+    writeChunk(0, elapsedMicros(), record.data(), static_cast<size_t>(out - record.data()));
+    return id;
+}
+
+bool StructuredLog::open(const std::string& path) {
+    close();
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    logFile = std::fopen(path.c_str(), "wb");
+    if (!logFile) {
+        return false;
+    }
+    std::setvbuf(logFile, nullptr, _IOFBF, 256 * 1024);
+    std::fwrite(MAGIC, 1, MAGIC_LENGTH, logFile);
+
+    openedAt = std::chrono::steady_clock::now();
+    nameIds.clear();
+    sessionCounter++;
+    session.store(sessionCounter, std::memory_order_release);
+    return true;
+}
+
+void StructuredLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (session.load() == 0) {
+            return;
+        }
+        session.store(0);   // New records are dropped from here on
+    }
+
+    {
+        std::lock_guard<std::mutex> registry(registryMutex);
+        for (size_t i = 0; i < threadBuffers.size(); i++) {
+            StructuredLogBuffer* buffer = threadBuffers[i];
+            while (buffer->busy.test_and_set(std::memory_order_acquire)) {
+            }
+            flushBuffer(buffer);
+            buffer->busy.clear(std::memory_order_release);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    std::fclose(logFile);
+    logFile = nullptr;
+}
+
+void StructuredLog::flush() {
+    StructuredLogBuffer* buffer = acquireBuffer();
+    if (!buffer) {
+        return;
+    }
+    flushBuffer(buffer);
+    releaseBuffer(buffer);
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (logFile) {
+        std::fflush(logFile);
+    }
+}
+
+const char* StructuredLog::getFormat(LogFormat format) {
+    size_t index = static_cast<size_t>(format);
+    return index < static_cast<size_t>(LogFormat::FORMAT_COUNT) ? FORMATS[index] : "<unknown format {}>";
+}
+
+long StructuredLog::decode(std::istream& in, std::ostream& out) {
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.compare(0, MAGIC_LENGTH, MAGIC) != 0) {
+        return -1;
+    }
+
+    std::vector<std::string> names(1, "?");
+    std::vector<DecodedRecord> records;
+    size_t position = MAGIC_LENGTH;
+
+    while (position < data.size()) {
+        uint64_t threadIndex, micros, length;
+        if (!readVarint(data, position, threadIndex) || !readVarint(data, position, micros) ||
+            !readVarint(data, position, length) || length > data.size() - position) {
+            return -1;
+        }
+        size_t chunkEnd = position + static_cast<size_t>(length);
+
+        while (position < chunkEnd) {
+            uint64_t formatId, delta;
+            if (!readVarint(data, position, formatId) || !readVarint(data, position, delta) ||
+                formatId >= static_cast<uint64_t>(LogFormat::FORMAT_COUNT)) {
+                return -1;
+            }
+            micros += delta;
+
+            // Substitute each tagged argument into the next "{}"
+            const char* format = FORMATS[formatId];
+            std::string text;
+            std::vector<std::string> arguments;
+            std::vector<unsigned char> tags;
+            std::vector<uint64_t> values;
+            const char* hole;
+            while ((hole = std::strstr(format, "{}")) != nullptr) {
+                if (position >= chunkEnd) {
+                    return -1;
+                }
+                unsigned char tag = static_cast<unsigned char>(data[position++]);
+                uint64_t value;
+                if (!readVarint(data, position, value)) {
+                    return -1;
+                }
+
+                std::string argument;
+                if (tag == TAG_UNSIGNED) {
+                    argument = std::to_string(value);
+                } else if (tag == TAG_SIGNED) {
+                    argument = std::to_string(static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1)));
+                } else if (tag == TAG_STRING) {
+                    if (value > chunkEnd - position) {
+                        return -1;
+                    }
+                    argument = data.substr(position, static_cast<size_t>(value));
+                    position += static_cast<size_t>(value);
+                } else if (tag == TAG_NAME) {
+                    argument = value < names.size() ? names[static_cast<size_t>(value)] : "?";
+                } else {
+                    return -1;
+                }
+
+                text.append(format, hole);
+                text += argument;
+                arguments.push_back(argument);
+                tags.push_back(tag);
+                values.push_back(value);
+                format = hole + 2;
+            }
+            text += format;
+
+            if (formatId == static_cast<uint64_t>(LogFormat::NAME_DEFINITION)) {
+                // Definitions are written in id order, so a new id is always the next one
+                if (arguments.size() != 2 || tags[0] != TAG_UNSIGNED || tags[1] != TAG_STRING ||
+                    values[0] == 0 || values[0] > names.size()) {
+                    return -1;
+                }
+                size_t id = static_cast<size_t>(values[0]);
+                if (id == names.size()) {
+                    names.push_back(arguments[1]);
+                } else {
+                    names[id] = arguments[1];
+                }
+                continue;
+            }
+
+            DecodedRecord record;
+            record.micros = micros;
+            record.threadIndex = static_cast<uint32_t>(threadIndex);
+            record.text.swap(text);
+            records.push_back(record);
+        }
+    }
+
+    // Chunks from different threads arrive out of order; per-thread order is kept
+    std::stable_sort(records.begin(), records.end(), [](const DecodedRecord& a, const DecodedRecord& b) {
+        return a.micros < b.micros;
+    });
+    for (size_t i = 0; i < records.size(); i++) {
+        out << "+" << std::fixed << std::setprecision(6) << records[i].micros / 1e6 << "s t"
+            << records[i].threadIndex << " " << records[i].text << "\n";
+    }
+    return static_cast<long>(records.size());
+}
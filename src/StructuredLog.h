@@ -0,0 +1,284 @@
+/**
+ * @file StructuredLog.h
+ * @brief Binary structured logging with deferred (offline) formatting
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-11
+ */
+
+#ifndef STRUCTUREDLOG_H
+#define STRUCTUREDLOG_H
+
+#include "Logger.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+// Every structured call site has a static format here; "{}" marks an argument.
+// Ids are written to the log, so only append new formats at the end.
+#define STRUCTURED_LOG_FORMATS(X) \
+    X(NAME_DEFINITION,      "{} = {}") \
+    X(SENDING_MESSAGE,      "[{}] Sending message: \"{}\"") \
+    X(COMMAND_CREATED,      "[Command] Command created with message: \"{}\"") \
+    X(SEND_COMMAND_CREATED, "[SendMessageCommand] Created for user: {}") \
+    X(SAVE_COMMAND_CREATED, "[SaveMessageCommand] Created for message: \"{}\"") \
+    X(COMMAND_ADDED,        "[{}] Command added to queue") \
+    X(EXECUTING_COMMANDS,   "[{}] Executing {} commands...") \
+    X(COMMANDS_EXECUTED,    "[{}] All commands executed!") \
+    X(SEND_EXECUTING,       "[SendMessageCommand] Executing - sending message to all users") \
+    X(SEND_COMPLETED,       "[SendMessageCommand] Message delivery completed") \
+    X(SAVE_EXECUTING,       "[SaveMessageCommand] Executing - saving message to history") \
+    X(SAVE_COMPLETED,       "[SaveMessageCommand] Message saved to history") \
+    X(BROADCASTING,         "[ChatRoom] Broadcasting message from {}") \
+    X(MESSAGE_SAVED,        "[ChatRoom] Message saved to history: {}") \
+    X(MESSAGE_RECEIVED,     "[{}] Received message from {} ({})") \
+    X(VALIDATING,           "[{} Validation] Validating message from {}") \
+    X(VALIDATION_APPROVED,  "[{} Validation] Message approved for {}") \
+    X(MESSAGES_USED,        "[{}] Messages used today: {}/{}")
+
+enum class LogFormat : uint16_t {
+#define STRUCTURED_LOG_ENUM(id, text) id,
+    STRUCTURED_LOG_FORMATS(STRUCTURED_LOG_ENUM)
+#undef STRUCTURED_LOG_ENUM
+    FORMAT_COUNT
+};
+
+/**
+ * @brief Cached id of a name in the current structured log session
+ *
+ * Session and id are packed into one atomic word, so a thread encoding the
+ * name never reads an id from one session paired with another session.
+ */
+struct LogNameRef {
+    std::atomic<uint64_t> packed;   ///< session << 32 | id
+
+    LogNameRef() : packed(0) {}
+
+    static uint64_t pack(uint32_t session, uint32_t id) { return (static_cast<uint64_t>(session) << 32) | id; }
+};
+
+/**
+ * @brief Log argument for a frequently repeated name (usually a user)
+ *
+ * The first record in a session writes the name once; later records carry
+ * only its small id.
+ */
+struct LogName {
+    const std::string& text;
+    LogNameRef& ref;
+
+    LogName(const std::string& text, LogNameRef& ref) : text(text), ref(ref) {}
+};
+
+/**
+ * @brief Staging area one thread appends encoded records to
+ */
+struct StructuredLogBuffer {
+    static const size_t CAPACITY = 64 * 1024;
+
+    std::atomic_flag busy;       // Held by the owner while appending, and by close()
+    uint32_t threadIndex;
+    uint32_t session;            // Session the buffered records belong to
+    uint64_t chunkStartMicros;   // Timestamp the first record's delta is relative to
+    uint64_t lastMicros;
+    size_t used;
+    char data[CAPACITY];
+};
+
+/**
+ * @class StructuredLog
+ * @brief Records format ids and typed arguments instead of text
+ *
+ * record() appends a varint-encoded record (format id, time delta, tagged
+ * arguments) to the calling thread's buffer; full buffers go to the file as
+ * one chunk. Nothing is formatted until the log is decoded offline with
+ * "logdecode", which renders the same text the Logger would have printed.
+ *
+ * File layout: the "PSLOG1\n" magic, then chunks of
+ * [thread index][start time in us][byte length][records], all varints.
+ * Thread index 0 holds name definitions and is written immediately.
+ */
+class StructuredLog {
+public:
+    static const size_t MAX_STRING_BYTES = 1024;   // Longer strings are truncated
+
+private:
+    enum ArgumentTag : unsigned char {
+        TAG_UNSIGNED = 1,
+        TAG_SIGNED = 2,
+        TAG_STRING = 3,
+        TAG_NAME = 4
+    };
+
+    static std::atomic<uint32_t> session;   // 0 while closed
+
+    static StructuredLogBuffer* acquireBuffer();
+    static void releaseBuffer(StructuredLogBuffer* buffer) { buffer->busy.clear(std::memory_order_release); }
+    static char* reserve(StructuredLogBuffer* buffer, size_t bytes);
+    static uint64_t elapsedMicros();
+    static uint32_t defineName(const std::string& text);
+
+    static char* putVarint(char* out, uint64_t value) {
+        while (value >= 0x80) {
+            *out++ = static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<char>(value);
+        return out;
+    }
+
+    static char* putString(char* out, const char* text, size_t length) {
+        if (length > MAX_STRING_BYTES) {
+            length = MAX_STRING_BYTES;
+        }
+        *out++ = TAG_STRING;
+        out = putVarint(out, length);
+        std::memcpy(out, text, length);
+        return out + length;
+    }
+
+    // Worst-case encoded size of each argument
+    static size_t bound(const std::string& value) { return 6 + (value.size() < MAX_STRING_BYTES ? value.size() : MAX_STRING_BYTES); }
+    static size_t bound(const char*) { return 6 + MAX_STRING_BYTES; }
+    static size_t bound(const LogName&) { return 6; }
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value, size_t>::type bound(T) { return 11; }
+
+    static size_t boundAll() { return 0; }
+    template <typename T, typename... Rest>
+    static size_t boundAll(const T& first, const Rest&... rest) { return bound(first) + boundAll(rest...); }
+
+    static char* encode(char* out, const std::string& value) { return putString(out, value.data(), value.size()); }
+    static char* encode(char* out, const char* value) { return putString(out, value, std::strlen(value)); }
+    static char* encode(char* out, const LogName& name) {
+        uint32_t current = session.load(std::memory_order_relaxed);
+        uint64_t cached = name.ref.packed.load(std::memory_order_relaxed);
+        uint32_t id = static_cast<uint32_t>(cached);
+        if (static_cast<uint32_t>(cached >> 32) != current) {
+            // Racing threads may both define it; the log stays consistent either way
+            id = defineName(name.text);
+            name.ref.packed.store(LogNameRef::pack(current, id), std::memory_order_relaxed);
+        }
+        *out++ = TAG_NAME;
+        return putVarint(out, id);
+    }
+    template <typename T>
+    static typename std::enable_if<std::is_unsigned<T>::value, char*>::type encode(char* out, T value) {
+        *out++ = TAG_UNSIGNED;
+        return putVarint(out, value);
+    }
+    template <typename T>
+    static typename std::enable_if<std::is_signed<T>::value, char*>::type encode(char* out, T value) {
+        int64_t wide = value;
+        *out++ = TAG_SIGNED;
+        return putVarint(out, (static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63));  // Zigzag
+    }
+
+    static char* encodeAll(char* out) { return out; }
+    template <typename T, typename... Rest>
+    static char* encodeAll(char* out, const T& first, const Rest&... rest) {
+        return encodeAll(encode(out, first), rest...);
+    }
+
+    // Text forms for formatText()
+    static void appendText(std::string& out, const std::string& value) { out += value; }
+    static void appendText(std::string& out, const char* value) { out += value; }
+    static void appendText(std::string& out, const LogName& name) { out += name.text; }
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value>::type appendText(std::string& out, T value) {
+        out += std::to_string(value);
+    }
+
+    static void formatInto(std::string& out, const char* format) { out += format; }
+    template <typename T, typename... Rest>
+    static void formatInto(std::string& out, const char* format, const T& first, const Rest&... rest) {
+        const char* hole = std::strstr(format, "{}");
+        if (!hole) {
+            out += format;
+            return;
+        }
+        out.append(format, hole);
+        appendText(out, first);
+        formatInto(out, hole + 2, rest...);
+    }
+
+public:
+    /**
+     * @brief Start a new binary log, replacing any open one
+     * @param path File to create
+     * @return false if the file could not be opened
+     */
+    static bool open(const std::string& path);
+
+    /**
+     * @brief Write every thread's buffered records and close the file
+     */
+    static void close();
+
+    static bool isOpen() { return session.load(std::memory_order_relaxed) != 0; }
+
+    /**
+     * @brief Write the calling thread's buffered records to the file
+     */
+    static void flush();
+
+    /**
+     * @brief Append one record for the calling thread
+     * @param format Static format of the message
+     * @param args One argument per "{}": integers, strings or LogName
+     */
+    template <typename... Args>
+    static void record(LogFormat format, const Args&... args) {
+        StructuredLogBuffer* buffer = acquireBuffer();
+        if (!buffer) {
+            return;
+        }
+
+        char* out = reserve(buffer, 16 + boundAll(args...));
+        uint64_t now = elapsedMicros();
+        out = putVarint(out, static_cast<uint16_t>(format));
+        out = putVarint(out, now - buffer->lastMicros);
+        buffer->lastMicros = now;
+        out = encodeAll(out, args...);
+        buffer->used = static_cast<size_t>(out - buffer->data);
+        releaseBuffer(buffer);
+    }
+
+    /**
+     * @brief Render a record as text, exactly as the decoder would
+     */
+    template <typename... Args>
+    static std::string formatText(LogFormat format, const Args&... args) {
+        std::string text;
+        formatInto(text, getFormat(format), args...);
+        return text;
+    }
+
+    static const char* getFormat(LogFormat format);
+
+    /**
+     * @brief Render a binary log as text, one line per record in time order
+     * @param in Log file contents
+     * @param out Receives lines of the form "+<seconds>s t<thread> <text>"
+     * @return Number of records decoded, or -1 if the data is not a valid log
+     */
+    static long decode(std::istream& in, std::ostream& out);
+};
+
+// Structured call site: at an enabled level the record goes to the binary log
+// when one is open, otherwise it is formatted and logged as text.
+#define LOG_EVENT(component, level, format, ...) do { \
+        if (LOG_COMPONENT_ENABLED(component, level)) { \
+            if (StructuredLog::isOpen()) { \
+                StructuredLog::record(LogFormat::format, ##__VA_ARGS__); \
+            } else { \
+                Logger::write(StructuredLog::formatText(LogFormat::format, ##__VA_ARGS__)); \
+            } \
+        } \
+    } while (0)
+
+#endif // STRUCTUREDLOG_H
@@ -0,0 +1,118 @@
+/**
+ * @file SubstringSearcher.cpp
+ * @brief Implementation of SubstringSearcher
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-08
+ */
+
+#include "SubstringSearcher.h"
+
+namespace {
+
+// ASCII uppercase folding without locale lookups
+struct FoldTable {
+    unsigned char upper[256];
+
+    FoldTable() {
+        for (int b = 0; b < 256; b++) {
+            upper[b] = static_cast<unsigned char>(b >= 'a' && b <= 'z' ? b - 'a' + 'A' : b);
+        }
+    }
+};
+
+const FoldTable fold;
+
+} // namespace
+
+SubstringSearcher::SubstringSearcher(const std::vector<std::string>& needles)
+    : minLength(0), blockSize(1) {
+
+    for (const std::string& needle : needles) {
+        if (needle.empty()) continue;
+
+        std::string folded;
+        for (char c : needle) {
+            folded.push_back(static_cast<char>(fold.upper[static_cast<unsigned char>(c)]));
+        }
+        if (patterns.empty() || folded.length() < minLength) {
+            minLength = folded.length();
+        }
+        patterns.push_back(folded);
+    }
+
+    if (patterns.empty()) {
+        return;
+    }
+
+    blockSize = minLength >= 2 ? 2 : 1;
+
+    // Only the first minLength bytes of each pattern take part in shifting
+    size_t defaultShift = minLength - blockSize + 1;
+    shift.assign(TABLE_SIZE, static_cast<unsigned char>(defaultShift < 255 ? defaultShift : 255));
+    bucketHead.assign(TABLE_SIZE, -1);
+    bucketNext.assign(patterns.size(), -1);
+
+    for (size_t p = patterns.size(); p-- > 0;) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(patterns[p].data());
+        for (size_t end = blockSize - 1; end < minLength; end++) {
+            size_t hash = blockHash(bytes, end);
+            size_t distance = minLength - 1 - end;
+            if (distance < shift[hash]) {
+                shift[hash] = static_cast<unsigned char>(distance);
+            }
+        }
+
+        // Prepend so each bucket stays in list order
+        size_t hash = blockHash(bytes, minLength - 1);
+        bucketNext[p] = bucketHead[hash];
+        bucketHead[hash] = static_cast<int>(p);
+    }
+}
+
+size_t SubstringSearcher::blockHash(const unsigned char* folded, size_t end) const {
+    size_t hash = folded[end];
+    if (blockSize == 2) {
+        hash = (static_cast<size_t>(folded[end - 1]) << 5) ^ hash;
+    }
+    return hash & (TABLE_SIZE - 1);
+}
+
+int SubstringSearcher::search(const char* data, size_t length) const {
+    if (patterns.empty() || length < minLength) {
+        return -1;
+    }
+
+    const unsigned char* text = reinterpret_cast<const unsigned char*>(data);
+    size_t pos = minLength - 1;   // Last byte of the current window
+
+    while (pos < length) {
+        unsigned char block[2];
+        block[1] = fold.upper[text[pos]];
+        if (blockSize == 2) block[0] = fold.upper[text[pos - 1]];
+        size_t hash = blockHash(block + 2 - blockSize, blockSize - 1);
+
+        size_t distance = shift[hash];
+        if (distance) {
+            pos += distance;
+            continue;
+        }
+
+        // Window may start a pattern: verify the candidates in this bucket
+        size_t start = pos + 1 - minLength;
+        for (int p = bucketHead[hash]; p >= 0; p = bucketNext[p]) {
+            const std::string& pattern = patterns[p];
+            if (start + pattern.length() > length) continue;
+
+            size_t i = 0;
+            while (i < pattern.length() &&
+                   fold.upper[text[start + i]] == static_cast<unsigned char>(pattern[i])) {
+                i++;
+            }
+            if (i == pattern.length()) {
+                return p;
+            }
+        }
+        pos++;
+    }
+    return -1;
+}
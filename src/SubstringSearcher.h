@@ -0,0 +1,62 @@
+/**
+ * @file SubstringSearcher.h
+ * @brief Precompiled case-insensitive multi-substring search (Wu-Manber / set Horspool)
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-08
+ */
+
+#ifndef SUBSTRINGSEARCHER_H
+#define SUBSTRINGSEARCHER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @class SubstringSearcher
+ * @brief Finds any of a fixed set of substrings, ignoring ASCII case
+ *
+ * Patterns are case-folded once and share one Horspool-style shift table
+ * keyed by a hash of the last two bytes of the search window (Wu-Manber),
+ * so a single pass over the text checks every pattern. search() runs
+ * directly on the caller's bytes through a static folding table and never
+ * allocates.
+ */
+class SubstringSearcher {
+private:
+    static const size_t TABLE_SIZE = 4096;
+
+    std::vector<std::string> patterns;      // Uppercased patterns
+    std::vector<unsigned char> shift;       // Safe shift per block hash
+    std::vector<int> bucketHead;            // First pattern whose prefix ends in each block hash
+    std::vector<int> bucketNext;            // Next pattern in the same bucket
+    size_t minLength;                       // Shortest pattern length
+    size_t blockSize;                       // 2, or 1 if a pattern has a single byte
+
+    size_t blockHash(const unsigned char* folded, size_t end) const;
+
+public:
+    SubstringSearcher() : minLength(0), blockSize(1) {}
+
+    /**
+     * @brief Compile a set of patterns
+     * @param needles Patterns to look for (any case, empty ones are ignored)
+     *
+     * Pattern indexes returned by search() follow the order of @p needles
+     * with empty entries skipped.
+     */
+    explicit SubstringSearcher(const std::vector<std::string>& needles);
+
+    /**
+     * @brief Find a pattern contained in the text
+     * @param data First byte of the text
+     * @param length Number of bytes
+     * @return Index of the pattern that starts earliest, or -1 if none occurs
+     */
+    int search(const char* data, size_t length) const;
+
+    int search(const std::string& text) const { return search(text.data(), text.length()); }
+
+    size_t size() const { return patterns.size(); }
+};
+
+#endif // SUBSTRINGSEARCHER_H
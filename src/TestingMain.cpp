@@ -17,6 +17,58 @@
 #include "SaveMessageCommand.h"
 #include "Logger.h"
 #include "ValidationStrategy.h"
+#include "BlockList.h"
+#include "VerdictCache.h"
+#include "ThreadPool.h"
+#include "ProfanityAutomaton.h"
+#include "StringInterner.h"
+#include "SubstringSearcher.h"
+#include "RateLimiter.h"
+#include "RoomSet.h"
+#include "ShardRing.h"
+#include "ShardRouter.h"
+#include "ShardWorker.h"
+#include "TimingWheel.h"
+#include "StructuredLog.h"
+#include "LogFileSink.h"
+#include "SendPipeline.h"
+#include "TimerService.h"
+#include "UserTable.h"
+#include "CommandJournal.h"
+#include "CommandScheduler.h"
+#include "CommandExecutor.h"
+#include "CommandQueue.h"
+#include "CommandVariant.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <cstdio>
+#include <unistd.h>
+
+// Count heap allocations so tests can check hot paths stay allocation-free
+std::atomic<unsigned long> allocationCount(0);
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
 
 void printSeparator(const std::string& title) {
     std::cout << "\n" << std::string(50, '=') << std::endl;
@@ -813,6 +865,2410 @@ void testToStringMethods() {
     delete room2;
 }
 
+// ================== BLOCK LIST RELOAD TEST ==================
+void testBlockListReload() {
+    printSeparator("BLOCK LIST RELOAD TEST");
+    
+    FreeUserValidationStrategy freeStrategy;
+    PremiumUserValidationStrategy premiumStrategy;
+    AdminUserValidationStrategy adminStrategy;
+    
+    std::cout << "\n--- Default Lists ---" << std::endl;
+    assert(!freeStrategy.validateMessage("you are stupid", "Tester"));
+    assert(freeStrategy.validateMessage("what a lovely cat", "Tester"));
+    unsigned long before = BlockListRegistry::getVersion();
+    
+    std::cout << "\n--- Reload From Files ---" << std::endl;
+    {
+        std::ofstream freeFile("test_free_blocklist.txt");
+        freeFile << "# test list\nlovely\n\n  mean-spirited  \n";
+        std::ofstream premiumFile("test_premium_blocklist.txt");
+        premiumFile << "grumpy\n";
+        std::ofstream adminFile("test_admin_threats.txt");
+        adminFile << "halt now\n";
+    }
+    
+    bool loaded = BlockListRegistry::loadFromFiles("test_free_blocklist.txt",
+                                                   "test_premium_blocklist.txt",
+                                                   "test_admin_threats.txt");
+    assert(loaded);
+    assert(BlockListRegistry::getVersion() > before);
+    
+    assert(freeStrategy.validateMessage("you are stupid", "Tester"));
+    assert(!freeStrategy.validateMessage("what a LOVELY cat", "Tester"));
+    assert(!freeStrategy.validateMessage("so mean-spirited!", "Tester"));
+    assert(freeStrategy.validateMessage("lovelyness is fine", "Tester"));
+    assert(!premiumStrategy.validateMessage("my dog is grumpy today", "Tester"));
+    assert(!adminStrategy.validateMessage("Halt Now please", "Tester"));
+    assert(adminStrategy.validateMessage("shutdown", "Tester"));
+    
+    std::cout << "\n--- Missing File Keeps Current Lists ---" << std::endl;
+    assert(!BlockListRegistry::loadFromFiles("missing.txt", "missing.txt", "missing.txt"));
+    assert(!freeStrategy.validateMessage("lovely", "Tester"));
+    
+    std::cout << "\n--- Reset To Defaults ---" << std::endl;
+    BlockListRegistry::resetToDefaults();
+    assert(!freeStrategy.validateMessage("you are stupid", "Tester"));
+    assert(freeStrategy.validateMessage("what a lovely cat", "Tester"));
+    
+    std::cout << "\n--- Config Directory ---" << std::endl;
+    std::rename("test_free_blocklist.txt", "free_blocklist.txt");
+    std::rename("test_premium_blocklist.txt", "premium_blocklist.txt");
+    std::rename("test_admin_threats.txt", "admin_threats.txt");
+    setenv("PETSPACE_CONFIG_DIR", ".", 1);
+    BlockListRegistry::reloadFromConfig();
+    assert(!freeStrategy.validateMessage("what a lovely cat", "Tester"));
+    assert(freeStrategy.validateMessage("you are stupid", "Tester"));
+    
+    std::remove("free_blocklist.txt");
+    BlockListRegistry::reloadFromConfig();   // Falls back to the built-ins
+    assert(!freeStrategy.validateMessage("you are stupid", "Tester"));
+    assert(freeStrategy.validateMessage("what a lovely cat", "Tester"));
+    
+    unsetenv("PETSPACE_CONFIG_DIR");
+    BlockListRegistry::reloadFromConfig();
+    assert(!freeStrategy.validateMessage("you are stupid", "Tester"));
+    
+    std::cout << "\n--- Reset Ignores The Config Directory ---" << std::endl;
+    setenv("PETSPACE_CONFIG_DIR", ".", 1);
+    {
+        std::ofstream freeFile("free_blocklist.txt");
+        freeFile << "lovely\n";   // "stupid" isn't in it
+    }
+    BlockListRegistry::reloadFromConfig();
+    assert(freeStrategy.validateMessage("you are stupid", "Tester"));
+    BlockListRegistry::resetToDefaults();
+    assert(!freeStrategy.validateMessage("you are stupid", "Tester"));
+    unsetenv("PETSPACE_CONFIG_DIR");
+    
+    std::remove("free_blocklist.txt");
+    std::remove("premium_blocklist.txt");
+    std::remove("admin_threats.txt");
+}
+
+// ================== VERDICT CACHE TEST ==================
+void testVerdictCache() {
+    printSeparator("VERDICT CACHE TEST");
+    
+    VerdictCache::enable(1024);
+    VerdictCache::resetStats();
+    
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* spammer = new PremiumUser("Spammer");
+    PremiumUser* other = new PremiumUser("Other");
+    room->registerUser(spammer);
+    room->registerUser(other);
+    
+    std::cout << "\n--- Repeated Messages Hit The Cache ---" << std::endl;
+    for (int i = 0; i < 5; i++) {
+        spammer->send("Buy cat food now", room);
+    }
+    other->send("Buy cat food now", room);
+    VerdictCacheStats stats = VerdictCache::getStats();
+    assert(stats.misses == 1);
+    assert(stats.hits == 5);
+    std::cout << "Hit rate: " << stats.hitRate() << std::endl;
+    
+    std::cout << "\n--- Blocked Verdicts Keep Their Reason ---" << std::endl;
+    assert(!spammer->send("what the shit", room));
+    assert(!other->send("what the shit", room));
+    
+    std::cout << "\n--- Block List Reload Invalidates ---" << std::endl;
+    BlockListRegistry::resetToDefaults();
+    VerdictCache::resetStats();
+    assert(!spammer->send("what the shit", room));
+    assert(VerdictCache::getStats().hits == 0);
+    
+    std::cout << "\n--- Strategy Swap Keeps Shared Verdicts ---" << std::endl;
+    spammer->send("Hello again", room);
+    spammer->setValidationStrategy(new PremiumUserValidationStrategy());
+    VerdictCache::resetStats();
+    spammer->send("Hello again", room);
+    assert(VerdictCache::getStats().hits == 1);
+    assert(VerdictCache::getStats().misses == 0);
+    
+    std::cout << "\n--- Explicit Invalidate ---" << std::endl;
+    VerdictCache::invalidate(spammer->getValidationStrategy()->getCacheKey());
+    VerdictCache::resetStats();
+    spammer->send("Hello again", room);
+    assert(VerdictCache::getStats().hits == 0);
+    
+    std::cout << "\n--- Hits Compare The Text ---" << std::endl;
+    VerdictCacheStats beforeStore = VerdictCache::getStats();
+    VerdictCache::store(2, "abcd", BlockListRegistry::getVersion(), ValidationVerdict::PROFANITY);
+    ValidationVerdict cached = ValidationVerdict::APPROVED;
+    assert(!VerdictCache::lookup(2, "abce", BlockListRegistry::getVersion(), cached));
+    assert(VerdictCache::lookup(2, "abcd", BlockListRegistry::getVersion(), cached));
+    assert(cached == ValidationVerdict::PROFANITY);
+    assert(VerdictCache::getStats().insertions == beforeStore.insertions + 1);
+    
+    std::cout << "\n--- Tiny Cache Evicts ---" << std::endl;
+    VerdictCache::enable(1);
+    VerdictCache::resetStats();
+    Logger::setLevel(NONE);
+    for (int i = 0; i < 200; i++) {
+        spammer->send("Distinct message " + std::to_string(i), room);
+    }
+    Logger::setLevel(USER_ONLY);
+    assert(VerdictCache::getStats().evictions > 0);
+    
+    VerdictCache::disable();
+    delete spammer;
+    delete other;
+    delete room;
+}
+
+// ================== BATCH VALIDATION TEST ==================
+void testBatchValidation() {
+    printSeparator("BATCH VALIDATION TEST");
+    
+    FreeUserValidationStrategy strategy;
+    ThreadPool pool(3);
+    
+    std::vector<std::string> messages;
+    std::vector<std::string> senders;
+    for (int i = 0; i < 2000; i++) {
+        switch (i % 4) {
+            case 0: messages.push_back("Hello number " + std::to_string(i)); break;
+            case 1: messages.push_back("this is stupid"); break;
+            case 2: messages.push_back("STOP SHOUTING"); break;
+            default: messages.push_back(""); break;
+        }
+        senders.push_back("Sender" + std::to_string(i));
+    }
+    
+    std::cout << "\n--- Verdicts Match Serial Validation ---" << std::endl;
+    BatchValidationResult result = strategy.validateBatch(&messages[0], messages.size(), &senders[0], &pool);
+    assert(result.verdicts.size() == messages.size());
+    for (size_t i = 0; i < messages.size(); i++) {
+        assert(result.verdicts[i] == strategy.evaluate(messages[i]));
+    }
+    assert(result.approvedCount == 500);
+    assert(!result.allApproved());
+    assert(result.verdictCounts[static_cast<int>(ValidationVerdict::PROFANITY)] == 500);
+    assert(result.verdictCounts[static_cast<int>(ValidationVerdict::EXCESSIVE_CAPS)] == 500);
+    assert(result.verdictCounts[static_cast<int>(ValidationVerdict::EMPTY_MESSAGE)] == 500);
+    std::cout << "Approved " << result.approvedCount << " of " << messages.size() << std::endl;
+    
+    std::cout << "\n--- Sender Names Are Validated ---" << std::endl;
+    senders[0] = "";
+    senders[4] = "Stupid Cat";
+    senders[8] = std::string(100, 'n');
+    senders[12] = "Tab\tName";
+    result = strategy.validateBatch(&messages[0], messages.size(), &senders[0], &pool);
+    for (size_t i = 0; i <= 12; i += 4) {
+        assert(result.verdicts[i] == ValidationVerdict::INVALID_NAME);
+    }
+    assert(result.verdictCounts[static_cast<int>(ValidationVerdict::INVALID_NAME)] == 4);
+    assert(result.approvedCount == 496);
+    assert(strategy.evaluateName("Whiskers") == ValidationVerdict::APPROVED);
+    
+    std::cout << "\n--- Empty Batch ---" << std::endl;
+    BatchValidationResult empty = strategy.validateBatch(nullptr, 0, nullptr, &pool);
+    assert(empty.verdicts.empty() && empty.allApproved());
+}
+
+// ================== OBFUSCATED PROFANITY TEST ==================
+void testObfuscatedProfanity() {
+    printSeparator("OBFUSCATED PROFANITY TEST");
+    
+    std::vector<std::string> terms;
+    terms.push_back("stupid");
+    terms.push_back("hell");
+    terms.push_back("shit");
+    terms.push_back("mean-spirited");
+    ProfanityAutomaton automaton(terms);
+    std::cout << "States: " << automaton.getStateCount() << ", classes: " << automaton.getClassCount() << std::endl;
+    
+    std::cout << "\n--- Plain Words Behave As Before ---" << std::endl;
+    std::string found;
+    assert(automaton.matches("you are stupid", &found) && found == "stupid");
+    assert(automaton.matches("STUPID!", nullptr));
+    assert(!automaton.matches("stupidity is not a word here", nullptr));
+    assert(!automaton.matches("hello shell", nullptr));
+    assert(!automaton.matches("", nullptr));
+    
+    std::cout << "\n--- Leetspeak, Separators And Case ---" << std::endl;
+    assert(automaton.matches("you are $tup1d", nullptr));
+    assert(automaton.matches("S.H.I.T happens", &found) && found == "shit");
+    assert(automaton.matches("sh!t", nullptr));
+    assert(automaton.matches("what the h3ll", nullptr));
+    assert(automaton.matches("what the h-e_l~l?", nullptr));
+    assert(automaton.matches("sh*t", nullptr));
+    assert(automaton.matches("so meanspirited", nullptr));
+    assert(automaton.matches("so MEAN-spirited", nullptr));
+    
+    std::cout << "\n--- No False Positives Across Words ---" << std::endl;
+    assert(!automaton.matches("he'll be fine", nullptr));
+    assert(!automaton.matches("has hit the ball", nullptr));
+    assert(!automaton.matches("a$hit", nullptr));
+    
+    std::cout << "\n--- A Capped Table Matches Like The Full One ---" << std::endl;
+    ProfanityAutomaton capped(terms, 2);   // Nearly everything continues on the trie
+    assert(capped.getStateCount() <= 2 && automaton.getStateCount() > 2);
+    const char* samples[] = {
+        "you are stupid", "STUPID!", "stupidity is not a word here", "hello shell", "",
+        "you are $tup1d", "S.H.I.T happens", "sh!t", "what the h-e_l~l?", "sh*t",
+        "so MEAN-spirited", "he'll be fine", "has hit the ball", "a$hit", "a.shit"
+    };
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        std::string fullTerm;
+        std::string cappedTerm;
+        assert(automaton.matches(samples[i], &fullTerm) == capped.matches(samples[i], &cappedTerm));
+        assert(fullTerm == cappedTerm);
+    }
+    
+    std::cout << "\n--- 50k Terms Compile In Linear Space ---" << std::endl;
+    std::vector<std::string> largeList;
+    size_t letters = 0;
+    uint32_t seed = 2463534242u;
+    for (size_t i = 0; i < 50000; i++) {
+        std::string word;
+        seed = seed * 1103515245u + 12345u;
+        size_t length = 4 + (seed >> 16) % 6;   // 4-9 letters
+        for (size_t c = 0; c < length; c++) {
+            seed = seed * 1103515245u + 12345u;
+            word.push_back(static_cast<char>('a' + (seed >> 16) % 26));
+        }
+        letters += word.size();
+        largeList.push_back(word);
+    }
+    std::chrono::steady_clock::time_point compileStart = std::chrono::steady_clock::now();
+    ProfanityAutomaton large(largeList);
+    double compileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - compileStart).count();
+    std::cout << "Compiled " << large.size() << " terms in " << compileSeconds << " s: " << large.getNodeCount()
+              << " trie nodes, " << large.getStateCount() << " table states" << std::endl;
+    assert(compileSeconds < 10.0);
+    assert(large.getNodeCount() <= letters + 1);
+    assert(large.getStateCount() <= ProfanityAutomaton::DEFAULT_MAX_DFA_STATES);
+    std::string shouted = largeList[31337];
+    std::transform(shouted.begin(), shouted.end(), shouted.begin(), ::toupper);
+    assert(large.matches("well " + shouted + "!", &found) && found == largeList[31337]);
+    assert(!large.matches("abcdefghijklmnop qrstuvwxyzabcdef", nullptr));
+    
+    std::cout << "\n--- Strategies Use The Automaton ---" << std::endl;
+    FreeUserValidationStrategy freeStrategy;
+    PremiumUserValidationStrategy premiumStrategy;
+    assert(!freeStrategy.validateMessage("you are $tup1d", "Tester"));
+    assert(!premiumStrategy.validateMessage("f*ck this", "Tester"));
+    assert(premiumStrategy.validateMessage("you are $tup1d", "Tester"));
+}
+
+// ================== THREAT SEARCHER TEST ==================
+void testSubstringSearcher() {
+    printSeparator("THREAT SEARCHER TEST");
+    
+    std::vector<std::string> needles;
+    needles.push_back("DROP TABLE");
+    needles.push_back("");
+    needles.push_back("rm -rf");
+    needles.push_back("abcabd");
+    SubstringSearcher searcher(needles);
+    assert(searcher.size() == 3);
+    
+    std::cout << "\n--- Case-Insensitive Matches ---" << std::endl;
+    assert(searcher.search("please drop table users") == 0);
+    assert(searcher.search("sudo RM -RF /") == 1);
+    assert(searcher.search("xxabcabcabdxx") == 2);
+    assert(searcher.search("ABCABD") == 2);
+    assert(searcher.search("drop tables are substrings too") == 0);
+    
+    std::cout << "\n--- Misses And Short Texts ---" << std::endl;
+    assert(searcher.search("drop-table") == -1);
+    assert(searcher.search("rm") == -1);
+    assert(searcher.search("") == -1);
+    assert(searcher.search("abcab") == -1);
+    
+    std::cout << "\n--- Admin Strategy ---" << std::endl;
+    AdminUserValidationStrategy admin;
+    std::string longClean(1990, 'a');
+    assert(admin.validateMessage(longClean + " reboo", "Admin"));
+    assert(!admin.validateMessage(longClean + " ReBoOt", "Admin"));
+}
+
+// ================== RATE LIMITER TEST ==================
+static uint64_t fakeClockMillis = 0;
+
+static uint64_t fakeClock() {
+    return fakeClockMillis;
+}
+
+void testRateLimiter() {
+    printSeparator("RATE LIMITER TEST");
+    RateLimiter::setClock(fakeClock);
+    fakeClockMillis = 1000;
+    
+    std::cout << "\n--- Token Bucket Refill ---" << std::endl;
+    RateLimitPolicy burst = {3, 3000};  // One token back per second
+    RateLimiter::setPolicy(UserType::PREMIUM, burst);
+    TokenBucket bucket;
+    assert(RateLimiter::getRemaining(bucket, UserType::PREMIUM) == 3);
+    assert(RateLimiter::tryConsume(bucket, UserType::PREMIUM));
+    assert(RateLimiter::tryConsume(bucket, UserType::PREMIUM));
+    assert(RateLimiter::tryConsume(bucket, UserType::PREMIUM));
+    assert(!RateLimiter::tryConsume(bucket, UserType::PREMIUM));
+    assert(RateLimiter::getRemaining(bucket, UserType::PREMIUM) == 0);
+    assert(RateLimiter::millisUntilAvailable(bucket, UserType::PREMIUM) == 1000);
+    fakeClockMillis += 999;
+    assert(!RateLimiter::canConsume(bucket, UserType::PREMIUM));
+    fakeClockMillis += 1;
+    assert(RateLimiter::getRemaining(bucket, UserType::PREMIUM) == 1);
+    fakeClockMillis += 10000;
+    assert(RateLimiter::getRemaining(bucket, UserType::PREMIUM) == 3);
+    assert(RateLimiter::getRemaining(bucket, UserType::ADMIN) == 0xFFFFFFFFu);
+    assert(RateLimiter::tryConsume(bucket, UserType::ADMIN));
+    
+    std::cout << "\n--- Per-Type Limits On Users ---" << std::endl;
+    ChatRoom* room = new CtrlCat();
+    FreeUser* free = new FreeUser("QuotaFree");
+    PremiumUser* premium = new PremiumUser("QuotaPremium");
+    room->registerUser(free);
+    room->registerUser(premium);
+    for (int i = 0; i < 3; i++) {
+        assert(premium->send("burst " + std::to_string(i), room));
+    }
+    assert(!premium->send("one too many", room));
+    fakeClockMillis += 1000;
+    assert(premium->send("after a second", room));
+    
+    for (int i = 0; i < free->getDailyMessageLimit(); i++) {
+        assert(free->send("daily " + std::to_string(i), room));
+    }
+    assert(free->getDailyMessageCount() == free->getDailyMessageLimit());
+    assert(!free->send("over the limit", room));
+    assert(!free->send("still over", room));
+    assert(RateLimiter::getPendingEventCount() == 1);  // One notice, not one per attempt
+    
+    std::cout << "\n--- Lazy Refill And Notice ---" << std::endl;
+    Logger::setLevel(BASIC);
+    fakeClockMillis += 24ULL * 60 * 60 * 1000 / 10 - 1;
+    assert(RateLimiter::processEvents() == 0);
+    fakeClockMillis += 100;
+    assert(RateLimiter::processEvents() == 1);
+    Logger::setLevel(USER_ONLY);
+    assert(free->getDailyMessageCount() == free->getDailyMessageLimit() - 1);
+    assert(free->send("one token back", room));
+    assert(!free->send("empty again", room));
+    free->resetDailyCount();
+    assert(RateLimiter::getPendingEventCount() == 0);
+    assert(free->getDailyMessageCount() == 0);
+    assert(free->send("after reset", room));
+    
+    std::cout << "\n--- Timing Wheel ---" << std::endl;
+    TimingWheel wheel(10, 0);
+    std::vector<int> order;
+    wheel.schedule(50, [&order]() { order.push_back(1); });
+    uint64_t cancelled = wheel.schedule(60, [&order]() { order.push_back(99); });
+    wheel.schedule(700, [&order]() { order.push_back(2); });
+    wheel.schedule(5000000, [&order]() { order.push_back(3); });   // Several levels up
+    wheel.schedule(200000000000ULL, [&order]() { order.push_back(4); });  // Beyond the top level
+    assert(wheel.cancel(cancelled));
+    assert(!wheel.cancel(cancelled));
+    assert(wheel.getPendingCount() == 4);
+    assert(wheel.advanceTo(49) == 0);
+    assert(wheel.advanceTo(50) == 1);
+    assert(wheel.advanceTo(699) == 0);
+    assert(wheel.advanceTo(700) == 1);
+    assert(wheel.advanceTo(4999999) == 0);
+    assert(wheel.advanceTo(5000000) == 1);
+    wheel.schedule(10, [&wheel, &order]() {
+        wheel.schedule(10, [&order]() { order.push_back(6); });
+        order.push_back(5);
+    });
+    assert(wheel.advanceTo(5000020) == 2);
+    assert(wheel.getPendingCount() == 1);
+    assert(order.size() == 5 && order[0] == 1 && order[1] == 2 && order[2] == 3 &&
+           order[3] == 5 && order[4] == 6);
+    assert(wheel.advanceTo(200000000000ULL) == 1);
+    assert(order.back() == 4);
+    
+    delete free;
+    delete premium;
+    delete room;
+    RateLimiter::setPolicy(UserType::PREMIUM, RateLimitPolicy{0, 0});
+    RateLimiter::setClock(nullptr);
+}
+
+// ================== ASYNC LOGGER TEST ==================
+void testAsyncLogger() {
+    printSeparator("ASYNC LOGGER TEST");
+    
+    // Capture std::cout so the background thread's output can be checked
+    std::stringstream captured;
+    std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+    
+    Logger::resetStats();
+    Logger::startAsync(64);
+    assert(Logger::isAsync());
+    for (int i = 0; i < 500; i++) {
+        Logger::user("line " + std::to_string(i));
+    }
+    Logger::flush();
+    
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++) {
+        producers.push_back(std::thread([t]() {
+            for (int i = 0; i < 250; i++) {
+                Logger::user("thread " + std::to_string(t) + " " + std::to_string(i));
+            }
+        }));
+    }
+    for (size_t t = 0; t < producers.size(); t++) {
+        producers[t].join();
+    }
+    Logger::stopAsync();   // Drains whatever is still buffered
+    assert(!Logger::isAsync());
+    
+    LoggerStats stats = Logger::getStats();
+    assert(stats.written == 1500);
+    assert(stats.dropped == 0);
+    assert(stats.batches <= stats.written);
+    
+    // Records from one producer keep their order
+    std::string line;
+    int nextSerial = 0;
+    int nextPerThread[4] = {0, 0, 0, 0};
+    int lines = 0;
+    while (std::getline(captured, line)) {
+        lines++;
+        if (line.compare(0, 5, "line ") == 0) {
+            assert(std::stoi(line.substr(5)) == nextSerial++);
+        } else {
+            int t = line[7] - '0';
+            assert(std::stoi(line.substr(9)) == nextPerThread[t]++);
+        }
+    }
+    assert(lines == 1500 && nextSerial == 500);
+    
+    // Dropping never blocks; every record is either written or counted
+    Logger::resetStats();
+    Logger::startAsync(2, LogOverflowPolicy::DROP);
+    for (int i = 0; i < 2000; i++) {
+        Logger::user("maybe dropped");
+    }
+    Logger::stopAsync();
+    stats = Logger::getStats();
+    assert(stats.written + stats.dropped == 2000);
+    
+    std::cout.rdbuf(original);
+    std::cout << "Async records written: 1500 in order" << std::endl;
+}
+
+// ================== LAZY LOGGING TEST ==================
+void testLazyLogging() {
+    printSeparator("LAZY LOGGING TEST");
+    
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* sender = new PremiumUser("Lazy");
+    AdminUser* listener = new AdminUser("Listener");
+    room->registerUser(sender);
+    room->registerUser(listener);
+    std::string name = "SomeoneWithALongName";
+    
+    std::cout << "\n--- Disabled Levels Never Format ---" << std::endl;
+    Logger::setLevel(NONE);
+    int evaluated = 0;
+    LOG_DEBUG("never built " + std::to_string(++evaluated));
+    LOG_USER("never built " + std::to_string(++evaluated));
+    assert(evaluated == 0);
+    
+    unsigned long before = allocationCount.load();
+    for (int i = 0; i < 100; i++) {
+        LOG_DEBUG("[" + name + "] Sending message: \"" + name + name + "\"");
+        LOG_INFO(name + " joined PetSpace (Premium User - unlimited messages)");
+        room->sendMessage("hi", sender);   // Short message: no copy allocates
+    }
+    unsigned long logAllocations = allocationCount.load() - before;
+    std::cout << "Allocations at NONE: " << logAllocations << std::endl;
+    assert(logAllocations == 0);
+    
+    std::cout << "\n--- Enabled Levels Still Log ---" << std::endl;
+    Logger::setLevel(USER_ONLY);
+    LOG_USER(name + ": visible " + std::to_string(++evaluated));
+    LOG_DEBUG("hidden " + std::to_string(++evaluated));
+    assert(evaluated == 1);
+    assert(LOG_ENABLED(USER_ONLY) && !LOG_ENABLED(BASIC));
+    
+    delete sender;
+    delete listener;
+    delete room;
+}
+
+// ================== STRUCTURED LOG TEST ==================
+void testStructuredLog() {
+    printSeparator("STRUCTURED LOG TEST");
+    
+    std::cout << "\n--- Text Rendering Matches Logger Lines ---" << std::endl;
+    std::string alice = "Alice";
+    LogNameRef aliceRef;
+    assert(StructuredLog::formatText(LogFormat::SENDING_MESSAGE, LogName(alice, aliceRef), "hi") ==
+           "[Alice] Sending message: \"hi\"");
+    assert(StructuredLog::formatText(LogFormat::MESSAGES_USED, LogName(alice, aliceRef), -3, 10u) ==
+           "[Alice] Messages used today: -3/10");
+    assert(StructuredLog::formatText(LogFormat::SEND_EXECUTING) ==
+           "[SendMessageCommand] Executing - sending message to all users");
+    
+    std::cout << "\n--- Binary Records Replace Text ---" << std::endl;
+    const char* path = "structured_test.pslog";
+    assert(StructuredLog::open(path));
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* sender = new PremiumUser("Binary");
+    PremiumUser* listener = new PremiumUser("Listener");
+    room->registerUser(sender);
+    room->registerUser(listener);
+    
+    std::stringstream captured;
+    std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+    Logger::setLevel(DEBUG);
+    sender->send("hello binary", room);
+    std::thread other([sender]() {
+        for (int i = 0; i < 1000; i++) {
+            LOG_EVENT(USER, DEBUG, EXECUTING_COMMANDS, sender->getLogName(), i);
+        }
+    });
+    other.join();
+    LOG_EVENT(USER, DEBUG, MESSAGES_USED, sender->getLogName(), -1, 5);
+    Logger::setLevel(USER_ONLY);
+    std::cout.rdbuf(original);
+    StructuredLog::close();
+    assert(!StructuredLog::isOpen());
+    assert(captured.str().find("Sending message") == std::string::npos);
+    assert(captured.str().find("Binary: hello binary") != std::string::npos);
+    
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream decoded;
+    long records = StructuredLog::decode(in, decoded);
+    in.close();
+    std::remove(path);
+    std::cout << "Decoded records: " << records << std::endl;
+    assert(records > 1000);
+    
+    std::string text = decoded.str();
+    assert(text.find(" [Binary] Sending message: \"hello binary\"\n") != std::string::npos);
+    assert(text.find(" [Listener] Received message from Binary (Premium)\n") != std::string::npos);
+    assert(text.find(" [Binary] Executing 999 commands...\n") != std::string::npos);
+    assert(text.find(" [Binary] Messages used today: -1/5\n") != std::string::npos);
+    
+    std::cout << "\n--- Closed Log Records Nothing ---" << std::endl;
+    StructuredLog::record(LogFormat::SEND_COMPLETED);
+    std::stringstream junk("not a log");
+    assert(StructuredLog::decode(junk, decoded) == -1);
+
+    std::cout << "\n--- Corrupt Name Definitions Are Rejected ---" << std::endl;
+    // Chunk header (thread, micros, length), then format 0 with a bad id or a swapped tag
+    const char skippedId[] = "PSLOG1\n\x00\x00\x09\x00\x00\x01\xC0\x84\x3D\x03\x01x";
+    const char swappedTags[] = "PSLOG1\n\x00\x00\x08\x00\x00\x03\x01x\x03\x01y";
+    std::stringstream hugeId(std::string(skippedId, sizeof(skippedId) - 1));
+    std::stringstream notANumber(std::string(swappedTags, sizeof(swappedTags) - 1));
+    assert(StructuredLog::decode(hugeId, decoded) == -1);
+    assert(StructuredLog::decode(notANumber, decoded) == -1);
+
+    delete sender;
+    delete listener;
+    delete room;
+}
+
+// ================== COMPONENT LOGGING TEST ==================
+int countOccurrences(const std::string& text, const std::string& needle) {
+    int count = 0;
+    for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+        count++;
+    }
+    return count;
+}
+
+void testComponentLogging() {
+    printSeparator("COMPONENT LOGGING TEST");
+    
+    std::vector<std::string> history;
+    for (int i = 0; i < 100; i++) {
+        history.push_back("message " + std::to_string(i));
+    }
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* user = new PremiumUser("Tracer");
+    room->registerUser(user);
+    
+    std::stringstream captured;
+    std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+    
+    // Global level USER_ONLY: iterators are silent
+    ConcreteAggregate quiet(&history);
+    Iterator* iterator = quiet.createIterator();
+    for (iterator->first(); !iterator->isDone(); iterator->next()) {
+        iterator->currentItem();
+    }
+    delete iterator;
+    assert(captured.str().empty());
+    
+    // Trace only the iterator subsystem, sampling its per-step output
+    Logger::setComponentLevel(LogComponent::ITERATOR, DEBUG);
+    Logger::setSampleRate(LogComponent::ITERATOR, 10);
+    ConcreteAggregate traced(&history);
+    iterator = traced.createIterator();
+    for (iterator->first(); !iterator->isDone(); iterator->next()) {
+        iterator->currentItem();
+    }
+    delete iterator;
+    user->send("not traced", room);
+    std::string trace = captured.str();
+    assert(countOccurrences(trace, "[ConcreteAggregate]") == 2);
+    assert(countOccurrences(trace, "Moved to index") == 10);
+    assert(countOccurrences(trace, "Current item") == 10);
+    assert(trace.find("[ChatRoom]") == std::string::npos);
+    assert(trace.find("Tracer: not traced") != std::string::npos);
+    
+    // A component can also be quieter than the global level
+    captured.str("");
+    Logger::setLevel(DEBUG);
+    Logger::setComponentLevel(LogComponent::VALIDATION, NONE);
+    Logger::setComponentLevel(LogComponent::USER, NONE);
+    Logger::setComponentLevel(LogComponent::CHATROOM, USER_ONLY);
+    Logger::setComponentLevel(LogComponent::COMMAND, NONE);
+    user->send("only the chat line", room);
+    assert(captured.str() == "Tracer: only the chat line\n");
+    
+    Logger::setLevel(USER_ONLY);
+    Logger::resetComponentLevels();
+    assert(Logger::getComponentLevel(LogComponent::ITERATOR) == USER_ONLY);
+    assert(Logger::getSampleRate(LogComponent::ITERATOR) == 1);
+    std::cout.rdbuf(original);
+    std::cout << "Traced " << countOccurrences(trace, "\n") << " iterator lines" << std::endl;
+    
+    delete user;
+    delete room;
+}
+
+// ================== FILE SINK TEST ==================
+std::vector<std::string> readLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream in(path.c_str());
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+void removeLogFiles(const std::string& path, unsigned rotated) {
+    std::remove(path.c_str());
+    for (unsigned i = 1; i <= rotated; i++) {
+        std::remove((path + "." + std::to_string(i)).c_str());
+    }
+}
+
+void testFileSink() {
+    printSeparator("FILE SINK TEST");
+    const std::string path = "filesink_test.log";
+    removeLogFiles(path, 4);
+    
+    std::cout << "\n--- Per-Thread Buffers Keep Thread Order ---" << std::endl;
+    LogFileSinkOptions options(path);
+    options.bufferBytes = 512;
+    assert(Logger::openFileSink(options));
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++) {
+        writers.push_back(std::thread([t]() {
+            for (int i = 0; i < 500; i++) {
+                Logger::user("thread " + std::to_string(t) + " " + std::to_string(i));
+            }
+        }));
+    }
+    for (size_t t = 0; t < writers.size(); t++) {
+        writers[t].join();
+    }
+    Logger::user("from main");
+    Logger::flush();
+    assert(readLines(path).size() == 2001);   // Everything is in the file after flush()
+    LogFileSinkStats stats = Logger::getFileSinkStats();
+    assert(stats.handoffs > 0 && stats.rotations == 0);
+    Logger::closeFileSink();
+    assert(!Logger::hasFileSink());
+    
+    std::vector<std::string> lines = readLines(path);
+    int nextPerThread[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (lines[i] != "from main") {
+            int t = lines[i][7] - '0';
+            assert(std::stoi(lines[i].substr(9)) == nextPerThread[t]++);
+        }
+    }
+    assert(nextPerThread[0] == 500 && nextPerThread[3] == 500);
+    removeLogFiles(path, 0);
+    
+    std::cout << "\n--- Size Rotation Keeps The Newest Files ---" << std::endl;
+    options.maxFileBytes = 2048;
+    options.maxFiles = 2;
+    options.fsyncIntervalMillis = 1;
+    assert(Logger::openFileSink(options));
+    for (int i = 0; i < 1000; i++) {
+        Logger::user("rotating line " + std::to_string(i));
+    }
+    Logger::closeFileSink();
+    std::vector<std::string> newest = readLines(path);
+    std::vector<std::string> older = readLines(path + ".1");
+    assert(!newest.empty() && !older.empty() && readLines(path + ".2").size() > 0);
+    assert(readLines(path + ".3").empty());
+    assert(newest.back() == "rotating line 999");
+    assert(std::stoi(older.back().substr(14)) + 1 == std::stoi(newest.front().substr(14)));
+    removeLogFiles(path, 2);
+    
+    std::cout << "\n--- Time Rotation ---" << std::endl;
+    LogFileSinkOptions timed(path);
+    timed.rotateIntervalMillis = 1;
+    assert(Logger::openFileSink(timed));
+    Logger::user("before");
+    Logger::flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    Logger::user("after");
+    Logger::flush();
+    assert(Logger::getFileSinkStats().rotations >= 1);
+    Logger::closeFileSink();
+    assert(readLines(path).back() == "after");
+    removeLogFiles(path, 5);
+    
+    Logger::user("Console output is back after closing the sink");
+}
+
+
+// ================== COMMAND POOL TEST ==================
+void testCommandPool() {
+    printSeparator("COMMAND POOL TEST");
+    
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* sender = new PremiumUser("Pooled");
+    AdminUser* listener = new AdminUser("PoolListener");
+    room->registerUser(sender);
+    room->registerUser(listener);
+    
+    std::cout << "\n--- Freed Commands Are Reused ---" << std::endl;
+    Command* first = new SendMessageCommand(room, sender, "hi");
+    void* firstAddress = first;
+    delete first;
+    Command* second = new SendMessageCommand(room, sender, "hi");
+    assert(static_cast<void*>(second) == firstAddress);
+    delete second;
+    
+    std::cout << "\n--- Steady State Needs No Heap ---" << std::endl;
+    Logger::setLevel(NONE);
+    CommandQueue queue;
+    for (int i = 0; i < 8; i++) {   // Warm up the free lists
+        queue.push(new SendMessageCommand(room, sender, "hi"));
+        queue.push(new SaveMessageCommand(room, sender, "hi"));
+        queue.discardAll();
+    }
+    size_t capacity = queue.capacity();
+    
+    unsigned long before = allocationCount.load();
+    for (int i = 0; i < 1000; i++) {
+        queue.push(new SendMessageCommand(room, sender, "hi"));
+        queue.push(new SaveMessageCommand(room, sender, "hi"));
+        queue.discardAll();
+        queue.push(new SendMessageCommand(room, sender, "hi"));
+        queue.executeAll();   // Delivers "hi"; nothing is saved
+    }
+    unsigned long commandAllocations = allocationCount.load() - before;
+    std::cout << "Allocations for 3000 commands: " << commandAllocations << std::endl;
+    assert(commandAllocations == 0);
+    assert(queue.empty() && queue.capacity() == capacity);
+    
+    std::cout << "\n--- Blocks Freed Elsewhere Return To Their Thread ---" << std::endl;
+    bool returned = true;
+    std::thread owner([&returned, room, sender]() {   // Fresh thread, so its free lists start empty
+        std::vector<Command*> handedOver;
+        for (int i = 0; i < 4; i++) {
+            handedOver.push_back(new SendMessageCommand(room, sender, "hi"));
+        }
+        std::vector<void*> addresses(handedOver.begin(), handedOver.end());
+        std::thread worker([&handedOver]() {
+            for (size_t i = 0; i < handedOver.size(); i++) {
+                delete handedOver[i];
+            }
+        });
+        worker.join();
+        for (int i = 0; i < 4; i++) {
+            Command* reused = new SendMessageCommand(room, sender, "hi");
+            returned = returned && std::find(addresses.begin(), addresses.end(), static_cast<void*>(reused)) != addresses.end();
+            delete reused;
+        }
+    });
+    owner.join();
+    assert(returned);
+    
+    std::cout << "\n--- Blocks Outliving Their Thread Go To The Heap ---" << std::endl;
+    Command* orphan = nullptr;
+    std::thread creator([&orphan, room, sender]() {
+        orphan = new SaveMessageCommand(room, sender, "hi");
+        delete new SaveMessageCommand(room, sender, "cached");
+    });
+    creator.join();
+    delete orphan;
+    Logger::setLevel(USER_ONLY);
+    
+    std::cout << "\n--- Queued Commands Still Run In Order ---" << std::endl;
+    size_t historyBefore = room->getChatHistory(listener)->size();
+    sender->send("pooled message", room);
+    assert(room->getChatHistory(listener)->size() == historyBefore + 1);
+    
+    delete sender;
+    delete listener;
+    delete room;
+}
+
+// ================== COMMAND VARIANT TEST ==================
+// Extension command used to check the open hierarchy still runs in order
+class RecordingCommand : public Command {
+private:
+    std::vector<std::string>* record;
+
+public:
+    RecordingCommand(std::vector<std::string>* record, std::string msg)
+        : Command(nullptr, nullptr, msg), record(record) {}
+    
+    void execute() override { record->push_back(message); }
+};
+
+struct KindCounter {
+    int sends;
+    int saves;
+    int customs;
+    
+    KindCounter() : sends(0), saves(0), customs(0) {}
+    void operator()(const SendMessageAction&) { sends++; }
+    void operator()(const SaveMessageAction&) { saves++; }
+    void operator()(const Command&) { customs++; }
+};
+
+void testCommandVariant() {
+    printSeparator("COMMAND VARIANT TEST");
+    
+    ChatRoom* room = new Dogorithm();
+    PremiumUser* sender = new PremiumUser("Variant");
+    AdminUser* listener = new AdminUser("VariantListener");
+    room->registerUser(sender);
+    room->registerUser(listener);
+    
+    std::cout << "\n--- Visitors See Each Kind ---" << std::endl;
+    std::vector<std::string> record;
+    KindCounter counter;
+    CommandVariant send = CommandVariant::sendMessage(room, sender, "woof");
+    CommandVariant save = CommandVariant::saveMessage(room, sender, "woof");
+    CommandVariant custom(new RecordingCommand(&record, "custom"));
+    send.visit(counter);
+    save.visit(counter);
+    custom.visit(counter);
+    assert(counter.sends == 1 && counter.saves == 1 && counter.customs == 1);
+    assert(send.getKind() == CommandVariant::Kind::SEND);
+    assert(custom.getKind() == CommandVariant::Kind::CUSTOM);
+    
+    CommandVariant moved(std::move(save));
+    assert(moved.getKind() == CommandVariant::Kind::SAVE);
+    
+    std::cout << "\n--- Built-in And Extension Commands Share A Queue ---" << std::endl;
+    size_t historyBefore = room->getChatHistory(listener)->size();
+    CommandQueue queue;
+    queue.push(std::move(send));
+    queue.push(new RecordingCommand(&record, "between"));
+    queue.push(std::move(moved));
+    queue.executeAll();
+    assert(record.size() == 1 && record[0] == "between");
+    assert(room->getChatHistory(listener)->size() == historyBefore + 1);
+    assert(room->getChatHistory(listener)->back() == "Variant: woof");
+    
+    std::cout << "\n--- Unrun Commands Are Released ---" << std::endl;
+    queue.push(new RecordingCommand(&record, "never"));
+    queue.push(CommandVariant::saveMessage(room, sender, "never"));
+    queue.discardAll();
+    assert(queue.empty() && record.size() == 1);
+    
+    std::cout << "\n--- Built-in Queue Needs No Heap ---" << std::endl;
+    Logger::setLevel(NONE);
+    for (int i = 0; i < 4; i++) {
+        queue.push(CommandVariant::sendMessage(room, sender, "hi"));
+        queue.push(CommandVariant::saveMessage(room, sender, "hi"));
+        queue.discardAll();
+    }
+    unsigned long before = allocationCount.load();
+    for (int i = 0; i < 1000; i++) {
+        queue.push(CommandVariant::sendMessage(room, sender, "hi"));
+        queue.push(CommandVariant::saveMessage(room, sender, "hi"));
+        queue.discardAll();
+        queue.push(CommandVariant::sendMessage(room, sender, "hi"));
+        queue.executeAll();
+    }
+    unsigned long variantAllocations = allocationCount.load() - before;
+    std::cout << "Allocations for 3000 commands: " << variantAllocations << std::endl;
+    assert(variantAllocations == 0);
+    Logger::setLevel(USER_ONLY);
+    
+    delete sender;
+    delete listener;
+    delete room;
+}
+
+// ================== COMMAND EXECUTOR TEST ==================
+class ThrowingCommand : public Command {
+public:
+    ThrowingCommand() : Command(nullptr, nullptr, "") {}
+    void execute() override { throw std::runtime_error("boom"); }
+};
+
+// Waits (bounded) for another executor's command, so it only finishes if both run at once
+class RendezvousCommand : public Command {
+private:
+    std::atomic<int>* arrived;
+
+public:
+    explicit RendezvousCommand(std::atomic<int>* arrived) : Command(nullptr, nullptr, ""), arrived(arrived) {}
+    
+    void execute() override {
+        arrived->fetch_add(1);
+        for (int i = 0; i < 2000 && arrived->load() < 2; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (arrived->load() < 2) {
+            throw std::runtime_error("ran alone");
+        }
+    }
+};
+
+void testCommandExecutor() {
+    printSeparator("COMMAND EXECUTOR TEST");
+    
+    std::cout << "\n--- Per-Executor Order Is Preserved ---" << std::endl;
+    ThreadPool pool(3);
+    std::vector<std::string> firstRecord;
+    std::vector<std::string> secondRecord;
+    std::vector<CommandFuture> futures;
+    {
+        CommandExecutor first(&pool);
+        CommandExecutor second(&pool);
+        for (int i = 0; i < 50; i++) {
+            std::vector<CommandVariant> batch;
+            batch.push_back(CommandVariant(new RecordingCommand(&firstRecord, std::to_string(i) + "a")));
+            batch.push_back(CommandVariant(new RecordingCommand(&firstRecord, std::to_string(i) + "b")));
+            futures.push_back(first.submit(std::move(batch)));
+            
+            batch.push_back(CommandVariant(new RecordingCommand(&secondRecord, std::to_string(i))));
+            futures.push_back(second.submit(std::move(batch)));
+        }
+        first.waitIdle();
+        assert(first.pendingBatches() == 0);
+    }   // Destructors wait for the rest
+    assert(firstRecord.size() == 100 && secondRecord.size() == 50);
+    for (int i = 0; i < 50; i++) {
+        assert(firstRecord[2 * i] == std::to_string(i) + "a");
+        assert(firstRecord[2 * i + 1] == std::to_string(i) + "b");
+        assert(secondRecord[i] == std::to_string(i));
+    }
+    for (size_t i = 0; i < futures.size(); i++) {
+        assert(futures[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        assert(futures[i].get().succeeded());
+    }
+    
+    std::cout << "\n--- Different Executors Run In Parallel ---" << std::endl;
+    std::atomic<int> arrived(0);
+    CommandExecutor left(&pool);
+    CommandExecutor right(&pool);
+    std::vector<CommandVariant> leftBatch;
+    std::vector<CommandVariant> rightBatch;
+    leftBatch.push_back(CommandVariant(new RendezvousCommand(&arrived)));
+    rightBatch.push_back(CommandVariant(new RendezvousCommand(&arrived)));
+    CommandFuture leftDone = left.submit(std::move(leftBatch));
+    CommandFuture rightDone = right.submit(std::move(rightBatch));
+    assert(leftDone.get().succeeded() && rightDone.get().succeeded());
+    
+    std::cout << "\n--- Errors Are Collected ---" << std::endl;
+    std::vector<std::string> record;
+    std::vector<CommandVariant> batch;
+    batch.push_back(CommandVariant(new RecordingCommand(&record, "before")));
+    batch.push_back(CommandVariant(new ThrowingCommand()));
+    batch.push_back(CommandVariant(new RecordingCommand(&record, "after")));
+    CommandBatchResult result = left.submit(std::move(batch)).get();
+    std::cout << "Executed " << result.executed << ", errors: " << result.errors.size()
+              << " (" << result.errors[0] << ")" << std::endl;
+    assert(!result.succeeded() && result.executed == 2 && result.errors[0] == "boom");
+    assert(record.size() == 2 && record[1] == "after");
+    
+    std::cout << "\n--- Users Send Without Waiting For Fan-Out ---" << std::endl;
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* sender = new PremiumUser("AsyncSender");
+    AdminUser* listener = new AdminUser("AsyncListener");
+    room->registerUser(sender);
+    room->registerUser(listener);
+    size_t historyBefore = room->getChatHistory(listener)->size();
+    
+    sender->setAsyncExecution(true);
+    assert(sender->isAsyncExecution());
+    assert(sender->send("async hello", room));
+    sender->waitForCommands();
+    assert(sender->getLastCompletion().get().succeeded());
+    assert(room->getChatHistory(listener)->size() == historyBefore + 1);
+    
+    sender->addCommand(new ThrowingCommand());
+    CommandFuture failed = sender->executeAllAsync();
+    assert(failed.get().errors.size() == 1);
+    
+    delete sender;
+    delete listener;
+    delete room;
+}
+
+// ================== GROUP COMMIT TEST ==================
+void testGroupCommit() {
+    printSeparator("GROUP COMMIT TEST");
+    
+    std::cout << "\n--- Histogram Buckets ---" << std::endl;
+    assert(HistoryCommitter::bucketFor(1) == 0);
+    assert(HistoryCommitter::bucketFor(2) == 1);
+    assert(HistoryCommitter::bucketFor(3) == 2 && HistoryCommitter::bucketFor(4) == 2);
+    assert(HistoryCommitter::bucketFor(8) == 3 && HistoryCommitter::bucketFor(9) == 4);
+    assert(HistoryCommitter::bucketFor(1000000) == GroupCommitStats::HISTOGRAM_BUCKETS - 1);
+    
+    ChatRoom* room = new Dogorithm();
+    PremiumUser* sender = new PremiumUser("Batcher");
+    AdminUser* admin = new AdminUser("BatchAdmin");
+    room->registerUser(sender);
+    room->registerUser(admin);
+    
+    std::cout << "\n--- Saves Commit In Size-Limited Batches ---" << std::endl;
+    int sinkCalls = 0;
+    size_t sinkEntries = 0;
+    room->setHistoryBatchSink([&sinkCalls, &sinkEntries](const std::vector<std::string>& batch) {
+        sinkCalls++;
+        sinkEntries += batch.size();
+        return true;
+    });
+    room->setGroupCommit(GroupCommitOptions(8));
+    Logger::setLevel(NONE);
+    for (int i = 0; i < 20; i++) {
+        sender->send("batch " + std::to_string(i), room);
+    }
+    Logger::setLevel(USER_ONLY);
+    GroupCommitStats stats = room->getGroupCommitStats();
+    assert(stats.batches == 2 && stats.messages == 16 && sinkCalls == 2);
+    
+    const std::vector<std::string>* history = room->getChatHistory(admin);   // Commits the last 4
+    assert(history->size() == 20 && sinkEntries == 20);
+    for (int i = 0; i < 20; i++) {
+        assert((*history)[i] == "Batcher: batch " + std::to_string(i));
+    }
+    stats = room->getGroupCommitStats();
+    std::cout << "Batches: " << stats.batches << ", size 5-8: " << stats.batchSizeHistogram[3]
+              << ", size 3-4: " << stats.batchSizeHistogram[2] << std::endl;
+    assert(stats.batches == 3 && stats.batchSizeHistogram[3] == 2 && stats.batchSizeHistogram[2] == 1);
+    
+    std::cout << "\n--- Quiet Batches Commit On A Timer ---" << std::endl;
+    room->setGroupCommit(GroupCommitOptions(1000, 50000));
+    Logger::setLevel(NONE);
+    sender->send("early", room);
+    sender->send("late", room);
+    Logger::setLevel(USER_ONLY);
+    assert(room->getGroupCommitStats().batches == 3);   // No third save is coming
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (room->getGroupCommitStats().batches == 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    assert(room->getGroupCommitStats().batches == 4 && sinkEntries == 22);
+    
+    std::cout << "\n--- Concurrent Senders Keep Their Own Order ---" << std::endl;
+    room->setGroupCommit(GroupCommitOptions(16));
+    std::vector<PremiumUser*> senders;
+    for (int u = 0; u < 4; u++) {
+        senders.push_back(new PremiumUser("Async" + std::to_string(u)));
+        room->registerUser(senders.back());
+        senders.back()->setAsyncExecution(true);
+    }
+    Logger::setLevel(NONE);
+    for (int i = 0; i < 50; i++) {
+        for (int u = 0; u < 4; u++) {
+            senders[u]->send(std::to_string(i), room);
+        }
+    }
+    for (int u = 0; u < 4; u++) {
+        senders[u]->waitForCommands();
+    }
+    Logger::setLevel(USER_ONLY);
+    history = room->getChatHistory(admin);
+    assert(history->size() == 222);
+    int next[4] = {0, 0, 0, 0};
+    for (size_t i = 22; i < history->size(); i++) {
+        int u = (*history)[i][5] - '0';
+        assert((*history)[i] == "Async" + std::to_string(u) + ": " + std::to_string(next[u]));
+        next[u]++;
+    }
+    
+    for (int u = 0; u < 4; u++) {
+        delete senders[u];
+    }
+    delete sender;
+    delete admin;
+    delete room;
+}
+
+// ================== SEND PIPELINE TEST ==================
+// Sends the same script through the serial path and a pipeline into separate rooms
+void runSendScript(const std::vector<User*>& senders, ChatRoom* cats, ChatRoom* dogs, SendPipeline* pipeline) {
+    const char* texts[] = {"hello", "this is stupid", "walkies?", "treats at five"};
+    for (int i = 0; i < 60; i++) {
+        User* sender = senders[i % senders.size()];
+        ChatRoom* room = (i % 3 == 0) ? dogs : cats;
+        std::string text = std::string(texts[i % 4]) + " #" + std::to_string(i);
+        if (pipeline) {
+            pipeline->submit(sender, room, text);
+        } else {
+            sender->send(text, room);
+        }
+    }
+}
+
+void testSendPipeline() {
+    printSeparator("SEND PIPELINE TEST");
+    
+    std::vector<ChatRoom*> rooms;
+    std::vector<User*> users[2];
+    AdminUser* admin = new AdminUser("PipelineAdmin");
+    for (int run = 0; run < 2; run++) {
+        rooms.push_back(new CtrlCat());
+        rooms.push_back(new Dogorithm());
+        users[run].push_back(new FreeUser("Freddy"));
+        users[run].push_back(new PremiumUser("Penny"));
+        users[run].push_back(new AdminUser("Adam"));
+        for (size_t u = 0; u < users[run].size(); u++) {
+            rooms[2 * run]->registerUser(users[run][u]);
+            rooms[2 * run + 1]->registerUser(users[run][u]);
+        }
+        rooms[2 * run]->registerUser(admin);
+        rooms[2 * run + 1]->registerUser(admin);
+    }
+    
+    std::cout << "\n--- Pipeline Matches The Serial Path ---" << std::endl;
+    Logger::setLevel(NONE);
+    runSendScript(users[0], rooms[0], rooms[1], nullptr);
+    SendPipelineStats stats;
+    {
+        SendPipeline pipeline(8);   // Small queues exercise backpressure
+        runSendScript(users[1], rooms[2], rooms[3], &pipeline);
+        pipeline.drain();
+        stats = pipeline.getStats();
+    }
+    Logger::setLevel(USER_ONLY);
+    
+    for (int room = 0; room < 2; room++) {
+        const std::vector<std::string>* serial = rooms[room]->getChatHistory(admin);
+        const std::vector<std::string>* piped = rooms[room + 2]->getChatHistory(admin);
+        assert(*serial == *piped);
+    }
+    size_t accepted = rooms[0]->getChatHistory(admin)->size() + rooms[1]->getChatHistory(admin)->size();
+    std::cout << "Accepted " << accepted << " of " << stats.submitted << ", rejected " << stats.rejected << std::endl;
+    assert(stats.submitted == 60 && accepted + stats.rejected == 60 && stats.rejected > 0);
+    
+    std::cout << "\n--- Stage Stats ---" << std::endl;
+    assert(stats.stages[static_cast<int>(PipelineStage::VALIDATE)].processed == 60);
+    assert(stats.stages[static_cast<int>(PipelineStage::PERSIST)].processed == accepted);
+    assert(stats.stages[static_cast<int>(PipelineStage::BROADCAST)].processed == accepted);
+    for (int i = 0; i < static_cast<int>(PipelineStage::COUNT); i++) {
+        assert(stats.stages[i].queueDepth == 0);
+        assert(stats.stages[i].maxQueueDepth <= 8);
+        assert(stats.stages[i].meanServiceMicros > 0.0);
+    }
+    assert(SendPipeline::validatingPipeline() == nullptr);
+    
+    for (int run = 0; run < 2; run++) {
+        for (size_t u = 0; u < users[run].size(); u++) {
+            delete users[run][u];
+        }
+    }
+    for (size_t r = 0; r < rooms.size(); r++) {
+        delete rooms[r];
+    }
+    delete admin;
+}
+
+// ================== COMMAND JOURNAL TEST ==================
+void testCommandJournal() {
+    printSeparator("COMMAND JOURNAL TEST");
+    const std::string path = "test_journal.tmp";
+    std::remove(path.c_str());
+    
+    std::cout << "\n--- Saves Survive A Restart ---" << std::endl;
+    ChatRoom* room = new CtrlCat();
+    PremiumUser* sender = new PremiumUser("Journaled");
+    AdminUser* admin = new AdminUser("JournalAdmin");
+    room->registerUser(sender);
+    room->registerUser(admin);
+    JournalReplayResult replayed;
+    assert(room->openJournal(JournalOptions(path, JournalDurability::FSYNC), &replayed));
+    assert(replayed.records == 0 && !replayed.truncated);
+    
+    Logger::setLevel(NONE);
+    for (int i = 0; i < 10; i++) {
+        sender->send("entry " + std::to_string(i), room);
+    }
+    Logger::setLevel(USER_ONLY);
+    JournalStats stats = room->getJournal()->getStats();
+    assert(stats.records == 10 && stats.batches == 10 && stats.fsyncs == 10);
+    std::vector<std::string> before = *room->getChatHistory(admin);
+    delete room;   // Closes the journal
+    
+    ChatRoom* restarted = new CtrlCat();
+    restarted->registerUser(admin);
+    assert(restarted->openJournal(JournalOptions(path), &replayed));
+    assert(replayed.records == 10 && !replayed.truncated);
+    assert(*restarted->getChatHistory(admin) == before);
+    restarted->closeJournal();
+    
+    std::cout << "\n--- A Torn Tail Is Dropped ---" << std::endl;
+    {
+        std::string partial;
+        CommandJournal::encodeRecord(CommandJournal::SAVE_RECORD, "Journaled: half written", partial);
+        std::ofstream out(path.c_str(), std::ios::app | std::ios::binary);
+        out.write(partial.data(), static_cast<std::streamsize>(partial.size() - 3));
+    }
+    std::vector<std::string> entries;
+    replayed = CommandJournal::replay(path, entries);
+    assert(replayed.records == 10 && replayed.truncated && entries == before);
+    
+    ChatRoom* recovered = new Dogorithm();
+    recovered->registerUser(sender);
+    recovered->registerUser(admin);
+    assert(recovered->openJournal(JournalOptions(path, JournalDurability::WRITE), &replayed));
+    assert(replayed.truncated);
+    sender->send("after the crash", recovered);
+    recovered->closeJournal();
+    entries.clear();
+    replayed = CommandJournal::replay(path, entries);
+    assert(replayed.records == 11 && !replayed.truncated);
+    assert(entries.back() == "Journaled: after the crash");
+    
+    std::cout << "\n--- Batches Become Single Writes ---" << std::endl;
+    std::remove(path.c_str());
+    JournalOptions buffered(path, JournalDurability::BUFFERED);
+    recovered->setGroupCommit(GroupCommitOptions(5));
+    assert(recovered->openJournal(buffered));
+    Logger::setLevel(NONE);
+    for (int i = 0; i < 20; i++) {
+        sender->send("buffered " + std::to_string(i), recovered);
+    }
+    Logger::setLevel(USER_ONLY);
+    stats = recovered->getJournal()->getStats();
+    std::cout << "Batches: " << stats.batches << ", writes: " << stats.writes << std::endl;
+    assert(stats.records == 20 && stats.batches == 4 && stats.writes == 0);
+    recovered->getJournal()->flush();
+    stats = recovered->getJournal()->getStats();
+    assert(stats.writes == 1 && stats.fsyncs == 1);
+    recovered->closeJournal();
+    entries.clear();
+    assert(CommandJournal::replay(path, entries).records == 20);
+    
+    std::cout << "\n--- Group Fsync Syncs An Idle Journal ---" << std::endl;
+    JournalOptions grouped(path, JournalDurability::GROUP_FSYNC);
+    grouped.fsyncIntervalMillis = 50;
+    recovered->setGroupCommit(GroupCommitOptions(1));
+    assert(recovered->openJournal(grouped));
+    sender->send("one quiet message", recovered);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    stats = recovered->getJournal()->getStats();
+    assert(stats.writes == 1 && stats.fsyncs == 1);
+    recovered->closeJournal();
+    
+    std::cout << "\n--- Failed Writes Are Not Committed ---" << std::endl;
+    ChatRoom* full = new CtrlCat();
+    full->registerUser(sender);
+    full->registerUser(admin);
+    assert(full->openJournal(JournalOptions("/dev/full", JournalDurability::WRITE)));
+    Logger::setLevel(NONE);
+    sender->send("nowhere to go", full);
+    assert(!full->flushHistory());
+    Logger::setLevel(USER_ONLY);
+    assert(full->getJournal()->getStats().writeErrors == 2);
+    assert(full->getGroupCommitStats().failedBatches == 2);
+    assert(full->getGroupCommitStats().messages == 0);
+    Logger::setLevel(NONE);
+    full->closeJournal();
+    assert(full->getChatHistory(admin)->size() == 1);   // Committed once nothing refuses it
+    Logger::setLevel(USER_ONLY);
+    full->removeUser(sender);
+    full->removeUser(admin);
+    delete full;
+    
+    std::remove(path.c_str());
+    delete recovered;
+    delete restarted;
+    delete sender;
+    delete admin;
+}
+
+// ================== COMMAND SCHEDULER TEST ==================
+// Holds the scheduler's only worker until released, so a backlog can build up
+class GateCommand : public Command {
+private:
+    std::atomic<bool>* open;
+    std::atomic<bool>* entered;
+
+public:
+    GateCommand(std::atomic<bool>* open, std::atomic<bool>* entered)
+        : Command(nullptr, nullptr, ""), open(open), entered(entered) {}
+    
+    void execute() override {
+        entered->store(true);
+        while (!open->load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+};
+
+// Blocks the scheduler's worker and returns once it is inside the gate
+void closeGate(CommandScheduler& scheduler, const void* flow, UserType type, std::atomic<bool>* open) {
+    std::atomic<bool> entered(false);
+    std::vector<CommandVariant> gate;
+    gate.push_back(CommandVariant(new GateCommand(open, &entered)));
+    scheduler.submit(flow, type, std::move(gate));
+    while (!entered.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+CommandFuture submitRecording(CommandScheduler& scheduler, const void* flow, UserType type,
+                              std::vector<std::string>* record, const std::string& label) {
+    std::vector<CommandVariant> batch;
+    batch.push_back(CommandVariant(new RecordingCommand(record, label)));
+    return scheduler.submit(flow, type, std::move(batch));
+}
+
+void testCommandScheduler() {
+    printSeparator("COMMAND SCHEDULER TEST");
+    
+    int flows[6];   // Addresses serve as flow keys
+    std::vector<std::string> record;
+    
+    std::cout << "\n--- Admin Batches Overtake A Free-User Flood ---" << std::endl;
+    {
+        CommandScheduler scheduler(1);
+        std::atomic<bool> open(false);
+        closeGate(scheduler, &flows[5], UserType::FREE, &open);
+        
+        for (int i = 0; i < 30; i++) {
+            submitRecording(scheduler, &flows[i % 3], UserType::FREE, &record, "free");
+        }
+        CommandFuture admin = submitRecording(scheduler, &flows[3], UserType::ADMIN, &record, "admin");
+        open.store(true);
+        admin.wait();
+        scheduler.waitIdle(&flows[0]);
+        scheduler.waitIdle(&flows[1]);
+        scheduler.waitIdle(&flows[2]);
+        
+        size_t adminPosition = std::find(record.begin(), record.end(), "admin") - record.begin();
+        std::cout << "Admin ran at position " << adminPosition << " of " << record.size() << std::endl;
+        assert(record.size() == 31 && adminPosition <= 3);
+        assert(scheduler.getStats(UserType::ADMIN).batches == 1);
+        assert(scheduler.getStats(UserType::FREE).batches == 31);
+    }
+    
+    std::cout << "\n--- Users In A Class Share Fairly And Keep Their Order ---" << std::endl;
+    record.clear();
+    {
+        CommandScheduler scheduler(1);
+        std::atomic<bool> open(false);
+        closeGate(scheduler, &flows[5], UserType::PREMIUM, &open);
+        
+        for (int i = 0; i < 20; i++) {
+            submitRecording(scheduler, &flows[0], UserType::PREMIUM, &record, "A" + std::to_string(i));
+        }
+        for (int i = 0; i < 20; i++) {
+            submitRecording(scheduler, &flows[1], UserType::PREMIUM, &record, "B" + std::to_string(i));
+        }
+        open.store(true);
+        scheduler.waitIdle(&flows[0]);
+        scheduler.waitIdle(&flows[1]);
+        
+        int seenA = 0;
+        int seenB = 0;
+        for (size_t i = 0; i < record.size(); i++) {
+            if (record[i][0] == 'A') {
+                assert(record[i] == "A" + std::to_string(seenA++));
+            } else {
+                assert(record[i] == "B" + std::to_string(seenB++));
+            }
+            if (i == 19) {
+                assert(seenA >= 8 && seenB >= 8);   // Interleaved, not A's backlog first
+            }
+        }
+    }
+    
+    std::cout << "\n--- Starvation Protection ---" << std::endl;
+    record.clear();
+    {
+        CommandScheduler scheduler(1);
+        QosClassPolicy patientFree = {1, 1000};
+        QosClassPolicy greedyAdmin = {1000, 0};
+        scheduler.setPolicy(UserType::FREE, patientFree);
+        scheduler.setPolicy(UserType::ADMIN, greedyAdmin);
+        
+        std::atomic<bool> open(false);
+        closeGate(scheduler, &flows[5], UserType::ADMIN, &open);
+        
+        submitRecording(scheduler, &flows[0], UserType::FREE, &record, "free");
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));   // Past the free deadline
+        for (int i = 0; i < 10; i++) {
+            submitRecording(scheduler, &flows[3 + i % 2], UserType::ADMIN, &record, "admin");
+        }
+        open.store(true);
+        scheduler.waitIdle(&flows[0]);
+        scheduler.waitIdle(&flows[3]);
+        scheduler.waitIdle(&flows[4]);
+        
+        assert(record[0] == "free");
+        QosClassStats freeStats = scheduler.getStats(UserType::FREE);
+        std::cout << "Promoted free batches: " << freeStats.promoted << std::endl;
+        assert(freeStats.promoted == 1 && freeStats.maxWaitMicros >= 1000);
+        assert(freeStats.p99LatencyMicros >= freeStats.p50LatencyMicros && freeStats.p50LatencyMicros > 0);
+    }
+
+    std::cout << "\n--- An Overdue Free Backlog Doesn't Hold Up Admins ---" << std::endl;
+    record.clear();
+    {
+        CommandScheduler scheduler(1);
+        QosClassPolicy patientFree = {1, 1000};
+        scheduler.setPolicy(UserType::FREE, patientFree);
+
+        std::atomic<bool> open(false);
+        closeGate(scheduler, &flows[5], UserType::FREE, &open);
+
+        for (int i = 0; i < 40; i++) {
+            submitRecording(scheduler, &flows[i % 3], UserType::FREE, &record, "free");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));   // Every free head is overdue
+        CommandFuture admin = submitRecording(scheduler, &flows[3], UserType::ADMIN, &record, "admin");
+        open.store(true);
+        admin.wait();
+        scheduler.waitIdle(&flows[0]);
+        scheduler.waitIdle(&flows[1]);
+        scheduler.waitIdle(&flows[2]);
+
+        size_t adminPosition = std::find(record.begin(), record.end(), "admin") - record.begin();
+        QosClassStats freeStats = scheduler.getStats(UserType::FREE);
+        std::cout << "Admin ran at position " << adminPosition << " of " << record.size() << std::endl;
+        assert(record.size() == 41 && adminPosition <= 1);
+        assert(freeStats.promoted > 0);   // Free batches were still promoted, just not all ahead of the admin
+    }
+
+    std::cout << "\n--- Users Send Through The Scheduler ---" << std::endl;
+    {
+        CommandScheduler scheduler(2);
+        ChatRoom* room = new CtrlCat();
+        AdminUser* moderator = new AdminUser("Moderator");
+        room->registerUser(moderator);
+        moderator->setAsyncExecution(true);
+        moderator->setCommandScheduler(&scheduler);
+        assert(moderator->getCommandScheduler() == &scheduler);
+        assert(moderator->send("Please keep it friendly", room));
+        moderator->waitForCommands();
+        assert(room->getChatHistory(moderator)->size() == 1);
+        assert(scheduler.getStats(UserType::ADMIN).batches == 1);
+        delete moderator;   // Retires its flow
+        delete room;
+    }
+}
+
+// ================== DEFERRED FLUSH TEST ==================
+class CountingRoom : public Dogorithm {
+public:
+    int singleCalls;
+    int batchCalls;
+    std::thread::id batchThread;   // Thread of the last sendMessages call
+    
+    CountingRoom() : singleCalls(0), batchCalls(0) {}
+    
+    void sendMessage(std::string message, User* fromUser) override {
+        singleCalls++;
+        Dogorithm::sendMessage(message, fromUser);
+    }
+    void saveMessage(std::string message, User* fromUser) override {
+        singleCalls++;
+        Dogorithm::saveMessage(message, fromUser);
+    }
+    void sendMessages(const std::vector<std::string>& messages, User* fromUser) override {
+        batchCalls++;
+        batchThread = std::this_thread::get_id();
+        Dogorithm::sendMessages(messages, fromUser);
+    }
+    void saveMessages(std::vector<std::string>& messages, User* fromUser) override {
+        batchCalls++;
+        Dogorithm::saveMessages(messages, fromUser);
+    }
+};
+
+// Polls until the user's timer has flushed and its executor has run the batch,
+// so the test does not depend on exact timing
+bool waitForTimedFlushes(User* user, unsigned long expected) {
+    for (int i = 0; i < 2000; i++) {
+        if (user->getFlushStats().timedFlushes >= expected) {
+            user->waitForCommands();
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+void testDeferredFlush() {
+    printSeparator("DEFERRED FLUSH TEST");
+    
+    std::cout << "\n--- Timer Service ---" << std::endl;
+    std::atomic<int> fired(0);
+    TimerService::schedule(1, [&fired]() { fired++; });
+    uint64_t cancelled = TimerService::schedule(60000, [&fired]() { fired += 100; });
+    assert(TimerService::cancel(cancelled));
+    assert(!TimerService::cancel(cancelled));
+    for (int i = 0; i < 2000 && fired.load() == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(fired.load() == 1 && TimerService::getPendingCount() == 0);
+    
+    CountingRoom* room = new CountingRoom();
+    CountingRoom* otherRoom = new CountingRoom();
+    PremiumUser* sender = new PremiumUser("Deferred");
+    AdminUser* admin = new AdminUser("FlushAdmin");
+    room->registerUser(sender);
+    room->registerUser(admin);
+    otherRoom->registerUser(sender);
+    otherRoom->registerUser(admin);
+    
+    std::cout << "\n--- Adjacent Commands For One Room Coalesce ---" << std::endl;
+    std::vector<std::string> record;
+    std::vector<CommandVariant> batch;
+    for (int i = 0; i < 3; i++) {
+        batch.push_back(CommandVariant::sendMessage(room, sender, "c" + std::to_string(i)));
+        batch.push_back(CommandVariant::saveMessage(room, sender, "c" + std::to_string(i)));
+    }
+    batch.push_back(CommandVariant(new RecordingCommand(&record, "custom")));
+    batch.push_back(CommandVariant::sendMessage(room, sender, "c3"));
+    batch.push_back(CommandVariant::sendMessage(otherRoom, sender, "elsewhere"));
+    Logger::setLevel(NONE);
+    size_t calls = CommandQueue::executeCoalesced(batch);
+    Logger::setLevel(USER_ONLY);
+    std::cout << "9 commands became " << calls << " room calls" << std::endl;
+    assert(calls == 5 && batch.empty() && record.size() == 1);
+    assert(room->batchCalls == 2 && room->singleCalls == 1 && otherRoom->singleCalls == 1);
+    const std::vector<std::string>* history = room->getChatHistory(admin);
+    assert(history->size() == 3);
+    for (int i = 0; i < 3; i++) {
+        assert((*history)[i] == "Deferred: c" + std::to_string(i));
+    }
+    
+    std::cout << "\n--- Size Policy ---" << std::endl;
+    sender->setFlushPolicy(CommandFlushPolicy(6));
+    assert(!sender->getFlushPolicy().isImmediate());
+    Logger::setLevel(NONE);
+    sender->send("s0", room);
+    sender->send("s1", room);
+    assert(room->getChatHistory(admin)->size() == 3);   // Still queued
+    sender->send("s2", room);
+    Logger::setLevel(USER_ONLY);
+    assert(room->getChatHistory(admin)->size() == 6);
+    CommandFlushStats stats = sender->getFlushStats();
+    assert(stats.flushes == 1 && stats.commands == 6 && stats.roomCalls == 2 && stats.timedFlushes == 0);
+    
+    std::cout << "\n--- Time Policy ---" << std::endl;
+    sender->setFlushPolicy(CommandFlushPolicy(0, 20));
+    Logger::setLevel(NONE);
+    sender->send("t0", room);
+    sender->send("t1", room);
+    sender->send("t2", otherRoom);
+    Logger::setLevel(USER_ONLY);
+    assert(waitForTimedFlushes(sender, 1));
+    Logger::flush();
+    history = room->getChatHistory(admin);
+    assert(history->size() == 8 && (*history)[7] == "Deferred: t1");
+    assert(otherRoom->getChatHistory(admin)->size() == 1);
+    stats = sender->getFlushStats();
+    std::cout << "Timed flushes: " << stats.timedFlushes << ", room calls: " << stats.roomCalls << std::endl;
+    assert(stats.flushes == 2 && stats.commands == 12 && stats.roomCalls == 6);
+    
+    std::cout << "\n--- Timed Fan-Out Runs Off The Timer Thread ---" << std::endl;
+    std::atomic<bool> probed(false);
+    std::thread::id timerThread;
+    TimerService::schedule(1, [&timerThread, &probed]() {
+        timerThread = std::this_thread::get_id();
+        probed.store(true);
+    });
+    for (int i = 0; i < 2000 && !probed.load(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(probed.load() && room->batchThread != timerThread);
+    
+    std::cout << "\n--- Deleting A User With A Timer Armed ---" << std::endl;
+    CountingRoom* scratch = new CountingRoom();
+    Logger::setLevel(NONE);
+    for (int i = 0; i < 50; i++) {
+        PremiumUser* brief = new PremiumUser("Brief" + std::to_string(i));
+        scratch->registerUser(brief);
+        brief->setFlushPolicy(CommandFlushPolicy(0, 1));
+        brief->send("gone soon", scratch);
+        if (i % 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));   // Let some timers fire mid-teardown
+        }
+        scratch->removeUser(brief);
+        delete brief;   // Cancels or waits for the timer; nothing runs on a freed user
+    }
+    Logger::setLevel(USER_ONLY);
+    assert(scratch->getMemberCount() == 0);
+    delete scratch;
+    
+    std::cout << "\n--- Explicit Flush ---" << std::endl;
+    sender->setFlushPolicy(CommandFlushPolicy(0, 0));
+    Logger::setLevel(NONE);
+    sender->send("e0", room);
+    sender->send("e1", room);
+    assert(room->getChatHistory(admin)->size() == 8);
+    assert(sender->flushCommands() == 4);
+    assert(sender->flushCommands() == 0);
+    Logger::setLevel(USER_ONLY);
+    assert(room->getChatHistory(admin)->size() == 10);
+    
+    std::cout << "\n--- Immediate Policy Is Unchanged ---" << std::endl;
+    PremiumUser* direct = new PremiumUser("Direct");
+    room->registerUser(direct);
+    int singlesBefore = room->singleCalls;
+    Logger::setLevel(NONE);
+    assert(direct->send("Sending right away", room));
+    Logger::setLevel(USER_ONLY);
+    assert(room->singleCalls == singlesBefore + 2 && room->getChatHistory(admin)->size() == 11);
+    assert(direct->getFlushStats().flushes == 0);
+    
+    std::cout << "\n--- Queued Sends Survive Their Sender ---" << std::endl;
+    Logger::setLevel(NONE);
+    sender->send("last words", room);
+    delete sender;   // No more sends to these rooms while it is still a member
+    Logger::setLevel(USER_ONLY);
+    history = room->getChatHistory(admin);
+    assert(history->size() == 12 && history->back() == "Deferred: last words");
+    
+    delete direct;
+    delete admin;
+    delete room;
+    delete otherRoom;
+}
+
+// ================== USER TABLE TEST ==================
+void testUserTable() {
+    printSeparator("USER TABLE TEST");
+    
+    std::cout << "\n--- Handles Resolve To Their User ---" << std::endl;
+    size_t liveBefore = UserTable::getLiveCount();
+    size_t adminsBefore = UserTable::countByType(UserType::ADMIN);
+    FreeUser* free = new FreeUser("TableFree");
+    AdminUser* admin = new AdminUser("TableAdmin");
+    UserHandle freeHandle = free->getHandle();
+    assert(!freeHandle.isNull() && freeHandle != admin->getHandle());
+    assert(UserTable::resolve(freeHandle) == free && UserTable::resolve(admin->getHandle()) == admin);
+    assert(UserTable::getLiveCount() == liveBefore + 2);
+    assert(UserTable::countByType(UserType::ADMIN) == adminsBefore + 1);
+    assert(UserTable::getType(freeHandle) == UserType::FREE);
+    assert(UserTable::resolve(UserHandle()) == nullptr);
+    
+    std::cout << "\n--- Names Are Stored Once ---" << std::endl;
+    assert(&free->getName() == &UserTable::getName(freeHandle));
+    assert(free->getName() == "TableFree");
+    
+    std::cout << "\n--- Hot Fields Live In The Table ---" << std::endl;
+    assert(UserTable::getStrategyKey(freeHandle) == free->getValidationStrategy()->getCacheKey());
+    ChatRoom* room = new Dogorithm();
+    room->registerUser(free);
+    room->registerUser(admin);
+    assert(room->hasMember(freeHandle));
+    uint64_t fullBefore = UserTable::getQuota(freeHandle).fullAt;
+    Logger::setLevel(NONE);
+    assert(free->send("Counting against the table", room));
+    Logger::setLevel(USER_ONLY);
+    assert(UserTable::getQuota(freeHandle).fullAt != fullBefore);
+    assert(free->getDailyMessageCount() == 1);
+    
+    std::cout << "\n--- Stale Handles Stop Resolving ---" << std::endl;
+    free->setFlushPolicy(CommandFlushPolicy(0, 0));
+    Logger::setLevel(NONE);
+    free->send("Queued but never sent", room);
+    Logger::setLevel(USER_ONLY);
+    std::vector<CommandVariant> orphaned;
+    orphaned.push_back(CommandVariant::sendMessage(room, free, "Orphan"));
+    orphaned.push_back(CommandVariant::saveMessage(room, free, "Orphan"));
+    room->removeUser(free);   // The destructor's flush is refused: no longer a member
+    delete free;
+    assert(UserTable::resolve(freeHandle) == nullptr && !room->hasMember(freeHandle));
+    assert(UserTable::getLiveCount() == liveBefore + 1);
+    
+    size_t historyBefore = room->getChatHistory(admin)->size();
+    Logger::setLevel(NONE);
+    CommandQueue::executeCoalesced(orphaned);   // Dropped instead of touching a deleted user
+    orphaned.push_back(CommandVariant::saveMessage(room, admin, "Still here"));
+    CommandQueue::executeCoalesced(orphaned);
+    Logger::setLevel(USER_ONLY);
+    assert(room->getChatHistory(admin)->size() == historyBefore + 1);
+    
+    std::cout << "\n--- Reused Slots Get A New Generation ---" << std::endl;
+    size_t slotsBefore = UserTable::getSlotCount();
+    bool reused = false;
+    Logger::setLevel(NONE);
+    for (size_t i = 0; i <= slotsBefore && !reused; i++) {   // Freed slots are reused oldest first
+        PremiumUser* churn = new PremiumUser("Churn");
+        UserHandle handle = churn->getHandle();
+        if (handle.index() == freeHandle.index()) {
+            reused = true;
+            assert(handle.generation() != freeHandle.generation());
+            assert(UserTable::resolve(freeHandle) == nullptr);
+        }
+        delete churn;
+    }
+    Logger::setLevel(USER_ONLY);
+    assert(reused && UserTable::getSlotCount() == slotsBefore);
+    
+    std::cout << "\n--- A Full Table Refuses New Users ---" << std::endl;
+    size_t limitBefore = UserTable::getLimit();
+    UserTable::setLimit(UserTable::getLiveCount() + 1);
+    FreeUser* last = new FreeUser("LastSeat");
+    bool refused = false;
+    Logger::setLevel(NONE);
+    try {
+        FreeUser overflow("Overflow");
+    } catch (const std::length_error&) {
+        refused = true;
+    }
+    Logger::setLevel(USER_ONLY);
+    assert(refused && UserTable::resolve(last->getHandle()) == last);
+    assert(last->getName() == "LastSeat");
+    delete last;
+    UserTable::setLimit(limitBefore);
+    assert(UserTable::getLimit() == limitBefore);
+    
+    delete admin;
+    delete room;
+}
+
+// ================== STRING INTERNING TEST ==================
+void testStringInterning() {
+    printSeparator("STRING INTERNING TEST");
+    
+    std::cout << "\n--- Equal Text, Equal Id ---" << std::endl;
+    size_t countBefore = StringInterner::getCount();
+    InternedString first = InternedString::of("Whiskers");
+    InternedString again = InternedString::of(std::string("Whisk") + "ers");
+    InternedString other = InternedString::of("Whiskerz");
+    assert(first == again && first != other);
+    assert(&first.str() == &again.str() && first.str() == "Whiskers");
+    assert(first.view() == StringRef("Whiskers") && first.view().size == 8);
+    assert(StringInterner::getCount() == countBefore + 2);
+    
+    std::cout << "\n--- Empty And Unknown Strings ---" << std::endl;
+    assert(InternedString().empty() && InternedString::of("") == InternedString());
+    assert(InternedString().str().empty());
+    bool found = true;
+    assert(InternedString::find("Never interned anywhere", &found).empty() && !found);
+    assert(InternedString::find("Whiskers", &found) == first && found);
+    assert(StringInterner::getCount() == countBefore + 2);
+    
+    std::cout << "\n--- Rooms Are Interned, User Names Are Not ---" << std::endl;
+    ChatRoom* room = new CtrlCat();
+    assert(room->getRoomName() == InternedString::of("CtrlCat"));
+    assert(Dogorithm().getRoomName().str() == "Dogorithm");
+    size_t roomsInterned = StringInterner::getCount();
+    PremiumUser* whiskers = new PremiumUser("Whiskers");
+    AdminUser* keeper = new AdminUser("InternKeeper");
+    room->registerUser(whiskers);
+    room->registerUser(keeper);
+    Logger::setLevel(NONE);
+    for (int i = 0; i < 100; i++) {   // Passers-by leave nothing behind
+        delete new FreeUser("Passerby" + std::to_string(i));
+    }
+    Logger::setLevel(USER_ONLY);
+    assert(StringInterner::getCount() == roomsInterned);
+    assert(whiskers->getName() == "Whiskers" && &whiskers->getName() != &first.str());
+    assert(whiskers->getNameHash() == StringRef("Whiskers").hash());
+    assert(room->findMember("Whiskers") == whiskers && room->findMember(other.view()) == nullptr);
+    assert(room->findMember("InternKeeper") == keeper);
+    
+    std::cout << "\n--- Type Labels Are Shared ---" << std::endl;
+    PremiumUser* second = new PremiumUser("SecondPremium");
+    assert(&whiskers->getUserTypeString() == &second->getUserTypeString());
+    assert(whiskers->getUserTypeString() == "Premium" && keeper->getUserTypeString() == "Admin");
+    delete second;
+    
+    std::cout << "\n--- History Uses The Stored Prefix ---" << std::endl;
+    assert(whiskers->getHistoryPrefix() == "Whiskers: ");
+    Logger::setLevel(NONE);
+    assert(whiskers->send("Naps are mandatory", room));
+    Logger::setLevel(USER_ONLY);
+    assert(room->getChatHistory(keeper)->back() == "Whiskers: Naps are mandatory");
+    
+    delete whiskers;
+    delete keeper;
+    delete room;
+}
+
+// ================== ROOM SET TEST ==================
+void testRoomSet() {
+    printSeparator("ROOM SET TEST");
+    
+    // Only compared, never dereferenced
+    std::vector<char> arena(64 * 4096);
+    std::vector<ChatRoom*> fakeRooms;
+    for (size_t i = 0; i < 4096; i++) {
+        fakeRooms.push_back(reinterpret_cast<ChatRoom*>(&arena[i * 64]));
+    }
+    
+    std::cout << "\n--- A Few Rooms Stay Inline ---" << std::endl;
+    std::cout << "sizeof(RoomSet): " << sizeof(RoomSet) << " bytes" << std::endl;
+    assert(sizeof(RoomSet) <= 32);
+    RoomSet rooms;
+    for (uint32_t i = 0; i < RoomSet::INLINE_ROOMS; i++) {
+        assert(rooms.insert(fakeRooms[i]));
+    }
+    assert(!rooms.insert(fakeRooms[0]));
+    assert(rooms.isInline() && rooms.heapBytes() == 0 && rooms.size() == RoomSet::INLINE_ROOMS);
+    assert(rooms.contains(fakeRooms[2]) && !rooms.contains(fakeRooms[3]));
+    
+    std::cout << "\n--- Many Rooms Switch To A Hash Table ---" << std::endl;
+    for (size_t i = RoomSet::INLINE_ROOMS; i < 3000; i++) {
+        assert(rooms.insert(fakeRooms[i]));
+    }
+    assert(!rooms.isInline() && rooms.size() == 3000 && rooms.heapBytes() >= 3000 * 2 * sizeof(ChatRoom*));
+    for (size_t i = 0; i < 4096; i++) {
+        assert(rooms.contains(fakeRooms[i]) == (i < 3000));
+    }
+    
+    std::cout << "\n--- Random Joins And Leaves Match std::set ---" << std::endl;
+    std::set<ChatRoom*> reference(fakeRooms.begin(), fakeRooms.begin() + 3000);
+    unsigned seed = 12345;
+    for (int op = 0; op < 50000; op++) {
+        seed = seed * 1103515245u + 12345u;
+        ChatRoom* room = fakeRooms[(seed >> 8) % fakeRooms.size()];
+        if ((seed >> 4) & 1) {
+            assert(rooms.insert(room) == reference.insert(room).second);
+        } else {
+            assert(rooms.erase(room) == (reference.erase(room) == 1));
+        }
+        assert(rooms.size() == reference.size());
+    }
+    for (size_t i = 0; i < fakeRooms.size(); i++) {
+        assert(rooms.contains(fakeRooms[i]) == (reference.count(fakeRooms[i]) == 1));
+    }
+    
+    std::cout << "\n--- Leaving Most Rooms Goes Back Inline ---" << std::endl;
+    for (size_t i = 0; i < fakeRooms.size(); i++) {
+        if (i != 7 && i != 4000) {
+            rooms.erase(fakeRooms[i]);
+        }
+    }
+    rooms.insert(fakeRooms[7]);
+    rooms.insert(fakeRooms[4000]);
+    assert(rooms.isInline() && rooms.size() == 2 && rooms.heapBytes() == 0);
+    assert(rooms.contains(fakeRooms[4000]) && !rooms.contains(fakeRooms[8]));
+    
+    std::cout << "\n--- Users Check Membership Through The Set ---" << std::endl;
+    Logger::setLevel(NONE);
+    PremiumUser* bot = new PremiumUser("RoomHopper");
+    std::vector<ChatRoom*> realRooms;
+    for (int i = 0; i < 40; i++) {
+        realRooms.push_back(new Dogorithm());
+        realRooms.back()->registerUser(bot);
+    }
+    for (int i = 0; i < 40; i++) {
+        assert(bot->isInChatRoom(realRooms[i]));
+    }
+    assert(bot->send("Hello, room 39", realRooms[39]));
+    for (int i = 0; i < 40; i++) {
+        realRooms[i]->removeUser(bot);
+        bot->removeChatRoom(realRooms[i]);
+        assert(!bot->isInChatRoom(realRooms[i]));
+    }
+    Logger::setLevel(USER_ONLY);
+    
+    delete bot;
+    for (size_t i = 0; i < realRooms.size(); i++) {
+        delete realRooms[i];
+    }
+}
+
+// ================== SHARDING TEST ==================
+void testSharding() {
+    printSeparator("SHARDING TEST");
+    
+    std::cout << "\n--- Adding A Shard Moves About 1/N Of The Keys ---" << std::endl;
+    ShardRing ring;
+    for (uint32_t shard = 1; shard <= 4; shard++) {
+        assert(ring.addShard(shard));
+    }
+    assert(!ring.addShard(2) && ring.getShardCount() == 4);
+    std::vector<uint32_t> owners;
+    size_t perShard[6] = {0, 0, 0, 0, 0, 0};
+    for (int key = 0; key < 10000; key++) {
+        owners.push_back(ring.shardFor("room-" + std::to_string(key)));
+        perShard[owners.back()]++;
+    }
+    for (uint32_t shard = 1; shard <= 4; shard++) {
+        assert(perShard[shard] > 1500 && perShard[shard] < 3500);
+    }
+    ring.addShard(5);
+    size_t moved = 0;
+    for (int key = 0; key < 10000; key++) {
+        uint32_t owner = ring.shardFor("room-" + std::to_string(key));
+        if (owner != owners[key]) {
+            assert(owner == 5);   // Keys only move to the new shard
+            moved++;
+        }
+    }
+    std::cout << "Keys moved to the 5th shard: " << moved << " of 10000" << std::endl;
+    assert(moved > 1200 && moved < 3000);
+    assert(ring.removeShard(5) && !ring.hasShard(5));
+    for (int key = 0; key < 10000; key++) {
+        assert(ring.shardFor("room-" + std::to_string(key)) == owners[key]);
+    }
+    
+    std::cout << "\n--- Frames Round-Trip And Reject Truncation ---" << std::endl;
+    ShardFrame frame(ShardMessage::SEND);
+    frame.putString("Biscuit").putVarint(300).putString("");
+    std::string body = frame.data().substr(4);
+    assert(static_cast<uint8_t>(frame.data()[0]) == body.size());
+    ShardFrameReader reader(body);
+    std::string text;
+    uint64_t number = 0;
+    assert(reader.getType() == ShardMessage::SEND);
+    assert(reader.getString(text) && text == "Biscuit");
+    assert(reader.getVarint(number) && number == 300);
+    assert(reader.getString(text) && text.empty() && reader.atEnd());
+    std::string truncated = body.substr(0, body.size() - 3);
+    ShardFrameReader shortReader(truncated);
+    assert(shortReader.getString(text) && !shortReader.getVarint(number) && !shortReader.isValid());
+    
+    Logger::setLevel(NONE);
+    std::string socketBase = "/tmp/petspace-test-" + std::to_string(::getpid()) + "-shard";
+    ShardWorker first(socketBase + "1.sock");
+    ShardWorker second(socketBase + "2.sock");
+    ShardWorker third(socketBase + "3.sock");
+    assert(first.start() && second.start() && third.start());
+    ShardRouter router;
+    assert(router.addShard(socketBase + "missing.sock") == -1);
+    int firstId = router.addShard(first.getSocketPath());
+    int secondId = router.addShard(second.getSocketPath());
+    assert(firstId > 0 && secondId > 0 && router.getShardCount() == 2);
+    
+    std::cout << "\n--- One Quota For A Free User Across Shards ---" << std::endl;
+    std::string roomOnFirst;
+    std::string roomOnSecond;
+    for (int key = 0; roomOnFirst.empty() || roomOnSecond.empty(); key++) {
+        std::string room = "pack-" + std::to_string(key);
+        (router.getShardFor(room) == static_cast<uint32_t>(firstId) ? roomOnFirst : roomOnSecond) = room;
+    }
+    assert(router.join("Biscuit", UserType::FREE, roomOnFirst, ShardRoomKind::CTRLCAT));
+    assert(router.join("Biscuit", UserType::FREE, roomOnSecond));
+    assert(!router.join("Biscuit", UserType::FREE, roomOnSecond));
+    assert(!router.join("Biscuit", UserType::PREMIUM, "pack-elsewhere"));
+    assert(router.join("Rex", UserType::PREMIUM, roomOnFirst));
+    assert(router.getRoomInfo(roomOnFirst).members == 2 && router.getRoomInfo(roomOnSecond).members == 1);
+    assert(first.getRoomCount() == 1 && second.getRoomCount() == 1);
+    
+    assert(!router.send("Biscuit", roomOnSecond, "you are stupid"));   // Shard validation, no quota used
+    assert(!router.send("Rex", roomOnSecond, "Rex is not in this room"));
+    uint32_t limit = RateLimiter::getPolicy(UserType::FREE).capacity;
+    unsigned accepted = 0;
+    for (unsigned i = 0; i < limit + 2; i++) {
+        accepted += router.send("Biscuit", i % 2 ? roomOnFirst : roomOnSecond, "Woof number " + std::to_string(i)) ? 1 : 0;
+    }
+    std::cout << "Free sends accepted across two shards: " << accepted << " (daily limit " << limit << ")" << std::endl;
+    assert(limit == 0 || accepted == limit);
+    assert(router.getStats().quotaRejections == (limit == 0 ? 0u : 2u));
+    assert(router.send("Rex", roomOnFirst, "Premium users are not limited"));
+    
+    std::cout << "\n--- Adding A Shard Moves Rooms With Members And History ---" << std::endl;
+    for (int r = 0; r < 120; r++) {
+        std::string room = "park-" + std::to_string(r);
+        assert(router.join("Rex", UserType::PREMIUM, room));
+        assert(router.join("Luna" + std::to_string(r % 7), UserType::ADMIN, room));
+        assert(router.send("Rex", room, "Fetch at park " + std::to_string(r)));
+    }
+    size_t rooms = router.getRoomCount();
+    unsigned long movedBefore = router.getStats().roomsMoved;
+    int thirdId = router.addShard(third.getSocketPath());
+    assert(thirdId > 0);
+    unsigned long roomsMoved = router.getStats().roomsMoved - movedBefore;
+    std::cout << "Rooms moved to the 3rd shard: " << roomsMoved << " of " << rooms << std::endl;
+    assert(roomsMoved > rooms / 6 && roomsMoved < rooms / 2);
+    assert(third.getRoomCount() == roomsMoved);
+    assert(first.getRoomCount() + second.getRoomCount() + third.getRoomCount() == rooms);
+    for (int r = 0; r < 120; r++) {
+        std::string room = "park-" + std::to_string(r);
+        ShardRoomInfo info = router.getRoomInfo(room);
+        assert(info.exists && info.shard == router.getShardFor(room));
+        assert(info.members == 2 && info.historySize == 1);
+        assert(router.send("Rex", room, "Still here at park " + std::to_string(r)));
+        assert(router.getRoomInfo(room).historySize == 2);
+    }
+    assert(!router.send("Biscuit", roomOnFirst, "Still out of messages today"));
+    
+    std::cout << "\n--- Removing A Shard Hands Its Rooms Back ---" << std::endl;
+    assert(router.removeShard(static_cast<uint32_t>(thirdId)));
+    assert(third.getRoomCount() == 0 && third.getUserCount() == 0 && router.getShardCount() == 2);
+    assert(first.getRoomCount() + second.getRoomCount() == rooms);
+    for (int r = 0; r < 120; r += 13) {
+        assert(router.getRoomInfo("park-" + std::to_string(r)).historySize == 2);
+    }
+    assert(router.leave("Rex", "park-0") && !router.leave("Rex", "park-0"));
+    assert(!router.send("Rex", "park-0", "Rex left this park"));
+    assert(router.getRoomInfo("park-0").members == 1);
+    
+    std::cout << "\n--- Sends During A Move Are Not Lost ---" << std::endl;
+    ShardWorker fourth(socketBase + "4.sock");
+    assert(fourth.start());
+    std::vector<std::thread> senders;
+    std::atomic<int> sendFailures(0);
+    for (int t = 0; t < 2; t++) {
+        senders.push_back(std::thread([&router, &sendFailures, t]() {
+            for (int m = 0; m < 60; m++) {
+                std::string room = "park-" + std::to_string(1 + t * 20 + m % 20);
+                if (!router.send("Rex", room, "Zoomies " + std::to_string(m))) {
+                    sendFailures.fetch_add(1);
+                }
+            }
+        }));
+    }
+    int fourthId = router.addShard(fourth.getSocketPath());
+    for (size_t t = 0; t < senders.size(); t++) {
+        senders[t].join();
+    }
+    assert(fourthId > 0 && sendFailures.load() == 0);
+    for (int r = 1; r <= 40; r++) {
+        assert(router.getRoomInfo("park-" + std::to_string(r)).historySize == 5);
+    }
+    assert(router.removeShard(static_cast<uint32_t>(fourthId)) && fourth.getRoomCount() == 0);
+    
+    std::cout << "\n--- A Failed Move Leaves The Room Where It Was ---" << std::endl;
+    ShardWorker pagedFirst(socketBase + "5.sock");
+    ShardWorker pagedSecond(socketBase + "6.sock");
+    assert(pagedFirst.start() && pagedSecond.start());
+    ShardRouter paged(64);   // Two or three history lines per page
+    int pagedFirstId = paged.addShard(pagedFirst.getSocketPath());
+    int pagedSecondId = paged.addShard(pagedSecond.getSocketPath());
+    std::string kennel;
+    for (int key = 0; kennel.empty(); key++) {
+        if (paged.getShardFor("kennel-" + std::to_string(key)) == static_cast<uint32_t>(pagedFirstId)) {
+            kennel = "kennel-" + std::to_string(key);
+        }
+    }
+    assert(paged.join("Rex", UserType::PREMIUM, kennel) && paged.join("Luna", UserType::ADMIN, kennel));
+    for (int m = 0; m < 40; m++) {
+        assert(paged.send("Rex", kennel, "Bark number " + std::to_string(m)));
+    }
+    pagedSecond.stop();
+    assert(!paged.removeShard(static_cast<uint32_t>(pagedFirstId)));
+    assert(paged.getStats().failedMoves == 1 && paged.getStats().roomsMoved == 0);
+    ShardRoomInfo kept = paged.getRoomInfo(kennel);
+    assert(kept.shard == static_cast<uint32_t>(pagedFirstId) && kept.members == 2 && kept.historySize == 40);
+    assert(paged.send("Rex", kennel, "Still in the old kennel"));
+    
+    std::cout << "\n--- A Restarted Shard Is Reconnected And History Moves In Pages ---" << std::endl;
+    assert(pagedSecond.start());
+    assert(paged.removeShard(static_cast<uint32_t>(pagedFirstId)));
+    ShardRouterStats pagedStats = paged.getStats();
+    std::cout << "Moved " << pagedStats.historyMoved << " history entries in " << pagedStats.historyPages << " pages" << std::endl;
+    assert(pagedStats.roomsMoved == 1 && pagedStats.historyMoved == 41 && pagedStats.historyPages > 10);
+    ShardRoomInfo landed = paged.getRoomInfo(kennel);
+    assert(landed.shard == static_cast<uint32_t>(pagedSecondId) && landed.members == 2 && landed.historySize == 41);
+    assert(pagedFirst.getRoomCount() == 0 && pagedFirst.getUserCount() == 0 && pagedSecond.getRoomCount() == 1);
+    assert(paged.send("Rex", kennel, "New kennel, same pack"));
+    
+    std::cout << "\n--- A Stopped Shard Fails Calls Instead Of Hanging ---" << std::endl;
+    second.stop();
+    assert(!router.send("Biscuit", roomOnSecond, "That shard is gone"));
+    Logger::setLevel(USER_ONLY);
+}
+
+// ================== PRESENCE TEST ==================
+class PresenceProbe : public PremiumUser {
+public:
+    int received;
+    std::vector<std::string> missed;
+    
+    explicit PresenceProbe(const std::string& name) : PremiumUser(name), received(0) {}
+    
+    void receive(std::string message, User* fromUser, ChatRoom* room) override {
+        received++;
+        PremiumUser::receive(message, fromUser, room);
+    }
+    
+    void receiveMissed(const std::string& entry, ChatRoom* room) override {
+        missed.push_back(entry);
+        PremiumUser::receiveMissed(entry, room);
+    }
+};
+
+// Counts deliveries from any thread
+class CountingListener : public PremiumUser {
+public:
+    std::atomic<int> received;
+    
+    explicit CountingListener(const std::string& name) : PremiumUser(name), received(0) {}
+    
+    void receive(std::string message, User* fromUser, ChatRoom* room) override {
+        received.fetch_add(1);
+        PremiumUser::receive(message, fromUser, room);
+    }
+};
+
+// Takes a member offline just before the next save, i.e. between a pipeline's broadcast and persist stages
+class DozingRoom : public CtrlCat {
+public:
+    User* dozer;
+    
+    DozingRoom() : dozer(nullptr) {}
+    
+    void saveMessage(std::string message, User* fromUser) override {
+        if (dozer) {
+            dozer->goOffline();
+            dozer = nullptr;
+        }
+        CtrlCat::saveMessage(message, fromUser);
+    }
+};
+
+void testPresence() {
+    printSeparator("PRESENCE TEST");
+    Logger::setLevel(NONE);
+    
+    std::cout << "\n--- Offline Members Are Skipped On Broadcast ---" << std::endl;
+    ChatRoom* park = new Dogorithm();
+    PremiumUser* rex = new PremiumUser("Rex");
+    PresenceProbe* bella = new PresenceProbe("Bella");
+    PresenceProbe* milo = new PresenceProbe("Milo");
+    PresenceProbe* coco = new PresenceProbe("Coco");
+    park->registerUser(rex);
+    park->registerUser(bella);
+    park->registerUser(milo);
+    park->registerUser(coco);
+    assert(bella->isOnline() && park->getOnlineCount() == 4 && park->getMemberCount() == 4);
+    assert(rex->send("Morning walk at the park", park));
+    assert(bella->received == 1 && milo->received == 1 && coco->received == 1);
+    
+    milo->goOffline();
+    assert(!milo->isOnline() && park->getOnlineCount() == 3 && park->getMemberCount() == 4);
+    assert(rex->send("Who brought the frisbee", park));
+    assert(bella->send("I did, it is the red one", park));
+    assert(milo->received == 1 && coco->received == 3 && bella->received == 2);
+    
+    std::cout << "\n--- Reconnecting Catches Up From The Read Watermark ---" << std::endl;
+    assert(milo->goOnline() == 2 && milo->isOnline());
+    assert(milo->missed.size() == 2);
+    assert(milo->missed[0] == "Rex: Who brought the frisbee");
+    assert(milo->missed[1] == "Bella: I did, it is the red one");
+    assert(milo->goOnline() == 0);   // Already online
+    assert(rex->send("See you all tomorrow", park));
+    assert(milo->received == 2 && milo->missed.size() == 2);
+    
+    std::cout << "\n--- Own Messages Are Not Replayed ---" << std::endl;
+    milo->goOffline();
+    assert(milo->send("Typing this from the car", park));
+    assert(rex->send("Drive safe Milo", park));
+    milo->missed.clear();
+    assert(milo->goOnline() == 1 && milo->missed[0] == "Rex: Drive safe Milo");
+    
+    std::cout << "\n--- Own Means Same Sender, Not Same Prefix ---" << std::endl;
+    PresenceProbe* bo = new PresenceProbe("Bo");
+    PremiumUser* otherBo = new PremiumUser("Bo");        // Same name, different member
+    PremiumUser* boJunior = new PremiumUser("Bo: Jr");   // History prefix starts with "Bo: "
+    park->registerUser(bo);
+    park->registerUser(otherBo);
+    park->registerUser(boJunior);
+    bo->goOffline();
+    assert(otherBo->send("Not me, the other Bo", park));
+    assert(boJunior->send("Junior checking in", park));
+    assert(bo->send("Mine, skipped on replay", park));
+    assert(bo->goOnline() == 2 && bo->missed.size() == 2);
+    assert(bo->missed[0] == "Bo: Not me, the other Bo" && bo->missed[1] == "Bo: Jr: Junior checking in");
+    park->removeUser(bo);
+    park->removeUser(otherBo);
+    park->removeUser(boJunior);
+    delete bo;
+    delete otherBo;
+    delete boJunior;
+    
+    std::cout << "\n--- Going Offline Mid-Pipeline Loses Nothing ---" << std::endl;
+    DozingRoom* den = new DozingRoom();
+    PresenceProbe* dozer = new PresenceProbe("Dozer");
+    PremiumUser* chatter = new PremiumUser("Chatter");
+    den->registerUser(dozer);
+    den->registerUser(chatter);
+    den->dozer = dozer;
+    {
+        SendPipeline pipeline;
+        pipeline.submit(chatter, den, "Are you still there");
+        pipeline.drain();
+    }
+    assert(dozer->received == 1 && !dozer->isOnline());
+    assert(dozer->goOnline() == 1 && dozer->missed[0] == "Chatter: Are you still there");   // At least once
+    den->removeUser(dozer);
+    den->removeUser(chatter);
+    delete dozer;
+    delete chatter;
+    delete den;
+    
+    std::cout << "\n--- Joining While Offline Starts At The Current History ---" << std::endl;
+    PresenceProbe* luna = new PresenceProbe("Luna");
+    luna->goOffline();
+    park->registerUser(luna);
+    assert(park->getOnlineCount() == 4 && park->getMemberCount() == 5);
+    assert(rex->send("Welcome to the park Luna", park));
+    assert(luna->received == 0 && luna->goOnline() == 1);
+    
+    std::cout << "\n--- Presence Covers Every Room Joined ---" << std::endl;
+    ChatRoom* lounge = new CtrlCat();
+    lounge->registerUser(rex);
+    lounge->registerUser(coco);
+    coco->goOffline();
+    assert(park->getOnlineCount() == 4 && lounge->getOnlineCount() == 1);
+    assert(rex->send("Park message for Coco", park));
+    assert(rex->send("Lounge message for Coco", lounge));
+    coco->missed.clear();
+    assert(coco->goOnline() == 2 && coco->missed.size() == 2);
+    
+    std::cout << "\n--- Leaving Keeps The Online List Consistent ---" << std::endl;
+    bella->goOffline();
+    park->removeUser(bella);
+    bella->removeChatRoom(park);
+    park->removeUser(milo);
+    milo->removeChatRoom(park);
+    assert(park->getMemberCount() == 3 && park->getOnlineCount() == 3);
+    int cocoBefore = coco->received;
+    int lunaBefore = luna->received;
+    assert(rex->send("Fewer of us now at the park", park));
+    assert(coco->received == cocoBefore + 1 && luna->received == lunaBefore + 1);
+    assert(!park->hasMember(bella->getHandle()) && park->hasMember(coco->getHandle()));
+    assert(bella->goOnline() == 0);
+    
+    std::cout << "\n--- Fan-Out Scales With Online Members ---" << std::endl;
+    ChatRoom* stadium = new Dogorithm();
+    std::vector<PresenceProbe*> crowd;
+    for (int i = 0; i < 500; i++) {
+        crowd.push_back(new PresenceProbe("Fan" + std::to_string(i)));
+        stadium->registerUser(crowd.back());
+        if (i % 50 != 0) {
+            crowd.back()->goOffline();
+        }
+    }
+    stadium->registerUser(rex);
+    assert(stadium->getMemberCount() == 501 && stadium->getOnlineCount() == 11);
+    assert(rex->send("Goal for the home team", stadium));
+    int delivered = 0;
+    for (size_t i = 0; i < crowd.size(); i++) {
+        delivered += crowd[i]->received;
+    }
+    std::cout << "Delivered to " << delivered << " of " << crowd.size() << " members" << std::endl;
+    assert(delivered == 10);
+    assert(crowd[1]->goOnline() == 1 && stadium->getOnlineCount() == 12);
+    
+    std::cout << "\n--- Membership Changes During Concurrent Sends ---" << std::endl;
+    ChatRoom* arena = new CtrlCat();
+    std::vector<CountingListener*> listeners;
+    for (int i = 0; i < 16; i++) {
+        listeners.push_back(new CountingListener("Listener" + std::to_string(i)));
+        arena->registerUser(listeners.back());
+    }
+    std::vector<PremiumUser*> lanes;
+    for (int i = 0; i < 3; i++) {
+        lanes.push_back(new PremiumUser("Lane" + std::to_string(i)));
+        arena->registerUser(lanes.back());
+    }
+    std::vector<std::thread> senders;
+    for (size_t i = 0; i < lanes.size(); i++) {
+        senders.push_back(std::thread([arena, &lanes, i]() {
+            for (int m = 0; m < 300; m++) {
+                arena->sendMessage("Lane traffic", lanes[i]);
+            }
+        }));
+    }
+    for (int round = 0; round < 50; round++) {
+        CountingListener* toggled = listeners[round % listeners.size()];
+        toggled->goOffline();
+        PremiumUser* visitor = new PremiumUser("Visitor" + std::to_string(round));
+        arena->registerUser(visitor);
+        arena->removeUser(visitor);
+        delete visitor;
+        toggled->goOnline();
+    }
+    for (size_t i = 0; i < senders.size(); i++) {
+        senders[i].join();
+    }
+    assert(arena->getMemberCount() == 19 && arena->getOnlineCount() == 19);
+    int arenaDelivered = 0;
+    for (size_t i = 0; i < listeners.size(); i++) {
+        arenaDelivered += listeners[i]->received.load();
+    }
+    assert(arenaDelivered > 0 && arenaDelivered <= 900 * 16);
+    for (size_t i = 0; i < listeners.size(); i++) {
+        arena->removeUser(listeners[i]);
+        delete listeners[i];
+    }
+    for (size_t i = 0; i < lanes.size(); i++) {
+        arena->removeUser(lanes[i]);
+        delete lanes[i];
+    }
+    delete arena;
+
+    std::cout << "\n--- Reconnecting While Saves Commit ---" << std::endl;
+    ChatRoom* kennel = new Dogorithm();
+    kennel->setGroupCommit(GroupCommitOptions(4));   // Commits grow the history on the saving threads
+    PresenceProbe* napper = new PresenceProbe("Napper");
+    kennel->registerUser(napper);
+    std::vector<PremiumUser*> barkers;
+    for (int i = 0; i < 3; i++) {
+        barkers.push_back(new PremiumUser("Barker" + std::to_string(i)));
+        kennel->registerUser(barkers.back());
+    }
+    std::vector<std::thread> savers;
+    std::atomic<int> doneSaving(0);
+    for (size_t i = 0; i < barkers.size(); i++) {
+        savers.push_back(std::thread([kennel, &barkers, &doneSaving, i]() {
+            for (int m = 0; m < 500; m++) {
+                kennel->saveMessage("Bark " + std::to_string(m), barkers[i]);
+            }
+            doneSaving.fetch_add(1);
+        }));
+    }
+    size_t caughtUp = 0;
+    while (doneSaving.load() < static_cast<int>(savers.size())) {
+        napper->goOffline();
+        caughtUp += napper->goOnline();
+    }
+    for (size_t i = 0; i < savers.size(); i++) {
+        savers[i].join();
+    }
+    assert(kennel->getHistorySize() == 1500);
+    assert(caughtUp == napper->missed.size() && caughtUp <= 1500);
+    kennel->removeUser(napper);
+    delete napper;
+    for (size_t i = 0; i < barkers.size(); i++) {
+        kennel->removeUser(barkers[i]);
+        delete barkers[i];
+    }
+    delete kennel;
+
+    for (size_t i = 0; i < crowd.size(); i++) {
+        stadium->removeUser(crowd[i]);
+        delete crowd[i];
+    }
+    stadium->removeUser(rex);
+    park->removeUser(coco);
+    park->removeUser(luna);
+    park->removeUser(rex);
+    lounge->removeUser(rex);
+    lounge->removeUser(coco);
+    delete stadium;
+    delete lounge;
+    delete park;
+    delete rex;
+    delete bella;
+    delete milo;
+    delete coco;
+    delete luna;
+    Logger::setLevel(USER_ONLY);
+}
 
 // ================== MAIN FUNCTION ==================
 int main() {
@@ -847,6 +3303,30 @@ int main() {
 
     testDailyCountGetters();
     testToStringMethods();
+    testBlockListReload();
+    testVerdictCache();
+    testBatchValidation();
+    testObfuscatedProfanity();
+    testSubstringSearcher();
+    testRateLimiter();
+    testAsyncLogger();
+    testLazyLogging();
+    testStructuredLog();
+    testComponentLogging();
+    testFileSink();
+    testCommandPool();
+    testCommandVariant();
+    testCommandExecutor();
+    testGroupCommit();
+    testSendPipeline();
+    testCommandJournal();
+    testCommandScheduler();
+    testDeferredFlush();
+    testUserTable();
+    testStringInterning();
+    testRoomSet();
+    testSharding();
+    testPresence();
     std::cout << "\n=== All Tests Complete ===" << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Implementation of ThreadPool
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-07
+ */
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount) : stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 2;
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && tasks.empty()) {
+                taskReady.wait(lock);
+            }
+            if (tasks.empty()) {
+                return;  // Stopping and drained
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+namespace {
+
+// Shared between the caller and helper tasks, which may outlive the call
+struct ParallelForState {
+    std::atomic<size_t> nextChunk;
+    std::atomic<size_t> chunksDone;
+    size_t chunkCount;
+    size_t chunkSize;
+    size_t count;
+    const std::function<void(size_t, size_t)>* body;
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    ParallelForState() : nextChunk(0), chunksDone(0), chunkCount(0), chunkSize(0), count(0), body(nullptr) {}
+
+    // Returns once no chunks are left to claim
+    void runChunks() {
+        for (;;) {
+            size_t chunk = nextChunk.fetch_add(1);
+            if (chunk >= chunkCount) {
+                return;
+            }
+
+            size_t begin = chunk * chunkSize;
+            size_t end = std::min(count, begin + chunkSize);
+            (*body)(begin, end);
+
+            if (chunksDone.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace
+
+void ThreadPool::parallelFor(size_t count, size_t grain,
+                             const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) grain = 1;
+
+    // A few chunks per thread keeps the load balanced without tiny tasks
+    size_t maxChunks = (workers.size() + 1) * 4;
+    size_t chunkSize = std::max(grain, (count + maxChunks - 1) / maxChunks);
+    size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    if (chunkCount == 1) {
+        body(0, count);
+        return;
+    }
+
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    state->chunkCount = chunkCount;
+    state->chunkSize = chunkSize;
+    state->count = count;
+    state->body = &body;
+
+    size_t helpers = std::min(workers.size(), chunkCount - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        submit([state]() { state->runChunks(); });
+    }
+
+    state->runChunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (state->chunksDone.load() != chunkCount) {
+        state->finished.wait(lock);
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
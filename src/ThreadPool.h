@@ -0,0 +1,73 @@
+/**
+ * @file ThreadPool.h
+ * @brief Fixed-size worker pool for parallel chat work
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-07
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Runs submitted tasks on a fixed set of worker threads
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()> > tasks;
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    bool stopping;
+
+    void workerLoop();
+
+public:
+    /**
+     * @brief Start the workers
+     * @param threadCount Number of workers, 0 for one per hardware thread
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * @brief Finish queued tasks and join the workers
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Queue a task for any worker
+     * @param task Work to run
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Split [0, count) into chunks and run them in parallel
+     * @param count Number of items
+     * @param grain Minimum items per chunk
+     * @param body Called with [begin, end) for each chunk
+     *
+     * The calling thread works on chunks too and returns once all are done.
+     */
+    void parallelFor(size_t count, size_t grain,
+                     const std::function<void(size_t, size_t)>& body);
+
+    size_t getThreadCount() const { return workers.size(); }
+
+    /**
+     * @brief Process-wide pool, created on first use
+     */
+    static ThreadPool& shared();
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,148 @@
+/**
+ * @file TimerService.cpp
+ * @brief Implementation of TimerService
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#include "TimerService.h"
+#include "TimingWheel.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const uint64_t TICK_MILLIS = 1;
+
+struct PendingTimer {
+    uint64_t wheelId;
+    TimerService::Callback callback;
+};
+
+std::mutex serviceMutex;                       // Guards everything below
+std::condition_variable wakeTimer;
+std::condition_variable callbackDone;
+TimingWheel* wheel = nullptr;
+std::map<uint64_t, PendingTimer> pending;      // By the id handed to callers
+std::vector<uint64_t> due;                     // Fired by the wheel, not yet run
+uint64_t nextTimerId = 1;
+uint64_t runningTimer = 0;                     // Callback executing right now, 0 if none
+std::thread timerThread;
+bool running = false;
+bool stopped = false;
+
+uint64_t steadyMillis() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void timerLoop() {
+    std::unique_lock<std::mutex> lock(serviceMutex);
+    while (!stopped) {
+        if (pending.empty()) {
+            wakeTimer.wait(lock);
+        } else {
+            wakeTimer.wait_for(lock, std::chrono::milliseconds(TICK_MILLIS));
+        }
+        if (stopped) {
+            break;
+        }
+
+        wheel->advanceTo(steadyMillis());   // Wheel callbacks only record what is due
+        for (size_t i = 0; i < due.size(); i++) {
+            std::map<uint64_t, PendingTimer>::iterator it = pending.find(due[i]);
+            if (it == pending.end()) {
+                continue;
+            }
+            TimerService::Callback callback;
+            callback.swap(it->second.callback);
+            pending.erase(it);
+
+            runningTimer = due[i];
+            lock.unlock();
+            callback();
+            lock.lock();
+            runningTimer = 0;
+            callbackDone.notify_all();
+        }
+        due.clear();
+    }
+}
+
+// Stops the thread before the statics it uses go away
+struct TimerShutdown {
+    ~TimerShutdown() {
+        TimerService::shutdown();
+    }
+};
+
+TimerShutdown timerShutdown;
+
+} // namespace
+
+uint64_t TimerService::schedule(uint64_t delayMillis, Callback callback) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    if (stopped) {
+        return 0;
+    }
+    if (!running) {
+        wheel = new TimingWheel(TICK_MILLIS, steadyMillis());
+        timerThread = std::thread(timerLoop);
+        running = true;
+    }
+
+    // Measure the delay from now, not from wherever the wheel last stopped
+    uint64_t current = steadyMillis();
+    uint64_t lag = current > wheel->getCurrentMillis() ? current - wheel->getCurrentMillis() : 0;
+
+    uint64_t timerId = nextTimerId++;
+    PendingTimer timer;
+    timer.wheelId = wheel->schedule(delayMillis + lag, [timerId]() { due.push_back(timerId); });
+    timer.callback.swap(callback);
+    pending.insert(std::make_pair(timerId, std::move(timer)));
+    wakeTimer.notify_one();
+    return timerId;
+}
+
+bool TimerService::cancel(uint64_t timerId) {
+    std::unique_lock<std::mutex> lock(serviceMutex);
+    std::map<uint64_t, PendingTimer>::iterator it = pending.find(timerId);
+    if (it != pending.end()) {
+        wheel->cancel(it->second.wheelId);
+        pending.erase(it);
+        return true;
+    }
+
+    // Already firing: wait it out, unless this is the callback cancelling itself
+    if (std::this_thread::get_id() != timerThread.get_id()) {
+        callbackDone.wait(lock, [timerId]() { return runningTimer != timerId; });
+    }
+    return false;
+}
+
+std::size_t TimerService::getPendingCount() {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    return pending.size();
+}
+
+void TimerService::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(serviceMutex);
+        if (stopped) {
+            return;
+        }
+        stopped = true;
+        wakeTimer.notify_one();
+    }
+    if (running) {
+        timerThread.join();
+    }
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    pending.clear();
+    delete wheel;
+    wheel = nullptr;
+}
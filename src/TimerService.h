@@ -0,0 +1,60 @@
+/**
+ * @file TimerService.h
+ * @brief Background thread that fires TimingWheel callbacks on time
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef TIMERSERVICE_H
+#define TIMERSERVICE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @class TimerService
+ * @brief Shared millisecond timer driven by its own thread
+ *
+ * RateLimiter's events only fire when someone calls processEvents(); this
+ * service runs a TimingWheel on a background thread instead, so deadlines
+ * such as a deferred command flush are met without any caller polling.
+ * The thread starts with the first schedule() and sleeps while nothing is
+ * pending.
+ *
+ * Callbacks run on the timer thread outside the service lock, so they may
+ * schedule or cancel timers and take their owner's locks. Once cancel()
+ * returns on another thread the callback has either finished or will
+ * never run, so an owner can cancel in its destructor and then go away.
+ * Do not cancel a timer while holding a lock its callback takes.
+ */
+class TimerService {
+private:
+    TimerService() = delete;
+
+public:
+    typedef std::function<void()> Callback;
+
+    /**
+     * @brief Run a callback on the timer thread after a delay
+     * @param delayMillis Milliseconds from now (rounded up to the 1 ms tick)
+     * @param callback Callback to run
+     * @return Id for cancel(), 0 if the service has shut down
+     */
+    static uint64_t schedule(uint64_t delayMillis, Callback callback);
+
+    /**
+     * @brief Cancel a pending timer
+     * @return true if it had not fired yet
+     */
+    static bool cancel(uint64_t timerId);
+
+    static std::size_t getPendingCount();
+
+    /**
+     * @brief Stop the thread and drop pending timers (done automatically at exit)
+     */
+    static void shutdown();
+};
+
+#endif // TIMERSERVICE_H
@@ -0,0 +1,144 @@
+/**
+ * @file TimingWheel.cpp
+ * @brief Implementation of the hierarchical timing wheel
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-09
+ */
+
+#include "TimingWheel.h"
+
+TimingWheel::TimingWheel(uint64_t tickMillis, uint64_t startMillis)
+    : tickMillis(tickMillis ? tickMillis : 1), currentTick(0), activeCount(0) {
+    currentTick = startMillis / this->tickMillis;
+    for (unsigned level = 0; level < LEVELS; level++) {
+        levelCount[level] = 0;
+    }
+}
+
+void TimingWheel::place(uint32_t index) {
+    uint64_t expiry = timers[index].expiryTick;
+    uint64_t delta = expiry > currentTick ? expiry - currentTick : 0;
+
+    for (unsigned level = 0; level < LEVELS; level++) {
+        uint64_t span = 1ULL << (SLOT_BITS * (level + 1));
+        if (delta < span || level == LEVELS - 1) {
+            // Beyond the top level: park in the furthest slot and re-cascade later
+            uint64_t slotTick = delta < span ? expiry : currentTick + span - 1;
+            size_t slot = (slotTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+            slots[level][slot].push_back(index);
+            levelCount[level]++;
+            return;
+        }
+    }
+}
+
+void TimingWheel::cascade(unsigned level) {
+    if (level >= LEVELS) {
+        return;
+    }
+
+    size_t slot = (currentTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+    if (slot == 0) {
+        cascade(level + 1);  // Higher levels feed this one first
+    }
+
+    std::vector<uint32_t> moving;
+    moving.swap(slots[level][slot]);
+    levelCount[level] -= moving.size();
+    for (size_t i = 0; i < moving.size(); i++) {
+        if (timers[moving[i]].active) {
+            place(moving[i]);
+        } else {
+            freeTimers.push_back(moving[i]);
+        }
+    }
+}
+
+uint64_t TimingWheel::schedule(uint64_t delayMillis, Callback callback) {
+    uint32_t index;
+    if (freeTimers.empty()) {
+        index = static_cast<uint32_t>(timers.size());
+        timers.push_back(Timer());
+        timers[index].generation = 0;
+    } else {
+        index = freeTimers.back();
+        freeTimers.pop_back();
+    }
+
+    Timer& timer = timers[index];
+    uint64_t delayTicks = (delayMillis + tickMillis - 1) / tickMillis;
+    timer.expiryTick = currentTick + (delayTicks ? delayTicks : 1);
+    timer.callback = callback;
+    timer.generation++;
+    timer.active = true;
+    activeCount++;
+
+    place(index);
+    return (static_cast<uint64_t>(timer.generation) << 32) | index;
+}
+
+bool TimingWheel::cancel(uint64_t timerId) {
+    uint32_t index = static_cast<uint32_t>(timerId);
+    uint32_t generation = static_cast<uint32_t>(timerId >> 32);
+    if (index >= timers.size() || timers[index].generation != generation || !timers[index].active) {
+        return false;
+    }
+
+    // Lazily removed from its slot; the pool entry is recycled when the slot is visited
+    timers[index].active = false;
+    timers[index].callback = Callback();
+    activeCount--;
+    return true;
+}
+
+size_t TimingWheel::advanceTo(uint64_t nowMillis) {
+    uint64_t targetTick = nowMillis / tickMillis;
+    size_t fired = 0;
+
+    while (currentTick < targetTick) {
+        if (activeCount == 0) {
+            currentTick = targetTick;  // Nothing to cascade or fire
+            break;
+        }
+
+        // With the lowest levels empty nothing can happen before the next
+        // cascade into them, so jump to the tick just before it
+        unsigned emptyLevels = 0;
+        while (emptyLevels < LEVELS - 1 && levelCount[emptyLevels] == 0) {
+            emptyLevels++;
+        }
+        if (emptyLevels > 0) {
+            uint64_t lastQuietTick = currentTick | ((1ULL << (SLOT_BITS * emptyLevels)) - 1);
+            if (lastQuietTick > currentTick) {
+                currentTick = lastQuietTick < targetTick ? lastQuietTick : targetTick;
+                continue;
+            }
+        }
+
+        currentTick++;
+        size_t slot = currentTick & (SLOTS - 1);
+        if (slot == 0) {
+            cascade(1);
+        }
+
+        std::vector<uint32_t> due;
+        due.swap(slots[0][slot]);
+        levelCount[0] -= due.size();
+        for (size_t i = 0; i < due.size(); i++) {
+            Timer& timer = timers[due[i]];
+            if (timer.active) {
+                Callback callback = timer.callback;
+                timer.active = false;
+                timer.callback = Callback();
+                activeCount--;
+                freeTimers.push_back(due[i]);
+                callback();   // May schedule more timers
+                fired++;
+            } else {
+                freeTimers.push_back(due[i]);
+            }
+        }
+    }
+
+    return fired;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file TimingWheel.h
+ * @brief Hierarchical timing wheel for scheduled chat events
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-09
+ */
+
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @class TimingWheel
+ * @brief Schedules callbacks with O(1) insert and cancel
+ *
+ * Four levels of 64 slots; level n slots are 64^n ticks wide. Timers far in
+ * the future sit in a coarse level and cascade down as the wheel turns, so
+ * advancing costs one slot visit per tick no matter how many timers exist.
+ * Not thread-safe: callers serialise access (see RateLimiter).
+ */
+class TimingWheel {
+public:
+    typedef std::function<void()> Callback;
+
+private:
+    static const unsigned LEVELS = 4;
+    static const unsigned SLOT_BITS = 6;
+    static const unsigned SLOTS = 1u << SLOT_BITS;
+
+    struct Timer {
+        uint64_t expiryTick;
+        Callback callback;
+        uint32_t generation;   // Bumped on reuse so stale ids cannot cancel
+        bool active;
+    };
+
+    uint64_t tickMillis;
+    uint64_t currentTick;
+    std::vector<Timer> timers;                 // Pool indexed by the low half of an id
+    std::vector<uint32_t> freeTimers;
+    std::vector<uint32_t> slots[LEVELS][SLOTS];
+    size_t levelCount[LEVELS];                 // Entries (live or cancelled) per level
+    size_t activeCount;
+
+    void place(uint32_t index);
+    void cascade(unsigned level);
+
+public:
+    /**
+     * @brief Create a wheel
+     * @param tickMillis Resolution of one tick in milliseconds
+     * @param startMillis Clock reading the wheel starts at
+     */
+    explicit TimingWheel(uint64_t tickMillis = 1000, uint64_t startMillis = 0);
+
+    /**
+     * @brief Schedule a callback
+     * @param delayMillis Delay from the wheel's current time (rounded up to a tick)
+     * @param callback Work to run from advanceTo()
+     * @return Non-zero timer id
+     */
+    uint64_t schedule(uint64_t delayMillis, Callback callback);
+
+    /**
+     * @brief Cancel a pending timer
+     * @param timerId Id returned by schedule()
+     * @return true if the timer was pending
+     */
+    bool cancel(uint64_t timerId);
+
+    /**
+     * @brief Turn the wheel up to a clock reading and run due callbacks
+     * @param nowMillis Current clock reading
+     * @return Number of callbacks run
+     */
+    size_t advanceTo(uint64_t nowMillis);
+
+    size_t getPendingCount() const { return activeCount; }
+    uint64_t getCurrentMillis() const { return currentTick * tickMillis; }
+};
+
+#endif // TIMINGWHEEL_H
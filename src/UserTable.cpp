@@ -0,0 +1,199 @@
+/**
+ * @file UserTable.cpp
+ * @brief Implementation of UserTable
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#include "UserTable.h"
+#include "Users.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace {
+
+const uint32_t CHUNK_BITS = 12;
+const uint32_t CHUNK_SLOTS = 1u << CHUNK_BITS;
+const uint32_t MAX_CHUNKS = UserTable::MAX_USERS >> CHUNK_BITS;
+const uint8_t FREE_SLOT = 0xFF;   // Type column value for slots without a user
+
+// One column per field; a send reads a few bytes from each of a few columns
+struct UserChunk {
+    std::atomic<uint8_t> generations[CHUNK_SLOTS];
+    std::atomic<User*> users[CHUNK_SLOTS];
+    uint8_t types[CHUNK_SLOTS];
+    unsigned strategyKeys[CHUNK_SLOTS];
+    TokenBucket quotas[CHUNK_SLOTS];
+    uint32_t nameHashes[CHUNK_SLOTS];    // Rejects most name lookups without touching the text
+    std::string names[CHUNK_SLOTS];
+    std::string prefixes[CHUNK_SLOTS];   // "name: ", built once per user
+
+    UserChunk() {
+        for (uint32_t i = 0; i < CHUNK_SLOTS; i++) {
+            generations[i].store(0, std::memory_order_relaxed);
+            users[i].store(nullptr, std::memory_order_relaxed);
+            types[i] = FREE_SLOT;
+            strategyKeys[i] = 0;
+            nameHashes[i] = 0;
+        }
+    }
+};
+
+// Chunks are never freed, so readers can hold references without a lock
+std::atomic<UserChunk*> chunks[MAX_CHUNKS];
+
+std::mutex tableMutex;                 // Guards everything below
+std::deque<uint32_t> freeSlots;        // FIFO, so one slot's generation wraps as late as possible
+uint32_t slotCount = 0;
+std::size_t liveCount = 0;
+std::size_t liveLimit = UserTable::MAX_USERS;
+
+UserChunk& chunkFor(uint32_t index) {
+    return *chunks[index >> CHUNK_BITS].load(std::memory_order_acquire);
+}
+
+uint32_t slotFor(uint32_t index) {
+    return index & (CHUNK_SLOTS - 1);
+}
+
+} // namespace
+
+UserHandle UserTable::add(User* user, const std::string& name, UserType type) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    uint32_t index;
+    if (liveCount >= liveLimit) {
+        return UserHandle();
+    } else if (!freeSlots.empty()) {
+        index = freeSlots.front();
+        freeSlots.pop_front();
+    } else if (slotCount < MAX_USERS) {
+        index = slotCount++;
+        if (slotFor(index) == 0) {
+            chunks[index >> CHUNK_BITS].store(new UserChunk(), std::memory_order_release);
+        }
+    } else {
+        return UserHandle();
+    }
+
+    UserChunk& chunk = chunkFor(index);
+    uint32_t slot = slotFor(index);
+    uint8_t generation = chunk.generations[slot].load(std::memory_order_relaxed);
+    if (generation == 0) {
+        generation = 1;   // First use; 0 is reserved so no handle is all zeros
+        chunk.generations[slot].store(generation, std::memory_order_relaxed);
+    }
+    chunk.names[slot] = name;
+    chunk.prefixes[slot].reserve(name.size() + 2);
+    chunk.prefixes[slot].append(name).append(": ");
+    chunk.nameHashes[slot] = StringRef(name).hash();
+    chunk.types[slot] = static_cast<uint8_t>(type);
+    chunk.strategyKeys[slot] = 0;
+    chunk.quotas[slot] = TokenBucket();
+    chunk.users[slot].store(user, std::memory_order_release);
+    liveCount++;
+    return UserHandle((static_cast<uint32_t>(generation) << 24) | index);
+}
+
+void UserTable::remove(UserHandle handle) {
+    if (!resolve(handle)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(tableMutex);
+    UserChunk& chunk = chunkFor(handle.index());
+    uint32_t slot = slotFor(handle.index());
+    chunk.users[slot].store(nullptr, std::memory_order_release);
+    chunk.types[slot] = FREE_SLOT;
+    std::string().swap(chunk.names[slot]);   // Release the text, not just clear it
+    std::string().swap(chunk.prefixes[slot]);
+
+    // Retire the generation now so stale handles fail straight away
+    uint8_t next = static_cast<uint8_t>(handle.generation() + 1);
+    chunk.generations[slot].store(next == 0 ? 1 : next, std::memory_order_release);
+    freeSlots.push_back(handle.index());
+    liveCount--;
+}
+
+User* UserTable::resolve(UserHandle handle) {
+    if (handle.isNull()) {
+        return nullptr;
+    }
+    UserChunk* chunk = chunks[handle.index() >> CHUNK_BITS].load(std::memory_order_acquire);
+    if (!chunk) {
+        return nullptr;
+    }
+    uint32_t slot = slotFor(handle.index());
+    if (chunk->generations[slot].load(std::memory_order_acquire) != handle.generation()) {
+        return nullptr;
+    }
+    User* user = chunk->users[slot].load(std::memory_order_acquire);
+
+    // The slot may have been freed and reused between the two loads
+    if (chunk->generations[slot].load(std::memory_order_acquire) != handle.generation()) {
+        return nullptr;
+    }
+    return user;
+}
+
+const std::string& UserTable::getName(UserHandle handle) {
+    return chunkFor(handle.index()).names[slotFor(handle.index())];
+}
+
+const std::string& UserTable::getHistoryPrefix(UserHandle handle) {
+    return chunkFor(handle.index()).prefixes[slotFor(handle.index())];
+}
+
+uint32_t UserTable::getNameHash(UserHandle handle) {
+    return chunkFor(handle.index()).nameHashes[slotFor(handle.index())];
+}
+
+UserType UserTable::getType(UserHandle handle) {
+    return static_cast<UserType>(chunkFor(handle.index()).types[slotFor(handle.index())]);
+}
+
+TokenBucket& UserTable::getQuota(UserHandle handle) {
+    return chunkFor(handle.index()).quotas[slotFor(handle.index())];
+}
+
+unsigned UserTable::getStrategyKey(UserHandle handle) {
+    return chunkFor(handle.index()).strategyKeys[slotFor(handle.index())];
+}
+
+void UserTable::setStrategyKey(UserHandle handle, unsigned key) {
+    chunkFor(handle.index()).strategyKeys[slotFor(handle.index())] = key;
+}
+
+std::size_t UserTable::countByType(UserType type) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    uint8_t wanted = static_cast<uint8_t>(type);
+    std::size_t count = 0;
+    for (uint32_t index = 0; index < slotCount; index += CHUNK_SLOTS) {
+        const uint8_t* types = chunkFor(index).types;
+        uint32_t slots = slotCount - index < CHUNK_SLOTS ? slotCount - index : CHUNK_SLOTS;
+        for (uint32_t slot = 0; slot < slots; slot++) {
+            count += types[slot] == wanted;
+        }
+    }
+    return count;
+}
+
+std::size_t UserTable::getLiveCount() {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    return liveCount;
+}
+
+std::size_t UserTable::getSlotCount() {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    return slotCount;
+}
+
+void UserTable::setLimit(std::size_t maxLive) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    liveLimit = maxLive < MAX_USERS ? maxLive : MAX_USERS;
+}
+
+std::size_t UserTable::getLimit() {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    return liveLimit;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file UserTable.h
+ * @brief Generational user handles and column storage for hot user fields
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-18
+ */
+
+#ifndef USERTABLE_H
+#define USERTABLE_H
+
+#include "RateLimiter.h"
+#include "StringInterner.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class User;
+enum class UserType;
+
+/**
+ * @brief 32-bit reference to a user: 24-bit slot index and 8-bit generation
+ *
+ * A slot's generation changes each time it is reused, so a handle kept
+ * after its user is destroyed resolves to nullptr instead of to whoever
+ * took the slot next. The zero value is never issued.
+ */
+struct UserHandle {
+    uint32_t value;
+
+    UserHandle() : value(0) {}
+    explicit UserHandle(uint32_t value) : value(value) {}
+
+    uint32_t index() const { return value & 0xFFFFFFu; }
+    uint8_t generation() const { return static_cast<uint8_t>(value >> 24); }
+    bool isNull() const { return value == 0; }
+
+    bool operator==(const UserHandle& other) const { return value == other.value; }
+    bool operator!=(const UserHandle& other) const { return value != other.value; }
+};
+
+/**
+ * @class UserTable
+ * @brief Registry of every live User, stored column by column
+ *
+ * Each User takes a slot when constructed and frees it when destroyed.
+ * The fields read on every send (type, quota, strategy key), the name
+ * and its "name: " history prefix live in parallel arrays, so a sweep
+ * over one field touches only that field's memory. Names are per user
+ * and unbounded, so they are stored here and released with the slot
+ * rather than interned. Slots come in fixed chunks that are never moved or
+ * freed, so references returned here stay valid while the user lives and
+ * readers need no lock. Adding and removing users takes a mutex.
+ */
+class UserTable {
+private:
+    UserTable() = delete;
+
+public:
+    static const uint32_t MAX_USERS = 1u << 24;
+
+    /**
+     * @brief Take a slot for a new user
+     * @return Handle for the user, or a null handle if the table is full
+     *
+     * The User constructor throws std::length_error on a null handle, so
+     * no user is ever created without a slot of its own.
+     */
+    static UserHandle add(User* user, const std::string& name, UserType type);
+
+    /**
+     * @brief Free a user's slot; its handles stop resolving
+     */
+    static void remove(UserHandle handle);
+
+    /**
+     * @brief The user a handle refers to
+     * @return nullptr if the user has been destroyed
+     */
+    static User* resolve(UserHandle handle);
+
+    static bool isLive(UserHandle handle) { return resolve(handle) != nullptr; }
+
+    // Columns; the handle must be live
+    static const std::string& getName(UserHandle handle);
+    static const std::string& getHistoryPrefix(UserHandle handle);
+    static uint32_t getNameHash(UserHandle handle);   ///< StringRef::hash() of the name
+    static UserType getType(UserHandle handle);
+    static TokenBucket& getQuota(UserHandle handle);
+    static unsigned getStrategyKey(UserHandle handle);
+    static void setStrategyKey(UserHandle handle, unsigned key);
+
+    /**
+     * @brief Count live users of one type by scanning only the type column
+     */
+    static std::size_t countByType(UserType type);
+
+    static std::size_t getLiveCount();
+
+    /**
+     * @brief Cap the number of live users (MAX_USERS by default)
+     *
+     * add() refuses new users once the cap is reached; users already
+     * registered are not affected by lowering it.
+     */
+    static void setLimit(std::size_t maxLive);
+    static std::size_t getLimit();
+
+    /**
+     * @brief Slots allocated so far (live, free or waiting for reuse)
+     */
+    static std::size_t getSlotCount();
+};
+
+#endif // USERTABLE_H
@@ -8,34 +8,58 @@
 #include "Users.h"
 #include "ChatRoom.h"
 #include "Command.h"
-#include "SendMessageCommand.h"
-#include "SaveMessageCommand.h"
+#include "CommandScheduler.h"
 #include "Logger.h"
+#include "SendPipeline.h"
+#include "TimerService.h"
 #include "ValidationStrategy.h"
 #include "Iterator.h"
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ================== Base User Class ==================
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-User::User(std::string userName, UserType type) : name(userName), userType(type), validationStrategy(nullptr) {
-    Logger::debug("[" + getUserTypeString() + " User] " + name + " base constructor");
+namespace {
+
+// A user without a slot would read another user's columns, so refuse it outright
+UserHandle claimSlot(User* user, const std::string& name, UserType type) {
+    UserHandle handle = UserTable::add(user, name, type);
+    if (handle.isNull()) {
+        LOG_INFO_IN(USER, "Cannot add " + name + ": the user table is full");
+        throw std::length_error("UserTable is full (" + std::to_string(UserTable::getLiveCount()) + " live users)");
+    }
+    return handle;
+}
+
+} // namespace
+
+User::User(std::string userName, UserType type)
+    : handle(claimSlot(this, userName, type)), name(UserTable::getName(handle)),
+      historyPrefix(UserTable::getHistoryPrefix(handle)), userType(type), flushTimer(0), flushArmed(false), timedRoomCalls(0), asyncExecution(false), online(true), commandScheduler(nullptr),
+      validationStrategy(nullptr) {
+    CommandFlushStats noFlushes = {0, 0, 0, 0};
+    flushStats = noFlushes;
+    LOG_DEBUG_IN(USER, "[" + getUserTypeString() + " User] " + name + " base constructor");
 }
 
 User::~User() {
-    std::vector<Command*>::iterator it;
-    for (it = commandQueue.begin(); it != commandQueue.end(); it++) {
-        delete *it;
+    cancelFlushTimer();
+    flushCommands();              // Deferred sends still go out
+    commandExecutor.waitIdle();   // Queued batches still point at this user
+    if (commandScheduler) {
+        commandScheduler->retireFlow(this);
     }
-    commandQueue.clear();
+    commandQueue.discardAll();
     delete validationStrategy;
     
-    Logger::debug("[" + getUserTypeString() + " User] " + name + " destroyed!");
+    LOG_DEBUG_IN(USER, "[" + getUserTypeString() + " User] " + name + " destroyed!");
+    UserTable::remove(handle);
 }
 
-std::string User::getName() const {
+const std::string& User::getName() const {
     return name;
 }
 
@@ -43,15 +67,63 @@ UserType User::getUserType() const {
     return userType;
 }
 
-std::string User::getUserTypeString() const {
+const std::string& User::getUserTypeString() const {
+    // Interned once; callers get a reference instead of a new string per call
+    static const InternedString labels[] = {
+        InternedString::of("Free"), InternedString::of("Premium"), InternedString::of("Admin"), InternedString::of("Unknown")
+    };
     switch (userType) {
-        case UserType::FREE: return "Free";
-        case UserType::PREMIUM: return "Premium";
-        case UserType::ADMIN: return "Admin";
-        default: return "Unknown";
+        case UserType::FREE: return labels[0].str();
+        case UserType::PREMIUM: return labels[1].str();
+        case UserType::ADMIN: return labels[2].str();
+        default: return labels[3].str();
     }
 }
 
+namespace {
+
+// Writes one "  - Room n" line per room for toString()
+struct RoomLister {
+    std::ostream& out;
+    size_t listed;
+
+    explicit RoomLister(std::ostream& out) : out(out), listed(0) {}
+
+    void operator()(ChatRoom* room) {
+        out << "  - Room " << ++listed << " (address: " << room << ")" << std::endl;
+    }
+};
+
+// Tells each room a user joined that its presence changed
+struct PresenceNotifier {
+    User* user;
+    bool online;
+    size_t replayed;
+
+    PresenceNotifier(User* user, bool online) : user(user), online(online), replayed(0) {}
+
+    void operator()(ChatRoom* room) {
+        replayed += room->setPresence(user, online);
+    }
+};
+
+// Runs a timed flush's batch on the user's executor, coalesced as an inline flush would be
+class CoalescedFlushCommand : public Command {
+private:
+    std::vector<CommandVariant> batch;
+    std::atomic<unsigned long>* roomCalls;
+
+public:
+    CoalescedFlushCommand(std::vector<CommandVariant>&& commands, std::atomic<unsigned long>* roomCalls)
+        : Command(nullptr, nullptr, std::string()), batch(std::move(commands)), roomCalls(roomCalls) {}
+
+    void execute() override {
+        roomCalls->fetch_add(CommandQueue::executeCoalesced(batch));
+    }
+};
+
+} // namespace
+
 std::string User::toString() const {
     std::stringstream ss;
     ss << "=== User Debug Info ===" << std::endl;
@@ -59,9 +131,8 @@ std::string User::toString() const {
     ss << "Type: " << getUserTypeString() << std::endl;
     ss << "Chat Rooms: " << chatRooms.size() << " rooms" << std::endl;
     
-    for (size_t i = 0; i < chatRooms.size(); i++) {
-        ss << "  - Room " << i + 1 << " (address: " << chatRooms[i] << ")" << std::endl;
-    }
+    RoomLister lister(ss);
+    chatRooms.forEach(lister);
     
     ss << "Command Queue: " << commandQueue.size() << " pending commands" << std::endl;
     
@@ -79,65 +150,204 @@ std::string User::toString() const {
 void User::receive(std::string message, User* fromUser, ChatRoom* room) {
     (void)message;
     (void)room;
-    Logger::debug("[" + name + "] Received message from " + fromUser->getName() + " (" + fromUser->getUserTypeString() + ")");
+    LOG_EVENT(USER, DEBUG, MESSAGE_RECEIVED, getLogName(), fromUser->getLogName(), fromUser->getUserTypeString());
+}
+
+void User::receiveMissed(const std::string& entry, ChatRoom* room) {
+    (void)room;
+    LOG_DEBUG_IN(USER, "[" + name + "] Missed while offline: " + entry);
 }
 
 void User::addCommand(Command* command) {
-    commandQueue.push_back(command);
-    Logger::debug("[" + name + "] Command added to queue");
+    {
+        std::lock_guard<std::recursive_mutex> lock(commandMutex);
+        commandQueue.push(command);
+    }
+    LOG_EVENT(USER, DEBUG, COMMAND_ADDED, getLogName());
+}
+
+void User::addCommand(CommandVariant&& command) {
+    {
+        std::lock_guard<std::recursive_mutex> lock(commandMutex);
+        commandQueue.push(std::move(command));
+    }
+    LOG_EVENT(USER, DEBUG, COMMAND_ADDED, getLogName());
 }
 
 void User::executeAll() {
-    Logger::debug("[" + name + "] Executing " + std::to_string(commandQueue.size()) + " commands...");
+    std::lock_guard<std::recursive_mutex> lock(commandMutex);
+    LOG_EVENT(USER, DEBUG, EXECUTING_COMMANDS, getLogName(), commandQueue.size());
     
-    std::vector<Command*>::iterator it;
-    for (it = commandQueue.begin(); it != commandQueue.end(); it++) {
-        (*it)->execute();
-        delete *it;
+    commandQueue.executeAll();
+    LOG_EVENT(USER, DEBUG, COMMANDS_EXECUTED, getLogName());
+}
+
+void User::setFlushPolicy(const CommandFlushPolicy& policy) {
+    cancelFlushTimer();
+    flushCommands();
+    std::lock_guard<std::recursive_mutex> lock(commandMutex);
+    flushPolicy = policy;
+}
+
+CommandFlushPolicy User::getFlushPolicy() {
+    std::lock_guard<std::recursive_mutex> lock(commandMutex);
+    return flushPolicy;
+}
+
+CommandFlushStats User::getFlushStats() {
+    std::lock_guard<std::recursive_mutex> lock(commandMutex);
+    CommandFlushStats stats = flushStats;
+    stats.roomCalls += timedRoomCalls.load();
+    return stats;
+}
+
+std::size_t User::flushCommands() {
+    return flush(false);
+}
+
+std::size_t User::flush(bool timed) {
+    std::lock_guard<std::recursive_mutex> lock(commandMutex);
+    std::size_t count = commandQueue.size();
+    if (count == 0) {
+        return 0;
+    }
+    flushStats.flushes++;
+    flushStats.commands += count;
+    if (timed) {
+        flushStats.timedFlushes++;
+    }
+
+    if (asyncExecution) {
+        executeAllAsync();
+        flushStats.roomCalls += count;   // The executor runs them one by one
+        return count;
     }
+
+    LOG_EVENT(USER, DEBUG, EXECUTING_COMMANDS, getLogName(), count);
+    std::vector<CommandVariant> batch;
+    commandQueue.takeAll(batch);
+    if (timed) {
+        // Keep the fan-out off the timer thread, which every user shares
+        std::vector<CommandVariant> handOff;
+        handOff.push_back(CommandVariant(new CoalescedFlushCommand(std::move(batch), &timedRoomCalls)));
+        lastCompletion = commandExecutor.submit(std::move(handOff));
+        return count;
+    }
+
+    // Earlier timed batches run first; they never take commandMutex
+    commandExecutor.waitIdle();
+    flushStats.roomCalls += CommandQueue::executeCoalesced(batch);
+    LOG_EVENT(USER, DEBUG, COMMANDS_EXECUTED, getLogName());
+    return count;
+}
+
+void User::armFlushTimer(uint64_t delayMillis) {
+    if (flushArmed) {
+        return;   // Already armed: it flushes these commands too
+    }
+
+    // schedule() never waits for a callback, so arming under commandMutex is safe
+    flushArmed = true;
+    flushTimer = TimerService::schedule(delayMillis, [this]() {
+        std::lock_guard<std::recursive_mutex> lock(commandMutex);
+        flushArmed = false;
+        flush(true);
+    });
+}
+
+void User::cancelFlushTimer() {
+    uint64_t timerId;
+    {
+        std::lock_guard<std::recursive_mutex> lock(commandMutex);
+        timerId = flushTimer;
+        flushArmed = false;
+    }
+    // Always cancel the last id: if it already fired this is a no-op, and if it
+    // is running cancel() waits, so the callback never outlives the user
+    if (timerId) {
+        TimerService::cancel(timerId);
+    }
+}
+
+CommandFuture User::executeAllAsync() {
+    std::lock_guard<std::recursive_mutex> lock(commandMutex);
+    LOG_EVENT(USER, DEBUG, EXECUTING_COMMANDS, getLogName(), commandQueue.size());
     
-    commandQueue.clear();
-    Logger::debug("[" + name + "] All commands executed!");
+    std::vector<CommandVariant> batch;
+    commandQueue.takeAll(batch);
+    if (commandScheduler) {
+        lastCompletion = commandScheduler->submit(this, std::move(batch));
+    } else {
+        lastCompletion = commandExecutor.submit(std::move(batch));
+    }
+    return lastCompletion;
 }
 
-void User::addChatRoom(ChatRoom* room) {
+void User::setCommandScheduler(CommandScheduler* scheduler) {
+    if (commandScheduler && commandScheduler != scheduler) {
+        commandScheduler->retireFlow(this);   // Earlier batches finish before later ones start elsewhere
+    }
+    commandExecutor.waitIdle();
+    commandScheduler = scheduler;
+}
 
-    for (std::vector<ChatRoom*>::iterator it = chatRooms.begin(); it != chatRooms.end(); it++) {
-        if (*it == room) {
-            Logger::debug("[" + name + "] Already in this chat room");
-            return;
-        }
+void User::waitForCommands() {
+    commandExecutor.waitIdle();
+    if (commandScheduler) {
+        commandScheduler->waitIdle(this);
+    }
+}
+
+void User::addChatRoom(ChatRoom* room) {
+    if (!chatRooms.insert(room)) {
+        LOG_DEBUG_IN(USER, "[" + name + "] Already in this chat room");
+        return;
     }
     
-    chatRooms.push_back(room);
-    Logger::debug("[" + name + "] Added to a chat room");
+    LOG_DEBUG_IN(USER, "[" + name + "] Added to a chat room");
 }
 
 void User::removeChatRoom(ChatRoom* room) {
-    for (std::vector<ChatRoom*>::iterator it = chatRooms.begin(); it != chatRooms.end(); it++) {
-        if (*it == room) {
-            chatRooms.erase(it);
-            Logger::info(name + " left a chat room");
-            return;
-        }
+    if (chatRooms.erase(room)) {
+        LOG_INFO_IN(USER, name + " left a chat room");
+        return;
     }
-    Logger::debug("[" + name + "] Was not in the specified chat room");
+    LOG_DEBUG_IN(USER, "[" + name + "] Was not in the specified chat room");
 }
 
 bool User::isInChatRoom(ChatRoom* room) const {
-    for (std::vector<ChatRoom*>::const_iterator it = chatRooms.begin(); it != chatRooms.end(); it++) {
-        if (*it == room) {
-            return true;
-        }
+    return chatRooms.contains(room);
+}
+
+void User::goOffline() {
+    if (!online) {
+        return;
     }
-    return false;
+    online = false;
+    PresenceNotifier notifier(this, false);
+    chatRooms.forEach(notifier);
+    LOG_DEBUG_IN(USER, "[" + name + "] went offline");
+}
+
+size_t User::goOnline() {
+    if (online) {
+        return 0;
+    }
+    online = true;
+    PresenceNotifier notifier(this, true);
+    chatRooms.forEach(notifier);
+    LOG_INFO_IN(USER, name + " is back online (" + std::to_string(notifier.replayed) + " missed messages)");
+    return notifier.replayed;
 }
 
 void User::setValidationStrategy(ValidationStrategy* strategy) {
+    // Cached verdicts belong to the strategy type, shared by every user of
+    // it, and only go stale when the block lists change - keep them
     delete validationStrategy;
     validationStrategy = strategy;
-    Logger::debug("[" + name + "] Validation strategy changed to " + 
-                  (strategy ? strategy->getStrategyName() : "None"));
+    UserTable::setStrategyKey(handle, strategy ? strategy->getCacheKey() : 0);
+    LOG_DEBUG_IN(USER, "[" + name + "] Validation strategy changed to " + 
+              (strategy ? strategy->getStrategyName() : "None"));
 }
 
 ValidationStrategy* User::getValidationStrategy() const {
@@ -146,86 +356,142 @@ ValidationStrategy* User::getValidationStrategy() const {
 
 bool User::validateMessage(const std::string& message) {
     if (!validationStrategy) {
-        Logger::debug("[" + name + "] No validation strategy set - allowing message");
+        LOG_DEBUG_IN(USER, "[" + name + "] No validation strategy set - allowing message");
         return true;
     }
     
     return validationStrategy->validateMessage(message, name);
 }
 
+bool User::hasQuota() const {
+    return RateLimiter::canConsume(quota(), userType);
+}
+
+void User::consumeQuota() {
+    RateLimiter::tryConsume(quota(), userType);
+}
+
 void User::performSend(std::string message, ChatRoom* room) {
     if (!isInChatRoom(room)) {
-        Logger::user(name + " tried to send a message but isn't in the room!");
+        LOG_USER_IN(USER, name + " tried to send a message but isn't in the room!");
         return;
     }
     
-    Logger::debug("[" + name + "] Sending message: \"" + message + "\"");
+    LOG_EVENT(USER, DEBUG, SENDING_MESSAGE, getLogName(), message);
 
-    Command* sendCmd = new SendMessageCommand(room, this, message);
-    Command* saveCmd = new SaveMessageCommand(room, this, message);
-    
-    addCommand(sendCmd);
-    addCommand(saveCmd);
+    if (SendPipeline* pipeline = SendPipeline::validatingPipeline()) {
+        pipeline->forward(this, room, std::move(message));   // Persist and broadcast run on later stages
+        return;
+    }
+
+    bool flushNow;
+    uint64_t flushAfter;
+    {
+        std::lock_guard<std::recursive_mutex> lock(commandMutex);
+        addCommand(CommandVariant::sendMessage(room, this, message));
+        addCommand(CommandVariant::saveMessage(room, this, std::move(message)));
+        
+        if (flushPolicy.isImmediate()) {
+            if (asyncExecution) {
+                executeAllAsync();
+            } else {
+                executeAll();
+            }
+            return;
+        }
+        flushNow = flushPolicy.everyCommands && commandQueue.size() >= flushPolicy.everyCommands;
+        flushAfter = flushPolicy.everyMillis;
+        if (!flushNow && flushAfter) {
+            armFlushTimer(flushAfter);
+        }
+    }
     
-    executeAll();
+    if (flushNow) {
+        flushCommands();
+    }
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ================== FreeUser Class ==================
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-FreeUser::FreeUser(std::string userName) : User(userName, UserType::FREE), dailyMessageCount(0) {
+FreeUser::FreeUser(std::string userName) : User(userName, UserType::FREE), quotaNoticeTimer(0) {
     validationStrategy = new FreeUserValidationStrategy();
+    UserTable::setStrategyKey(handle, validationStrategy->getCacheKey());
     
-    Logger::info(name + " joined PetSpace (Free User - " + std::to_string(DAILY_MESSAGE_LIMIT) + 
-                " messages/day, " + std::to_string(validationStrategy->getMaxMessageLength()) + " char limit)");
-    Logger::debug("[FreeUser] " + name + " using " + validationStrategy->getStrategyName() + " validation");
+    LOG_INFO_IN(USER, name + " joined PetSpace (Free User - " + std::to_string(getDailyMessageLimit()) + 
+            " messages/day, " + std::to_string(validationStrategy->getMaxMessageLength()) + " char limit)");
+    LOG_DEBUG_IN(USER, "[FreeUser] " + name + " using " + validationStrategy->getStrategyName() + " validation");
+}
+
+FreeUser::~FreeUser() {
+    if (quotaNoticeTimer) {
+        RateLimiter::cancelEvent(quotaNoticeTimer);
+    }
 }
 
 std::string FreeUser::toString() const {
     std::stringstream ss;
     ss << User::toString();
     ss << "=== Free User Specific ===" << std::endl;
-    ss << "Daily Messages Used: " << dailyMessageCount << "/" << DAILY_MESSAGE_LIMIT << std::endl;
+    ss << "Daily Messages Used: " << getDailyMessageCount() << "/" << getDailyMessageLimit() << std::endl;
     ss << "==========================" << std::endl;
     
     return ss.str();
 }
 
 bool FreeUser::send(std::string message, ChatRoom* room) {
-    if (dailyMessageCount >= DAILY_MESSAGE_LIMIT) {
-        Logger::user(name + ": Daily message limit reached! Upgrade to Premium for unlimited messaging.");
+    if (!hasQuota()) {
+        LOG_USER_IN(USER, name + ": Daily message limit reached! Upgrade to Premium for unlimited messaging.");
+        scheduleQuotaNotice();
         return false;
     }
 
     if (!isInChatRoom(room)) {
-        Logger::user(name + " tried to send a message but isn't in the room!");
+        LOG_USER_IN(USER, name + " tried to send a message but isn't in the room!");
         return false;
     }
 
     if (!validateMessage(message)) {
-        Logger::debug("[" + name + "] Message blocked by " + validationStrategy->getStrategyName() + " strategy");
+        LOG_DEBUG_IN(USER, "[" + name + "] Message blocked by " + validationStrategy->getStrategyName() + " strategy");
         return false;
     }
 
-    dailyMessageCount++;
-    Logger::debug("[" + name + "] Messages used today: " + std::to_string(dailyMessageCount) + 
-                  "/" + std::to_string(DAILY_MESSAGE_LIMIT));
+    consumeQuota();
+    LOG_EVENT(USER, DEBUG, MESSAGES_USED, getLogName(), getDailyMessageCount(), getDailyMessageLimit());
     
     performSend(message, room);
     return true;
 }
 
+void FreeUser::scheduleQuotaNotice() {
+    if (quotaNoticeTimer) {
+        return;
+    }
+
+    quotaNoticeTimer = RateLimiter::scheduleEvent(RateLimiter::millisUntilAvailable(quota(), userType), [this]() {
+        quotaNoticeTimer = 0;
+        LOG_INFO_IN(USER, name + " can send messages again");
+    });
+}
+
 void FreeUser::resetDailyCount() {
-    dailyMessageCount = 0;
-    Logger::info(name + "'s daily message count has been reset");
+    RateLimiter::refill(quota());
+    if (quotaNoticeTimer) {
+        RateLimiter::cancelEvent(quotaNoticeTimer);
+        quotaNoticeTimer = 0;
+    }
+    LOG_INFO_IN(USER, name + "'s daily message count has been reset");
 }
 
 int FreeUser::getDailyMessageCount() const {
-    return dailyMessageCount;
+    if (!RateLimiter::isLimited(userType)) {
+        return 0;
+    }
+    return static_cast<int>(getDailyMessageLimit() - RateLimiter::getRemaining(quota(), userType));
 }
 
 int FreeUser::getDailyMessageLimit() const {
-    return DAILY_MESSAGE_LIMIT;
+    return static_cast<int>(RateLimiter::getPolicy(userType).capacity);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ================== PremiumUser Class ==================
@@ -233,9 +499,10 @@ int FreeUser::getDailyMessageLimit() const {
 
 PremiumUser::PremiumUser(std::string userName) : User(userName, UserType::PREMIUM) {
     validationStrategy = new PremiumUserValidationStrategy();
+    UserTable::setStrategyKey(handle, validationStrategy->getCacheKey());
     
-    Logger::info(name + " joined PetSpace (Premium User - unlimited messaging, mild language allowed)");
-    Logger::debug("[PremiumUser] " + name + " using " + validationStrategy->getStrategyName() + " validation");
+    LOG_INFO_IN(USER, name + " joined PetSpace (Premium User - unlimited messaging, mild language allowed)");
+    LOG_DEBUG_IN(USER, "[PremiumUser] " + name + " using " + validationStrategy->getStrategyName() + " validation");
 }
 
 std::string PremiumUser::toString() const {
@@ -250,16 +517,22 @@ std::string PremiumUser::toString() const {
 }
 
 bool PremiumUser::send(std::string message, ChatRoom* room) {
+    if (!hasQuota()) {
+        LOG_USER_IN(USER, name + ": Message rate limit reached. Please slow down.");
+        return false;
+    }
+
     if (!isInChatRoom(room)) {
-        Logger::user(name + " tried to send a message but isn't in the room!");
+        LOG_USER_IN(USER, name + " tried to send a message but isn't in the room!");
         return false;
     }
 
     if (!validateMessage(message)) {
-        Logger::debug("[" + name + "] Message blocked by " + validationStrategy->getStrategyName() + " strategy");
+        LOG_DEBUG_IN(USER, "[" + name + "] Message blocked by " + validationStrategy->getStrategyName() + " strategy");
         return false;
     }
     
+    consumeQuota();
     performSend(message, room);
     return true;
 }
@@ -270,10 +543,11 @@ bool PremiumUser::send(std::string message, ChatRoom* room) {
 
 AdminUser::AdminUser(std::string userName) : User(userName, UserType::ADMIN) {
     validationStrategy = new AdminUserValidationStrategy();
+    UserTable::setStrategyKey(handle, validationStrategy->getCacheKey());
     
-    Logger::info(name + " joined PetSpace (Admin User - full privileges, " + 
-                std::to_string(validationStrategy->getMaxMessageLength()) + " char limit)");
-    Logger::debug("[AdminUser] " + name + " using " + validationStrategy->getStrategyName() + " validation");
+    LOG_INFO_IN(USER, name + " joined PetSpace (Admin User - full privileges, " + 
+            std::to_string(validationStrategy->getMaxMessageLength()) + " char limit)");
+    LOG_DEBUG_IN(USER, "[AdminUser] " + name + " using " + validationStrategy->getStrategyName() + " validation");
 }
 
 std::string AdminUser::toString() const {
@@ -289,48 +563,54 @@ std::string AdminUser::toString() const {
 }
 
 bool AdminUser::send(std::string message, ChatRoom* room) {
+    if (!hasQuota()) {
+        LOG_USER_IN(USER, name + ": Message rate limit reached. Please slow down.");
+        return false;
+    }
+
     if (!isInChatRoom(room)) {
-        Logger::user(name + " tried to send a message but isn't in the room!");
+        LOG_USER_IN(USER, name + " tried to send a message but isn't in the room!");
         return false;
     }
 
     if (!validateMessage(message)) {
-        Logger::debug("[" + name + "] Admin message blocked by " + validationStrategy->getStrategyName() + " strategy");
+        LOG_DEBUG_IN(USER, "[" + name + "] Admin message blocked by " + validationStrategy->getStrategyName() + " strategy");
         return false;
     }
     
-    Logger::debug("[" + name + "] Admin user - message approved with minimal restrictions");
+    LOG_DEBUG_IN(USER, "[" + name + "] Admin user - message approved with minimal restrictions");
+    consumeQuota();
     performSend(message, room);
     return true;
 }
 
 void AdminUser::receive(std::string message, User* fromUser, ChatRoom* room) {
-    Logger::debug("[ADMIN LOG] " + name + " received message for moderation review");
+    LOG_DEBUG_IN(USER, "[ADMIN LOG] " + name + " received message for moderation review");
 
     User::receive(message, fromUser, room);
 }
 
 Iterator* AdminUser::requestChatHistoryIterator(ChatRoom* room) {
-    Logger::debug("[" + name + "] Admin requesting chat history iterator...");
+    LOG_DEBUG_IN(USER, "[" + name + "] Admin requesting chat history iterator...");
     return room->createIterator(this);
 }
 
 void AdminUser::iterateChatHistory(ChatRoom* room) {
-    Logger::info("[Admin] " + name + " is viewing chat history...");
+    LOG_INFO_IN(USER, "[Admin] " + name + " is viewing chat history...");
     
     Iterator* iterator = requestChatHistoryIterator(room);
     
     if (iterator) {
-        Logger::user("=== CHAT HISTORY ===");
+        LOG_USER_IN(USER, "=== CHAT HISTORY ===");
         
         for (iterator->first(); !iterator->isDone(); iterator->next()) {
             std::string message = iterator->currentItem();
-            Logger::user("  " + message);
+            LOG_USER_IN(USER, "  " + message);
         }
         
-        Logger::user("=== END HISTORY ===");
+        LOG_USER_IN(USER, "=== END HISTORY ===");
         delete iterator;
     } else {
-        Logger::user("[Admin] " + name + " failed to access chat history");
+        LOG_USER_IN(USER, "[Admin] " + name + " failed to access chat history");
     }
 }
\ No newline at end of file
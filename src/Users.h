@@ -8,12 +8,21 @@
 #ifndef USERS_H
 #define USERS_H
 
+#include "RateLimiter.h"
+#include "RoomSet.h"
+#include "CommandExecutor.h"
+#include "CommandQueue.h"
+#include "StructuredLog.h"
+#include "UserTable.h"
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 
 // Forward declarations
 class ChatRoom;
 class Command;
+class CommandScheduler;
 class Iterator;
 class ValidationStrategy;
 
@@ -29,17 +38,32 @@ enum class UserType {
  */
 class User {
 protected:
-    std::string name;
+    UserHandle handle;                      ///< Slot in UserTable, which holds the hot per-user fields
+    const std::string& name;                ///< Stored in UserTable and freed with the slot
+    const std::string& historyPrefix;       ///< "name: ", shared by log lines and saved history
     UserType userType;
-    std::vector<ChatRoom*> chatRooms;
-    std::vector<Command*> commandQueue;
+    RoomSet chatRooms;                      ///< Rooms joined; checked on every send
+    CommandQueue commandQueue;
+    std::recursive_mutex commandMutex;      ///< Guards commandQueue and serializes flushes (timer thread included)
+    CommandFlushPolicy flushPolicy;         ///< When performSend runs what it queued
+    CommandFlushStats flushStats;
+    uint64_t flushTimer;                    ///< Last TimerService flush armed; kept after it fires so cancel always sees it
+    bool flushArmed;                        ///< A timed flush is pending; cleared by its callback under commandMutex
+    std::atomic<unsigned long> timedRoomCalls;   ///< Room calls made by timed flushes on commandExecutor
+    CommandExecutor commandExecutor;        ///< Runs this user's batches on the shared pool, in order
+    bool asyncExecution;                    ///< performSend hands batches to commandExecutor
+    bool online;                            ///< Connected; rooms only push messages to online members
+    CommandFuture lastCompletion;           ///< Most recent asynchronous batch
+    CommandScheduler* commandScheduler;     ///< QoS scheduler for asynchronous batches, if any (not owned)
     ValidationStrategy* validationStrategy; ///< Strategy pattern for message validation
+    mutable LogNameRef logNameRef;          ///< Id of the name in the structured log
 
 public:
     /**
      * @brief Constructor for User
      * @param userName Name of the user
      * @param type Type of user (FREE, PREMIUM, ADMIN)
+     * @throws std::length_error if the UserTable has no slot left
      */
     User(std::string userName, UserType type);
     
@@ -49,9 +73,13 @@ public:
     virtual ~User();
     
     // Getters
-    std::string getName() const;
+    const std::string& getName() const;
+    uint32_t getNameHash() const { return UserTable::getNameHash(handle); }
+    UserHandle getHandle() const { return handle; }
+    const std::string& getHistoryPrefix() const { return historyPrefix; }
+    LogName getLogName() const { return LogName(name, logNameRef); }
     UserType getUserType() const;
-    std::string getUserTypeString() const;
+    const std::string& getUserTypeString() const;
     std::string toString() const;
     
     // Mediator pattern methods (Colleague role)
@@ -63,6 +91,13 @@ public:
      */
     virtual void receive(std::string message, User* fromUser, ChatRoom* room);
     
+    /**
+     * @brief Receive a message saved while this user was offline
+     * @param entry History entry ("Name: message")
+     * @param room The chat room it was saved in
+     */
+    virtual void receiveMissed(const std::string& entry, ChatRoom* room);
+    
     /**
      * @brief Send a message to a chat room (pure virtual - implemented by subclasses)
      * @param message The message to send
@@ -74,20 +109,92 @@ public:
     // Command pattern methods (Invoker role)
     /**
      * @brief Add a command to the queue
-     * @param command Command to add
+     * @param command Command to add (the queue takes ownership)
      */
     void addCommand(Command* command);
     
+    /**
+     * @brief Add a built-in command to the queue by value
+     * @param command Command to add
+     */
+    void addCommand(CommandVariant&& command);
+    
     /**
      * @brief Execute all queued commands
      */
     void executeAll();
     
+    /**
+     * @brief Choose when sends run; commands already queued are flushed first
+     * @param policy Size and time triggers (the default runs each send immediately)
+     */
+    void setFlushPolicy(const CommandFlushPolicy& policy);
+    CommandFlushPolicy getFlushPolicy();
+    
+    /**
+     * @brief Run every queued command now, coalescing adjacent ones for the same room
+     * @return Commands flushed
+     *
+     * With asynchronous execution on, the batch is handed to the executor
+     * (or scheduler) as one batch instead. Called from the timer thread for
+     * time-based policies.
+     */
+    std::size_t flushCommands();
+    
+    CommandFlushStats getFlushStats();
+    
+    /**
+     * @brief Hand all queued commands to the shared worker pool
+     * @return Handle that completes once they have run, with any errors they threw
+     *
+     * Batches from one user run in the order submitted; different users' batches
+     * run in parallel, scheduled by UserType if a CommandScheduler is set.
+     */
+    CommandFuture executeAllAsync();
+    
+    /**
+     * @brief Make send() return before fan-out finishes
+     * @param enabled true to run sends through executeAllAsync()
+     */
+    void setAsyncExecution(bool enabled) { asyncExecution = enabled; }
+    bool isAsyncExecution() const { return asyncExecution; }
+    
+    /**
+     * @brief Run asynchronous batches through a QoS scheduler instead of the shared pool
+     * @param scheduler Scheduler that outlives this user, nullptr for the shared pool
+     */
+    void setCommandScheduler(CommandScheduler* scheduler);
+    CommandScheduler* getCommandScheduler() const { return commandScheduler; }
+    
+    /**
+     * @brief Handle for the most recent asynchronous batch (invalid if none yet)
+     */
+    CommandFuture getLastCompletion() const { return lastCompletion; }
+    
+    /**
+     * @brief Block until every asynchronous batch from this user has run
+     */
+    void waitForCommands();
+    
     // Chat room management
     void addChatRoom(ChatRoom* room);
     void removeChatRoom(ChatRoom* room);
     bool isInChatRoom(ChatRoom* room) const;
     
+    // Presence
+    /**
+     * @brief Disconnect: rooms stop pushing to this user and note how far it has read
+     */
+    void goOffline();
+    
+    /**
+     * @brief Reconnect and catch up on every room from its history
+     * @return Messages replayed through receiveMissed()
+     */
+    size_t goOnline();
+    
+    bool isOnline() const { return online; }
+    
     // Strategy pattern methods (Context role)
     /**
      * @brief Set the validation strategy
@@ -123,15 +230,47 @@ protected:
      * @brief Perform the actual send operation (common implementation)
      * @param message Message to send
      * @param room Chat room to send to
+     *
+     * On a SendPipeline's validate stage the message is forwarded to the
+     * pipeline instead of running the commands here.
      */
     void performSend(std::string message, ChatRoom* room);
     
+    /**
+     * @brief Flush after delayMillis, unless a flush is already armed (call with commandMutex held)
+     *
+     * The timer thread only takes the batch; commandExecutor runs it.
+     */
+    void armFlushTimer(uint64_t delayMillis);
+
+    /**
+     * @brief Cancel the armed flush, waiting if it is running (not with commandMutex held)
+     */
+    void cancelFlushTimer();
+    std::size_t flush(bool timed);
+    
     /**
      * @brief Validate message using current strategy
      * @param message Message to validate
      * @return true if valid, false if blocked
      */
     bool validateMessage(const std::string& message);
+    
+    /**
+     * @brief Check the user's send quota without using it
+     * @return true if the RateLimiter policy for this user type allows a message now
+     */
+    bool hasQuota() const;
+    
+    /**
+     * @brief The user's send quota (limits set per UserType in RateLimiter)
+     */
+    TokenBucket& quota() const { return UserTable::getQuota(handle); }
+    
+    /**
+     * @brief Use one message from the user's send quota
+     */
+    void consumeQuota();
 };
 
 /**
@@ -140,8 +279,12 @@ protected:
  */
 class FreeUser : public User {
 private:
-    static const int DAILY_MESSAGE_LIMIT = 10;
-    int dailyMessageCount;
+    uint64_t quotaNoticeTimer;  ///< Pending "quota is back" event, 0 if none
+    
+    /**
+     * @brief Schedule a notice for when the next message is allowed
+     */
+    void scheduleQuotaNotice();
 
 public:
     /**
@@ -151,9 +294,9 @@ public:
     FreeUser(std::string userName);
     
     /**
-     * @brief Destructor
+     * @brief Destructor - cancels any pending quota notice
      */
-    ~FreeUser() = default;
+    ~FreeUser();
     
     std::string toString() const;
     
@@ -165,7 +308,7 @@ public:
      */
     bool send(std::string message, ChatRoom* room) override;
     
-    // Free user specific methods
+    // Free user specific methods (quota comes from RateLimiter's FREE policy)
     void resetDailyCount();
     int getDailyMessageCount() const;
     int getDailyMessageLimit() const;
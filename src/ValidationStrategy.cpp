@@ -7,84 +7,228 @@
 
 #include "ValidationStrategy.h"
 #include "Logger.h"
+#include "StructuredLog.h"
+#include "BlockList.h"
+#include "VerdictCache.h"
+#include "ThreadPool.h"
 #include <algorithm>
 #include <vector>
 #include <cctype>
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ================== ValidationStrategy ==================
+// Shared flow: evaluate (or reuse a cached verdict), then explain any block
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ValidationStrategy::validateMessage(const std::string& message, const std::string& userName) {
+    LOG_EVENT(VALIDATION, DEBUG, VALIDATING, getStrategyName(), userName);
+
+    ValidationVerdict verdict = evaluateCached(message);
+
+    if (verdict != ValidationVerdict::APPROVED) {
+        if (LOG_COMPONENT_ENABLED(VALIDATION, DEBUG)) {
+            std::string detail = explainVerdict(message, verdict);
+            if (!detail.empty()) LOG_DEBUG_IN(VALIDATION, detail);
+        }
+        LOG_USER_IN(VALIDATION, userName + ": " + describeVerdict(verdict));
+        return false;
+    }
+
+    LOG_EVENT(VALIDATION, DEBUG, VALIDATION_APPROVED, getStrategyName(), userName);
+    return true;
+}
+
+ValidationVerdict ValidationStrategy::evaluateCached(const std::string& message) const {
+    unsigned cacheKey = VerdictCache::isEnabled() ? getCacheKey() : 0;
+    if (!cacheKey) {
+        return evaluate(message);
+    }
+
+    // Read the version before evaluating so a concurrent reload can only cause a miss
+    ValidationVerdict verdict;
+    unsigned long version = BlockListRegistry::getVersion();
+    if (!VerdictCache::lookup(cacheKey, message, version, verdict)) {
+        verdict = evaluate(message);
+        VerdictCache::store(cacheKey, message, version, verdict);
+    }
+    return verdict;
+}
+
+BatchValidationResult ValidationStrategy::validateBatch(const std::string* messages, size_t count,
+                                                        const std::string* userNames,
+                                                        ThreadPool* pool) const {
+    BatchValidationResult result;
+    result.verdicts.resize(count);
+    result.approvedCount = 0;
+    for (size_t i = 0; i < VERDICT_COUNT; i++) result.verdictCounts[i] = 0;
+
+    ValidationVerdict* verdicts = result.verdicts.empty() ? nullptr : &result.verdicts[0];
+
+    // Each chunk writes only its own slice, so no synchronisation is needed.
+    // Senders repeat in runs, so a name is only checked when it changes.
+    if (!pool) pool = &ThreadPool::shared();
+    pool->parallelFor(count, 256, [this, messages, userNames, verdicts](size_t begin, size_t end) {
+        const std::string* lastName = nullptr;
+        ValidationVerdict nameVerdict = ValidationVerdict::APPROVED;
+        for (size_t i = begin; i < end; i++) {
+            if (userNames && (!lastName || userNames[i] != *lastName)) {
+                lastName = &userNames[i];
+                nameVerdict = evaluateName(*lastName);
+            }
+            verdicts[i] = nameVerdict != ValidationVerdict::APPROVED ? nameVerdict : evaluateCached(messages[i]);
+        }
+    });
+
+    for (size_t i = 0; i < count; i++) {
+        result.verdictCounts[static_cast<size_t>(verdicts[i])]++;
+    }
+    result.approvedCount = result.verdictCounts[static_cast<size_t>(ValidationVerdict::APPROVED)];
+
+    // Deferred, aggregated logging: one summary, then a few examples at debug level
+    size_t blocked = count - result.approvedCount;
+    LOG_INFO_IN(VALIDATION, "[" + getStrategyName() + " Validation] Batch of " + std::to_string(count) + ": " +
+             std::to_string(result.approvedCount) + " approved, " + std::to_string(blocked) + " blocked");
+    if (blocked && LOG_COMPONENT_ENABLED(VALIDATION, DEBUG)) {
+        for (size_t v = 1; v < VERDICT_COUNT; v++) {
+            if (result.verdictCounts[v]) {
+                LOG_DEBUG_IN(VALIDATION, "  " + std::string(getVerdictName(static_cast<ValidationVerdict>(v))) +
+                          ": " + std::to_string(result.verdictCounts[v]));
+            }
+        }
+        size_t shown = 0;
+        for (size_t i = 0; i < count && shown < 10; i++) {
+            if (verdicts[i] != ValidationVerdict::APPROVED) {
+                std::string who = userNames ? userNames[i] : "message " + std::to_string(i);
+                std::string detail = explainVerdict(messages[i], verdicts[i]);
+                LOG_DEBUG_IN(VALIDATION, "  " + who + ": " + describeVerdict(verdicts[i]) +
+                          (detail.empty() ? "" : " " + detail));
+                shown++;
+            }
+        }
+    }
+
+    return result;
+}
+
+const char* ValidationStrategy::getVerdictName(ValidationVerdict verdict) {
+    switch (verdict) {
+        case ValidationVerdict::APPROVED: return "APPROVED";
+        case ValidationVerdict::EMPTY_MESSAGE: return "EMPTY_MESSAGE";
+        case ValidationVerdict::TOO_LONG: return "TOO_LONG";
+        case ValidationVerdict::PROFANITY: return "PROFANITY";
+        case ValidationVerdict::EXCESSIVE_CAPS: return "EXCESSIVE_CAPS";
+        case ValidationVerdict::SEVERE_PROFANITY: return "SEVERE_PROFANITY";
+        case ValidationVerdict::SPAM: return "SPAM";
+        case ValidationVerdict::SYSTEM_THREAT: return "SYSTEM_THREAT";
+        case ValidationVerdict::INVALID_NAME: return "INVALID_NAME";
+        default: return "UNKNOWN";
+    }
+}
+
+std::string ValidationStrategy::describeVerdict(ValidationVerdict verdict) const {
+    switch (verdict) {
+        case ValidationVerdict::APPROVED: return "Message approved";
+        case ValidationVerdict::EMPTY_MESSAGE: return "Cannot send empty messages";
+        case ValidationVerdict::TOO_LONG: return "Message too long!";
+        case ValidationVerdict::PROFANITY: return "Language not appropriate!";
+        case ValidationVerdict::EXCESSIVE_CAPS: return "Please don't use excessive CAPS!";
+        case ValidationVerdict::SEVERE_PROFANITY: return "That language is too severe!";
+        case ValidationVerdict::SPAM: return "Message appears to be spam.";
+        case ValidationVerdict::SYSTEM_THREAT: return "Message blocked - contains potential system threats!";
+        case ValidationVerdict::INVALID_NAME: return "Sender name is not allowed.";
+        default: return "Message blocked";
+    }
+}
+
+std::string ValidationStrategy::explainVerdict(const std::string&, ValidationVerdict) const {
+    return std::string();
+}
+
+ValidationVerdict ValidationStrategy::evaluateName(const std::string& userName) const {
+    if (userName.empty() || userName.length() > MAX_NAME_LENGTH) {
+        return ValidationVerdict::INVALID_NAME;
+    }
+    for (char c : userName) {
+        if (iscntrl(static_cast<unsigned char>(c))) return ValidationVerdict::INVALID_NAME;
+    }
+
+    // Names are shown to everyone, so every tier gets the family-friendly list
+    BlockListRegistry::ReadGuard lists;
+    if (lists->freeWords.matches(userName, nullptr) || lists->threats.search(userName) >= 0) {
+        return ValidationVerdict::INVALID_NAME;
+    }
+    return ValidationVerdict::APPROVED;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ================== FreeUserValidationStrategy ==================
 //Free users: Short messages, no profanity, no caps abuse
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool FreeUserValidationStrategy::validateMessage(const std::string& message, const std::string& userName) {
-    Logger::debug("[FreeUserValidation] Validating message from " + userName);
-    
+ValidationVerdict FreeUserValidationStrategy::evaluate(const std::string& message) const {
     if (message.empty()) {
-        Logger::user(userName + ": Cannot send empty messages");
-        return false;
+        return ValidationVerdict::EMPTY_MESSAGE;
     }
 
     if (message.length() > MAX_FREE_MESSAGE_LENGTH) {
-        Logger::user(userName + ": Message too long! Free users limited to " + 
-                    std::to_string(MAX_FREE_MESSAGE_LENGTH) + " characters. Upgrade to Premium for longer messages!");
-        return false;
+        return ValidationVerdict::TOO_LONG;
     }
 
     if (containsAnyProfanity(message)) {
-        Logger::user(userName + ": Language not appropriate! Free users must keep messages family-friendly. Upgrade to Premium for more flexibility!");
-        return false;
+        return ValidationVerdict::PROFANITY;
     }
 
     if (hasExcessiveCaps(message)) {
-        Logger::user(userName + ": Please don't use excessive CAPS! Free users must follow basic etiquette rules.");
-        return false;
+        return ValidationVerdict::EXCESSIVE_CAPS;
     }
     
-    Logger::debug("[FreeUserValidation] Message approved for free user " + userName);
-    return true;
+    return ValidationVerdict::APPROVED;
 }
 
-bool FreeUserValidationStrategy::containsAnyProfanity(const std::string& message) const {
-    std::vector<std::string> blockedWords = {
-        "stupid", "dumb", "hate", "sucks", "crap", "damn", "hell", 
-        "shut", "idiot", "loser", "weird", "ugly", "fat", "shit", "fuck", "bitch", "poes"
-    };
-    
-    std::string lowerMessage = message;
-    std::transform(lowerMessage.begin(), lowerMessage.end(), lowerMessage.begin(), ::tolower);
-    
-    for (const std::string& word : blockedWords) {
-        size_t pos = 0;
-        while ((pos = lowerMessage.find(word, pos)) != std::string::npos) {
-            // Check if it's a whole word (not part of another word)
-            bool isWordStart = (pos == 0 || !isalnum(static_cast<unsigned char>(lowerMessage[pos - 1])));
-            bool isWordEnd = (pos + word.length() == lowerMessage.length() || 
-                             !isalnum(static_cast<unsigned char>(lowerMessage[pos + word.length()])));
-            
-            if (isWordStart && isWordEnd) {
-                Logger::debug("[FreeUserValidation] Blocked word found: " + word);
-                return true;
-            }
-            pos++;
-        }
+std::string FreeUserValidationStrategy::describeVerdict(ValidationVerdict verdict) const {
+    switch (verdict) {
+        case ValidationVerdict::TOO_LONG:
+            return "Message too long! Free users limited to " + 
+                   std::to_string(MAX_FREE_MESSAGE_LENGTH) + " characters. Upgrade to Premium for longer messages!";
+        case ValidationVerdict::PROFANITY:
+            return "Language not appropriate! Free users must keep messages family-friendly. Upgrade to Premium for more flexibility!";
+        case ValidationVerdict::EXCESSIVE_CAPS:
+            return "Please don't use excessive CAPS! Free users must follow basic etiquette rules.";
+        default:
+            return ValidationStrategy::describeVerdict(verdict);
     }
-    return false;
 }
 
-bool FreeUserValidationStrategy::hasExcessiveCaps(const std::string& message) const {
-    if (message.length() < 5) return false;
-    
-    int capsCount = 0;
+std::string FreeUserValidationStrategy::explainVerdict(const std::string& message, ValidationVerdict verdict) const {
+    if (verdict == ValidationVerdict::PROFANITY) {
+        BlockListRegistry::ReadGuard lists;
+        std::string word;
+        lists->freeWords.matches(message, &word);
+        return "[FreeUserValidation] Blocked word found: " + word;
+    }
+    if (verdict == ValidationVerdict::EXCESSIVE_CAPS) {
+        return "[FreeUserValidation] Excessive caps detected: " +
+               std::to_string(countCaps(message)) + "/" + std::to_string(message.length());
+    }
+    return std::string();
+}
+
+bool FreeUserValidationStrategy::containsAnyProfanity(const std::string& message) const {
+    BlockListRegistry::ReadGuard lists;
+    return lists->freeWords.matches(message, nullptr);
+}
+
+size_t FreeUserValidationStrategy::countCaps(const std::string& message) {
+    size_t capsCount = 0;
     for (char c : message) {
         if (isupper(static_cast<unsigned char>(c))) capsCount++;
     }
+    return capsCount;
+}
 
-    bool excessive = (capsCount > message.length() * 0.3);
-    if (excessive) {
-        Logger::debug("[FreeUserValidation] Excessive caps detected: " + 
-                     std::to_string(capsCount) + "/" + std::to_string(message.length()));
-    }
-    return excessive;
+bool FreeUserValidationStrategy::hasExcessiveCaps(const std::string& message) const {
+    if (message.length() < 5) return false;
+    return countCaps(message) > message.length() * 0.3;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -92,59 +236,55 @@ bool FreeUserValidationStrategy::hasExcessiveCaps(const std::string& message) co
 // Premium users: No length limit, but still no severe profanity
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool PremiumUserValidationStrategy::validateMessage(const std::string& message, const std::string& userName) {
-    Logger::debug("[PremiumUserValidation] Validating message from premium user " + userName);
-    
+ValidationVerdict PremiumUserValidationStrategy::evaluate(const std::string& message) const {
     if (message.empty()) {
-        Logger::user(userName + ": Cannot send empty messages");
-        return false;
+        return ValidationVerdict::EMPTY_MESSAGE;
     }
 
-    Logger::debug("[PremiumUserValidation] Premium user - no length restrictions (" + 
-                  std::to_string(message.length()) + " characters)");
-
     if (containsSevereProfanity(message)) {
-        Logger::user(userName + ": That language is too severe! Even Premium users must avoid extreme profanity.");
-        return false;
+        return ValidationVerdict::SEVERE_PROFANITY;
     }
 
     if (isExcessiveSpam(message)) {
-        Logger::user(userName + ": Message appears to be spam. Please send meaningful content!");
-        return false;
+        return ValidationVerdict::SPAM;
     }
     
-    Logger::debug("[PremiumUserValidation] Message approved for premium user " + userName);
-    return true;
+    return ValidationVerdict::APPROVED;
 }
 
-bool PremiumUserValidationStrategy::containsSevereProfanity(const std::string& message) const {
-    std::vector<std::string> severeWords = {
-        "fuck", "shit", "bitch", "asshole", "bastard", "whore", "slut"
-    };
-    
-    std::string lowerMessage = message;
-    std::transform(lowerMessage.begin(), lowerMessage.end(), lowerMessage.begin(), ::tolower);
-    
-    for (const std::string& word : severeWords) {
-        size_t pos = 0;
-        while ((pos = lowerMessage.find(word, pos)) != std::string::npos) {
-            // Check if it's a whole word (not part of another word)
-            bool isWordStart = (pos == 0 || !isalnum(static_cast<unsigned char>(lowerMessage[pos - 1])));
-            bool isWordEnd = (pos + word.length() == lowerMessage.length() || 
-                             !isalnum(static_cast<unsigned char>(lowerMessage[pos + word.length()])));
-            
-            if (isWordStart && isWordEnd) {
-                Logger::debug("[PremiumUserValidation] Severe profanity detected: " + word);
-                return true;
-            }
-            pos++;
-        }
+std::string PremiumUserValidationStrategy::describeVerdict(ValidationVerdict verdict) const {
+    switch (verdict) {
+        case ValidationVerdict::SEVERE_PROFANITY:
+            return "That language is too severe! Even Premium users must avoid extreme profanity.";
+        case ValidationVerdict::SPAM:
+            return "Message appears to be spam. Please send meaningful content!";
+        default:
+            return ValidationStrategy::describeVerdict(verdict);
     }
-    return false;
 }
 
-bool PremiumUserValidationStrategy::isExcessiveSpam(const std::string& message) const {
-    if (message.length() < 10) return false;
+std::string PremiumUserValidationStrategy::explainVerdict(const std::string& message, ValidationVerdict verdict) const {
+    if (verdict == ValidationVerdict::SEVERE_PROFANITY) {
+        BlockListRegistry::ReadGuard lists;
+        std::string word;
+        lists->severeWords.matches(message, &word);
+        return "[PremiumUserValidation] Severe profanity detected: " + word;
+    }
+    if (verdict == ValidationVerdict::SPAM) {
+        int repeat = longestRepeat(message);
+        return repeat > 15 ? "[PremiumUserValidation] Excessive character repetition: " + std::to_string(repeat)
+                           : "[PremiumUserValidation] All caps spam detected";
+    }
+    return std::string();
+}
+
+bool PremiumUserValidationStrategy::containsSevereProfanity(const std::string& message) const {
+    BlockListRegistry::ReadGuard lists;
+    return lists->severeWords.matches(message, nullptr);
+}
+
+int PremiumUserValidationStrategy::longestRepeat(const std::string& message) {
+    if (message.empty()) return 0;
 
     int maxRepeat = 0;
     int currentRepeat = 1;
@@ -157,10 +297,13 @@ bool PremiumUserValidationStrategy::isExcessiveSpam(const std::string& message)
             currentRepeat = 1;
         }
     }
-    maxRepeat = std::max(maxRepeat, currentRepeat);
+    return std::max(maxRepeat, currentRepeat);
+}
+
+bool PremiumUserValidationStrategy::isExcessiveSpam(const std::string& message) const {
+    if (message.length() < 10) return false;
 
-    if (maxRepeat > 15) {
-        Logger::debug("[PremiumUserValidation] Excessive character repetition: " + std::to_string(maxRepeat));
+    if (longestRepeat(message) > 15) {
         return true;
     }
 
@@ -169,12 +312,7 @@ bool PremiumUserValidationStrategy::isExcessiveSpam(const std::string& message)
         if (isupper(static_cast<unsigned char>(c))) capsCount++;
     }
 
-    if (capsCount > message.length() * 0.8) {
-        Logger::debug("[PremiumUserValidation] All caps spam detected");
-        return true;
-    }
-    
-    return false;
+    return capsCount > message.length() * 0.8;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -182,48 +320,48 @@ bool PremiumUserValidationStrategy::isExcessiveSpam(const std::string& message)
 // Admin users: Can say almost anything, very high limits
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool AdminUserValidationStrategy::validateMessage(const std::string& message, const std::string& userName) {
-    Logger::debug("[AdminUserValidation] Validating message from admin " + userName);
-    
+ValidationVerdict AdminUserValidationStrategy::evaluate(const std::string& message) const {
     if (message.empty()) {
-        Logger::user(userName + ": Cannot send empty messages");
-        return false;
+        return ValidationVerdict::EMPTY_MESSAGE;
     }
 
     if (message.length() > MAX_ADMIN_MESSAGE_LENGTH) {
-        Logger::user(userName + ": Even admin messages have limits! Max " + 
-                    std::to_string(MAX_ADMIN_MESSAGE_LENGTH) + " characters for system stability.");
-        return false;
+        return ValidationVerdict::TOO_LONG;
     }
 
     if (containsSystemThreats(message)) {
-        Logger::user(userName + ": Admin message blocked - contains potential system threats!");
-        return false;
+        return ValidationVerdict::SYSTEM_THREAT;
     }
     
-    Logger::debug("[AdminUserValidation] Admin message approved - full privileges (" + 
-                  std::to_string(message.length()) + " characters)");
-    return true;
+    return ValidationVerdict::APPROVED;
 }
 
-bool AdminUserValidationStrategy::containsSystemThreats(const std::string& message) const {
-    std::vector<std::string> threatWords = {
-        "DELETE FROM", "DROP TABLE", "rm -rf", "format c:", 
-        "shutdown", "reboot", "kill -9", "sudo rm", "del /s"
-    };
-    
-    std::string upperMessage = message;
-    std::transform(upperMessage.begin(), upperMessage.end(), upperMessage.begin(), ::toupper);
-    
-    for (const std::string& threat : threatWords) {
-        std::string upperThreat = threat;
-        std::transform(upperThreat.begin(), upperThreat.end(), upperThreat.begin(), ::toupper);
-        
-        if (upperMessage.find(upperThreat) != std::string::npos) {
-            Logger::debug("[AdminUserValidation] System threat detected: " + threat);
-            return true;
+std::string AdminUserValidationStrategy::describeVerdict(ValidationVerdict verdict) const {
+    switch (verdict) {
+        case ValidationVerdict::TOO_LONG:
+            return "Even admin messages have limits! Max " + 
+                   std::to_string(MAX_ADMIN_MESSAGE_LENGTH) + " characters for system stability.";
+        case ValidationVerdict::SYSTEM_THREAT:
+            return "Admin message blocked - contains potential system threats!";
+        default:
+            return ValidationStrategy::describeVerdict(verdict);
+    }
+}
+
+std::string AdminUserValidationStrategy::explainVerdict(const std::string& message, ValidationVerdict verdict) const {
+    if (verdict == ValidationVerdict::SYSTEM_THREAT) {
+        BlockListRegistry::ReadGuard lists;
+        int threat = lists->threats.search(message);
+        if (threat >= 0) {
+            return "[AdminUserValidation] System threat detected: " + lists->threatWords[threat];
         }
     }
-    
-    return false;
+    return std::string();
+}
+
+bool AdminUserValidationStrategy::containsSystemThreats(const std::string& message) const {
+    BlockListRegistry::ReadGuard lists;
+
+    // Runs on the original bytes; nothing is allocated
+    return lists->threats.search(message) >= 0;
 }
\ No newline at end of file
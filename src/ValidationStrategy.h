@@ -9,6 +9,37 @@
 #define VALIDATIONSTRATEGY_H
 
 #include <string>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @brief Outcome of a validation, doubling as the reason code when blocked
+ */
+enum class ValidationVerdict : unsigned char {
+    APPROVED,
+    EMPTY_MESSAGE,
+    TOO_LONG,
+    PROFANITY,
+    EXCESSIVE_CAPS,
+    SEVERE_PROFANITY,
+    SPAM,
+    SYSTEM_THREAT,
+    INVALID_NAME      ///< Batch only: the sender's name failed validateName()
+};
+
+const size_t VERDICT_COUNT = 9;
+
+/**
+ * @brief Result of validating a batch of messages
+ */
+struct BatchValidationResult {
+    std::vector<ValidationVerdict> verdicts;  ///< One byte per message, same order as the input
+    size_t approvedCount;
+    size_t verdictCounts[VERDICT_COUNT];      ///< Messages per ValidationVerdict value
+
+    bool allApproved() const { return approvedCount == verdicts.size(); }
+};
 
 /**
  * @class ValidationStrategy
@@ -23,8 +54,84 @@ public:
      * @param message The message to validate
      * @param userName The user sending the message
      * @return true if valid, false otherwise
+     *
+     * Runs evaluate() (through the VerdictCache when it is enabled and the
+     * strategy is cacheable) and tells the user why a message was blocked.
      */
-    virtual bool validateMessage(const std::string& message, const std::string& userName) = 0;
+    virtual bool validateMessage(const std::string& message, const std::string& userName);
+    
+    /**
+     * @brief Checks a message against the strategy rules without user-facing output
+     * @param message The message to check
+     * @return APPROVED or the reason the message is blocked
+     */
+    virtual ValidationVerdict evaluate(const std::string& message) const = 0;
+    
+    /**
+     * @brief Gets the user-facing explanation for a blocked verdict
+     * @param verdict Reason code returned by evaluate()
+     * @return Text shown after the user's name
+     */
+    virtual std::string describeVerdict(ValidationVerdict verdict) const;
+    
+    /**
+     * @brief Checks a user name (non-empty, printable, bounded, no blocked terms)
+     * @param userName Name to check
+     * @return APPROVED or INVALID_NAME
+     */
+    virtual ValidationVerdict evaluateName(const std::string& userName) const;
+    
+    /**
+     * @brief Validates many messages in parallel before any is accepted
+     * @param messages First message of the span
+     * @param count Number of messages
+     * @param userNames Sender of each message (may be nullptr); a message whose
+     *        sender fails evaluateName() gets INVALID_NAME
+     * @param pool Pool to split the work across, nullptr for ThreadPool::shared()
+     * @return Verdict per message plus per-reason counts
+     *
+     * The workers only evaluate; all logging happens on the calling thread
+     * once the whole batch is done. evaluate() must be safe to call concurrently.
+     */
+    BatchValidationResult validateBatch(const std::string* messages, size_t count,
+                                        const std::string* userNames = nullptr,
+                                        ThreadPool* pool = nullptr) const;
+    
+    /**
+     * @brief Gets a short identifier for a verdict
+     * @param verdict Verdict to name
+     * @return Constant name such as "PROFANITY"
+     */
+    static const char* getVerdictName(ValidationVerdict verdict);
+    
+    /**
+     * @brief Gets the key this strategy's verdicts are cached under
+     * @return Non-zero key shared by all instances with identical rules, 0 to opt out of caching
+     */
+    virtual unsigned getCacheKey() const { return 0; }
+
+protected:
+    /**
+     * @brief evaluate() through the VerdictCache when enabled and cacheable
+     * @param message The message to check
+     * @return APPROVED or the reason the message is blocked
+     */
+    ValidationVerdict evaluateCached(const std::string& message) const;
+
+    /**
+     * @brief Debug detail for a blocked verdict, such as the matched term
+     * @param message Message that was blocked
+     * @param verdict Verdict evaluate() returned for it
+     * @return Detail text, empty if there is nothing to add
+     *
+     * Only called on the validating thread with debug logging enabled, so
+     * evaluate() itself never logs.
+     */
+    virtual std::string explainVerdict(const std::string& message, ValidationVerdict verdict) const;
+
+    static const size_t MAX_NAME_LENGTH = 64;
+
+public:
     
     /**
      * @brief Gets the strategy name
@@ -48,14 +155,20 @@ public:
  */
 class FreeUserValidationStrategy : public ValidationStrategy {
 public:
-    bool validateMessage(const std::string& message, const std::string& userName) override;
+    ValidationVerdict evaluate(const std::string& message) const override;
+    std::string describeVerdict(ValidationVerdict verdict) const override;
+    unsigned getCacheKey() const override { return 1; }
     std::string getStrategyName() const override { return "Free User"; }
     int getMaxMessageLength() const override { return 100; }
 
+protected:
+    std::string explainVerdict(const std::string& message, ValidationVerdict verdict) const override;
+
 private:
     static const int MAX_FREE_MESSAGE_LENGTH = 100;
     bool containsAnyProfanity(const std::string& message) const;
     bool hasExcessiveCaps(const std::string& message) const;
+    static size_t countCaps(const std::string& message);
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -67,13 +180,19 @@ private:
  */
 class PremiumUserValidationStrategy : public ValidationStrategy {
 public:
-    bool validateMessage(const std::string& message, const std::string& userName) override;
+    ValidationVerdict evaluate(const std::string& message) const override;
+    std::string describeVerdict(ValidationVerdict verdict) const override;
+    unsigned getCacheKey() const override { return 2; }
     std::string getStrategyName() const override { return "Premium User"; }
     int getMaxMessageLength() const override { return -1; }
 
+protected:
+    std::string explainVerdict(const std::string& message, ValidationVerdict verdict) const override;
+
 private:
     bool containsSevereProfanity(const std::string& message) const;
     bool isExcessiveSpam(const std::string& message) const;
+    static int longestRepeat(const std::string& message);
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -85,10 +204,15 @@ private:
  */
 class AdminUserValidationStrategy : public ValidationStrategy {
 public:
-    bool validateMessage(const std::string& message, const std::string& userName) override;
+    ValidationVerdict evaluate(const std::string& message) const override;
+    std::string describeVerdict(ValidationVerdict verdict) const override;
+    unsigned getCacheKey() const override { return 3; }
     std::string getStrategyName() const override { return "Admin User"; }
     int getMaxMessageLength() const override { return 2000; }
 
+protected:
+    std::string explainVerdict(const std::string& message, ValidationVerdict verdict) const override;
+
 private:
     static const int MAX_ADMIN_MESSAGE_LENGTH = 2000;
     bool containsSystemThreats(const std::string& message) const;
@@ -0,0 +1,210 @@
+/**
+ * @file VerdictCache.cpp
+ * @brief Implementation of the sharded verdict cache
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-06
+ */
+
+#include "VerdictCache.h"
+#include "Logger.h"
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace {
+
+const size_t SET_WAYS = 4;
+
+inline uint64_t mix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+struct CacheEntry {
+    uint64_t hash;
+    unsigned long blockListVersion;
+    unsigned long generation;
+    std::string text;            // Compared on a hit; the hash only picks the slot
+    unsigned char cacheKey;      // 0 marks an empty slot
+    ValidationVerdict verdict;
+    unsigned char referenced;    // CLOCK bit
+
+    CacheEntry() : hash(0), blockListVersion(0), generation(0), cacheKey(0),
+                   verdict(ValidationVerdict::APPROVED), referenced(0) {}
+};
+
+} // namespace
+
+/**
+ * @brief One independently locked slice of the cache
+ */
+class VerdictCache::Shard {
+public:
+    std::mutex mutex;
+    std::vector<CacheEntry> slots;
+};
+
+VerdictCache::Shard* VerdictCache::shards = nullptr;
+size_t VerdictCache::shardCount = 0;
+uint64_t VerdictCache::hashKey = 0;
+std::atomic<unsigned long> VerdictCache::generations[16];
+std::atomic<unsigned long> VerdictCache::hits(0);
+std::atomic<unsigned long> VerdictCache::misses(0);
+std::atomic<unsigned long> VerdictCache::insertions(0);
+std::atomic<unsigned long> VerdictCache::evictions(0);
+std::atomic<unsigned long> VerdictCache::invalidations(0);
+
+void VerdictCache::enable(size_t capacity) {
+    disable();
+
+    shardCount = 16;
+    size_t setsPerShard = capacity / (shardCount * SET_WAYS);
+    if (setsPerShard == 0) setsPerShard = 1;
+
+    std::random_device entropy;
+    hashKey = (static_cast<uint64_t>(entropy()) << 32) ^ entropy();
+
+    shards = new Shard[shardCount];
+    for (size_t i = 0; i < shardCount; i++) {
+        shards[i].slots.resize(setsPerShard * SET_WAYS);
+    }
+
+    LOG_INFO_IN(VALIDATION, "[VerdictCache] Enabled with room for " +
+             std::to_string(shardCount * setsPerShard * SET_WAYS) + " verdicts");
+}
+
+void VerdictCache::disable() {
+    delete[] shards;
+    shards = nullptr;
+    shardCount = 0;
+}
+
+bool VerdictCache::lookup(unsigned cacheKey, const std::string& message,
+                          unsigned long blockListVersion, ValidationVerdict& verdict) {
+    if (!shards) {
+        return false;
+    }
+
+    uint64_t hash = hashBytes(message.data(), message.length(), hashKey + cacheKey);
+    unsigned long generation = generations[cacheKey & 15].load(std::memory_order_relaxed);
+    Shard& shard = shards[hash % shardCount];
+    size_t base = ((hash >> 16) % (shard.slots.size() / SET_WAYS)) * SET_WAYS;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i = base; i < base + SET_WAYS; i++) {
+            CacheEntry& entry = shard.slots[i];
+            if (entry.cacheKey == cacheKey && entry.hash == hash &&
+                entry.blockListVersion == blockListVersion &&
+                entry.generation == generation && entry.text == message) {
+                entry.referenced = 1;
+                verdict = entry.verdict;
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void VerdictCache::store(unsigned cacheKey, const std::string& message,
+                         unsigned long blockListVersion, ValidationVerdict verdict) {
+    if (!shards) {
+        return;
+    }
+
+    uint64_t hash = hashBytes(message.data(), message.length(), hashKey + cacheKey);
+    unsigned long generation = generations[cacheKey & 15].load(std::memory_order_relaxed);
+    Shard& shard = shards[hash % shardCount];
+    size_t base = ((hash >> 16) % (shard.slots.size() / SET_WAYS)) * SET_WAYS;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Prefer the same key, then an empty or stale slot, then CLOCK
+    CacheEntry* victim = nullptr;
+    for (size_t i = base; i < base + SET_WAYS && !victim; i++) {
+        CacheEntry& entry = shard.slots[i];
+        if (entry.cacheKey == cacheKey && entry.hash == hash && entry.text == message) {
+            victim = &entry;
+        }
+    }
+    for (size_t i = base; i < base + SET_WAYS && !victim; i++) {
+        CacheEntry& entry = shard.slots[i];
+        if (entry.cacheKey == 0 || entry.blockListVersion != blockListVersion ||
+            entry.generation != generations[entry.cacheKey & 15].load(std::memory_order_relaxed)) {
+            victim = &entry;
+        }
+    }
+    for (size_t sweep = 0; sweep < 2 * SET_WAYS && !victim; sweep++) {
+        CacheEntry& entry = shard.slots[base + sweep % SET_WAYS];
+        if (entry.referenced) {
+            entry.referenced = 0;
+        } else {
+            victim = &entry;
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    victim->hash = hash;
+    victim->blockListVersion = blockListVersion;
+    victim->generation = generation;
+    victim->text = message;
+    victim->cacheKey = static_cast<unsigned char>(cacheKey);
+    victim->verdict = verdict;
+    victim->referenced = 0;
+    insertions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void VerdictCache::invalidate(unsigned cacheKey) {
+    generations[cacheKey & 15].fetch_add(1);
+    invalidations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void VerdictCache::invalidateAll() {
+    for (size_t i = 0; i < 16; i++) {
+        generations[i].fetch_add(1);
+    }
+    invalidations.fetch_add(1, std::memory_order_relaxed);
+}
+
+VerdictCacheStats VerdictCache::getStats() {
+    VerdictCacheStats stats;
+    stats.hits = hits.load();
+    stats.misses = misses.load();
+    stats.insertions = insertions.load();
+    stats.evictions = evictions.load();
+    stats.invalidations = invalidations.load();
+    return stats;
+}
+
+void VerdictCache::resetStats() {
+    hits = 0;
+    misses = 0;
+    insertions = 0;
+    evictions = 0;
+    invalidations = 0;
+}
+
+uint64_t VerdictCache::hashBytes(const char* data, size_t length, uint64_t seed) {
+    uint64_t hash = mix64(seed + 0x9e3779b97f4a7c15ULL) ^ (length * 0x9e3779b97f4a7c15ULL);
+
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t block;
+        std::memcpy(&block, data + i, 8);
+        hash = (hash ^ mix64(block)) * 0x9fb21c651e98df25ULL;
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, length - i);
+    hash ^= mix64(tail ^ (length - i));
+
+    return mix64(hash);
+}
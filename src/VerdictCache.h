@@ -0,0 +1,124 @@
+/**
+ * @file VerdictCache.h
+ * @brief Optional bounded cache of validation verdicts for repeated messages
+ * @author Megan Azmanov & Kyle McCalgan
+ * @date 2025-10-06
+ */
+
+#ifndef VERDICTCACHE_H
+#define VERDICTCACHE_H
+
+#include "ValidationStrategy.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Snapshot of the cache counters
+ */
+struct VerdictCacheStats {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long insertions;
+    unsigned long evictions;
+    unsigned long invalidations;
+
+    /**
+     * @brief Fraction of lookups answered from the cache
+     * @return Value in [0, 1], 0 when nothing was looked up
+     */
+    double hitRate() const {
+        unsigned long total = hits + misses;
+        return total ? static_cast<double>(hits) / total : 0.0;
+    }
+};
+
+/**
+ * @class VerdictCache
+ * @brief Shared cache mapping (strategy cache key, message hash) to a verdict
+ *
+ * Disabled by default. Entries live in hash-selected shards, each guarded by
+ * its own mutex and evicted with a CLOCK policy inside small 4-way sets, so
+ * concurrent validations rarely touch the same lock. Messages are hashed
+ * with a key drawn at random when the cache is enabled, and a hit also
+ * compares the stored text, so a crafted collision can't borrow another
+ * message's verdict.
+ *
+ * Entries are tagged with the block list version and a per-key generation;
+ * a mismatch on either is treated as a miss. Publishing new block lists or
+ * calling invalidate() therefore drops stale verdicts without a sweep.
+ */
+class VerdictCache {
+private:
+    class Shard;
+
+    static Shard* shards;
+    static size_t shardCount;
+    static uint64_t hashKey;
+    static std::atomic<unsigned long> generations[16];
+    static std::atomic<unsigned long> hits;
+    static std::atomic<unsigned long> misses;
+    static std::atomic<unsigned long> insertions;
+    static std::atomic<unsigned long> evictions;
+    static std::atomic<unsigned long> invalidations;
+
+public:
+    /**
+     * @brief Turn the cache on (call during setup, not while validating)
+     * @param capacity Maximum number of cached verdicts
+     */
+    static void enable(size_t capacity);
+
+    /**
+     * @brief Turn the cache off and free its memory
+     */
+    static void disable();
+
+    static bool isEnabled() { return shards != nullptr; }
+
+    /**
+     * @brief Look up a cached verdict
+     * @param cacheKey Strategy cache key (non-zero)
+     * @param message Message being validated
+     * @param blockListVersion Block list version the caller validates against
+     * @param verdict Receives the cached verdict on a hit
+     * @return true on a hit
+     */
+    static bool lookup(unsigned cacheKey, const std::string& message,
+                       unsigned long blockListVersion, ValidationVerdict& verdict);
+
+    /**
+     * @brief Remember a verdict
+     * @param cacheKey Strategy cache key (non-zero)
+     * @param message Message that was validated
+     * @param blockListVersion Block list version read before evaluating
+     * @param verdict Verdict to cache
+     */
+    static void store(unsigned cacheKey, const std::string& message,
+                      unsigned long blockListVersion, ValidationVerdict verdict);
+
+    /**
+     * @brief Drop every verdict cached under one strategy key
+     * @param cacheKey Strategy cache key
+     */
+    static void invalidate(unsigned cacheKey);
+
+    /**
+     * @brief Drop every cached verdict
+     */
+    static void invalidateAll();
+
+    static VerdictCacheStats getStats();
+    static void resetStats();
+
+    /**
+     * @brief Fast non-cryptographic 64-bit hash (8 bytes per step)
+     * @param data Bytes to hash
+     * @param length Number of bytes
+     * @param seed Seed mixed into the result
+     * @return Hash value
+     */
+    static uint64_t hashBytes(const char* data, size_t length, uint64_t seed);
+};
+
+#endif // VERDICTCACHE_H